@@ -0,0 +1,97 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.IO;
+
+// Engine-independent encode/mux/transmit pipeline (std C++ only, see Tools/CineSRTBench for the standalone build)
+public class CineSRTCore : ModuleRules
+{
+    public CineSRTCore(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+        
+        bUseUnity = false;
+        bUsePrecompiled = false;
+        
+        PublicIncludePaths.AddRange(
+            new string[] {
+                Path.Combine(ModuleDirectory, "Public")
+            }
+        );
+        
+        PrivateIncludePaths.AddRange(
+            new string[] {
+                Path.Combine(ModuleDirectory, "Private")
+            }
+        );
+        
+        // Core is only used by the module glue (log and ParallelFor hooks)
+        PrivateDependencyModuleNames.AddRange(
+            new string[]
+            {
+                "Core"
+            }
+        );
+        
+        // Add SRT library
+        string ThirdPartyPath = Path.Combine(ModuleDirectory, "..", "ThirdParty");
+        string SRTPath = Path.Combine(ThirdPartyPath, "SRT");
+        
+        PublicIncludePaths.Add(Path.Combine(SRTPath, "include"));
+        
+        if (Target.Platform == UnrealTargetPlatform.Win64)
+        {
+            // SRT 라이브러리 경로 (빌드 완료 후 활성화)
+            PublicAdditionalLibraries.Add(Path.Combine(SRTPath, "lib", "Win64", "srt.lib"));
+            
+            // Windows system libraries
+            PublicSystemLibraries.AddRange(new string[] {
+                "ws2_32.lib",
+                "winmm.lib"
+            });
+        }
+        else if (Target.Platform == UnrealTargetPlatform.Mac)
+        {
+            // PublicAdditionalLibraries.Add(Path.Combine(SRTPath, "lib", "Mac", "libsrt.a"));
+        }
+        else if (Target.Platform == UnrealTargetPlatform.Linux)
+        {
+            // PublicAdditionalLibraries.Add(Path.Combine(SRTPath, "lib", "Linux", "libsrt.a"));
+        }
+        
+        // OpenH264 for the software H.264 encoder (optional; falls back to MJPEG when absent)
+        string OpenH264Path = Path.Combine(ThirdPartyPath, "OpenH264");
+        bool bWithOpenH264 = Directory.Exists(Path.Combine(OpenH264Path, "include"));
+        
+        if (bWithOpenH264)
+        {
+            PrivateIncludePaths.Add(Path.Combine(OpenH264Path, "include"));
+            
+            if (Target.Platform == UnrealTargetPlatform.Win64)
+            {
+                PublicAdditionalLibraries.Add(Path.Combine(OpenH264Path, "lib", "Win64", "openh264.lib"));
+            }
+            else if (Target.Platform == UnrealTargetPlatform.Mac)
+            {
+                PublicAdditionalLibraries.Add(Path.Combine(OpenH264Path, "lib", "Mac", "libopenh264.a"));
+            }
+            else if (Target.Platform == UnrealTargetPlatform.Linux)
+            {
+                PublicAdditionalLibraries.Add(Path.Combine(OpenH264Path, "lib", "Linux", "libopenh264.a"));
+            }
+        }
+        
+        PublicDefinitions.Add("WITH_OPENH264=" + (bWithOpenH264 ? "1" : "0"));
+        
+        // libjpeg-turbo ships with the engine on every platform in the plugin allow list
+        AddEngineThirdPartyPrivateStaticDependencies(Target, "LibJpegTurbo");
+        PrivateDefinitions.Add("WITH_LIBJPEGTURBO=1");
+        
+        // Enable exceptions for SRT
+        bEnableExceptions = true;
+        
+        // SRT 매크로 정의 (암호화 비활성화)
+        PublicDefinitions.Add("WITH_SRT=1");
+        PublicDefinitions.Add("SRT_ENABLE_ENCRYPTION=0");
+    }
+}
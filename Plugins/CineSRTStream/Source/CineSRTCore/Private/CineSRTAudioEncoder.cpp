@@ -0,0 +1,189 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTAudioEncoder.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace CineSRT
+{
+    namespace
+    {
+        constexpr int32 Aes3HeaderSize = 4;
+
+        // PES_packet_length(16비트) = 플래그 3 + PTS 5 + AES3 헤더 + 데이터
+        constexpr int32 MaxAes3DataSize = 0xFFFF - 3 - 5 - Aes3HeaderSize;
+
+        // 한 패킷에 넣는 최대 길이 - 작은 버퍼를 모을 때도 오디오 지연이 이 이상 늘지 않음
+        constexpr int32 MaxPacketMs = 40;
+
+        // 버퍼 도착 시각이 샘플 수로 센 시각에서 이만큼 벗어나면 시계를 다시 맞춤 (멈춤, 장치 변경)
+        constexpr double ClockResyncSeconds = 0.05;
+
+        // 버퍼마다 도착 시각 쪽으로 옮기는 비율 - 콜백 지터는 거르고 장치 클록 드리프트만 따라감
+        constexpr double ClockSlew = 0.01;
+
+        // 한 번에 옮기는 최대 폭: 90kHz 한 틱(11us)보다 작게 두어 패킷 PTS가 샘플 수와 어긋나 보이지 않게 함
+        constexpr double MaxClockSlewSeconds = 0.00001;
+
+        // AES3 블록 = 192 프레임, 블록 첫 프레임에 F(framing) 비트
+        constexpr int32 Aes3BlockFrames = 192;
+
+        uint32 ReverseBits(uint32 Value, int32 NumBits)
+        {
+            Value = ((Value >> 1) & 0x55555555u) | ((Value & 0x55555555u) << 1);
+            Value = ((Value >> 2) & 0x33333333u) | ((Value & 0x33333333u) << 2);
+            Value = ((Value >> 4) & 0x0F0F0F0Fu) | ((Value & 0x0F0F0F0Fu) << 4);
+            Value = ((Value >> 8) & 0x00FF00FFu) | ((Value & 0x00FF00FFu) << 8);
+            Value = (Value >> 16) | (Value << 16);
+            return Value >> (32 - NumBits);
+        }
+    }
+
+    FAudioEncoder::FAudioEncoder(const FConfig& InConfig)
+        : Config(InConfig)
+    {
+        Config.NumChannels = std::min(std::max(Config.NumChannels + (Config.NumChannels & 1), 2), 8);
+        Config.BitsPerSample = Config.BitsPerSample >= 24 ? 24 : Config.BitsPerSample >= 20 ? 20 : 16;
+
+        // 채널 쌍마다 서브프레임 두 개 = 2 x (샘플 + VUCF 4비트), 항상 바이트 경계
+        BytesPerFrame = Config.NumChannels * (Config.BitsPerSample + 4) / 8;
+        MaxPacketFrames = std::min(MaxAes3DataSize / BytesPerFrame, SampleRate * MaxPacketMs / 1000);
+        Config.MinPacketFrames = std::min(std::max(Config.MinPacketFrames, 1), MaxPacketFrames);
+    }
+
+    void FAudioEncoder::Reset()
+    {
+        ClockOrigin = -1.0;
+        ClockFrames = 0;
+        Pending.reset();
+        FramingIndex = 0;
+    }
+
+    bool FAudioEncoder::Encode(const float* Samples, int32 NumFrames, int32 InNumChannels, int32 InSampleRate, double Now, FPacketSink Sink)
+    {
+        if (InSampleRate != SampleRate)
+        {
+            if (!bWarnedSampleRate)
+            {
+                Logf(ELogLevel::Warning, "Audio at %d Hz cannot be carried as SMPTE 302M (48 kHz only); audio is not streamed", InSampleRate);
+                bWarnedSampleRate = true;
+            }
+            return false;
+        }
+        if (!Samples || NumFrames <= 0 || InNumChannels <= 0)
+        {
+            return true;
+        }
+
+        // 버퍼는 Now에 렌더링을 마친 구간 - 첫 샘플 시각은 샘플 수로 이어 가고, 도착 시각은 드리프트 보정에만
+        const double BufferStart = Now - (double)NumFrames / SampleRate + Config.TimeOffsetSeconds;
+        if (ClockOrigin < 0.0)
+        {
+            ClockOrigin = BufferStart;
+            ClockFrames = 0;
+        }
+        else
+        {
+            const double Error = BufferStart - (ClockOrigin + (double)ClockFrames / SampleRate);
+            if (std::abs(Error) > ClockResyncSeconds)
+            {
+                // 끊긴 구간 앞뒤가 한 패킷에 섞이지 않도록 모으던 것부터 내보냄
+                if (Pending)
+                {
+                    FinishPacket(Sink);
+                }
+                ClockOrigin = BufferStart;
+                ClockFrames = 0;
+                ClockResyncs++;
+            }
+            else
+            {
+                ClockOrigin += std::min(std::max(Error * ClockSlew, -MaxClockSlewSeconds), MaxClockSlewSeconds);
+            }
+        }
+        double FrameTime = ClockOrigin + (double)ClockFrames / SampleRate;
+        ClockFrames += NumFrames;
+
+        while (NumFrames > 0)
+        {
+            if (!Pending)
+            {
+                Pending = std::make_shared<FEncodedAudio>();
+                Pending->Data.reserve(Aes3HeaderSize + (size_t)MaxPacketFrames * BytesPerFrame);
+                Pending->Data.resize(Aes3HeaderSize);
+                Pending->SampleRate = SampleRate;
+                Pending->CaptureTime = FrameTime;
+            }
+
+            const int32 Take = std::min(NumFrames, MaxPacketFrames - Pending->NumFrames);
+            const size_t Offset = Pending->Data.size();
+            Pending->Data.resize(Offset + (size_t)Take * BytesPerFrame);
+            PackFrames(Samples, Take, InNumChannels, Pending->Data.data() + Offset);
+            Pending->NumFrames += Take;
+            Samples += (size_t)Take * InNumChannels;
+            NumFrames -= Take;
+            FrameTime += (double)Take / SampleRate;
+
+            if (Pending->NumFrames >= MaxPacketFrames)
+            {
+                FinishPacket(Sink);
+            }
+        }
+
+        if (Pending && Pending->NumFrames >= Config.MinPacketFrames)
+        {
+            FinishPacket(Sink);
+        }
+        return true;
+    }
+
+    void FAudioEncoder::PackFrames(const float* Samples, int32 NumFrames, int32 InNumChannels, uint8* Out)
+    {
+        const int32 Bits = Config.BitsPerSample;
+        const double Scale = (double)((1 << (Bits - 1)) - 1);
+        const uint32 Mask = (1u << Bits) - 1;
+        const int32 NumChannels = Config.NumChannels;
+
+        for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+        {
+            const float* Input = Samples + (size_t)Frame * InNumChannels;
+            const uint32 Framing = FramingIndex == 0 ? 1u : 0u;
+            FramingIndex = (FramingIndex + 1) % Aes3BlockFrames;
+
+            for (int32 Pair = 0; Pair < NumChannels; Pair += 2)
+            {
+                // AES3 서브프레임: 샘플을 LSB부터, 그 뒤에 V U C F. 쌍 하나가 바이트 경계에서 끝나므로 쌍마다 비움
+                uint64 Accumulator = 0;
+                for (int32 Sub = 0; Sub < 2; ++Sub)
+                {
+                    const int32 Channel = Pair + Sub;
+                    const int32 Source = InNumChannels == 1 ? (Channel < 2 ? 0 : -1) : (Channel < InNumChannels ? Channel : -1);
+                    const float Sample = Source >= 0 ? std::min(std::max(Input[Source], -1.0f), 1.0f) : 0.0f;
+                    const uint32 Value = (uint32)(int32)std::lround(Sample * Scale) & Mask;
+                    Accumulator = (Accumulator << Bits) | ReverseBits(Value, Bits);
+                    Accumulator = (Accumulator << 4) | (Sub == 0 ? Framing : 0u);
+                }
+                for (int32 Shift = 2 * (Bits + 4) - 8; Shift >= 0; Shift -= 8)
+                {
+                    *Out++ = (uint8)(Accumulator >> Shift);
+                }
+            }
+        }
+    }
+
+    void FAudioEncoder::FinishPacket(FPacketSink& Sink)
+    {
+        // AES3 헤더: audio_packet_size(16) number_channels(2) channel_identification(8) bits_per_sample(2) alignment(4)
+        uint8* Header = Pending->Data.data();
+        const int32 PacketSize = (int32)Pending->Data.size() - Aes3HeaderSize;
+        const uint32 ChannelCode = (uint32)(Config.NumChannels / 2 - 1);
+        const uint32 BitsCode = (uint32)((Config.BitsPerSample - 16) / 4);
+        Header[0] = (uint8)(PacketSize >> 8);
+        Header[1] = (uint8)PacketSize;
+        Header[2] = (uint8)(ChannelCode << 6);
+        Header[3] = (uint8)(BitsCode << 4);
+        Sink(std::move(Pending));
+        Pending.reset();
+    }
+}
@@ -0,0 +1,145 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTBitrateController.h"
+
+#include <algorithm>
+
+namespace CineSRT
+{
+    FBitrateController::FBitrateController(const FSettings& InSettings)
+        : Settings(InSettings)
+    {
+        if (Settings.Ladder.empty())
+        {
+            Settings.Ladder.push_back(FBitrateRung());
+        }
+        Reset();
+    }
+
+    void FBitrateController::Reset()
+    {
+        CurrentRung = std::min(std::max(Settings.StartRung, 0), GetNumRungs() - 1);
+        CongestedSamples = 0;
+        CleanSince = -1.0;
+        LastChangeTime = -1.0;
+        LastUpgradeTime = -1.0;
+        UpgradeHold = Settings.UpgradeHoldSeconds;
+    }
+
+    bool FBitrateController::IsCongested(const FTransmitter::FLinkStats& Sample) const
+    {
+        if (Sample.PacketsDropped > 0)
+        {
+            return true;
+        }
+        if (Sample.SendBufferMs > Settings.LatencyMs * Settings.DowngradeBufferRatio)
+        {
+            return true;
+        }
+        if (Sample.SendBufferFill > Settings.DowngradeBufferFill)
+        {
+            return true;
+        }
+        return Sample.PacketsSent > 0 && (float)Sample.PacketsLost / (float)Sample.PacketsSent > Settings.DowngradeLossRate;
+    }
+
+    bool FBitrateController::Update(const FTransmitter::FLinkStats& Sample, double Now)
+    {
+        if (Sample.NumClients == 0)
+        {
+            // 받는 쪽이 없으면 링크에 대해 알 수 있는 게 없음
+            CongestedSamples = 0;
+            CleanSince = -1.0;
+            return false;
+        }
+
+        const bool bSettling = LastChangeTime >= 0.0 && Now - LastChangeTime < Settings.SettleSeconds;
+
+        if (IsCongested(Sample))
+        {
+            CleanSince = -1.0;
+            if (bSettling)
+            {
+                // 직전 변경의 효과가 아직 버퍼에 반영되지 않음
+                return false;
+            }
+
+            CongestedSamples++;
+            const bool bDropping = Sample.PacketsDropped > 0;
+            if ((bDropping || CongestedSamples >= Settings.DowngradeSamples) && CurrentRung + 1 < GetNumRungs())
+            {
+                // 올린 직후 다시 막히면 그 단계는 이 링크에 무리 - 다음 승급은 더 오래 기다림
+                if (LastUpgradeTime >= 0.0 && Now - LastUpgradeTime < UpgradeHold + Settings.SettleSeconds)
+                {
+                    UpgradeHold = std::min(UpgradeHold * 2.0, Settings.MaxUpgradeHoldSeconds);
+                }
+                ChangeRung(CurrentRung + 1, Now);
+                return true;
+            }
+            return false;
+        }
+
+        CongestedSamples = 0;
+        if (CleanSince < 0.0)
+        {
+            CleanSince = Now;
+        }
+
+        // 오래 안정적이면 승급 대기 시간을 원래대로
+        if (LastChangeTime >= 0.0 && Now - LastChangeTime > Settings.MaxUpgradeHoldSeconds)
+        {
+            UpgradeHold = Settings.UpgradeHoldSeconds;
+        }
+
+        if (CurrentRung == 0 || bSettling || Now - CleanSince < UpgradeHold)
+        {
+            return false;
+        }
+
+        // 현재 실제 송신량을 다음 단계 비율로 늘려 추정 대역폭 안에 들어오는지 확인
+        const FBitrateRung& Current = Settings.Ladder[CurrentRung];
+        const FBitrateRung& Next = Settings.Ladder[CurrentRung - 1];
+        if (Sample.BandwidthMbps > 0.0 && Sample.SendRateMbps > 0.0 && Current.Bitrate > 0)
+        {
+            const double ExpectedMbps = Sample.SendRateMbps * Next.Bitrate / Current.Bitrate;
+            if (ExpectedMbps > Sample.BandwidthMbps * Settings.UpgradeHeadroom)
+            {
+                return false;
+            }
+        }
+
+        ChangeRung(CurrentRung - 1, Now);
+        LastUpgradeTime = Now;
+        return true;
+    }
+
+    void FBitrateController::ChangeRung(int32 NewRung, double Now)
+    {
+        const FBitrateRung& From = Settings.Ladder[CurrentRung];
+        const FBitrateRung& To = Settings.Ladder[NewRung];
+        Logf(ELogLevel::Log, "Adaptive bitrate: rung %d -> %d (%d -> %d Kbps, JPEG quality %d -> %d)",
+            CurrentRung, NewRung, From.Bitrate, To.Bitrate, From.JpegQuality, To.JpegQuality);
+
+        CurrentRung = NewRung;
+        CongestedSamples = 0;
+        CleanSince = -1.0;
+        LastChangeTime = Now;
+    }
+
+    std::vector<FBitrateRung> FBitrateController::MakeDefaultLadder(const FBitrateRung& Top)
+    {
+        // JPEG 품질은 크기와 비선형이라 비트레이트 비율과 대략 맞춘 값
+        static const float BitrateScales[] = { 1.0f, 0.75f, 0.5f, 0.35f, 0.25f };
+        static const float QualityScales[] = { 1.0f, 0.85f, 0.7f, 0.55f, 0.4f };
+
+        std::vector<FBitrateRung> Ladder;
+        for (int32 Index = 0; Index < (int32)(sizeof(BitrateScales) / sizeof(BitrateScales[0])); ++Index)
+        {
+            FBitrateRung Rung = Top;
+            Rung.Bitrate = std::max((int32)(Top.Bitrate * BitrateScales[Index]), 100);
+            Rung.JpegQuality = std::max((int32)(Top.JpegQuality * QualityScales[Index]), 10);
+            Ladder.push_back(Rung);
+        }
+        return Ladder;
+    }
+}
@@ -0,0 +1,364 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTColorConvert.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+    // MSVC emits any intrinsic without flags; GCC/Clang need the target enabled per function
+    #if defined(__clang__) || defined(__GNUC__)
+        #define SRT_TARGET_SSE41 __attribute__((target("sse4.1")))
+        #define SRT_TARGET_AVX2 __attribute__((target("avx2")))
+    #else
+        #define SRT_TARGET_SSE41
+        #define SRT_TARGET_AVX2
+    #endif
+    #define SRT_WITH_X86_KERNELS 1
+#else
+    #define SRT_WITH_X86_KERNELS 0
+#endif
+
+namespace CineSRT
+{
+    namespace
+    {
+        // BT.709 limited range, coefficients scaled by 256
+        //   Y = (( 47 R + 157 G +  16 B + 128) >> 8) + 16
+        //   U = ((-26 R -  86 G + 112 B + 128) >> 8) + 128
+        //   V = ((112 R - 102 G -  10 B + 128) >> 8) + 128
+        // Chroma is taken from the rounded 2x2 average of each channel.
+
+        inline uint8 ComputeLuma(const uint8* Pixel)
+        {
+            return (uint8)(((47 * Pixel[2] + 157 * Pixel[1] + 16 * Pixel[0] + 128) >> 8) + 16);
+        }
+
+        /** One pair of source rows -> two luma rows and one chroma row, columns [Begin, End). */
+        template<bool bInterleaved>
+        void ConvertRowPairScalar(const uint8* Src0, const uint8* Src1, uint8* Y0, uint8* Y1, uint8* U, uint8* V, int32 Begin, int32 End)
+        {
+            for (int32 X = Begin; X < End; X += 2)
+            {
+                const uint8* P00 = Src0 + X * 4;
+                const uint8* P01 = P00 + 4;
+                const uint8* P10 = Src1 + X * 4;
+                const uint8* P11 = P10 + 4;
+                Y0[X] = ComputeLuma(P00);
+                Y0[X + 1] = ComputeLuma(P01);
+                Y1[X] = ComputeLuma(P10);
+                Y1[X + 1] = ComputeLuma(P11);
+
+                const int32 B = (P00[0] + P01[0] + P10[0] + P11[0] + 2) >> 2;
+                const int32 G = (P00[1] + P01[1] + P10[1] + P11[1] + 2) >> 2;
+                const int32 R = (P00[2] + P01[2] + P10[2] + P11[2] + 2) >> 2;
+                const uint8 Cb = (uint8)(((-26 * R - 86 * G + 112 * B + 128) >> 8) + 128);
+                const uint8 Cr = (uint8)(((112 * R - 102 * G - 10 * B + 128) >> 8) + 128);
+                if (bInterleaved)
+                {
+                    U[X] = Cb;
+                    U[X + 1] = Cr;
+                }
+                else
+                {
+                    U[X / 2] = Cb;
+                    V[X / 2] = Cr;
+                }
+            }
+        }
+
+#if SRT_WITH_X86_KERNELS
+        // --- SSE4.1: 16 pixels per row pair per iteration ---
+        //
+        // BGRA bytes are widened to 16-bit and multiplied with (B, G, R, A) coefficient quads via
+        // madd, which leaves two 32-bit partial sums per pixel; hadd folds them into one sum per pixel.
+        // Every intermediate is exact, so the result matches the scalar path bit for bit.
+
+        SRT_TARGET_SSE41 static inline __m128i LumaX4SSE41(__m128i Pixels)
+        {
+            const __m128i Zero = _mm_setzero_si128();
+            const __m128i Coef = _mm_setr_epi16(16, 157, 47, 0, 16, 157, 47, 0);
+            const __m128i Lo = _mm_madd_epi16(_mm_unpacklo_epi8(Pixels, Zero), Coef);
+            const __m128i Hi = _mm_madd_epi16(_mm_unpackhi_epi8(Pixels, Zero), Coef);
+            const __m128i Sum = _mm_hadd_epi32(Lo, Hi);
+            return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(Sum, _mm_set1_epi32(128)), 8), _mm_set1_epi32(16));
+        }
+
+        /** Four pixels from each row -> two averaged BGRA quads (16-bit). */
+        SRT_TARGET_SSE41 static inline __m128i Average2x2SSE41(__m128i Row0, __m128i Row1)
+        {
+            const __m128i Zero = _mm_setzero_si128();
+            const __m128i Lo = _mm_add_epi16(_mm_unpacklo_epi8(Row0, Zero), _mm_unpacklo_epi8(Row1, Zero)); // px0, px1
+            const __m128i Hi = _mm_add_epi16(_mm_unpackhi_epi8(Row0, Zero), _mm_unpackhi_epi8(Row1, Zero)); // px2, px3
+            const __m128i Sum = _mm_add_epi16(_mm_unpacklo_epi64(Lo, Hi), _mm_unpackhi_epi64(Lo, Hi));
+            return _mm_srli_epi16(_mm_add_epi16(Sum, _mm_set1_epi16(2)), 2);
+        }
+
+        SRT_TARGET_SSE41 static inline __m128i ChromaX4SSE41(__m128i AverageA, __m128i AverageB, __m128i Coef)
+        {
+            const __m128i Sum = _mm_hadd_epi32(_mm_madd_epi16(AverageA, Coef), _mm_madd_epi16(AverageB, Coef));
+            return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(Sum, _mm_set1_epi32(128)), 8), _mm_set1_epi32(128));
+        }
+
+        template<bool bInterleaved>
+        SRT_TARGET_SSE41 int32 ConvertRowPairSSE41(const uint8* Src0, const uint8* Src1, uint8* Y0, uint8* Y1, uint8* U, uint8* V, int32 Width)
+        {
+            const __m128i CoefU = _mm_setr_epi16(112, -86, -26, 0, 112, -86, -26, 0);
+            const __m128i CoefV = _mm_setr_epi16(-10, -102, 112, 0, -10, -102, 112, 0);
+
+            int32 X = 0;
+            for (; X + 16 <= Width; X += 16)
+            {
+                const __m128i* Row0 = reinterpret_cast<const __m128i*>(Src0 + X * 4);
+                const __m128i* Row1 = reinterpret_cast<const __m128i*>(Src1 + X * 4);
+                const __m128i A0 = _mm_loadu_si128(Row0 + 0), A1 = _mm_loadu_si128(Row0 + 1), A2 = _mm_loadu_si128(Row0 + 2), A3 = _mm_loadu_si128(Row0 + 3);
+                const __m128i B0 = _mm_loadu_si128(Row1 + 0), B1 = _mm_loadu_si128(Row1 + 1), B2 = _mm_loadu_si128(Row1 + 2), B3 = _mm_loadu_si128(Row1 + 3);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(Y0 + X), _mm_packus_epi16(
+                    _mm_packs_epi32(LumaX4SSE41(A0), LumaX4SSE41(A1)), _mm_packs_epi32(LumaX4SSE41(A2), LumaX4SSE41(A3))));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(Y1 + X), _mm_packus_epi16(
+                    _mm_packs_epi32(LumaX4SSE41(B0), LumaX4SSE41(B1)), _mm_packs_epi32(LumaX4SSE41(B2), LumaX4SSE41(B3))));
+
+                const __m128i Avg0 = Average2x2SSE41(A0, B0);
+                const __m128i Avg1 = Average2x2SSE41(A1, B1);
+                const __m128i Avg2 = Average2x2SSE41(A2, B2);
+                const __m128i Avg3 = Average2x2SSE41(A3, B3);
+                const __m128i Cb = _mm_packs_epi32(ChromaX4SSE41(Avg0, Avg1, CoefU), ChromaX4SSE41(Avg2, Avg3, CoefU));
+                const __m128i Cr = _mm_packs_epi32(ChromaX4SSE41(Avg0, Avg1, CoefV), ChromaX4SSE41(Avg2, Avg3, CoefV));
+                if (bInterleaved)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(U + X), _mm_or_si128(Cb, _mm_slli_epi16(Cr, 8)));
+                }
+                else
+                {
+                    const __m128i Packed = _mm_packus_epi16(Cb, Cr);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(U + X / 2), Packed);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(V + X / 2), _mm_unpackhi_epi64(Packed, Packed));
+                }
+            }
+            return X;
+        }
+
+        // --- AVX2: 32 pixels per row pair per iteration ---
+        //
+        // Same arithmetic on 256-bit registers. unpack/hadd/pack work within 128-bit lanes, so the
+        // results come out lane-interleaved and are put back in pixel order with one permute.
+
+        SRT_TARGET_AVX2 static inline __m256i LumaX8AVX2(__m256i Pixels)
+        {
+            const __m256i Zero = _mm256_setzero_si256();
+            const __m256i Coef = _mm256_setr_epi16(16, 157, 47, 0, 16, 157, 47, 0, 16, 157, 47, 0, 16, 157, 47, 0);
+            const __m256i Lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(Pixels, Zero), Coef);
+            const __m256i Hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(Pixels, Zero), Coef);
+            const __m256i Sum = _mm256_hadd_epi32(Lo, Hi); // y0..y7 in order
+            return _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(Sum, _mm256_set1_epi32(128)), 8), _mm256_set1_epi32(16));
+        }
+
+        SRT_TARGET_AVX2 static inline __m256i Average2x2AVX2(__m256i Row0, __m256i Row1)
+        {
+            const __m256i Zero = _mm256_setzero_si256();
+            const __m256i Lo = _mm256_add_epi16(_mm256_unpacklo_epi8(Row0, Zero), _mm256_unpacklo_epi8(Row1, Zero));
+            const __m256i Hi = _mm256_add_epi16(_mm256_unpackhi_epi8(Row0, Zero), _mm256_unpackhi_epi8(Row1, Zero));
+            const __m256i Sum = _mm256_add_epi16(_mm256_unpacklo_epi64(Lo, Hi), _mm256_unpackhi_epi64(Lo, Hi));
+            return _mm256_srli_epi16(_mm256_add_epi16(Sum, _mm256_set1_epi16(2)), 2); // c0, c1 | c2, c3
+        }
+
+        SRT_TARGET_AVX2 static inline __m256i ChromaX8AVX2(__m256i AverageA, __m256i AverageB, __m256i Coef)
+        {
+            // hadd gives c0 c1 c4 c5 | c2 c3 c6 c7
+            const __m256i Sum = _mm256_permutevar8x32_epi32(
+                _mm256_hadd_epi32(_mm256_madd_epi16(AverageA, Coef), _mm256_madd_epi16(AverageB, Coef)),
+                _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7));
+            return _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(Sum, _mm256_set1_epi32(128)), 8), _mm256_set1_epi32(128));
+        }
+
+        /** Eight in-order 32-bit values from each input -> sixteen in-order 16-bit values. */
+        SRT_TARGET_AVX2 static inline __m256i PackOrderedAVX2(__m256i A, __m256i B)
+        {
+            return _mm256_permute4x64_epi64(_mm256_packs_epi32(A, B), _MM_SHUFFLE(3, 1, 2, 0));
+        }
+
+        template<bool bInterleaved>
+        SRT_TARGET_AVX2 int32 ConvertRowPairAVX2(const uint8* Src0, const uint8* Src1, uint8* Y0, uint8* Y1, uint8* U, uint8* V, int32 Width)
+        {
+            const __m256i CoefU = _mm256_setr_epi16(112, -86, -26, 0, 112, -86, -26, 0, 112, -86, -26, 0, 112, -86, -26, 0);
+            const __m256i CoefV = _mm256_setr_epi16(-10, -102, 112, 0, -10, -102, 112, 0, -10, -102, 112, 0, -10, -102, 112, 0);
+            const __m256i LumaOrder = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+            int32 X = 0;
+            for (; X + 32 <= Width; X += 32)
+            {
+                const __m256i* Row0 = reinterpret_cast<const __m256i*>(Src0 + X * 4);
+                const __m256i* Row1 = reinterpret_cast<const __m256i*>(Src1 + X * 4);
+                const __m256i A0 = _mm256_loadu_si256(Row0 + 0), A1 = _mm256_loadu_si256(Row0 + 1), A2 = _mm256_loadu_si256(Row0 + 2), A3 = _mm256_loadu_si256(Row0 + 3);
+                const __m256i B0 = _mm256_loadu_si256(Row1 + 0), B1 = _mm256_loadu_si256(Row1 + 1), B2 = _mm256_loadu_si256(Row1 + 2), B3 = _mm256_loadu_si256(Row1 + 3);
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(Y0 + X), _mm256_permutevar8x32_epi32(_mm256_packus_epi16(
+                    _mm256_packs_epi32(LumaX8AVX2(A0), LumaX8AVX2(A1)), _mm256_packs_epi32(LumaX8AVX2(A2), LumaX8AVX2(A3))), LumaOrder));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(Y1 + X), _mm256_permutevar8x32_epi32(_mm256_packus_epi16(
+                    _mm256_packs_epi32(LumaX8AVX2(B0), LumaX8AVX2(B1)), _mm256_packs_epi32(LumaX8AVX2(B2), LumaX8AVX2(B3))), LumaOrder));
+
+                const __m256i Avg0 = Average2x2AVX2(A0, B0);
+                const __m256i Avg1 = Average2x2AVX2(A1, B1);
+                const __m256i Avg2 = Average2x2AVX2(A2, B2);
+                const __m256i Avg3 = Average2x2AVX2(A3, B3);
+                const __m256i Cb = PackOrderedAVX2(ChromaX8AVX2(Avg0, Avg1, CoefU), ChromaX8AVX2(Avg2, Avg3, CoefU));
+                const __m256i Cr = PackOrderedAVX2(ChromaX8AVX2(Avg0, Avg1, CoefV), ChromaX8AVX2(Avg2, Avg3, CoefV));
+                if (bInterleaved)
+                {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(U + X), _mm256_or_si256(Cb, _mm256_slli_epi16(Cr, 8)));
+                }
+                else
+                {
+                    // U c0-7, V c0-7 | U c8-15, V c8-15 -> U c0-15 | V c0-15
+                    const __m256i Packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(Cb, Cr), _MM_SHUFFLE(3, 1, 2, 0));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(U + X / 2), _mm256_castsi256_si128(Packed));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(V + X / 2), _mm256_extracti128_si256(Packed, 1));
+                }
+            }
+            return X;
+        }
+
+        bool DetectCpuFeature(EColorKernel Kernel)
+        {
+        #if defined(_MSC_VER) && !defined(__clang__)
+            int32 Info[4];
+            __cpuid(Info, 1);
+            const bool bSSE41 = (Info[2] & (1 << 19)) != 0;
+            const bool bOSXSave = (Info[2] & (1 << 27)) != 0;
+            const bool bAVX = (Info[2] & (1 << 28)) != 0;
+            if (Kernel == EColorKernel::SSE41)
+            {
+                return bSSE41;
+            }
+            if (!bOSXSave || !bAVX || (_xgetbv(0) & 0x6) != 0x6)
+            {
+                return false;
+            }
+            __cpuidex(Info, 7, 0);
+            return (Info[1] & (1 << 5)) != 0;
+        #else
+            __builtin_cpu_init();
+            return Kernel == EColorKernel::SSE41 ? __builtin_cpu_supports("sse4.1") != 0 : __builtin_cpu_supports("avx2") != 0;
+        #endif
+        }
+#endif // SRT_WITH_X86_KERNELS
+
+        template<bool bInterleaved>
+        bool ConvertBGRA(const uint8* BGRA, int32 Width, int32 Height, int32 SrcStride, uint8* OutY, uint8* OutU, uint8* OutV,
+            EColorKernel Kernel, bool bParallel)
+        {
+            if (!BGRA || !OutY || !OutU || (!bInterleaved && !OutV) || Width <= 0 || Height <= 0 || (Width % 2) != 0 || (Height % 2) != 0)
+            {
+                return false;
+            }
+            if (SrcStride <= 0)
+            {
+                SrcStride = Width * 4;
+            }
+            if (Kernel == EColorKernel::Auto || !FColorConverter::IsKernelSupported(Kernel))
+            {
+                Kernel = FColorConverter::GetBestKernel();
+            }
+
+            const int32 ChromaStride = bInterleaved ? Width : Width / 2;
+            const int32 NumRowPairs = Height / 2;
+
+            auto ConvertRowPairs = [=](int32 BeginPair, int32 EndPair)
+            {
+                for (int32 Pair = BeginPair; Pair < EndPair; ++Pair)
+                {
+                    const uint8* Src0 = BGRA + (std::size_t)(Pair * 2) * SrcStride;
+                    const uint8* Src1 = Src0 + SrcStride;
+                    uint8* Y0 = OutY + (std::size_t)(Pair * 2) * Width;
+                    uint8* Y1 = Y0 + Width;
+                    uint8* U = OutU + (std::size_t)Pair * ChromaStride;
+                    uint8* V = bInterleaved ? nullptr : OutV + (std::size_t)Pair * ChromaStride;
+
+                    int32 Done = 0;
+#if SRT_WITH_X86_KERNELS
+                    if (Kernel == EColorKernel::AVX2)
+                    {
+                        Done = ConvertRowPairAVX2<bInterleaved>(Src0, Src1, Y0, Y1, U, V, Width);
+                    }
+                    else if (Kernel == EColorKernel::SSE41)
+                    {
+                        Done = ConvertRowPairSSE41<bInterleaved>(Src0, Src1, Y0, Y1, U, V, Width);
+                    }
+#endif
+                    // Columns the SIMD loop could not cover (or the whole row for the scalar kernel)
+                    ConvertRowPairScalar<bInterleaved>(Src0, Src1, Y0, Y1, U, V, Done, Width);
+                }
+            };
+
+            // Bands of at least 32 row pairs keep task overhead well below the conversion cost
+            constexpr int32 MinPairsPerBand = 32;
+            const int32 NumBands = bParallel ? std::max(1, std::min(NumRowPairs / MinPairsPerBand, GetNumberOfCores())) : 1;
+            if (NumBands <= 1)
+            {
+                ConvertRowPairs(0, NumRowPairs);
+                return true;
+            }
+
+            const int32 PairsPerBand = (NumRowPairs + NumBands - 1) / NumBands;
+            ParallelFor(NumBands, [&](int32 Band)
+            {
+                const int32 BeginPair = Band * PairsPerBand;
+                ConvertRowPairs(BeginPair, std::min(BeginPair + PairsPerBand, NumRowPairs));
+            });
+            return true;
+        }
+    }
+
+    bool FColorConverter::ConvertBGRAToI420(const uint8* BGRA, int32 Width, int32 Height, int32 SrcStride,
+        uint8* OutY, uint8* OutU, uint8* OutV, EColorKernel Kernel, bool bParallel)
+    {
+        return ConvertBGRA<false>(BGRA, Width, Height, SrcStride, OutY, OutU, OutV, Kernel, bParallel);
+    }
+
+    bool FColorConverter::ConvertBGRAToNV12(const uint8* BGRA, int32 Width, int32 Height, int32 SrcStride,
+        uint8* OutY, uint8* OutUV, EColorKernel Kernel, bool bParallel)
+    {
+        return ConvertBGRA<true>(BGRA, Width, Height, SrcStride, OutY, OutUV, nullptr, Kernel, bParallel);
+    }
+
+    EColorKernel FColorConverter::GetBestKernel()
+    {
+        static const EColorKernel BestKernel =
+            IsKernelSupported(EColorKernel::AVX2) ? EColorKernel::AVX2 :
+            IsKernelSupported(EColorKernel::SSE41) ? EColorKernel::SSE41 :
+            EColorKernel::Scalar;
+        return BestKernel;
+    }
+
+    bool FColorConverter::IsKernelSupported(EColorKernel Kernel)
+    {
+        switch (Kernel)
+        {
+            case EColorKernel::Scalar:
+                return true;
+#if SRT_WITH_X86_KERNELS
+            case EColorKernel::SSE41:
+            case EColorKernel::AVX2:
+                return DetectCpuFeature(Kernel);
+#endif
+            default:
+                return false;
+        }
+    }
+
+    const char* FColorConverter::GetKernelName(EColorKernel Kernel)
+    {
+        switch (Kernel)
+        {
+            case EColorKernel::Scalar: return "Scalar";
+            case EColorKernel::SSE41:  return "SSE4.1";
+            case EColorKernel::AVX2:   return "AVX2";
+            default:                   return "Auto";
+        }
+    }
+}
@@ -0,0 +1,155 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTCore.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(__APPLE__) || defined(__linux__)
+    #include <pthread.h>
+#endif
+
+namespace CineSRT
+{
+    namespace
+    {
+        std::mutex& GetHookMutex()
+        {
+            static std::mutex Mutex;
+            return Mutex;
+        }
+
+        // Handlers are swapped as a whole so a log call never sees a half-assigned std::function
+        std::shared_ptr<const FLogHandler>& GetLogHandler()
+        {
+            static std::shared_ptr<const FLogHandler> Handler;
+            return Handler;
+        }
+
+        std::shared_ptr<const FParallelForHandler>& GetParallelForHandler()
+        {
+            static std::shared_ptr<const FParallelForHandler> Handler;
+            return Handler;
+        }
+
+        const char* GetLevelName(ELogLevel Level)
+        {
+            switch (Level)
+            {
+                case ELogLevel::Verbose: return "Verbose";
+                case ELogLevel::Warning: return "Warning";
+                case ELogLevel::Error:   return "Error";
+                default:                 return "Log";
+            }
+        }
+    }
+
+    void SetLogHandler(FLogHandler Handler)
+    {
+        std::shared_ptr<const FLogHandler> NewHandler = Handler ? std::make_shared<const FLogHandler>(std::move(Handler)) : nullptr;
+        std::lock_guard<std::mutex> Lock(GetHookMutex());
+        GetLogHandler() = std::move(NewHandler);
+    }
+
+    void Logf(ELogLevel Level, const char* Format, ...)
+    {
+        char Message[1024];
+        va_list Args;
+        va_start(Args, Format);
+        std::vsnprintf(Message, sizeof(Message), Format, Args);
+        va_end(Args);
+
+        std::shared_ptr<const FLogHandler> Handler;
+        {
+            std::lock_guard<std::mutex> Lock(GetHookMutex());
+            Handler = GetLogHandler();
+        }
+        if (Handler)
+        {
+            (*Handler)(Level, Message);
+        }
+        else if (Level != ELogLevel::Verbose)
+        {
+            std::fprintf(stderr, "CineSRT: %s: %s\n", GetLevelName(Level), Message);
+        }
+    }
+
+    int32 GetNumberOfCores()
+    {
+        static const int32 NumCores = (int32)std::max(1u, std::thread::hardware_concurrency());
+        return NumCores;
+    }
+
+    void SetCurrentThreadName(const char* Name)
+    {
+#if defined(_WIN32)
+        wchar_t WideName[64];
+        std::size_t Index = 0;
+        for (; Name[Index] && Index + 1 < sizeof(WideName) / sizeof(WideName[0]); ++Index)
+        {
+            WideName[Index] = (wchar_t)Name[Index];
+        }
+        WideName[Index] = 0;
+        SetThreadDescription(GetCurrentThread(), WideName);
+#elif defined(__APPLE__)
+        pthread_setname_np(Name);
+#elif defined(__linux__)
+        char ShortName[16]; // the kernel limit, including the terminator
+        std::snprintf(ShortName, sizeof(ShortName), "%s", Name);
+        pthread_setname_np(pthread_self(), ShortName);
+#else
+        (void)Name;
+#endif
+    }
+
+    void SetParallelForHandler(FParallelForHandler Handler)
+    {
+        std::shared_ptr<const FParallelForHandler> NewHandler = Handler ? std::make_shared<const FParallelForHandler>(std::move(Handler)) : nullptr;
+        std::lock_guard<std::mutex> Lock(GetHookMutex());
+        GetParallelForHandler() = std::move(NewHandler);
+    }
+
+    void ParallelFor(int32 Num, const std::function<void(int32)>& Body)
+    {
+        if (Num <= 0)
+        {
+            return;
+        }
+
+        std::shared_ptr<const FParallelForHandler> Handler;
+        {
+            std::lock_guard<std::mutex> Lock(GetHookMutex());
+            Handler = GetParallelForHandler();
+        }
+        if (Handler)
+        {
+            (*Handler)(Num, Body);
+            return;
+        }
+
+        // No task system outside the engine: one thread per extra index, the caller runs index 0
+        std::vector<std::thread> Threads;
+        Threads.reserve(Num - 1);
+        for (int32 Index = 1; Index < Num; ++Index)
+        {
+            Threads.emplace_back([&Body, Index] { Body(Index); });
+        }
+        Body(0);
+        for (std::thread& Thread : Threads)
+        {
+            Thread.join();
+        }
+    }
+}
@@ -0,0 +1,54 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+// Engine glue for the CineSRTCore module. Only built by UnrealBuildTool; the standalone
+// tools compile the rest of Private/ without it and keep the default std-only hooks.
+
+#include "CineSRTCore.h"
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCineSRTCore, Log, All);
+
+class FCineSRTCoreModule : public IModuleInterface
+{
+public:
+    virtual void StartupModule() override
+    {
+        // 코어 로그를 UE 로그로, 코어 병렬 작업을 태스크 그래프로 보냄
+        CineSRT::SetLogHandler([](CineSRT::ELogLevel Level, const char* Message)
+        {
+            switch (Level)
+            {
+                case CineSRT::ELogLevel::Verbose:
+                    UE_LOG(LogCineSRTCore, Verbose, TEXT("%s"), UTF8_TO_TCHAR(Message));
+                    break;
+                case CineSRT::ELogLevel::Log:
+                    UE_LOG(LogCineSRTCore, Log, TEXT("%s"), UTF8_TO_TCHAR(Message));
+                    break;
+                case CineSRT::ELogLevel::Warning:
+                    UE_LOG(LogCineSRTCore, Warning, TEXT("%s"), UTF8_TO_TCHAR(Message));
+                    break;
+                case CineSRT::ELogLevel::Error:
+                    UE_LOG(LogCineSRTCore, Error, TEXT("%s"), UTF8_TO_TCHAR(Message));
+                    break;
+            }
+        });
+
+        CineSRT::SetParallelForHandler([](int32 Num, const std::function<void(int32)>& Body)
+        {
+            ::ParallelFor(Num, [&Body](int32 Index)
+            {
+                Body(Index);
+            });
+        });
+    }
+
+    virtual void ShutdownModule() override
+    {
+        CineSRT::SetParallelForHandler(nullptr);
+        CineSRT::SetLogHandler(nullptr);
+    }
+};
+
+IMPLEMENT_MODULE(FCineSRTCoreModule, CineSRTCore)
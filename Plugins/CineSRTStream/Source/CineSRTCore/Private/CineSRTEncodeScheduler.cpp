@@ -0,0 +1,116 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTEncodeScheduler.h"
+#include "CineSRTEncoderPool.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace CineSRT
+{
+    FEncodeScheduler::FEncodeScheduler(int32 NumThreads)
+    {
+        if (NumThreads <= 0)
+        {
+            NumThreads = std::max(GetNumberOfCores() - 2, 1);
+        }
+
+        Threads.reserve(NumThreads);
+        for (int32 Index = 0; Index < NumThreads; ++Index)
+        {
+            Threads.emplace_back([this, Index]
+            {
+                char ThreadName[32];
+                std::snprintf(ThreadName, sizeof(ThreadName), "SRTEncodeShared%d", Index);
+                SetCurrentThreadName(ThreadName);
+                Run();
+            });
+        }
+        Logf(ELogLevel::Log, "Shared encode scheduler started with %d threads", NumThreads);
+    }
+
+    FEncodeScheduler::~FEncodeScheduler()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            bShouldStop = true;
+        }
+        WorkCondition.notify_all();
+        for (std::thread& Thread : Threads)
+        {
+            Thread.join();
+        }
+    }
+
+    int32 FEncodeScheduler::GetNumPools() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return (int32)Pools.size();
+    }
+
+    void FEncodeScheduler::AddPool(FEncoderPool& Pool)
+    {
+        std::shared_ptr<FEntry> Entry = std::make_shared<FEntry>();
+        Entry->Pool = &Pool;
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Pools.push_back(std::move(Entry));
+            WorkEpoch++;
+        }
+        WorkCondition.notify_all();
+    }
+
+    void FEncodeScheduler::RemovePool(FEncoderPool& Pool)
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        auto It = std::find_if(Pools.begin(), Pools.end(), [&Pool](const std::shared_ptr<FEntry>& Entry) { return Entry->Pool == &Pool; });
+        if (It == Pools.end())
+        {
+            return;
+        }
+        std::shared_ptr<FEntry> Entry = *It;
+        Pools.erase(It);
+
+        // 인코딩 중인 프레임은 끝까지 (풀이 bShouldStop을 보므로 다음 프레임은 꺼내지 않음)
+        IdleCondition.wait(Lock, [&Entry] { return Entry->ActiveCalls == 0; });
+    }
+
+    void FEncodeScheduler::Notify()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            WorkEpoch++;
+        }
+        WorkCondition.notify_all();
+    }
+
+    void FEncodeScheduler::Run()
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        while (!bShouldStop)
+        {
+            // 풀마다 한 프레임씩 한 바퀴. 하나라도 인코딩했으면 바로 다음 바퀴, 아니면 새 프레임이 올 때까지 대기
+            const uint64 Epoch = WorkEpoch;
+            const std::size_t NumVisits = Pools.size();
+            bool bDidWork = false;
+            for (std::size_t Visit = 0; Visit < NumVisits && !bShouldStop && !Pools.empty(); ++Visit)
+            {
+                std::shared_ptr<FEntry> Entry = Pools[NextPool++ % Pools.size()];
+                Entry->ActiveCalls++;
+                Lock.unlock();
+                const bool bEncoded = Entry->Pool->RunScheduledFrame();
+                Lock.lock();
+                if (--Entry->ActiveCalls == 0)
+                {
+                    IdleCondition.notify_all();
+                }
+                bDidWork |= bEncoded;
+            }
+
+            if (!bDidWork)
+            {
+                WorkCondition.wait(Lock, [this, Epoch] { return bShouldStop || WorkEpoch != Epoch; });
+            }
+        }
+    }
+}
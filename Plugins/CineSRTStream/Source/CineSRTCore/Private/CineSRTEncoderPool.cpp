@@ -0,0 +1,987 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTEncoderPool.h"
+#include "CineSRTEncodeScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace CineSRT
+{
+    class FEncoderPool::FEncodeWorker
+    {
+    public:
+        FEncodeWorker(FEncoderPool& InOwner, FGeneration& InGeneration, std::unique_ptr<IVideoEncoder> InEncoder)
+            : AppliedRate(PackRate(InGeneration.Config.Bitrate, InGeneration.Config.JpegQuality)) // 인코더가 초기화된 값
+            , Owner(InOwner)
+            , Generation(InGeneration)
+            , Encoder(std::move(InEncoder))
+        {
+        }
+
+        ~FEncodeWorker()
+        {
+            Join();
+            Encoder->Shutdown();
+        }
+
+        void Start(int32 Index)
+        {
+            Thread = std::thread([this, Index]
+            {
+                char ThreadName[32];
+                std::snprintf(ThreadName, sizeof(ThreadName), "SRTEncoder%d", Index);
+                SetCurrentThreadName(ThreadName);
+                Owner.WorkerLoop(*this);
+
+                // 퇴역한 인코더는 자기 스레드에서 정리 - 남은 건 즉시 끝나는 join뿐
+                Encoder->Shutdown();
+                Owner.OnWorkerExited(Generation);
+            });
+        }
+
+        void Join()
+        {
+            if (Thread.joinable())
+            {
+                Thread.join();
+            }
+        }
+
+        FGeneration& GetGeneration() const { return Generation; }
+        IVideoEncoder& GetEncoder() const { return *Encoder; }
+
+        uint64 AppliedRate;  // 이 인코더에 마지막으로 적용한 레이트 (워커를 돌리는 스레드만 접근)
+        bool bBusy = false;  // QueueMutex: 공유 스케줄러 스레드가 이 인코더로 인코딩 중
+
+        // 입력 스케일링: 렌디션 크기로 줄인 프레임 (워커를 돌리는 스레드만 접근, 인코딩이 끝나면 바로 재사용)
+        FFrameScaler Scaler;
+        FRawFrame ScaledFrame;
+
+    private:
+        FEncoderPool& Owner;
+        FGeneration& Generation;
+        std::unique_ptr<IVideoEncoder> Encoder;
+        std::thread Thread;
+    };
+
+    FEncoderPool::FEncoderPool()
+        : EncodedFramePool(std::make_shared<FEncodedFramePool>())
+    {
+    }
+
+    FEncoderPool::~FEncoderPool()
+    {
+        Stop();
+    }
+
+    bool FEncoderPool::Start(EEncodingFormat Format, const FVideoEncoderConfig& InConfig)
+    {
+        if (bIsRunning)
+            return true;
+
+        bShouldStop = false;
+        PackedRate = PackRate(InConfig.Bitrate, InConfig.JpegQuality);
+        std::unique_ptr<FGeneration> Generation = CreateGeneration(Format, InConfig);
+        if (!Generation)
+        {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> Lock(OutputMutex);
+            Stats.OutputQueueHighWater = 0;
+            Stats.Reconfigurations = 0;
+            Stats.WarmUpTime = (float)Generation->WarmUpSeconds;
+            PtsOrigin = -1.0;
+            LastPts = -1;
+        }
+        ActiveFormat = Generation->Format;
+        ActivateGeneration(std::move(Generation));
+        if (Scheduler)
+        {
+            Scheduler->AddPool(*this);
+        }
+        bIsRunning = true;
+        return true;
+    }
+
+    void FEncoderPool::Stop()
+    {
+        if (!bIsRunning) return;
+        {
+            std::lock_guard<std::mutex> Lock(QueueMutex);
+            bShouldStop = true;
+        }
+        QueueCondition.notify_all();
+
+        // 만들던 워커 묶음은 bShouldStop을 보고 활성화하지 않음
+        JoinBuildThread();
+
+        // 공유 스레드가 이 풀에서 인코딩 중인 프레임을 끝낼 때까지
+        if (Scheduler)
+        {
+            Scheduler->RemovePool(*this);
+        }
+
+        // 워커 소멸자가 스레드 종료를 기다린 뒤 인코더를 정리 (락 밖에서 - 워커가 QueueMutex를 잡고 빠져나감)
+        std::vector<std::unique_ptr<FGeneration>> Stopped;
+        {
+            std::lock_guard<std::mutex> Lock(QueueMutex);
+            Stopped.swap(Generations);
+        }
+        for (std::unique_ptr<FGeneration>& Generation : Stopped)
+        {
+            for (std::unique_ptr<FEncodeWorker>& Worker : Generation->Workers)
+            {
+                Worker->Join();
+            }
+        }
+        Stopped.clear();
+        NextWorkerIndex = 0;
+
+        // 아직 인코딩되지 않은 프레임은 풀로 돌려보냄
+        {
+            std::lock_guard<std::mutex> Lock(QueueMutex);
+            InputQueue.clear();
+            NextInputSequence = 0;
+            LastSubmitCaptureTime = -1.0;
+            bDeliveryPending = false;
+        }
+        {
+            std::lock_guard<std::mutex> Lock(OutputMutex);
+            ReorderBuffer.clear();
+            ReadyFrames.clear();
+            OutputQueue.clear();
+            NextOutputSequence = 0;
+            Stats.WorkerCount = 0;
+            Stats.OutputQueueDepth = 0;
+            LastReleasedFrame.reset();
+        }
+        {
+            // 다시 시작하면 첫 프레임은 항상 인코딩
+            std::lock_guard<std::mutex> Lock(StaticMutex);
+            StaticReference.reset();
+        }
+        bIsRunning = false;
+    }
+
+    bool FEncoderPool::Reconfigure(EEncodingFormat Format, const FVideoEncoderConfig& InConfig, EEncodingFormat FallbackFormat)
+    {
+        if (!bIsRunning)
+        {
+            return false;
+        }
+
+        // 먼저 요청된 전환이 끝나야 다음 전환 (인코더 생성은 수십 ms 이내)
+        JoinBuildThread();
+        ReapRetiredGenerations();
+
+        // 새 설정의 레이트를 바로 적용 - 이후 SetRate 호출이 새 워커 묶음에도 그대로 이어짐
+        PackedRate = PackRate(InConfig.Bitrate, InConfig.JpegQuality);
+        bIsBuilding = true;
+        BuildThread = std::thread([this, Format, InConfig, FallbackFormat]
+        {
+            SetCurrentThreadName("SRTEncoderBuild");
+            const double StartTime = GetTimeSeconds();
+            std::unique_ptr<FGeneration> Generation = CreateGeneration(Format, InConfig);
+            if (!Generation && FallbackFormat != EEncodingFormat::None && FallbackFormat != Format && !bShouldStop)
+            {
+                Logf(ELogLevel::Warning, "Encoder format %d failed to initialize for %dx%d, falling back to format %d",
+                    (int32)Format, InConfig.Width, InConfig.Height, (int32)FallbackFormat);
+                Generation = CreateGeneration(FallbackFormat, InConfig);
+            }
+
+            if (!Generation)
+            {
+                Logf(ELogLevel::Error, "Encoder reconfiguration to %dx%d failed, keeping the current encoder", InConfig.Width, InConfig.Height);
+            }
+            else if (ActivateGeneration(std::move(Generation)))
+            {
+                Logf(ELogLevel::Log, "Encoder reconfigured to %dx%d @ %d fps in %.1f ms", InConfig.Width, InConfig.Height,
+                    InConfig.FPS, (GetTimeSeconds() - StartTime) * 1000.0);
+            }
+            bIsBuilding = false;
+        });
+        return true;
+    }
+
+    bool FEncoderPool::CanEncode(int32 Width, int32 Height) const
+    {
+        std::lock_guard<std::mutex> Lock(QueueMutex);
+        return FindGeneration(Width, Height) != nullptr;
+    }
+
+    std::unique_ptr<FEncoderPool::FGeneration> FEncoderPool::CreateGeneration(EEncodingFormat Format, const FVideoEncoderConfig& InConfig)
+    {
+        std::unique_ptr<IVideoEncoder> Encoder = CreateVideoEncoder(Format, InConfig);
+        if (!Encoder || !Encoder->Initialize())
+        {
+            return nullptr;
+        }
+
+        std::unique_ptr<FGeneration> Generation = std::make_unique<FGeneration>();
+        Generation->Config = InConfig;
+        Generation->Format = Encoder->GetFormat();
+        Generation->bIntraOnly = Encoder->IsIntraOnly();
+        Generation->bSliceOutput = Encoder->SupportsSliceOutput();
+
+        // 인트라 전용 코덱만 프레임 단위로 병렬화 (인터 코덱은 참조 프레임 상태를 공유해야 함)
+        const int32 NumWorkers = Encoder->IsIntraOnly() ? std::min(std::max(InConfig.ThreadCount, 1), GetNumberOfCores()) : 1;
+        Generation->Workers.push_back(std::make_unique<FEncodeWorker>(*this, *Generation, std::move(Encoder)));
+        for (int32 Index = 1; Index < NumWorkers; ++Index)
+        {
+            std::unique_ptr<IVideoEncoder> WorkerEncoder = CreateVideoEncoder(Format, InConfig);
+            if (!WorkerEncoder || !WorkerEncoder->Initialize())
+            {
+                break;
+            }
+            Generation->Workers.push_back(std::make_unique<FEncodeWorker>(*this, *Generation, std::move(WorkerEncoder)));
+        }
+        if (bWarmUp)
+        {
+            Generation->WarmUpSeconds = WarmUpGeneration(*Generation);
+        }
+        return Generation;
+    }
+
+    double FEncoderPool::WarmUpGeneration(FGeneration& Generation)
+    {
+        // 코덱의 지연 초기화(허프만 테이블, 스크래치 버퍼 페이지, 레이트 컨트롤 상태)를 첫 실제 프레임이 떠안지 않도록
+        // 워커마다 빈 프레임을 한 장씩 인코딩해서 버림. 아직 워커 스레드가 돌기 전이라 여기서 바로 호출해도 됨
+        const double StartTime = GetTimeSeconds();
+        const FVideoEncoderConfig& Config = Generation.Config;
+        const std::vector<uint8> Blank((std::size_t)Config.Width * Config.Height * 4, 0);
+        FEncodedFrame Scratch;
+        for (std::unique_ptr<FEncodeWorker>& Worker : Generation.Workers)
+        {
+            IVideoEncoder& Encoder = Worker->GetEncoder();
+            Scratch.Data.clear();
+            Encoder.EncodeFrame(Blank.data(), (int32)Blank.size(), Scratch);
+            if (!Generation.bIntraOnly)
+            {
+                // 예열 프레임을 참조하지 않도록 실제 첫 프레임은 IDR로
+                Encoder.RequestKeyframe();
+            }
+        }
+
+        // 인코딩된 프레임 버퍼도 미리: 인트라 전용은 픽셀당 2비트(보통 품질의 MJPEG는 그 안쪽), 인터 코덱은 평균 프레임의 4배 (키프레임)
+        const std::size_t FrameBytes = Generation.bIntraOnly
+            ? (std::size_t)Config.Width * Config.Height / 4
+            : (std::size_t)std::max(Config.Bitrate, 1) * 1000 / 8 / std::max(Config.FPS, 1) * 4;
+        EncodedFramePool->Preallocate((int32)Generation.Workers.size() + OutputQueueCapacity, std::max(FrameBytes, Scratch.Data.size()));
+
+        const double Elapsed = GetTimeSeconds() - StartTime;
+        Logf(ELogLevel::Log, "Encoder warm-up: %d workers at %dx%d in %.1f ms", (int32)Generation.Workers.size(), Config.Width, Config.Height, Elapsed * 1000.0);
+        return Elapsed;
+    }
+
+    bool FEncoderPool::ActivateGeneration(std::unique_ptr<FGeneration> Generation)
+    {
+        FGeneration& Activated = *Generation;
+        const int32 NumWorkers = (int32)Activated.Workers.size();
+        bool bReplacesGeneration = false;
+        {
+            std::lock_guard<std::mutex> Lock(QueueMutex);
+            if (bShouldStop)
+            {
+                return false;
+            }
+            Activated.RunningWorkers = Scheduler ? 0 : NumWorkers;
+            bReplacesGeneration = !Generations.empty();
+            Generations.push_back(std::move(Generation));
+        }
+        if (!Scheduler)
+        {
+            for (std::unique_ptr<FEncodeWorker>& Worker : Activated.Workers)
+            {
+                Worker->Start(NextWorkerIndex++);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> Lock(OutputMutex);
+            Stats.WorkerCount = NumWorkers;
+            Stats.Reconfigurations += bReplacesGeneration ? 1 : 0;
+        }
+        return true;
+    }
+
+    FEncoderPool::FGeneration* FEncoderPool::FindGeneration(int32 Width, int32 Height) const
+    {
+        // 크기가 같으면 가장 최근 묶음이 담당 (같은 해상도의 코덱/스레드 변경은 준비되는 즉시 전환)
+        // 입력 스케일링이면 어떤 크기든 워커가 맞춰 줄이므로 가장 최근 묶음
+        for (auto It = Generations.rbegin(); It != Generations.rend(); ++It)
+        {
+            FGeneration& Generation = **It;
+            if (!Generation.bRetiring && (bScaleInput || (Generation.Config.Width == Width && Generation.Config.Height == Height)))
+            {
+                return &Generation;
+            }
+        }
+        return nullptr;
+    }
+
+    void FEncoderPool::ReapRetiredGenerations()
+    {
+        std::vector<std::unique_ptr<FGeneration>> Retired;
+        {
+            std::lock_guard<std::mutex> Lock(QueueMutex);
+            for (auto It = Generations.begin(); It != Generations.end();)
+            {
+                // 스레드 모드에서는 워커가 맡은 프레임을 다 처리해야 빠져나오므로 대기 프레임 검사는 공유 스케줄러용
+                FGeneration* Generation = It->get();
+                const bool bHasPendingFrames = std::any_of(InputQueue.begin(), InputQueue.end(),
+                    [Generation](const FPendingFrame& Pending) { return Pending.Generation == Generation; });
+                if (Generation->bRetiring && Generation->RunningWorkers == 0 && !bHasPendingFrames)
+                {
+                    Retired.push_back(std::move(*It));
+                    It = Generations.erase(It);
+                }
+                else
+                {
+                    ++It;
+                }
+            }
+        }
+        // 스레드는 이미 끝났으므로 join은 바로 돌아옴
+        Retired.clear();
+    }
+
+    void FEncoderPool::JoinBuildThread()
+    {
+        if (BuildThread.joinable())
+        {
+            BuildThread.join();
+        }
+    }
+
+    bool FEncoderPool::SubmitFrame(FRawFrameRef Frame)
+    {
+        if (!bIsRunning || !Frame) return false;
+        const double CaptureTime = Frame->CaptureTime > 0.0 ? Frame->CaptureTime : GetTimeSeconds();
+        EStaticFramePolicy StaticPolicy = CheckStaticFrame(Frame, CaptureTime);
+        int64 DroppedSequence = -1;
+        int32 DropsToLog = 0;
+        int32 FillSlots = 0;
+        {
+            std::lock_guard<std::mutex> Lock(QueueMutex);
+            const double Now = GetTimeSeconds();
+            FPendingFrame Pending;
+            Pending.Generation = FindGeneration(Frame->Width, Frame->Height);
+            if (StaticPolicy == EStaticFramePolicy::Repeat && (!Pending.Generation || !Pending.Generation->bIntraOnly))
+            {
+                // 인터 코덱의 직전 프레임은 참조 상태에 묶여 있어 다시 보낼 수 없음
+                StaticPolicy = EStaticFramePolicy::Skip;
+            }
+            const double PreviousCaptureTime = LastSubmitCaptureTime;
+            LastSubmitCaptureTime = CaptureTime;
+            if (StaticPolicy != EStaticFramePolicy::Skip)
+            {
+                // 놓친 슬롯의 반복은 이 프레임보다 앞 순번 (직전 그림이 먼저 나가야 함)
+                FillSlots = GetSlotsToFill(Pending.Generation, PreviousCaptureTime, CaptureTime);
+                NextInputSequence += FillSlots;
+            }
+            Pending.Sequence = StaticPolicy == EStaticFramePolicy::Skip ? -1 : NextInputSequence++;
+            Pending.CaptureTime = CaptureTime;
+            Pending.SubmitTime = Now;
+            Pending.bRepeat = StaticPolicy == EStaticFramePolicy::Repeat;
+            if (StaticPolicy == EStaticFramePolicy::Skip)
+            {
+                // 인코딩도 전송도 없음 - 받는 쪽은 마지막 그림을 유지
+            }
+            else if (!Pending.Generation)
+            {
+                // No worker set encodes this size (captured before a resolution change or after a failed one);
+                // the encoder would read past its buffer
+                DroppedSequence = Pending.Sequence;
+            }
+            else
+            {
+                // 새 묶음으로 첫 프레임이 오면 그 이전 묶음은 더 받을 프레임이 없음 - 남은 것만 처리하고 퇴역
+                int32 NumWorkers = 0;
+                for (std::unique_ptr<FGeneration>& Generation : Generations)
+                {
+                    if (Generation.get() == Pending.Generation)
+                    {
+                        break;
+                    }
+                    Generation->bRetiring = true;
+                }
+                for (std::unique_ptr<FGeneration>& Generation : Generations)
+                {
+                    NumWorkers += Generation->bRetiring ? 0 : (int32)Generation->Workers.size();
+                }
+                ActiveFormat = Pending.Generation->Format;
+
+                if ((int32)InputQueue.size() > std::max(5, NumWorkers))
+                {
+                    DroppedSequence = InputQueue.front().Sequence;
+                    InputQueue.pop_front();
+                    DropsSinceLog++;
+                    if (Now - LastDropLogTime >= DropLogIntervalSeconds)
+                    {
+                        DropsToLog = DropsSinceLog;
+                        DropsSinceLog = 0;
+                        LastDropLogTime = Now;
+                    }
+                }
+                for (int32 Slot = FillSlots; Slot > 0; --Slot)
+                {
+                    FPendingFrame Fill;
+                    Fill.Generation = Pending.Generation;
+                    Fill.Sequence = Pending.Sequence - Slot;
+                    Fill.CaptureTime = CaptureTime - Slot * FillSlotInterval;
+                    Fill.SubmitTime = Now;
+                    Fill.bRepeat = true;
+                    InputQueue.push_back(std::move(Fill));
+                }
+                // 반복 프레임은 픽셀이 필요 없으니 캡처 버퍼를 바로 풀로 돌려보냄
+                if (!Pending.bRepeat)
+                {
+                    Pending.Frame = std::move(Frame);
+                }
+                InputQueue.push_back(std::move(Pending));
+            }
+        }
+        if (StaticPolicy != EStaticFramePolicy::Encode || FillSlots > 0)
+        {
+            std::lock_guard<std::mutex> Lock(OutputMutex);
+            if (StaticPolicy != EStaticFramePolicy::Encode)
+            {
+                Stats.StaticFrames++;
+                if (PipelineStats)
+                {
+                    PipelineStats->Add(EPipelineCounter::FramesStatic);
+                }
+            }
+            Stats.FilledSlots += FillSlots;
+        }
+        if (StaticPolicy == EStaticFramePolicy::Skip)
+        {
+            return true;
+        }
+        QueueCondition.notify_all();
+        if (Scheduler)
+        {
+            Scheduler->Notify();
+        }
+
+        if (DroppedSequence >= 0)
+        {
+            SkipFrame(DroppedSequence);
+        }
+        if (DropsToLog > 0)
+        {
+            Logf(ELogLevel::Warning, "Encoder queue full, dropped %d frame(s) since the last report", DropsToLog);
+        }
+        return true;
+    }
+
+    int32 FEncoderPool::GetSlotsToFill(const FGeneration* Generation, double PreviousCaptureTime, double CaptureTime) const
+    {
+        if (FillSlotInterval <= 0.0 || !Generation || !Generation->bIntraOnly || PreviousCaptureTime < 0.0)
+        {
+            return 0;
+        }
+        // 슬롯 시각으로 찍힌 프레임이라 간격은 거의 정확히 정수 배 - 반올림으로 충분
+        const int64 Missed = std::llround((CaptureTime - PreviousCaptureTime) / FillSlotInterval) - 1;
+        const int64 MaxSlots = std::max<int64>(1, (int64)(0.5 / FillSlotInterval));
+        return Missed > 0 && Missed <= MaxSlots ? (int32)Missed : 0;
+    }
+
+    void FEncoderPool::SetFillMissedSlots(double InSlotInterval)
+    {
+        std::lock_guard<std::mutex> Lock(QueueMutex);
+        FillSlotInterval = std::max(InSlotInterval, 0.0);
+    }
+
+    EStaticFramePolicy FEncoderPool::CheckStaticFrame(const FRawFrameRef& Frame, double CaptureTime)
+    {
+        std::lock_guard<std::mutex> Lock(StaticMutex);
+        if (StaticSettings.Policy == EStaticFramePolicy::Encode)
+        {
+            StaticReference.reset();
+            return EStaticFramePolicy::Encode;
+        }
+
+        // 기준 프레임이 받는 쪽에 도달하지 못했으면 같은 그림이라도 다시 인코딩
+        const bool bReferenceLost = bStaticReferenceLost.exchange(false);
+        if (!bReferenceLost && StaticReference && CaptureTime - StaticReferenceTime < StaticSettings.KeepAliveSeconds
+            && FFrameCompare::IsWithinTolerance(*StaticReference, *Frame, StaticSettings.Tolerance))
+        {
+            return StaticSettings.Policy;
+        }
+
+        // 인코딩할 프레임이 새 기준 (버퍼는 인코더와 공유, 다음 인코딩 때 풀로 돌아감)
+        StaticReference = Frame;
+        StaticReferenceTime = CaptureTime;
+        return EStaticFramePolicy::Encode;
+    }
+
+    void FEncoderPool::SetStaticFrameSettings(const FStaticFrameSettings& InSettings)
+    {
+        std::lock_guard<std::mutex> Lock(StaticMutex);
+        StaticSettings = InSettings;
+        StaticSettings.Tolerance = std::min(std::max(StaticSettings.Tolerance, 0), 255);
+    }
+
+    void FEncoderPool::SetFrameSink(FEncodedFrameSink Sink)
+    {
+        std::lock_guard<std::mutex> DeliveryLock(DeliveryMutex);
+        FrameSink = std::move(Sink);
+    }
+
+    void FEncoderPool::SetRate(int32 Bitrate, int32 JpegQuality)
+    {
+        PackedRate = PackRate(Bitrate, JpegQuality);
+    }
+
+    void FEncoderPool::RequestKeyframe()
+    {
+        bKeyframeRequested = true;
+    }
+
+    bool FEncoderPool::GetEncodedFrame(FEncodedFrameRef& OutEncodedFrame)
+    {
+        std::lock_guard<std::mutex> Lock(OutputMutex);
+        if (OutputQueue.empty())
+        {
+            return false;
+        }
+        OutEncodedFrame = std::move(OutputQueue.front());
+        OutputQueue.pop_front();
+        Stats.OutputQueueDepth = (int32)OutputQueue.size();
+        return true;
+    }
+
+    FEncoderPool::FStats FEncoderPool::GetStats() const
+    {
+        std::lock_guard<std::mutex> Lock(OutputMutex);
+        return Stats;
+    }
+
+    void FEncoderPool::WorkerLoop(FEncodeWorker& Worker)
+    {
+        FGeneration& Generation = Worker.GetGeneration();
+        while (true)
+        {
+            FPendingFrame Input;
+            {
+                std::unique_lock<std::mutex> Lock(QueueMutex);
+                auto Next = InputQueue.end();
+                QueueCondition.wait(Lock, [&]
+                {
+                    if (bShouldStop || bDeliveryPending)
+                    {
+                        return true;
+                    }
+                    Next = std::find_if(InputQueue.begin(), InputQueue.end(),
+                        [&Generation](const FPendingFrame& Pending) { return Pending.Generation == &Generation; });
+                    return Next != InputQueue.end() || Generation.bRetiring;
+                });
+                if (!bShouldStop && bDeliveryPending)
+                {
+                    Lock.unlock();
+                    DeliverPendingFrames();
+                    continue;
+                }
+                if (bShouldStop || Next == InputQueue.end())
+                {
+                    // 정지했거나, 퇴역했고 맡은 프레임을 다 처리함
+                    break;
+                }
+                Input = std::move(*Next);
+                InputQueue.erase(Next);
+            }
+
+            EncodePendingFrame(Worker, Input);
+        }
+    }
+
+    bool FEncoderPool::RunScheduledFrame()
+    {
+        if (DeliverPendingFrames())
+        {
+            return true;
+        }
+        FEncodeWorker* Worker = nullptr;
+        FPendingFrame Input;
+        {
+            std::lock_guard<std::mutex> Lock(QueueMutex);
+            if (bShouldStop)
+            {
+                return false;
+            }
+
+            // 캡처 순서대로 보되, 자기 묶음의 워커가 모두 바쁜 프레임은 건너뜀 (인터 코덱은 워커가 하나라 순서 유지)
+            for (auto It = InputQueue.begin(); It != InputQueue.end() && !Worker; ++It)
+            {
+                for (std::unique_ptr<FEncodeWorker>& Candidate : It->Generation->Workers)
+                {
+                    if (!Candidate->bBusy)
+                    {
+                        Worker = Candidate.get();
+                        Worker->bBusy = true;
+                        It->Generation->RunningWorkers++;
+                        Input = std::move(*It);
+                        InputQueue.erase(It);
+                        break;
+                    }
+                }
+            }
+        }
+        if (!Worker)
+        {
+            return false;
+        }
+
+        EncodePendingFrame(*Worker, Input);
+
+        std::lock_guard<std::mutex> Lock(QueueMutex);
+        Worker->bBusy = false;
+        Worker->GetGeneration().RunningWorkers--;
+        return true;
+    }
+
+    void FEncoderPool::EncodePendingFrame(FEncodeWorker& Worker, FPendingFrame& Input)
+    {
+        IVideoEncoder& WorkerEncoder = Worker.GetEncoder();
+        const uint64 Rate = PackedRate.load();
+        if (Rate != Worker.AppliedRate)
+        {
+            WorkerEncoder.SetRate((int32)(Rate >> 32), (int32)(uint32)Rate);
+            Worker.AppliedRate = Rate;
+        }
+
+        // 실패한 프레임도 빈 항목으로 재정렬 단계에 넘겨 뒤 프레임이 막히지 않게 함
+        FReorderEntry Entry;
+        Entry.CaptureTime = Input.CaptureTime;
+        Entry.SubmitTime = Input.SubmitTime;
+        if (Input.bRepeat)
+        {
+            // 비트스트림은 차례가 왔을 때 직전에 나간 프레임에서 복사
+            Entry.bRepeat = true;
+            Entry.EncodeEndTime = GetTimeSeconds();
+            CompleteFrame(Input.Sequence, std::move(Entry), 0.0);
+            return;
+        }
+        if (bKeyframeRequested.load(std::memory_order_relaxed) && bKeyframeRequested.exchange(false))
+        {
+            WorkerEncoder.RequestKeyframe();
+        }
+        double EncodeTime = 0.0;
+        const double DequeueTime = GetTimeSeconds();
+
+        // 렌디션: 다른 스트림과 공유하는 캡처 프레임을 이 워커 묶음 크기로 리샘플 (원본은 읽기만 함)
+        const FVideoEncoderConfig& Config = Worker.GetGeneration().Config;
+        const FRawFrame* Source = Input.Frame.get();
+        bool bSourceReady = true;
+        if (Source->Width != Config.Width || Source->Height != Config.Height)
+        {
+            FRawFrame& Scaled = Worker.ScaledFrame;
+            Scaled.Width = Config.Width;
+            Scaled.Height = Config.Height;
+            Scaled.Data.resize((std::size_t)Config.Width * Config.Height * 4);
+            bSourceReady = Worker.Scaler.Scale(*Source, Scaled);
+            Source = &Scaled;
+            Input.Frame.reset(); // 캡처 버퍼는 다른 렌디션이 다 읽으면 풀로 돌아감
+            if (PipelineStats && bSourceReady)
+            {
+                PipelineStats->Record(EPipelineStage::Scale, GetTimeSeconds() - DequeueTime);
+            }
+        }
+
+        const double StartTime = GetTimeSeconds();
+        Entry.Frame = EncodedFramePool->Acquire();
+        Entry.Frame->CaptureTime = Input.CaptureTime; // 인코더 레이트 컨트롤도 실제 캡처 간격을 봄
+        Entry.Frame->QueueSeconds = DequeueTime - Input.SubmitTime;
+        Entry.Frame->Format = WorkerEncoder.GetFormat(); // 슬라이스 스트리밍이면 첫 슬라이스와 함께 나가므로 미리
+        bool bEncoded = false;
+        if (bSourceReady && Worker.GetGeneration().bSliceOutput)
+        {
+            // 차례가 된 프레임은 슬라이스가 나오는 대로 Data에 이어 붙이며 내보내고, 아니면 끝난 뒤 평소처럼 재정렬
+            const uint8* Bitstream = nullptr;
+            int32 BitstreamSize = 0;
+            bEncoded = WorkerEncoder.EncodeFrameSliced(Source->Data.data(), (int32)Source->Data.size(), *Entry.Frame,
+                [this, &Input, &Entry, &Bitstream, &BitstreamSize](const uint8* Data, int32 Size)
+                {
+                    Bitstream = Data;
+                    BitstreamSize = Size;
+                    if (Entry.bStreaming)
+                    {
+                        Entry.Frame->Partial->Publish(Data, Size);
+                    }
+                    else
+                    {
+                        StreamFrame(Input.Sequence, Entry, Data, Size);
+                    }
+                });
+            if (bEncoded && !Entry.bStreaming)
+            {
+                Entry.Frame->Data.assign(Bitstream, Bitstream + BitstreamSize);
+            }
+        }
+        else if (bSourceReady)
+        {
+            bEncoded = WorkerEncoder.EncodeFrame(Source->Data.data(), (int32)Source->Data.size(), *Entry.Frame);
+        }
+
+        if (bEncoded)
+        {
+            Entry.EncodeEndTime = GetTimeSeconds();
+            EncodeTime = Entry.EncodeEndTime - StartTime;
+            if (PipelineStats)
+            {
+                if (Entry.Frame->ConvertSeconds > 0.0)
+                {
+                    PipelineStats->Record(EPipelineStage::Convert, Entry.Frame->ConvertSeconds);
+                }
+                PipelineStats->Record(EPipelineStage::Encode, EncodeTime - Entry.Frame->ConvertSeconds);
+            }
+        }
+        else
+        {
+            bStaticReferenceLost = true;
+        }
+
+        // Hand the buffer back to the pool before waiting for the next frame
+        Input.Frame.reset();
+        if (Entry.bStreaming)
+        {
+            // 이미 내보낸 프레임 - 하류에 끝(또는 실패)을 알리고 통계만 반영
+            FinishStreamedFrame(Entry.Frame, bEncoded, EncodeTime);
+            return;
+        }
+        if (!bEncoded)
+        {
+            Entry.Frame.reset();
+        }
+        CompleteFrame(Input.Sequence, std::move(Entry), EncodeTime);
+    }
+
+    void FEncoderPool::OnWorkerExited(FGeneration& Generation)
+    {
+        std::lock_guard<std::mutex> Lock(QueueMutex);
+        Generation.RunningWorkers--;
+    }
+
+    void FEncoderPool::SkipFrame(int64 Sequence)
+    {
+        // 버린 순번은 자리 표시로 넘기고 나머지는 평소 재정렬 규칙대로 (원본이 인코딩 중인 반복 프레임은 계속 대기).
+        // 싱크는 여기서 부르지 않음 - 캡처 스레드가 전송 대기에 막히지 않도록 풀린 프레임은 워커가 전달
+        bStaticReferenceLost = true;
+        bool bReleased = false;
+        {
+            std::lock_guard<std::mutex> Lock(OutputMutex);
+            FReorderEntry Skipped;
+            Skipped.bSkipped = true;
+            ReorderBuffer.emplace(Sequence, std::move(Skipped));
+            ReleaseReadyFrames();
+            bReleased = !ReadyFrames.empty();
+        }
+        if (bReleased)
+        {
+            {
+                std::lock_guard<std::mutex> Lock(QueueMutex);
+                bDeliveryPending = true;
+            }
+            QueueCondition.notify_one();
+            if (Scheduler)
+            {
+                Scheduler->Notify();
+            }
+        }
+    }
+
+    bool FEncoderPool::DeliverPendingFrames()
+    {
+        if (!bDeliveryPending.load(std::memory_order_relaxed) || !bDeliveryPending.exchange(false))
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> DeliveryLock(DeliveryMutex);
+        DeliverReadyFrames();
+        return true;
+    }
+
+    void FEncoderPool::CompleteFrame(int64 Sequence, FReorderEntry Entry, double EncodeTime)
+    {
+        // 재정렬은 OutputMutex 안에서, 싱크 호출은 밖에서 (GetStats/SubmitFrame이 전송 대기에 막히지 않도록)
+        std::lock_guard<std::mutex> DeliveryLock(DeliveryMutex);
+        {
+            std::lock_guard<std::mutex> Lock(OutputMutex);
+            ReorderBuffer.emplace(Sequence, std::move(Entry));
+            ReleaseReadyFrames();
+            RecordEncodeTime(EncodeTime);
+        }
+        DeliverReadyFrames();
+    }
+
+    bool FEncoderPool::StreamFrame(int64 Sequence, FReorderEntry& Entry, const uint8* Bitstream, int32 Size)
+    {
+        std::lock_guard<std::mutex> DeliveryLock(DeliveryMutex);
+        {
+            std::lock_guard<std::mutex> Lock(OutputMutex);
+            if (!FrameSink || Sequence != NextOutputSequence)
+            {
+                return false;
+            }
+
+            // 하류가 프레임을 받기 전에 첫 슬라이스까지 채워 둠
+            Entry.Frame->Partial = std::make_shared<FPartialBitstream>(Entry.Frame->Data);
+            Entry.Frame->Partial->Publish(Bitstream, Size);
+            Entry.bStreaming = true;
+            Entry.EncodeEndTime = GetTimeSeconds();
+            ReorderBuffer.emplace(Sequence, Entry);
+            ReleaseReadyFrames();
+        }
+        DeliverReadyFrames();
+        return true;
+    }
+
+    void FEncoderPool::FinishStreamedFrame(const FEncodedFrameRef& Frame, bool bSucceeded, double EncodeTime)
+    {
+        Frame->Partial->Finish(bSucceeded);
+
+        std::lock_guard<std::mutex> DeliveryLock(DeliveryMutex);
+        {
+            std::lock_guard<std::mutex> Lock(OutputMutex);
+            if (bSucceeded)
+            {
+                Stats.FramesEncoded++;
+                Stats.TotalBytesEncoded += (int64)Frame->Data.size();
+                if (PipelineStats)
+                {
+                    PipelineStats->Add(EPipelineCounter::FramesEncoded);
+                    PipelineStats->Add(EPipelineCounter::BytesEncoded, (int64)Frame->Data.size());
+                }
+                RecordEncodeTime(EncodeTime);
+            }
+            else
+            {
+                // 일부는 이미 나갔지만 온전한 그림이 아님 - 이걸 반복하지 않도록 끊음
+                if (LastReleasedFrame == Frame)
+                {
+                    LastReleasedFrame.reset();
+                }
+                Stats.FramesDropped++;
+                if (PipelineStats)
+                {
+                    PipelineStats->Add(EPipelineCounter::FramesDropped);
+                }
+            }
+
+            // 이 프레임이 끝나길 기다리던 반복 프레임
+            ReleaseReadyFrames();
+        }
+        DeliverReadyFrames();
+    }
+
+    void FEncoderPool::ReleaseReadyFrames()
+    {
+        const double Now = GetTimeSeconds();
+        for (auto It = ReorderBuffer.find(NextOutputSequence); It != ReorderBuffer.end(); It = ReorderBuffer.find(NextOutputSequence))
+        {
+            if (It->second.bRepeat && LastReleasedFrame && LastReleasedFrame->Partial && !LastReleasedFrame->Partial->IsFinished())
+            {
+                // 원본이 아직 인코딩 중 - 끝나면 FinishStreamedFrame이 다시 부름
+                break;
+            }
+            FReorderEntry Ready = std::move(It->second);
+            ReorderBuffer.erase(It);
+            NextOutputSequence++;
+            if (Ready.bRepeat && LastReleasedFrame)
+            {
+                // 내보낸 프레임은 하류에서 공유 중이라 새 프레임에 복사하고 시각만 바꿈
+                Ready.Frame = EncodedFramePool->Acquire();
+                Ready.Frame->Data.assign(LastReleasedFrame->Data.begin(), LastReleasedFrame->Data.end());
+                Ready.Frame->Format = LastReleasedFrame->Format;
+                Ready.Frame->bKeyframe = LastReleasedFrame->bKeyframe;
+                Ready.Frame->CaptureTime = Ready.CaptureTime;
+                Ready.Frame->QueueSeconds = Now - Ready.SubmitTime;
+            }
+            if (Ready.bSkipped || !Ready.Frame)
+            {
+                // 빠진 프레임 뒤의 반복은 엉뚱한 그림이 될 수 있으니 같이 버림
+                LastReleasedFrame.reset();
+                Stats.FramesDropped++;
+                if (PipelineStats)
+                {
+                    PipelineStats->Add(EPipelineCounter::FramesDropped);
+                }
+                continue;
+            }
+            // PTS는 캡처 시계에서 (인코딩 지터와 무관). 같은 틱에 두 번 캡처돼도 단조 증가 유지
+            if (PtsOrigin < 0.0)
+            {
+                PtsOrigin = Ready.CaptureTime;
+            }
+            Ready.Frame->Pts = std::max((int64)std::llround((Ready.CaptureTime - PtsOrigin) * 90000.0), LastPts + 1);
+            LastPts = Ready.Frame->Pts;
+            if (!Ready.bRepeat)
+            {
+                LastReleasedFrame = Ready.Frame;
+                EncodeLatency.Record(Now - Ready.SubmitTime);
+                Ready.Frame->QueueSeconds += Now - Ready.EncodeEndTime;
+            }
+            if (!Ready.bRepeat && !Ready.bStreaming)
+            {
+                Stats.FramesEncoded++;
+                Stats.TotalBytesEncoded += (int64)Ready.Frame->Data.size();
+                if (PipelineStats)
+                {
+                    PipelineStats->Add(EPipelineCounter::FramesEncoded);
+                    PipelineStats->Add(EPipelineCounter::BytesEncoded, (int64)Ready.Frame->Data.size());
+                }
+            }
+            if (FrameSink)
+            {
+                ReadyFrames.push_back(std::move(Ready.Frame));
+                continue;
+            }
+
+            // 아무도 꺼내가지 않으면 무한히 쌓이지 않도록 가장 오래된 프레임부터 버림
+            if ((int32)OutputQueue.size() >= OutputQueueCapacity)
+            {
+                OutputQueue.pop_front();
+                Stats.OutputFramesDropped++;
+            }
+            OutputQueue.push_back(std::move(Ready.Frame));
+        }
+        Stats.OutputQueueDepth = (int32)OutputQueue.size();
+        Stats.OutputQueueHighWater = std::max(Stats.OutputQueueHighWater, Stats.OutputQueueDepth);
+    }
+
+    void FEncoderPool::RecordEncodeTime(double EncodeTime)
+    {
+        if (EncodeTime > 0.0)
+        {
+            // 워커별 인코딩 시간 (병렬이므로 처리량은 WorkerCount / AverageEncodeTime까지)
+            const int32 NumTimed = std::max(Stats.FramesEncoded, 1);
+            Stats.AverageEncodeTime += (float)((EncodeTime - Stats.AverageEncodeTime) / NumTimed);
+        }
+    }
+
+    void FEncoderPool::DeliverReadyFrames()
+    {
+        // 싱크를 부르는 동안 SkipFrame이 더 풀어 둘 수 있으므로 빌 때까지
+        std::vector<FEncodedFrameRef> Frames;
+        while (true)
+        {
+            {
+                std::lock_guard<std::mutex> Lock(OutputMutex);
+                Frames.swap(ReadyFrames);
+            }
+            if (Frames.empty())
+            {
+                return;
+            }
+            for (FEncodedFrameRef& Frame : Frames)
+            {
+                FrameSink(std::move(Frame));
+            }
+            Frames.clear();
+        }
+    }
+}
@@ -0,0 +1,229 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTFrame.h"
+
+namespace CineSRT
+{
+    FRawFramePool::~FRawFramePool()
+    {
+        std::lock_guard<std::mutex> Lock(PoolLock);
+        for (FRawFrame* Frame : FreeList)
+        {
+            delete Frame;
+        }
+        FreeList.clear();
+    }
+
+    void FRawFramePool::Preallocate(int32 Count, int32 Width, int32 Height, bool bCommit)
+    {
+        const std::size_t NumBytes = (std::size_t)Width * Height * 4;
+
+        std::lock_guard<std::mutex> Lock(PoolLock);
+        while (TotalFrames < Count)
+        {
+            FreeList.push_back(new FRawFrame());
+            TotalFrames++;
+            Allocations++;
+        }
+        for (FRawFrame* Frame : FreeList)
+        {
+            // reserve만으로는 페이지가 매핑되지 않아 첫 캡처의 복사가 페이지 폴트를 떠안음
+            if (bCommit && Frame->Data.size() < NumBytes)
+            {
+                Frame->Data.resize(NumBytes);
+            }
+            else
+            {
+                Frame->Data.reserve(NumBytes);
+            }
+        }
+    }
+
+    FRawFrameRef FRawFramePool::Acquire(int32 Width, int32 Height)
+    {
+        FRawFrame* Frame = nullptr;
+        {
+            std::lock_guard<std::mutex> Lock(PoolLock);
+            if (!FreeList.empty())
+            {
+                Frame = FreeList.back();
+                FreeList.pop_back();
+            }
+            else
+            {
+                Frame = new FRawFrame();
+                TotalFrames++;
+                Allocations++;
+            }
+        }
+
+        // Only grows the buffer the first time a larger resolution comes through
+        Frame->Width = Width;
+        Frame->Height = Height;
+        Frame->Data.resize((std::size_t)Width * Height * 4);
+        Frame->CaptureTime = 0.0;
+
+        std::weak_ptr<FRawFramePool> WeakPool = weak_from_this();
+        return FRawFrameRef(Frame, [WeakPool](FRawFrame* ReleasedFrame)
+        {
+            if (std::shared_ptr<FRawFramePool> Pool = WeakPool.lock())
+            {
+                Pool->Release(ReleasedFrame);
+            }
+            else
+            {
+                delete ReleasedFrame;
+            }
+        });
+    }
+
+    FRawFramePool::FPoolStats FRawFramePool::GetStats() const
+    {
+        std::lock_guard<std::mutex> Lock(PoolLock);
+        FPoolStats Stats;
+        Stats.TotalFrames = TotalFrames;
+        Stats.FreeFrames = (int32)FreeList.size();
+        Stats.Allocations = Allocations;
+        return Stats;
+    }
+
+    void FRawFramePool::Release(FRawFrame* Frame)
+    {
+        std::lock_guard<std::mutex> Lock(PoolLock);
+        FreeList.push_back(Frame);
+    }
+
+    FEncodedFramePool::~FEncodedFramePool()
+    {
+        std::lock_guard<std::mutex> Lock(PoolLock);
+        for (FEncodedFrame* Frame : FreeList)
+        {
+            delete Frame;
+        }
+        FreeList.clear();
+    }
+
+    FEncodedFrameRef FEncodedFramePool::Acquire()
+    {
+        FEncodedFrame* Frame = nullptr;
+        {
+            std::lock_guard<std::mutex> Lock(PoolLock);
+            if (!FreeList.empty())
+            {
+                Frame = FreeList.back();
+                FreeList.pop_back();
+            }
+        }
+        if (!Frame)
+        {
+            Frame = new FEncodedFrame();
+        }
+
+        // Keep the buffer's capacity, reset everything else
+        Frame->Data.clear();
+        Frame->Partial.reset();
+        Frame->Format = EEncodingFormat::None;
+        Frame->bKeyframe = false;
+        Frame->Pts = 0;
+        Frame->CaptureTime = 0.0;
+        Frame->SubmitTime = 0.0;
+        Frame->ConvertSeconds = 0.0;
+        Frame->QueueSeconds = 0.0;
+
+        std::weak_ptr<FEncodedFramePool> WeakPool = weak_from_this();
+        return FEncodedFrameRef(Frame, [WeakPool](FEncodedFrame* ReleasedFrame)
+        {
+            if (std::shared_ptr<FEncodedFramePool> Pool = WeakPool.lock())
+            {
+                Pool->Release(ReleasedFrame);
+            }
+            else
+            {
+                delete ReleasedFrame;
+            }
+        });
+    }
+
+    void FEncodedFramePool::Preallocate(int32 Count, std::size_t Bytes)
+    {
+        std::lock_guard<std::mutex> Lock(PoolLock);
+        while ((int32)FreeList.size() < Count)
+        {
+            FreeList.push_back(new FEncodedFrame());
+        }
+        for (FEncodedFrame* Frame : FreeList)
+        {
+            if (Frame->Data.capacity() < Bytes)
+            {
+                // 한 번 써서 페이지까지 잡아 두고, 길이는 Acquire가 비움
+                Frame->Data.resize(Bytes);
+            }
+        }
+    }
+
+    void FEncodedFramePool::Release(FEncodedFrame* Frame)
+    {
+        std::lock_guard<std::mutex> Lock(PoolLock);
+        FreeList.push_back(Frame);
+    }
+
+    void FPartialBitstream::Publish(const uint8* Prefix, int32 Size)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        if (bFinished || Size <= (int32)Data.size())
+        {
+            return;
+        }
+        Data.insert(Data.end(), Prefix + Data.size(), Prefix + Size);
+        if (Wakeup)
+        {
+            Wakeup();
+        }
+    }
+
+    void FPartialBitstream::Finish(bool bInSucceeded)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            bFinished = true;
+            bSucceeded = bInSucceeded;
+            if (Wakeup)
+            {
+                Wakeup();
+            }
+        }
+        FinishedCondition.notify_all();
+    }
+
+    int32 FPartialBitstream::Read(int32 Offset, FReader Reader, bool& bOutFinished, bool& bOutSucceeded)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        const int32 Published = (int32)Data.size();
+        if (Offset < Published)
+        {
+            Reader(Data.data() + Offset, Published - Offset);
+        }
+        bOutFinished = bFinished;
+        bOutSucceeded = bSucceeded;
+        return Published;
+    }
+
+    bool FPartialBitstream::WaitFinished()
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        FinishedCondition.wait(Lock, [this] { return bFinished; });
+        return bSucceeded;
+    }
+
+    bool FPartialBitstream::IsFinished() const
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return bFinished;
+    }
+
+    void FPartialBitstream::SetWakeup(std::function<void()> InWakeup)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Wakeup = std::move(InWakeup);
+    }
+}
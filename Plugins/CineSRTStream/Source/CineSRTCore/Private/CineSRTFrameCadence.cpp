@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTFrameCadence.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace CineSRT
+{
+    namespace
+    {
+        // 폴 간격 평활 계수 - 게임 프레임 시간이 튀어도 캡처 판정이 흔들리지 않게
+        constexpr double PollPeriodSmoothing = 0.1;
+
+        // 멈췄다 돌아온 폴(로딩, 디버거)은 프레임 시간 추정에 넣지 않음
+        constexpr double MaxPollPeriodSeconds = 0.25;
+    }
+
+    void FFrameCadence::Start(double FrameRate, double Now)
+    {
+        Interval = FrameRate > 0.0 ? 1.0 / FrameRate : 0.0;
+        Origin = Now;
+        NextSlot = 0;
+        LastPollTime = -1.0;
+        PollPeriod = 0.0;
+    }
+
+    void FFrameCadence::Stop()
+    {
+        Interval = 0.0;
+    }
+
+    void FFrameCadence::SetFrameRate(double FrameRate)
+    {
+        if (!IsRunning() || FrameRate <= 0.0)
+        {
+            return;
+        }
+        // 마지막으로 잡은 슬롯에서 새 간격으로 다시 시작 (아직 잡은 게 없으면 첫 슬롯 그대로)
+        if (NextSlot > 0)
+        {
+            Origin += (NextSlot - 1) * Interval;
+            NextSlot = 1;
+        }
+        Interval = 1.0 / FrameRate;
+    }
+
+    FFrameCadence::FTick FFrameCadence::Poll(double Now)
+    {
+        FTick Tick;
+        if (!IsRunning())
+        {
+            return Tick;
+        }
+
+        if (LastPollTime >= 0.0 && Now - LastPollTime < MaxPollPeriodSeconds)
+        {
+            const double Period = Now - LastPollTime;
+            PollPeriod = PollPeriod > 0.0 ? PollPeriod + (Period - PollPeriod) * PollPeriodSmoothing : Period;
+        }
+        LastPollTime = Now;
+
+        // 다음 폴보다 이번 폴이 슬롯에 더 가까우면 지금 캡처 (최대 반 슬롯 앞당김).
+        // 게임이 목표보다 빠르면 슬롯 사이 폴은 건너뛰고, 느리면 지나간 슬롯 중 가장 최근 것을 잡음
+        const double Lead = std::min(PollPeriod, Interval) * 0.5;
+        const int64 DueSlot = (int64)std::floor((Now + Lead - Origin) / Interval);
+        if (DueSlot < NextSlot)
+        {
+            return Tick;
+        }
+
+        Tick.bCapture = true;
+        Tick.SlotTime = Origin + DueSlot * Interval;
+        Tick.Error = Now - Tick.SlotTime;
+        Tick.MissedSlots = (int32)std::min<int64>(DueSlot - NextSlot, 0x7fffffff);
+        NextSlot = DueSlot + 1;
+        return Tick;
+    }
+}
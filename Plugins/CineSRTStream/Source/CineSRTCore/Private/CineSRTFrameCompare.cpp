@@ -0,0 +1,147 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTFrameCompare.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #include <immintrin.h>
+    // MSVC emits any intrinsic without flags; GCC/Clang need the target enabled per function
+    #if defined(__clang__) || defined(__GNUC__)
+        #define SRT_TARGET_SSE41 __attribute__((target("sse4.1")))
+        #define SRT_TARGET_AVX2 __attribute__((target("avx2")))
+    #else
+        #define SRT_TARGET_SSE41
+        #define SRT_TARGET_AVX2
+    #endif
+    #define SRT_WITH_X86_KERNELS 1
+#else
+    #define SRT_WITH_X86_KERNELS 0
+#endif
+
+namespace CineSRT
+{
+    namespace
+    {
+        bool CompareScalar(const uint8* A, const uint8* B, std::size_t Begin, std::size_t End, int32 Tolerance)
+        {
+            for (std::size_t Index = Begin; Index < End; ++Index)
+            {
+                const int32 Difference = (int32)A[Index] - (int32)B[Index];
+                if (Difference > Tolerance || -Difference > Tolerance)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+#if SRT_WITH_X86_KERNELS
+        // |a - b| in unsigned bytes, minus the tolerance with saturation: non-zero lanes are over it.
+        // 64바이트씩 모아 한 번만 검사 - 분기가 줄고 바뀐 프레임은 첫 몇 블록에서 끝남
+        SRT_TARGET_SSE41 static inline __m128i ExcessSSE41(const uint8* A, const uint8* B, __m128i Tolerance)
+        {
+            const __m128i VA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(A));
+            const __m128i VB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B));
+            const __m128i Difference = _mm_or_si128(_mm_subs_epu8(VA, VB), _mm_subs_epu8(VB, VA));
+            return _mm_subs_epu8(Difference, Tolerance);
+        }
+
+        SRT_TARGET_SSE41 bool CompareSSE41(const uint8* A, const uint8* B, std::size_t Size, int32 Tolerance, std::size_t& OutDone)
+        {
+            const __m128i VTolerance = _mm_set1_epi8((char)Tolerance);
+            std::size_t Index = 0;
+            for (; Index + 64 <= Size; Index += 64)
+            {
+                const __m128i Excess = _mm_or_si128(
+                    _mm_or_si128(ExcessSSE41(A + Index, B + Index, VTolerance), ExcessSSE41(A + Index + 16, B + Index + 16, VTolerance)),
+                    _mm_or_si128(ExcessSSE41(A + Index + 32, B + Index + 32, VTolerance), ExcessSSE41(A + Index + 48, B + Index + 48, VTolerance)));
+                if (!_mm_testz_si128(Excess, Excess))
+                {
+                    return false;
+                }
+            }
+            OutDone = Index;
+            return true;
+        }
+
+        SRT_TARGET_AVX2 static inline __m256i ExcessAVX2(const uint8* A, const uint8* B, __m256i Tolerance)
+        {
+            const __m256i VA = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(A));
+            const __m256i VB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(B));
+            const __m256i Difference = _mm256_or_si256(_mm256_subs_epu8(VA, VB), _mm256_subs_epu8(VB, VA));
+            return _mm256_subs_epu8(Difference, Tolerance);
+        }
+
+        SRT_TARGET_AVX2 bool CompareAVX2(const uint8* A, const uint8* B, std::size_t Size, int32 Tolerance, std::size_t& OutDone)
+        {
+            const __m256i VTolerance = _mm256_set1_epi8((char)Tolerance);
+            std::size_t Index = 0;
+            for (; Index + 128 <= Size; Index += 128)
+            {
+                const __m256i Excess = _mm256_or_si256(
+                    _mm256_or_si256(ExcessAVX2(A + Index, B + Index, VTolerance), ExcessAVX2(A + Index + 32, B + Index + 32, VTolerance)),
+                    _mm256_or_si256(ExcessAVX2(A + Index + 64, B + Index + 64, VTolerance), ExcessAVX2(A + Index + 96, B + Index + 96, VTolerance)));
+                if (!_mm256_testz_si256(Excess, Excess))
+                {
+                    return false;
+                }
+            }
+            OutDone = Index;
+            return true;
+        }
+#endif // SRT_WITH_X86_KERNELS
+    }
+
+    bool FFrameCompare::IsWithinTolerance(const uint8* A, const uint8* B, std::size_t Size, int32 Tolerance, EColorKernel Kernel)
+    {
+        if (A == B || Size == 0)
+        {
+            return true;
+        }
+        if (!A || !B)
+        {
+            return false;
+        }
+        if (Tolerance <= 0)
+        {
+            // 완전히 같은지만 보면 되므로 libc의 벡터화된 비교가 가장 빠름
+            return std::memcmp(A, B, Size) == 0;
+        }
+        if (Tolerance >= 255)
+        {
+            return true;
+        }
+        if (Kernel == EColorKernel::Auto || !FColorConverter::IsKernelSupported(Kernel))
+        {
+            Kernel = FColorConverter::GetBestKernel();
+        }
+
+        std::size_t Done = 0;
+#if SRT_WITH_X86_KERNELS
+        if (Kernel == EColorKernel::AVX2 && !CompareAVX2(A, B, Size, Tolerance, Done))
+        {
+            return false;
+        }
+        if (Kernel != EColorKernel::Scalar)
+        {
+            std::size_t Tail = 0;
+            if (!CompareSSE41(A + Done, B + Done, Size - Done, Tolerance, Tail))
+            {
+                return false;
+            }
+            Done += Tail;
+        }
+#endif
+        return CompareScalar(A, B, Done, Size, Tolerance);
+    }
+
+    bool FFrameCompare::IsWithinTolerance(const FRawFrame& A, const FRawFrame& B, int32 Tolerance, EColorKernel Kernel)
+    {
+        if (A.Width != B.Width || A.Height != B.Height || A.Data.size() != B.Data.size())
+        {
+            return false;
+        }
+        return IsWithinTolerance(A.Data.data(), B.Data.data(), A.Data.size(), Tolerance, Kernel);
+    }
+}
@@ -0,0 +1,365 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTFrameScaler.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #include <immintrin.h>
+    // MSVC emits any intrinsic without flags; GCC/Clang need the target enabled per function
+    #if defined(__clang__) || defined(__GNUC__)
+        #define SRT_TARGET_SSE41 __attribute__((target("sse4.1")))
+        #define SRT_TARGET_AVX2 __attribute__((target("avx2")))
+    #else
+        #define SRT_TARGET_SSE41
+        #define SRT_TARGET_AVX2
+    #endif
+    #define SRT_WITH_X86_KERNELS 1
+#else
+    #define SRT_WITH_X86_KERNELS 0
+#endif
+
+namespace CineSRT
+{
+    namespace
+    {
+        // Bilinear weights are 7-bit (w0 + w1 = 128). A horizontally filtered channel is at most
+        // 255 * 128 and fits int16; the vertical pass sums two of those with 7-bit weights in 32 bits
+        // and rounds away 14 bits, which can never exceed 255.
+        constexpr int32 WeightBits = 7;
+        constexpr int32 WeightOne = 1 << WeightBits;
+        constexpr int32 VerticalRound = 1 << (2 * WeightBits - 1);
+
+        /** Source position of an output column/row (pixel centres aligned) -> left tap and right-tap weight. */
+        inline void MapCoordinate(int32 Index, int32 SrcSize, int32 DstSize, int32& OutTap, int32& OutWeight)
+        {
+            const int64 Step = ((int64)SrcSize << 16) / DstSize;
+            const int64 Position = Index * Step + Step / 2 - 32768;
+            OutTap = (int32)(Position >> 16);
+            OutWeight = (int32)(((Position & 0xFFFF) + 256) >> 9);
+            if (Position < 0)
+            {
+                OutTap = 0;
+                OutWeight = 0;
+            }
+            // 오른쪽 탭이 항상 원본 안에 있도록 마지막 열은 왼쪽 탭을 하나 당기고 가중치를 전부 오른쪽에
+            if (OutTap >= SrcSize - 1)
+            {
+                OutTap = SrcSize - 2;
+                OutWeight = WeightOne;
+            }
+        }
+
+        inline int32 PackWeights(int32 Weight)
+        {
+            return (WeightOne - Weight) | (Weight << 16);
+        }
+
+        void HalveRowScalar(const uint8* Src0, const uint8* Src1, uint8* Dst, int32 Begin, int32 End)
+        {
+            for (int32 X = Begin; X < End; ++X)
+            {
+                const uint8* P0 = Src0 + X * 8;
+                const uint8* P1 = Src1 + X * 8;
+                for (int32 Channel = 0; Channel < 4; ++Channel)
+                {
+                    Dst[X * 4 + Channel] = (uint8)((P0[Channel] + P0[Channel + 4] + P1[Channel] + P1[Channel + 4] + 2) >> 2);
+                }
+            }
+        }
+
+        void FilterRowScalar(const uint8* Src, int16* Dst, const int32* Offsets, const int32* Weights, int32 Begin, int32 End)
+        {
+            for (int32 X = Begin; X < End; ++X)
+            {
+                const uint8* P = Src + Offsets[X] * 4;
+                const int32 W0 = Weights[X] & 0xFFFF;
+                const int32 W1 = Weights[X] >> 16;
+                for (int32 Channel = 0; Channel < 4; ++Channel)
+                {
+                    Dst[X * 4 + Channel] = (int16)(P[Channel] * W0 + P[Channel + 4] * W1);
+                }
+            }
+        }
+
+        void BlendRowsScalar(const int16* Row0, const int16* Row1, uint8* Dst, int32 Weight, int32 Begin, int32 End)
+        {
+            const int32 W0 = WeightOne - Weight;
+            for (int32 Index = Begin; Index < End; ++Index)
+            {
+                Dst[Index] = (uint8)((Row0[Index] * W0 + Row1[Index] * Weight + VerticalRound) >> (2 * WeightBits));
+            }
+        }
+
+#if SRT_WITH_X86_KERNELS
+        // --- SSE4.1 ---
+
+        /** Four pixels from each row -> two 2x2 averages (16-bit BGRA quads). */
+        SRT_TARGET_SSE41 static inline __m128i Average2x2SSE41(__m128i Row0, __m128i Row1)
+        {
+            const __m128i Zero = _mm_setzero_si128();
+            const __m128i Lo = _mm_add_epi16(_mm_unpacklo_epi8(Row0, Zero), _mm_unpacklo_epi8(Row1, Zero)); // px0, px1
+            const __m128i Hi = _mm_add_epi16(_mm_unpackhi_epi8(Row0, Zero), _mm_unpackhi_epi8(Row1, Zero)); // px2, px3
+            const __m128i Sum = _mm_add_epi16(_mm_unpacklo_epi64(Lo, Hi), _mm_unpackhi_epi64(Lo, Hi));
+            return _mm_srli_epi16(_mm_add_epi16(Sum, _mm_set1_epi16(2)), 2);
+        }
+
+        /** Four output pixels per iteration from eight source pixels of each row. */
+        SRT_TARGET_SSE41 int32 HalveRowSSE41(const uint8* Src0, const uint8* Src1, uint8* Dst, int32 Width)
+        {
+            int32 X = 0;
+            for (; X + 4 <= Width; X += 4)
+            {
+                const __m128i* Row0 = reinterpret_cast<const __m128i*>(Src0 + X * 8);
+                const __m128i* Row1 = reinterpret_cast<const __m128i*>(Src1 + X * 8);
+                const __m128i First = Average2x2SSE41(_mm_loadu_si128(Row0), _mm_loadu_si128(Row1));
+                const __m128i Second = Average2x2SSE41(_mm_loadu_si128(Row0 + 1), _mm_loadu_si128(Row1 + 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + X * 4), _mm_packus_epi16(First, Second));
+            }
+            return X;
+        }
+
+        /** Two output pixels per iteration: each tap pair is regrouped per channel and weighted with one madd. */
+        SRT_TARGET_SSE41 int32 FilterRowSSE41(const uint8* Src, int16* Dst, const int32* Offsets, const int32* Weights, int32 Width)
+        {
+            const __m128i Zero = _mm_setzero_si128();
+            const __m128i ByChannel = _mm_setr_epi8(0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+
+            int32 X = 0;
+            for (; X + 2 <= Width; X += 2)
+            {
+                const __m128i Taps = _mm_shuffle_epi8(_mm_unpacklo_epi64(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(Src + Offsets[X] * 4)),
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i*>(Src + Offsets[X + 1] * 4))), ByChannel);
+                const __m128i First = _mm_madd_epi16(_mm_unpacklo_epi8(Taps, Zero), _mm_set1_epi32(Weights[X]));
+                const __m128i Second = _mm_madd_epi16(_mm_unpackhi_epi8(Taps, Zero), _mm_set1_epi32(Weights[X + 1]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + X * 4), _mm_packs_epi32(First, Second));
+            }
+            return X;
+        }
+
+        SRT_TARGET_SSE41 static inline __m128i BlendX8SSE41(__m128i Row0, __m128i Row1, __m128i Weights)
+        {
+            const __m128i Round = _mm_set1_epi32(VerticalRound);
+            const __m128i Lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(Row0, Row1), Weights), Round), 2 * WeightBits);
+            const __m128i Hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(Row0, Row1), Weights), Round), 2 * WeightBits);
+            return _mm_packs_epi32(Lo, Hi);
+        }
+
+        SRT_TARGET_SSE41 int32 BlendRowsSSE41(const int16* Row0, const int16* Row1, uint8* Dst, int32 Weight, int32 Count)
+        {
+            const __m128i Weights = _mm_set1_epi32(PackWeights(Weight));
+
+            int32 Index = 0;
+            for (; Index + 16 <= Count; Index += 16)
+            {
+                const __m128i* A = reinterpret_cast<const __m128i*>(Row0 + Index);
+                const __m128i* B = reinterpret_cast<const __m128i*>(Row1 + Index);
+                const __m128i First = BlendX8SSE41(_mm_loadu_si128(A), _mm_loadu_si128(B), Weights);
+                const __m128i Second = BlendX8SSE41(_mm_loadu_si128(A + 1), _mm_loadu_si128(B + 1), Weights);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Index), _mm_packus_epi16(First, Second));
+            }
+            return Index;
+        }
+
+        // --- AVX2: vertical blend only ---
+        //
+        // The box and horizontal passes are shuffle-bound and gain little from 256-bit lanes;
+        // the blend is pure arithmetic. unpack and pack stay within 128-bit lanes, so sixteen
+        // channels come back in order and only the final byte pack needs a permute.
+
+        SRT_TARGET_AVX2 static inline __m256i BlendX16AVX2(__m256i Row0, __m256i Row1, __m256i Weights)
+        {
+            const __m256i Round = _mm256_set1_epi32(VerticalRound);
+            const __m256i Lo = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(Row0, Row1), Weights), Round), 2 * WeightBits);
+            const __m256i Hi = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(Row0, Row1), Weights), Round), 2 * WeightBits);
+            return _mm256_packs_epi32(Lo, Hi);
+        }
+
+        SRT_TARGET_AVX2 int32 BlendRowsAVX2(const int16* Row0, const int16* Row1, uint8* Dst, int32 Weight, int32 Count)
+        {
+            const __m256i Weights = _mm256_set1_epi32(PackWeights(Weight));
+
+            int32 Index = 0;
+            for (; Index + 32 <= Count; Index += 32)
+            {
+                const __m256i* A = reinterpret_cast<const __m256i*>(Row0 + Index);
+                const __m256i* B = reinterpret_cast<const __m256i*>(Row1 + Index);
+                const __m256i First = BlendX16AVX2(_mm256_loadu_si256(A), _mm256_loadu_si256(B), Weights);
+                const __m256i Second = BlendX16AVX2(_mm256_loadu_si256(A + 1), _mm256_loadu_si256(B + 1), Weights);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + Index),
+                    _mm256_permute4x64_epi64(_mm256_packus_epi16(First, Second), _MM_SHUFFLE(3, 1, 2, 0)));
+            }
+            return Index;
+        }
+#endif // SRT_WITH_X86_KERNELS
+
+        void HalveImage(const uint8* Src, int32 SrcStride, uint8* Dst, int32 DstWidth, int32 DstHeight, EColorKernel Kernel)
+        {
+            for (int32 Y = 0; Y < DstHeight; ++Y)
+            {
+                const uint8* Src0 = Src + (std::size_t)(Y * 2) * SrcStride;
+                const uint8* Src1 = Src0 + SrcStride;
+                uint8* Row = Dst + (std::size_t)Y * DstWidth * 4;
+
+                int32 Done = 0;
+#if SRT_WITH_X86_KERNELS
+                if (Kernel != EColorKernel::Scalar)
+                {
+                    Done = HalveRowSSE41(Src0, Src1, Row, DstWidth);
+                }
+#endif
+                HalveRowScalar(Src0, Src1, Row, Done, DstWidth);
+            }
+        }
+    }
+
+    bool FFrameScaler::Scale(const uint8* Src, int32 SrcWidth, int32 SrcHeight, int32 SrcStride,
+        uint8* Dst, int32 DstWidth, int32 DstHeight, EColorKernel Kernel)
+    {
+        if (!Src || !Dst || SrcWidth < 2 || SrcHeight < 2 || DstWidth < 2 || DstHeight < 2)
+        {
+            return false;
+        }
+        if (SrcStride <= 0)
+        {
+            SrcStride = SrcWidth * 4;
+        }
+        if (Kernel == EColorKernel::Auto || !FColorConverter::IsKernelSupported(Kernel))
+        {
+            Kernel = FColorConverter::GetBestKernel();
+        }
+
+        // 2배 이상 줄이는 동안은 박스 필터로 반씩 - 마지막 단계가 목표 크기면 바로 출력에 씀
+        const uint8* Current = Src;
+        int32 Width = SrcWidth;
+        int32 Height = SrcHeight;
+        int32 Stride = SrcStride;
+        int32 BufferIndex = 0;
+        while (Width >= DstWidth * 2 && Height >= DstHeight * 2)
+        {
+            const int32 HalfWidth = Width / 2;
+            const int32 HalfHeight = Height / 2;
+            const bool bFinal = HalfWidth == DstWidth && HalfHeight == DstHeight;
+            uint8* Halved = Dst;
+            if (!bFinal)
+            {
+                std::vector<uint8>& Buffer = HalvedBuffers[BufferIndex];
+                Buffer.resize((std::size_t)HalfWidth * HalfHeight * 4);
+                Halved = Buffer.data();
+                BufferIndex ^= 1;
+            }
+            HalveImage(Current, Stride, Halved, HalfWidth, HalfHeight, Kernel);
+            if (bFinal)
+            {
+                return true;
+            }
+            Current = Halved;
+            Width = HalfWidth;
+            Height = HalfHeight;
+            Stride = HalfWidth * 4;
+        }
+
+        if (Width == DstWidth && Height == DstHeight)
+        {
+            for (int32 Y = 0; Y < Height; ++Y)
+            {
+                std::memcpy(Dst + (std::size_t)Y * DstWidth * 4, Current + (std::size_t)Y * Stride, (std::size_t)Width * 4);
+            }
+            return true;
+        }
+
+        Bilinear(Current, Width, Height, Stride, Dst, DstWidth, DstHeight, Kernel);
+        return true;
+    }
+
+    bool FFrameScaler::Scale(const FRawFrame& Src, FRawFrame& Dst, EColorKernel Kernel)
+    {
+        if ((int64)Src.Data.size() < (int64)Src.Width * Src.Height * 4 || (int64)Dst.Data.size() < (int64)Dst.Width * Dst.Height * 4)
+        {
+            return false;
+        }
+        return Scale(Src.Data.data(), Src.Width, Src.Height, Src.Width * 4, Dst.Data.data(), Dst.Width, Dst.Height, Kernel);
+    }
+
+    void FFrameScaler::Bilinear(const uint8* Src, int32 SrcWidth, int32 SrcHeight, int32 SrcStride,
+        uint8* Dst, int32 DstWidth, int32 DstHeight, EColorKernel Kernel)
+    {
+        if (TableSrcWidth != SrcWidth || TableDstWidth != DstWidth)
+        {
+            ColumnOffsets.resize(DstWidth);
+            ColumnWeights.resize(DstWidth);
+            for (int32 X = 0; X < DstWidth; ++X)
+            {
+                int32 Weight = 0;
+                MapCoordinate(X, SrcWidth, DstWidth, ColumnOffsets[X], Weight);
+                ColumnWeights[X] = PackWeights(Weight);
+            }
+            TableSrcWidth = SrcWidth;
+            TableDstWidth = DstWidth;
+        }
+
+        const int32 RowLength = DstWidth * 4;
+        for (int32 Slot = 0; Slot < 2; ++Slot)
+        {
+            FilteredRows[Slot].resize(RowLength);
+            FilteredRowIndex[Slot] = -1; // 원본이 바뀌었으므로 이전 호출의 행은 무효
+        }
+
+        auto FilterRow = [&](int32 SrcRow, int32 Slot)
+        {
+            const uint8* Row = Src + (std::size_t)SrcRow * SrcStride;
+            int16* Out = FilteredRows[Slot].data();
+            int32 Done = 0;
+#if SRT_WITH_X86_KERNELS
+            if (Kernel != EColorKernel::Scalar)
+            {
+                Done = FilterRowSSE41(Row, Out, ColumnOffsets.data(), ColumnWeights.data(), DstWidth);
+            }
+#endif
+            FilterRowScalar(Row, Out, ColumnOffsets.data(), ColumnWeights.data(), Done, DstWidth);
+            FilteredRowIndex[Slot] = SrcRow;
+        };
+
+        for (int32 Y = 0; Y < DstHeight; ++Y)
+        {
+            int32 Top = 0;
+            int32 Weight = 0;
+            MapCoordinate(Y, SrcHeight, DstHeight, Top, Weight);
+
+            // 아래 탭 행은 다음 출력 행의 위 탭으로 재사용되는 경우가 많음
+            if (FilteredRowIndex[1] == Top)
+            {
+                std::swap(FilteredRows[0], FilteredRows[1]);
+                std::swap(FilteredRowIndex[0], FilteredRowIndex[1]);
+            }
+            if (FilteredRowIndex[0] != Top)
+            {
+                FilterRow(Top, 0);
+            }
+            if (FilteredRowIndex[1] != Top + 1)
+            {
+                FilterRow(Top + 1, 1);
+            }
+
+            const int16* Row0 = FilteredRows[0].data();
+            const int16* Row1 = FilteredRows[1].data();
+            uint8* Out = Dst + (std::size_t)Y * RowLength;
+            int32 Done = 0;
+#if SRT_WITH_X86_KERNELS
+            if (Kernel == EColorKernel::AVX2)
+            {
+                Done = BlendRowsAVX2(Row0, Row1, Out, Weight, RowLength);
+            }
+            if (Kernel != EColorKernel::Scalar)
+            {
+                Done += BlendRowsSSE41(Row0 + Done, Row1 + Done, Out + Done, Weight, RowLength - Done);
+            }
+#endif
+            BlendRowsScalar(Row0, Row1, Out, Weight, Done, RowLength);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTPipelineStats.h"
+
+#include <cstdio>
+
+namespace CineSRT
+{
+    FPipelineStats::FPipelineStats()
+    {
+        for (std::atomic<int64>& Counter : Counters)
+        {
+            Counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    FPipelineStats::FStageSummary FPipelineStats::GetStage(EPipelineStage Stage) const
+    {
+        const FLatencyHistogram& Histogram = Stages[(int32)Stage];
+        FStageSummary Summary;
+        Summary.Count = Histogram.GetCount();
+        Summary.AverageMs = Histogram.GetAverageMs();
+        Summary.P50Ms = Histogram.GetPercentileMs(50.0);
+        Summary.P95Ms = Histogram.GetPercentileMs(95.0);
+        Summary.P99Ms = Histogram.GetPercentileMs(99.0);
+        Summary.MaxMs = Histogram.GetMaxMs();
+        return Summary;
+    }
+
+    void FPipelineStats::Reset()
+    {
+        for (FLatencyHistogram& Histogram : Stages)
+        {
+            Histogram.Reset();
+        }
+        for (std::atomic<int64>& Counter : Counters)
+        {
+            Counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::string FPipelineStats::FormatSummary() const
+    {
+        std::string Summary;
+        char Line[160];
+        for (int32 Index = 0; Index < (int32)EPipelineStage::Num; ++Index)
+        {
+            const FStageSummary Stage = GetStage((EPipelineStage)Index);
+            if (Stage.Count == 0)
+            {
+                continue;
+            }
+            std::snprintf(Line, sizeof(Line), "  %-10s p50 %7.2f  p95 %7.2f  p99 %7.2f  max %7.2f ms  (%llu)\n",
+                GetStageName((EPipelineStage)Index), Stage.P50Ms, Stage.P95Ms, Stage.P99Ms, Stage.MaxMs, (unsigned long long)Stage.Count);
+            Summary += Line;
+        }
+
+        Summary += " ";
+        for (int32 Index = 0; Index < (int32)EPipelineCounter::Num; ++Index)
+        {
+            std::snprintf(Line, sizeof(Line), " %s %lld", GetCounterName((EPipelineCounter)Index), (long long)GetCounter((EPipelineCounter)Index));
+            Summary += Line;
+        }
+        return Summary;
+    }
+
+    const char* FPipelineStats::GetStageName(EPipelineStage Stage)
+    {
+        switch (Stage)
+        {
+            case EPipelineStage::Cadence: return "cadence";
+            case EPipelineStage::Capture: return "capture";
+            case EPipelineStage::Readback: return "readback";
+            case EPipelineStage::Scale: return "scale";
+            case EPipelineStage::Convert: return "convert";
+            case EPipelineStage::Encode: return "encode";
+            case EPipelineStage::QueueWait: return "queue wait";
+            case EPipelineStage::Mux: return "mux";
+            case EPipelineStage::Send: return "send";
+            default: return "?";
+        }
+    }
+
+    const char* FPipelineStats::GetCounterName(EPipelineCounter Counter)
+    {
+        switch (Counter)
+        {
+            case EPipelineCounter::FramesCaptured: return "captured";
+            case EPipelineCounter::FramesEncoded: return "encoded";
+            case EPipelineCounter::FramesDropped: return "dropped";
+            case EPipelineCounter::FramesSent: return "sent";
+            case EPipelineCounter::BytesEncoded: return "bytes";
+            case EPipelineCounter::FramesStatic: return "static";
+            case EPipelineCounter::SlotsMissed: return "missed";
+            default: return "?";
+        }
+    }
+}
@@ -0,0 +1,265 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace CineSRT
+{
+    namespace
+    {
+        // 프레임이 없을 때 기록 스레드가 부분 블록 플러시를 확인하는 간격
+        constexpr int32 IdleWaitMs = 100;
+    }
+
+    FRecorder::FRecorder(const FSettings& InSettings)
+        : Settings(InSettings)
+        , Queue((uint32)std::max(InSettings.QueueCapacity, 2))
+    {
+    }
+
+    FRecorder::~FRecorder()
+    {
+        Stop();
+    }
+
+    bool FRecorder::Start(const std::string& InPath)
+    {
+        if (bIsRecording)
+        {
+            return false;
+        }
+
+        File = std::fopen(InPath.c_str(), "wb");
+        if (!File)
+        {
+            Logf(ELogLevel::Error, "Failed to create recording '%s'", InPath.c_str());
+            return false;
+        }
+        // 블록 단위로 직접 쓰므로 stdio 버퍼는 거치지 않음
+        std::setvbuf(File, nullptr, _IONBF, 0);
+
+        // 디스크 쓰기 단위 버퍼는 한 번만 (정렬된 시작 주소)
+        const int32 Capacity = (std::max(Settings.WriteBlockBytes, WriteAlignment) + WriteAlignment - 1) & ~(WriteAlignment - 1);
+        if (Capacity != BlockCapacity)
+        {
+            BlockStorage.reset(new uint8[(std::size_t)Capacity + WriteAlignment]);
+            const std::uintptr_t Address = reinterpret_cast<std::uintptr_t>(BlockStorage.get());
+            Block = BlockStorage.get() + ((WriteAlignment - (Address & (WriteAlignment - 1))) & (WriteAlignment - 1));
+            BlockCapacity = Capacity;
+        }
+        BlockSize = 0;
+
+        // 지난 Stop과 겹쳐 들어온 프레임은 이번 파일 것이 아님
+        FQueuedFrame Stale;
+        while (Queue.TryPop(Stale))
+        {
+        }
+
+        Path = InPath;
+        Muxer = FTSMuxer(); // 파일마다 PAT/PMT와 연속성 카운터를 처음부터
+        bDropUntilKeyframe = true; // 파일은 키프레임에서 시작
+        BacklogBytes = 0;
+        BacklogHighWater = 0;
+        FramesDropped = 0;
+        BytesDropped = 0;
+        FramesRecorded = 0;
+        FramesFailed = 0;
+        BytesWritten = 0;
+        Writes = 0;
+        bWriteFailed = false;
+        StartTime = GetTimeSeconds();
+        StopTime = 0.0;
+
+        // 위의 생산자 상태(bDropUntilKeyframe)를 다 채운 뒤에 공개 - RecordFrame은 다른 스레드(인코더 싱크)에서 acquire로 읽음
+        bShouldStop = false;
+        bIsRecording.store(true, std::memory_order_release);
+        Thread = std::thread([this]
+        {
+            SetCurrentThreadName("CineSRTRecorder");
+            Run();
+        });
+        Logf(ELogLevel::Log, "Recording to '%s'", Path.c_str());
+        return true;
+    }
+
+    void FRecorder::Stop()
+    {
+        if (!bIsRecording)
+        {
+            return;
+        }
+
+        // 기록 스레드는 큐에 남은 프레임까지 쓰고 끝남
+        bIsRecording = false;
+        bShouldStop = true;
+        FrameReadyEvent.Trigger();
+        if (Thread.joinable())
+        {
+            Thread.join();
+        }
+        StopTime = GetTimeSeconds();
+
+        const FStats Summary = GetStats();
+        Logf(ELogLevel::Log, "Recording '%s' closed: %lld frames, %.1f MB at %.1f MB/s, %lld dropped, %lld failed",
+            Path.c_str(), Summary.FramesRecorded, Summary.BytesWritten / 1048576.0, Summary.WriteMBps,
+            Summary.FramesDropped, Summary.FramesFailed);
+    }
+
+    bool FRecorder::RecordFrame(const FEncodedFrameRef& Frame)
+    {
+        if (!bIsRecording.load(std::memory_order_acquire) || !Frame || bWriteFailed.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        // 인코딩 중인 프레임은 크기를 아직 모름 - 기록 스레드가 꺼낼 때까지는 프레임 수로만 제한
+        const int64 Bytes = Frame->Partial ? 0 : (int64)Frame->Data.size();
+        if (bDropUntilKeyframe)
+        {
+            if (!Frame->bKeyframe)
+            {
+                FramesDropped++;
+                BytesDropped += Bytes;
+                return false;
+            }
+            bDropUntilKeyframe = false;
+        }
+
+        FQueuedFrame Queued;
+        Queued.Frame = Frame;
+        Queued.Bytes = Bytes;
+        if (BacklogBytes.load(std::memory_order_relaxed) + Bytes > Settings.MaxBacklogBytes || !Queue.TryPush(Queued))
+        {
+            // 디스크가 못 따라옴: 라이브 경로를 막지 않고 버림. 인터 코덱은 다음 키프레임까지 같이 버려야 파일이 디코딩됨
+            FramesDropped++;
+            BytesDropped += Bytes;
+            bDropUntilKeyframe = true;
+            return false;
+        }
+
+        BacklogBytes += Bytes;
+        const int32 Depth = (int32)Queue.Num();
+        if (Depth > BacklogHighWater.load(std::memory_order_relaxed))
+        {
+            BacklogHighWater = Depth;
+        }
+        FrameReadyEvent.Trigger();
+        return true;
+    }
+
+    FRecorder::FStats FRecorder::GetStats() const
+    {
+        FStats Stats;
+        Stats.FramesRecorded = FramesRecorded.load();
+        Stats.BytesWritten = BytesWritten.load();
+        Stats.FramesDropped = FramesDropped.load();
+        Stats.BytesDropped = BytesDropped.load();
+        Stats.FramesFailed = FramesFailed.load();
+        Stats.BacklogFrames = (int32)Queue.Num();
+        Stats.BacklogHighWater = BacklogHighWater.load();
+        Stats.BacklogBytes = BacklogBytes.load();
+        Stats.Writes = Writes.load();
+        const double Elapsed = (StopTime > 0.0 ? StopTime : GetTimeSeconds()) - StartTime;
+        Stats.WriteMBps = StartTime > 0.0 && Elapsed > 0.0 ? Stats.BytesWritten / 1048576.0 / Elapsed : 0.0;
+        Stats.bWriteFailed = bWriteFailed.load();
+        return Stats;
+    }
+
+    void FRecorder::Run()
+    {
+        while (true)
+        {
+            FQueuedFrame Queued;
+            if (!Queue.TryPop(Queued))
+            {
+                if (bShouldStop)
+                {
+                    break;
+                }
+                FrameReadyEvent.Wait(IdleWaitMs);
+
+                // 저비트레이트에서도 블록이 몇 초씩 메모리에만 머물지 않도록
+                if (BlockSize > 0 && GetTimeSeconds() - BlockStartTime >= Settings.FlushIntervalSeconds)
+                {
+                    WriteBlock();
+                }
+                continue;
+            }
+            BacklogBytes -= Queued.Bytes;
+
+            if (Queued.Frame->Partial && !Queued.Frame->Partial->WaitFinished())
+            {
+                // 인코딩이 끝나지 않은 채 실패한 프레임 - 라이브에는 일부가 나갔지만 파일에는 넣지 않음
+                FramesFailed++;
+                continue;
+            }
+            if (bWriteFailed)
+            {
+                FramesDropped++;
+                continue;
+            }
+            WriteFrame(*Queued.Frame);
+        }
+
+        if (BlockSize > 0)
+        {
+            WriteBlock();
+        }
+        std::fclose(File);
+        File = nullptr;
+    }
+
+    void FRecorder::WriteFrame(FEncodedFrame& Frame)
+    {
+        Muxer.MuxFrame(Frame, [this](const uint8* Payload, int32 PayloadSize)
+        {
+            AppendToBlock(Payload, PayloadSize);
+            return true;
+        });
+        FramesRecorded++;
+    }
+
+    void FRecorder::AppendToBlock(const uint8* Data, int32 Size)
+    {
+        while (Size > 0)
+        {
+            if (BlockSize == 0)
+            {
+                BlockStartTime = GetTimeSeconds();
+            }
+            const int32 Take = std::min(Size, BlockCapacity - BlockSize);
+            std::memcpy(Block + BlockSize, Data, Take);
+            BlockSize += Take;
+            Data += Take;
+            Size -= Take;
+            if (BlockSize == BlockCapacity)
+            {
+                WriteBlock();
+            }
+        }
+    }
+
+    void FRecorder::WriteBlock()
+    {
+        if (bWriteFailed)
+        {
+            BlockSize = 0;
+            return;
+        }
+
+        const double WriteStart = GetTimeSeconds();
+        const std::size_t Written = std::fwrite(Block, 1, (std::size_t)BlockSize, File);
+        WriteLatency.Record(GetTimeSeconds() - WriteStart);
+        if (Written != (std::size_t)BlockSize)
+        {
+            // 디스크가 가득 찼거나 사라짐 - 이후 프레임은 버리고 라이브는 계속
+            Logf(ELogLevel::Error, "Recording '%s' stopped: write of %d bytes failed after %lld bytes", Path.c_str(), BlockSize, BytesWritten.load());
+            bWriteFailed = true;
+        }
+        BytesWritten += (int64)Written;
+        Writes++;
+        BlockSize = 0;
+    }
+}
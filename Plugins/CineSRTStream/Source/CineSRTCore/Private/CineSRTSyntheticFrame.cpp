@@ -0,0 +1,26 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTSyntheticFrame.h"
+
+#include <cstddef>
+
+namespace CineSRT
+{
+    void FSyntheticFrame::Fill(uint8* BGRA, int32 Width, int32 Height, int32 FrameIndex)
+    {
+        uint32 Seed = 0x9E3779B9u * (FrameIndex + 1);
+        for (int32 Y = 0; Y < Height; ++Y)
+        {
+            uint8* Row = BGRA + (std::size_t)Y * Width * 4;
+            for (int32 X = 0; X < Width; ++X)
+            {
+                Seed = Seed * 1664525u + 1013904223u;
+                const uint8 Noise = (uint8)(Seed >> 28);
+                Row[X * 4 + 0] = (uint8)((uint8)(X + FrameIndex * 2) + Noise);
+                Row[X * 4 + 1] = (uint8)((uint8)(Y + FrameIndex) + Noise);
+                Row[X * 4 + 2] = (uint8)((X + Y) / 2 - FrameIndex * 3);
+                Row[X * 4 + 3] = 255;
+            }
+        }
+    }
+}
@@ -0,0 +1,589 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTTSMuxer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace CineSRT
+{
+    namespace
+    {
+        constexpr uint8 SyncByte = 0x47;
+        constexpr int64 TimestampMask = 0x1FFFFFFFFll; // 33 bits
+
+        // 시작 코드, stream_id, PES_packet_length, 플래그 두 바이트, header_data_length + PTS/DTS
+        constexpr int32 PesHeaderSize = 19;
+
+        // 길이 있는 PES의 두 번째부터: 같은 액세스 유닛을 이어 가므로 PTS 없음
+        constexpr int32 ContinuationPesHeaderSize = 9;
+
+        struct FCrc32Table
+        {
+            uint32 Entries[256];
+
+            FCrc32Table()
+            {
+                for (uint32 Index = 0; Index < 256; ++Index)
+                {
+                    uint32 Crc = Index << 24;
+                    for (int32 Bit = 0; Bit < 8; ++Bit)
+                    {
+                        Crc = (Crc & 0x80000000u) ? (Crc << 1) ^ 0x04C11DB7u : (Crc << 1);
+                    }
+                    Entries[Index] = Crc;
+                }
+            }
+        };
+
+        // CRC-32/MPEG-2 used by PSI sections
+        uint32 ComputeSectionCrc(const uint8* Data, int32 Size)
+        {
+            static const FCrc32Table Table;
+            uint32 Crc = 0xFFFFFFFFu;
+            for (int32 Index = 0; Index < Size; ++Index)
+            {
+                Crc = (Crc << 8) ^ Table.Entries[((Crc >> 24) ^ Data[Index]) & 0xFF];
+            }
+            return Crc;
+        }
+
+        void WriteSectionCrc(uint8* Section, int32 SizeWithoutCrc)
+        {
+            const uint32 Crc = ComputeSectionCrc(Section, SizeWithoutCrc);
+            Section[SizeWithoutCrc + 0] = (uint8)(Crc >> 24);
+            Section[SizeWithoutCrc + 1] = (uint8)(Crc >> 16);
+            Section[SizeWithoutCrc + 2] = (uint8)(Crc >> 8);
+            Section[SizeWithoutCrc + 3] = (uint8)Crc;
+        }
+
+        void WritePesTimestamp(uint8* Out, uint8 Prefix, int64 Timestamp)
+        {
+            Out[0] = (uint8)((Prefix << 4) | (((Timestamp >> 30) & 0x07) << 1) | 1);
+            Out[1] = (uint8)(Timestamp >> 22);
+            Out[2] = (uint8)((((Timestamp >> 15) & 0x7F) << 1) | 1);
+            Out[3] = (uint8)(Timestamp >> 7);
+            Out[4] = (uint8)(((Timestamp & 0x7F) << 1) | 1);
+        }
+
+        bool StartsWithAccessUnitDelimiter(const uint8* Data, int32 Size)
+        {
+            if (Size >= 5 && Data[0] == 0 && Data[1] == 0 && Data[2] == 0 && Data[3] == 1)
+            {
+                return (Data[4] & 0x1F) == 9;
+            }
+            if (Size >= 4 && Data[0] == 0 && Data[1] == 0 && Data[2] == 1)
+            {
+                return (Data[3] & 0x1F) == 9;
+            }
+            return false;
+        }
+    }
+
+    FTSMuxer::FTSMuxer()
+    {
+        std::memset(Payload, 0, sizeof(Payload));
+    }
+
+    void FTSMuxer::Reset()
+    {
+        PacketsInPayload = 0;
+        bPsiPending = true;
+    }
+
+    uint8 FTSMuxer::GetStreamType(EEncodingFormat Format)
+    {
+        switch (Format)
+        {
+            case EEncodingFormat::H264: return 0x1B;
+            case EEncodingFormat::H265: return 0x24;
+            default:                    return 0x06; // MJPEG has no registered stream type; carried as private PES data
+        }
+    }
+
+    uint8 FTSMuxer::GetPesStreamId(EEncodingFormat Format)
+    {
+        // private_stream_1 for MJPEG, like the 302M audio - 0xE0 would claim an MPEG video stream
+        return Format == EEncodingFormat::H264 || Format == EEncodingFormat::H265 ? 0xE0 : 0xBD;
+    }
+
+    uint8* FTSMuxer::BeginPacket()
+    {
+        return Payload + PacketsInPayload * PacketSize;
+    }
+
+    bool FTSMuxer::FinishPacket(FPayloadSink& Sink)
+    {
+        if (++PacketsInPayload < PacketsPerPayload)
+        {
+            return true;
+        }
+        PacketsInPayload = 0;
+        return Sink(Payload, PayloadSize);
+    }
+
+    bool FTSMuxer::FlushPadded(FPayloadSink& Sink)
+    {
+        if (PacketsInPayload == 0)
+        {
+            return true;
+        }
+        while (PacketsInPayload < PacketsPerPayload)
+        {
+            uint8* Packet = BeginPacket();
+            Packet[0] = SyncByte;
+            Packet[1] = (uint8)(NullPid >> 8);
+            Packet[2] = (uint8)NullPid;
+            Packet[3] = 0x10;
+            std::memset(Packet + 4, 0xFF, PacketSize - 4);
+            PacketsInPayload++;
+        }
+        PacketsInPayload = 0;
+        return Sink(Payload, PayloadSize);
+    }
+
+    void FTSMuxer::WritePcrField(uint8* Out, int64 Pcr)
+    {
+        // program_clock_reference_base (33 bits), reserved, extension 0
+        Pcr &= TimestampMask;
+        Out[0] = (uint8)(Pcr >> 25);
+        Out[1] = (uint8)(Pcr >> 17);
+        Out[2] = (uint8)(Pcr >> 9);
+        Out[3] = (uint8)(Pcr >> 1);
+        Out[4] = (uint8)(((Pcr & 0x01) << 7) | 0x7E);
+        Out[5] = 0x00;
+    }
+
+    bool FTSMuxer::WritePcrPacket(int64 Pcr, FPayloadSink& Sink)
+    {
+        // adaptation_field_control 10: no payload, so the continuity counter repeats the last video packet's
+        uint8* Packet = BeginPacket();
+        Packet[0] = SyncByte;
+        Packet[1] = (uint8)(VideoPid >> 8);
+        Packet[2] = (uint8)VideoPid;
+        Packet[3] = (uint8)(0x20 | ((VideoContinuity - 1) & 0x0F));
+        Packet[4] = PacketSize - 5; // adaptation_field_length
+        Packet[5] = 0x10;           // PCR_flag
+        WritePcrField(Packet + 6, Pcr);
+        std::memset(Packet + 12, 0xFF, PacketSize - 12);
+        LastPcr = Pcr;
+        return FinishPacket(Sink);
+    }
+
+    bool FTSMuxer::WritePcr(int64 Pcr, FPayloadSink Sink)
+    {
+        if (LastPcr < 0 || Pcr <= LastPcr || bFrameOpen)
+        {
+            return true;
+        }
+        return WritePcrPacket(Pcr, Sink);
+    }
+
+    void FTSMuxer::WritePsi(uint16 Pid, const uint8* Section, int32 SectionSize, uint8& Continuity)
+    {
+        uint8* Packet = BeginPacket();
+        Packet[0] = SyncByte;
+        Packet[1] = (uint8)(0x40 | (Pid >> 8)); // payload_unit_start
+        Packet[2] = (uint8)Pid;
+        Packet[3] = (uint8)(0x10 | Continuity);
+        Packet[4] = 0x00; // pointer_field
+        std::memcpy(Packet + 5, Section, SectionSize);
+        std::memset(Packet + 5 + SectionSize, 0xFF, PacketSize - 5 - SectionSize);
+        Continuity = (Continuity + 1) & 0x0F;
+    }
+
+    void FTSMuxer::WritePat()
+    {
+        uint8 Section[16] =
+        {
+            0x00,                                       // table_id
+            0xB0, 13,                                   // section_syntax_indicator, section_length
+            0x00, 0x01,                                 // transport_stream_id
+            0xC1,                                       // version 0, current_next
+            0x00, 0x00,                                 // section_number, last_section_number
+            0x00, 0x01,                                 // program_number
+            (uint8)(0xE0 | (PmtPid >> 8)), (uint8)PmtPid
+        };
+        WriteSectionCrc(Section, 12);
+        WritePsi(0x0000, Section, sizeof(Section), PatContinuity);
+    }
+
+    void FTSMuxer::WritePmt()
+    {
+        uint8 Section[38] =
+        {
+            0x02,                                       // table_id
+            0xB0, 18,                                   // section_syntax_indicator, section_length
+            0x00, 0x01,                                 // program_number
+            (uint8)(0xC1 | ((PmtVersion & 0x1F) << 1)), // version, current_next
+            0x00, 0x00,                                 // section_number, last_section_number
+            (uint8)(0xE0 | (VideoPid >> 8)), (uint8)VideoPid, // PCR_PID
+            0xF0, 0x00,                                 // program_info_length
+            GetStreamType(CurrentFormat),
+            (uint8)(0xE0 | (VideoPid >> 8)), (uint8)VideoPid,
+            0xF0, 0x00                                  // ES_info_length
+        };
+        int32 Size = 17;
+        if (GetStreamType(CurrentFormat) == 0x06)
+        {
+            // MJPEG: private PES identified by an "MJPG" registration descriptor (a private tag, not one SMPTE-RA lists)
+            const uint8 VideoDescriptor[] = { 0x05, 4, 'M', 'J', 'P', 'G' };
+            std::memcpy(Section + Size, VideoDescriptor, sizeof(VideoDescriptor));
+            Size += sizeof(VideoDescriptor);
+            Section[16] = sizeof(VideoDescriptor);
+        }
+        if (bHasAudio)
+        {
+            // SMPTE 302M: private PES identified by the "BSSD" registration descriptor
+            const uint8 AudioEntry[] =
+            {
+                0x06,
+                (uint8)(0xE0 | (AudioPid >> 8)), (uint8)AudioPid,
+                0xF0, 6,                                // ES_info_length
+                0x05, 4, 'B', 'S', 'S', 'D'             // registration_descriptor
+            };
+            std::memcpy(Section + Size, AudioEntry, sizeof(AudioEntry));
+            Size += sizeof(AudioEntry);
+        }
+        Section[2] = (uint8)(Size + 4 - 3);
+        WriteSectionCrc(Section, Size);
+        WritePsi(PmtPid, Section, Size + 4, PmtContinuity);
+    }
+
+    bool FTSMuxer::MuxFrame(const FEncodedFrame& Frame, FPayloadSink Sink)
+    {
+        if (Frame.Data.empty())
+        {
+            return true;
+        }
+        return BeginFrame(Frame, Sink) && WriteFrameData(Frame.Data.data(), (int32)Frame.Data.size(), Sink) && EndFrame(Sink);
+    }
+
+    bool FTSMuxer::BeginFrame(const FEncodedFrame& Frame, FPayloadSink Sink)
+    {
+        if (Frame.Format != CurrentFormat)
+        {
+            CurrentFormat = Frame.Format;
+            PmtVersion = (PmtVersion + 1) & 0x1F;
+            bPsiPending = true;
+        }
+
+        // The clock never runs backwards: WritePcr extrapolates between frames and may get a little ahead of a frame
+        // whose capture-to-mux delay grew. A jump of more than PcrJumpLimit either way is a new timeline, left as is
+        FramePcr = Frame.Pts;
+        if (LastPcr >= 0 && FramePcr <= LastPcr && LastPcr - FramePcr < PcrJumpLimit)
+        {
+            FramePcr = LastPcr + 1;
+        }
+        FramePts = (Frame.Pts + PtsOffset) & TimestampMask;
+
+        if (bPsiPending || Frame.bKeyframe || Frame.Pts - LastPsiPts >= PsiInterval)
+        {
+            WritePat();
+            if (!FinishPacket(Sink)) return false;
+            WritePmt();
+            if (!FinishPacket(Sink)) return false;
+            LastPsiPts = Frame.Pts;
+            bPsiPending = false;
+        }
+
+        // Frames further apart than PcrInterval (low frame rate, or no one calling WritePcr): PCR-only packets,
+        // interpolated, so a receiver never goes longer than PcrInterval without one
+        if (LastPcr >= 0 && FramePcr - LastPcr > PcrInterval && FramePcr - LastPcr < PcrJumpLimit)
+        {
+            for (int64 Pcr = LastPcr + PcrInterval; Pcr < FramePcr; Pcr += PcrInterval)
+            {
+                if (!WritePcrPacket(Pcr, Sink)) return false;
+            }
+        }
+
+        // Video stream_ids: one unbounded PES whose header goes ahead of the access unit in the first packet (the AUD,
+        // if needed, with the first data). MJPEG: bounded PES packets, each header written once its length is known
+        bBoundedPes = GetPesStreamId(CurrentFormat) != 0xE0;
+        bFirstPes = true;
+        FrameBytesLeft = Frame.Partial ? -1 : (int64)Frame.Data.size(); // 인코더가 아직 쓰는 Data는 읽지 않음
+        PesLeft = 0;
+        PendingVideoSize = 0;
+        bPesStart = false;
+        if (!bBoundedPes)
+        {
+            PendingVideoSize = WritePesHeader(PendingVideo, -1);
+            bPesStart = true;
+            bFirstPes = false;
+        }
+        bFrameOpen = true;
+        bFirstVideoPacket = true;
+        bFrameKeyframe = Frame.bKeyframe;
+        bFrameHasData = false;
+        return true;
+    }
+
+    bool FTSMuxer::WriteFrameData(const uint8* Data, int32 Size, FPayloadSink Sink)
+    {
+        if (Size <= 0)
+        {
+            return true;
+        }
+        if (!bFrameHasData)
+        {
+            bFrameHasData = true;
+            if (CurrentFormat == EEncodingFormat::H264 && !StartsWithAccessUnitDelimiter(Data, Size))
+            {
+                const uint8 AccessUnitDelimiter[] = { 0x00, 0x00, 0x00, 0x01, 0x09, 0xF0 };
+                std::memcpy(PendingVideo + PendingVideoSize, AccessUnitDelimiter, sizeof(AccessUnitDelimiter));
+                PendingVideoSize += sizeof(AccessUnitDelimiter);
+            }
+        }
+        if (bBoundedPes)
+        {
+            FrameBytesLeft = FrameBytesLeft >= 0 ? std::max<int64>(FrameBytesLeft - Size, 0) : -1;
+            return WriteBoundedPes(Data, Size, false, Sink);
+        }
+
+        // 패킷 하나를 채울 만큼 모이면 바로 내보내고, 남은 자투리만 다음 조각이나 EndFrame까지 보관
+        while (PendingVideoSize + Size >= GetVideoCapacity())
+        {
+            const int32 FromData = GetVideoCapacity() - PendingVideoSize;
+            if (!WriteVideoPacket(Data, FromData, Sink))
+            {
+                return false;
+            }
+            Data += FromData;
+            Size -= FromData;
+        }
+        std::memcpy(PendingVideo + PendingVideoSize, Data, Size);
+        PendingVideoSize += Size;
+        return true;
+    }
+
+    bool FTSMuxer::EndFrame(FPayloadSink Sink)
+    {
+        bFrameOpen = false;
+        if (bBoundedPes && !WriteBoundedPes(nullptr, 0, true, Sink))
+        {
+            return false;
+        }
+        if (PendingVideoSize > 0 && !WriteVideoPacket(nullptr, 0, Sink))
+        {
+            return false;
+        }
+
+        // Flush so the tail of this frame is not held back until the next one arrives
+        return FlushPadded(Sink);
+    }
+
+    int32 FTSMuxer::WritePesHeader(uint8* Out, int32 DataSize) const
+    {
+        // The frame's first PES carries the PTS (DTS == PTS, no reordering) and data_alignment_indicator
+        const int32 HeaderSize = bFirstPes ? PesHeaderSize : ContinuationPesHeaderSize;
+        const int32 PesLength = DataSize < 0 ? 0 : HeaderSize - 6 + DataSize; // 0: unbounded, video stream_ids only
+        Out[0] = 0x00;
+        Out[1] = 0x00;
+        Out[2] = 0x01;
+        Out[3] = GetPesStreamId(CurrentFormat);
+        Out[4] = (uint8)(PesLength >> 8);
+        Out[5] = (uint8)PesLength;
+        Out[6] = bFirstPes ? 0x84 : 0x80;
+        Out[7] = bFirstPes ? 0xC0 : 0x00;
+        Out[8] = (uint8)(HeaderSize - 9);
+        if (bFirstPes)
+        {
+            WritePesTimestamp(Out + 9, 0x3, FramePts);
+            WritePesTimestamp(Out + 14, 0x1, FramePts);
+        }
+        return HeaderSize;
+    }
+
+    bool FTSMuxer::WriteBoundedPes(const uint8* Data, int32 Size, bool bEndOfFrame, FPayloadSink& Sink)
+    {
+        // 크기를 아는 프레임은 PES마다 길이를 먼저 적고 데이터는 들어오는 대로. 모르면(인코딩 중) 모인 바이트로 TS 패킷을
+        // 꼭 채우는 PES만 열고 나머지는 다음 조각까지 보관 - 어느 쪽이든 PES는 프레임의 마지막 것 말고는 패킷 경계에서 끝남
+        while (true)
+        {
+            if (PesLeft == 0)
+            {
+                const int32 Available = PendingVideoSize + Size; // PES 사이의 자투리는 데이터뿐
+                const int32 HeaderSize = bFirstPes ? PesHeaderSize : ContinuationPesHeaderSize;
+                const int32 FirstPacketData = GetVideoCapacity() - HeaderSize;
+                const int32 MaxData = 0xFFFF - (HeaderSize - 6);
+                const int64 Remaining = bEndOfFrame ? Available : FrameBytesLeft >= 0 ? Available + FrameBytesLeft : -1;
+                int32 DataSize;
+                if (Remaining >= 0 && Remaining <= MaxData)
+                {
+                    if (Remaining == 0 && !bFirstPes)
+                    {
+                        break;
+                    }
+                    DataSize = (int32)Remaining;
+                }
+                else
+                {
+                    const int32 Limit = Remaining >= 0 ? MaxData : std::min(Available, MaxData);
+                    if (Limit < FirstPacketData)
+                    {
+                        break;
+                    }
+                    DataSize = FirstPacketData + (Limit - FirstPacketData) / (PacketSize - 4) * (PacketSize - 4);
+                }
+
+                std::memmove(PendingVideo + HeaderSize, PendingVideo, PendingVideoSize);
+                WritePesHeader(PendingVideo, DataSize);
+                PendingVideoSize += HeaderSize;
+                PesLeft = HeaderSize + DataSize;
+                bPesStart = true;
+                bFirstPes = false;
+            }
+
+            const int32 PacketBytes = std::min(PesLeft, GetVideoCapacity());
+            if (PendingVideoSize + Size < PacketBytes)
+            {
+                break;
+            }
+            const int32 FromData = PacketBytes - PendingVideoSize;
+            if (!WriteVideoPacket(Data, FromData, Sink))
+            {
+                return false;
+            }
+            Data += FromData;
+            Size -= FromData;
+            PesLeft -= PacketBytes;
+        }
+        if (Size > 0)
+        {
+            std::memcpy(PendingVideo + PendingVideoSize, Data, Size);
+            PendingVideoSize += Size;
+        }
+        return true;
+    }
+
+    bool FTSMuxer::MuxAudio(const FEncodedAudio& Audio, FPayloadSink Sink)
+    {
+        if (Audio.Data.empty())
+        {
+            return true;
+        }
+        if (!bHasAudio)
+        {
+            bHasAudio = true;
+            PmtVersion = (PmtVersion + 1) & 0x1F;
+            bPsiPending = true;
+        }
+        if (bPsiPending)
+        {
+            WritePat();
+            if (!FinishPacket(Sink)) return false;
+            WritePmt();
+            if (!FinishPacket(Sink)) return false;
+            bPsiPending = false;
+        }
+
+        // Audio PES needs its length (unlike video); one AES3 packet per PES, PTS only
+        uint8 Header[14];
+        const int32 PesLength = 3 + 5 + (int32)Audio.Data.size();
+        Header[0] = 0x00;
+        Header[1] = 0x00;
+        Header[2] = 0x01;
+        Header[3] = 0xBD;  // private_stream_1
+        Header[4] = (uint8)(PesLength >> 8);
+        Header[5] = (uint8)PesLength;
+        Header[6] = 0x84;  // data_alignment_indicator
+        Header[7] = 0x80;  // PTS only
+        Header[8] = 5;
+        WritePesTimestamp(Header + 9, 0x2, (Audio.Pts + PtsOffset) & TimestampMask);
+
+        const uint8* Data = Audio.Data.data();
+        int32 HeaderLeft = (int32)sizeof(Header);
+        int32 DataLeft = (int32)Audio.Data.size();
+        bool bFirst = true;
+        while (HeaderLeft + DataLeft > 0)
+        {
+            uint8* Packet = BeginPacket();
+            const int32 Take = std::min(HeaderLeft + DataLeft, PacketSize - 4);
+            const int32 AdaptationSize = PacketSize - 4 - Take;
+            Packet[0] = SyncByte;
+            Packet[1] = (uint8)((bFirst ? 0x40 : 0x00) | (AudioPid >> 8));
+            Packet[2] = (uint8)AudioPid;
+            Packet[3] = (uint8)((AdaptationSize > 0 ? 0x30 : 0x10) | AudioContinuity);
+            AudioContinuity = (AudioContinuity + 1) & 0x0F;
+            if (AdaptationSize > 0)
+            {
+                // Stuffing on the last packet only
+                Packet[4] = (uint8)(AdaptationSize - 1);
+                if (AdaptationSize > 1)
+                {
+                    Packet[5] = 0x00;
+                    std::memset(Packet + 6, 0xFF, AdaptationSize - 2);
+                }
+            }
+
+            uint8* Out = Packet + 4 + AdaptationSize;
+            const int32 FromHeader = std::min(HeaderLeft, Take);
+            std::memcpy(Out, Header + sizeof(Header) - HeaderLeft, FromHeader);
+            std::memcpy(Out + FromHeader, Data, Take - FromHeader);
+            HeaderLeft -= FromHeader;
+            Data += Take - FromHeader;
+            DataLeft -= Take - FromHeader;
+            bFirst = false;
+            if (!FinishPacket(Sink))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool FTSMuxer::WriteVideoPacket(const uint8* Data, int32 Size, FPayloadSink& Sink)
+    {
+        uint8* Packet = BeginPacket();
+
+        // Adaptation field: PCR + random access on the first packet, stuffing on the last
+        const int32 Capacity = GetVideoCapacity();
+        const int32 Take = PendingVideoSize + Size;
+        int32 AdaptationSize = (bFirstVideoPacket ? 8 : 0) + Capacity - Take;
+
+        Packet[0] = SyncByte;
+        Packet[1] = (uint8)((bPesStart ? 0x40 : 0x00) | (VideoPid >> 8));
+        Packet[2] = (uint8)VideoPid;
+        Packet[3] = (uint8)((AdaptationSize > 0 ? 0x30 : 0x10) | VideoContinuity);
+        VideoContinuity = (VideoContinuity + 1) & 0x0F;
+
+        if (AdaptationSize > 0)
+        {
+            Packet[4] = (uint8)(AdaptationSize - 1); // adaptation_field_length excludes itself
+            if (AdaptationSize > 1)
+            {
+                int32 Offset = 5;
+                uint8 Flags = 0x00;
+                if (bFirstVideoPacket)
+                {
+                    Flags |= 0x10; // PCR_flag
+                    if (bFrameKeyframe)
+                    {
+                        Flags |= 0x40; // random_access_indicator
+                    }
+                }
+                Packet[Offset++] = Flags;
+                if (bFirstVideoPacket)
+                {
+                    WritePcrField(Packet + Offset, FramePcr);
+                    Offset += 6;
+                    LastPcr = FramePcr;
+                }
+                std::memset(Packet + Offset, 0xFF, 4 + AdaptationSize - Offset);
+            }
+        }
+
+        // Held-back bytes (PES header, the previous piece's tail) first, then the new data
+        uint8* Out = Packet + 4 + AdaptationSize;
+        std::memcpy(Out, PendingVideo, PendingVideoSize);
+        if (Size > 0)
+        {
+            std::memcpy(Out + PendingVideoSize, Data, Size);
+        }
+        PendingVideoSize = 0;
+        bFirstVideoPacket = false;
+        bPesStart = false;
+        return FinishPacket(Sink);
+    }
+}
@@ -0,0 +1,1608 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTTransmitter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if WITH_SRT && !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+namespace CineSRT
+{
+    namespace
+    {
+        // 리스너 소켓에 들어가는 설정 - 이게 같으면 Prepare로 열어 둔 리스너를 그대로 씀
+        bool HasSameListener(const FTransmitter::FSettings& A, const FTransmitter::FSettings& B)
+        {
+            return A.BindAddress == B.BindAddress && A.Port == B.Port && A.LatencyTolerance == B.LatencyTolerance
+                && A.MaxBW == B.MaxBW && A.InputBW == B.InputBW && A.Overhead == B.Overhead && A.MaxClients == B.MaxClients;
+        }
+    }
+
+    int32 FTransmitter::SRTUsers = 0;
+    std::mutex FTransmitter::SRTInitLock;
+
+    FTransmitter::FTransmitter(const FSettings& InSettings)
+        : Settings(InSettings)
+    {
+    }
+
+    FTransmitter::~FTransmitter()
+    {
+        StopTransmission();
+        CleanupSRT();
+
+        // 남은 스트림 핸들로는 더 이상 전송하지 않음
+        std::lock_guard<std::mutex> Lock(StreamsLock);
+        for (std::shared_ptr<FStream>& Stream : Streams)
+        {
+            Stream->bRegistered = false;
+        }
+        Streams.clear();
+    }
+
+    FTransmitter::FStream::FStream(FTransmitter& InOwner, const std::string& InStreamId)
+        : Owner(InOwner)
+        , StreamId(InStreamId)
+        , TransmissionQueue(InOwner.Settings.QueueCapacity)
+        , AudioQueue(AudioQueueCapacity)
+    {
+    }
+
+    void FTransmitter::Run()
+    {
+        Logf(ELogLevel::Log, "Transmitter thread started");
+
+#if WITH_SRT
+        SRT_EPOLL_EVENT Events[16];
+        double LastWaitLogTime = GetTimeSeconds();
+
+        while (!bShouldStop)
+        {
+            if (bStreamsChanged.load(std::memory_order_acquire))
+            {
+                SyncStreams();
+            }
+
+            if (NumClients.load(std::memory_order_relaxed) == 0)
+            {
+                // 클라이언트가 없으면 리스너 이벤트에서 블록 (accept 폴링 없음). 접속 캐시로 먹싱 중인 프레임이 있으면 짧게
+                bool bAnyOpenFrame = false;
+                for (const std::shared_ptr<FStream>& Stream : ActiveStreams)
+                {
+                    bAnyOpenFrame |= Stream->OpenFrame != nullptr || !Stream->PendingAudio.empty();
+                }
+                const int32 NumEvents = srt_epoll_uwait(EpollId, Events, (int)(sizeof(Events) / sizeof(Events[0])), bAnyOpenFrame ? JoinPollMs : IdleWaitMs);
+                if (NumEvents > 0)
+                {
+                    HandleSocketEvents(Events, NumEvents);
+                }
+
+                // 받을 곳이 없는 프레임은 쌓아두지 않음
+                const double Now = GetTimeSeconds();
+                for (const std::shared_ptr<FStream>& Stream : ActiveStreams)
+                {
+                    ServiceStream(*Stream, Now);
+                }
+
+                // 5초에 한 번만 로그
+                if (NumClients.load(std::memory_order_relaxed) == 0 && GetTimeSeconds() - LastWaitLogTime > 5.0)
+                {
+                    Logf(ELogLevel::Log, "Waiting for connection on port %d (%d streams)", Settings.Port, (int32)ActiveStreams.size());
+                    LastWaitLogTime = GetTimeSeconds();
+                }
+                continue;
+            }
+
+            // 송신 버퍼가 찬 클라이언트가 있으면 EPOLL_OUT을 짧게 기다리고,
+            // 아니면 새 프레임이 들어올 때까지 대기 (TransmitFrame이 깨움)
+            bool bAnyWaitingWritable = false;
+            bool bAnyQueued = false;
+            bool bAnyPendingAudio = false;
+            bool bAnyPcrClock = false;
+            for (const std::shared_ptr<FStream>& Stream : ActiveStreams)
+            {
+                for (const std::unique_ptr<FClient>& Client : Stream->Clients)
+                {
+                    bAnyWaitingWritable |= Client->bWaitingWritable;
+                }
+                bAnyQueued |= Stream->TransmissionQueue.Num() > 0 || Stream->AudioQueue.Num() > 0;
+                bAnyPendingAudio |= !Stream->PendingAudio.empty();
+                bAnyPcrClock |= !Stream->Clients.empty() && Stream->LastPcrTime >= 0.0;
+            }
+            if (!bAnyWaitingWritable && !bAnyQueued)
+            {
+                // 접속 캐시/키프레임 요청이 켜져 있으면 새 호출자를 다음 프레임까지 기다리게 하지 않도록 리스너를 자주 확인.
+                // 프레임을 기다리는 오디오가 있으면 AudioHoldMs가 지나는 대로 혼자 내보내야 하므로 역시 짧게.
+                // 비디오가 나가는 중이면 프레임이 뜸해도 PCR이 PcrInterval을 넘기지 않도록 PcrPollMs마다
+                const bool bFastJoin = Settings.JoinCacheMaxBytes > 0 || Settings.bKeyframeOnJoin;
+                FrameReadyEvent.Wait(bFastJoin || bAnyPendingAudio ? JoinPollMs : bAnyPcrClock ? PcrPollMs : IdleWaitMs);
+            }
+
+            // 연결/끊김/쓰기 가능 이벤트 처리
+            const int32 NumEvents = srt_epoll_uwait(EpollId, Events, (int)(sizeof(Events) / sizeof(Events[0])), bAnyWaitingWritable ? WritableWaitMs : 0);
+            if (NumEvents > 0)
+            {
+                HandleSocketEvents(Events, NumEvents);
+            }
+
+            const double Now = GetTimeSeconds();
+            for (const std::shared_ptr<FStream>& Stream : ActiveStreams)
+            {
+                if (bShouldStop)
+                {
+                    break;
+                }
+                ServiceStream(*Stream, Now);
+            }
+        }
+#endif
+
+        Logf(ELogLevel::Log, "Transmitter thread stopped");
+    }
+
+    void FTransmitter::ServiceStream(FStream& Stream, double Now)
+    {
+        // 오디오는 같이 나갈 비디오 프레임을 고를 수 있도록 꺼내 둠
+        FEncodedAudioRef Audio;
+        while (Stream.AudioQueue.TryPop(Audio))
+        {
+            Stream.PendingAudio.push_back(std::move(Audio));
+        }
+
+        if (Stream.Clients.empty())
+        {
+            // 받을 곳이 없어도 접속 캐시는 채워 둠 - 첫 클라이언트(재접속 포함)도 바로 시작
+            FEncodedFrameRef Discarded;
+            while (ContinueOpenFrame(Stream) && Stream.TransmissionQueue.TryPop(Discarded))
+            {
+                Stream.QueueSpaceEvent.Trigger();
+                if (Settings.JoinCacheMaxBytes > 0)
+                {
+                    FanOutFrame(Stream, Discarded);
+                }
+                MarkFirstPacket(Stream);
+            }
+            if (Settings.JoinCacheMaxBytes > 0)
+            {
+                FanOutAudio(Stream, Now);
+            }
+            else
+            {
+                Stream.PendingAudio.clear();
+            }
+            Stream.LastStatsTime = Now;
+            Stream.LastLinkStatsTime = Now; // 첫 샘플은 접속 후 한 주기가 지나서
+            return;
+        }
+
+        // 프레임당 한 번만 먹싱해서 이 스트림의 모든 클라이언트 큐에 분배. 인코딩 중인 프레임이 있으면 그게 끝나야 다음 프레임
+        FEncodedFrameRef Frame;
+        while (!bShouldStop && ContinueOpenFrame(Stream) && Stream.TransmissionQueue.TryPop(Frame))
+        {
+            Stream.QueueSpaceEvent.Trigger();
+            if (Stream.PipelineStats)
+            {
+                Stream.PipelineStats->Record(EPipelineStage::QueueWait, Frame->QueueSeconds + GetTimeSeconds() - Frame->SubmitTime);
+            }
+            FanOutFrame(Stream, Frame);
+            MarkFirstPacket(Stream);
+        }
+        FanOutAudio(Stream, Now);
+        FanOutPcr(Stream, GetTimeSeconds());
+
+        for (std::unique_ptr<FClient>& Client : Stream.Clients)
+        {
+            if (!Client->bWaitingWritable && !Client->bDisconnect)
+            {
+                FlushClient(Stream, *Client);
+            }
+
+            // 정해진 시간 안에 따라잡지 못한 클라이언트는 끊어서 다른 클라이언트를 보호
+            if (Client->LaggingSince > 0.0 && (Now - Client->LaggingSince) * 1000.0 > Settings.SlowClientTimeoutMs)
+            {
+                Logf(ELogLevel::Warning, "Disconnecting slow client %s (%lld frames dropped)",
+                    Client->Address.c_str(), Client->FramesDropped);
+                Client->bDisconnect = true;
+            }
+        }
+        RemoveDisconnectedClients(Stream);
+        if (Stream.Clients.empty())
+        {
+            return;
+        }
+
+        if (Now - Stream.LastStatsTime >= 1.0)
+        {
+            UpdateClientStats(Stream, Now - Stream.LastStatsTime);
+            Stream.LastStatsTime = Now;
+        }
+
+        if ((Now - Stream.LastLinkStatsTime) * 1000.0 >= Settings.LinkStatsPeriodMs)
+        {
+            SampleLinkStats(Stream, Now - Stream.LastLinkStatsTime);
+            Stream.LastLinkStatsTime = Now;
+        }
+
+        // 10초마다 전송 지연 요약
+        const FLatencyHistogram& SendLatency = Stream.SendLatency;
+        if (Now - Stream.LastLatencyLogTime > 10.0 && SendLatency.GetCount() > 0)
+        {
+            Logf(ELogLevel::Log, "Stream '%s' send latency over %llu frames: p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms",
+                Stream.StreamId.c_str(), SendLatency.GetCount(), SendLatency.GetPercentileMs(50.0), SendLatency.GetPercentileMs(95.0),
+                SendLatency.GetPercentileMs(99.0), SendLatency.GetMaxMs());
+            if (Stream.JoinLatency.GetCount() > 0)
+            {
+                Logf(ELogLevel::Log, "  time to first picture over %llu joins: p50 %.1f ms, max %.1f ms (%lld from cache, %lld keyframes requested)",
+                    Stream.JoinLatency.GetCount(), Stream.JoinLatency.GetPercentileMs(50.0), Stream.JoinLatency.GetMaxMs(),
+                    Stream.ClientsJoinedFromCache.load(), Stream.KeyframesRequested.load());
+            }
+            for (const std::unique_ptr<FClient>& Client : Stream.Clients)
+            {
+                Logf(ELogLevel::Log, "  %s: %.2f Mbps, backlog %d, sent %lld, dropped %lld",
+                    Client->Address.c_str(), Client->SendRateMbps, (int32)Client->Queue.size(), Client->FramesSent, Client->FramesDropped);
+            }
+            Stream.LastLatencyLogTime = Now;
+        }
+    }
+
+    void FTransmitter::SyncStreams()
+    {
+        std::vector<std::shared_ptr<FStream>> Registered;
+        uint64 Version = 0;
+        {
+            std::lock_guard<std::mutex> Lock(StreamsLock);
+            bStreamsChanged = false;
+            Registered = Streams;
+            Version = StreamsVersion;
+        }
+
+        // 등록 해제된 스트림의 호출자는 여기서 끊음 - 이후로 전송 스레드는 그 스트림을 건드리지 않음
+        for (std::shared_ptr<FStream>& Stream : ActiveStreams)
+        {
+            if (std::find(Registered.begin(), Registered.end(), Stream) == Registered.end())
+            {
+                DisconnectAllClients(*Stream);
+                AbandonOpenFrame(*Stream);
+                Stream->JoinCache.clear();
+                Stream->JoinCacheBytes = 0;
+                FEncodedFrameRef Discarded;
+                while (Stream->TransmissionQueue.TryPop(Discarded))
+                {
+                }
+                Stream->QueueSpaceEvent.Trigger();
+            }
+        }
+        const double Now = GetTimeSeconds();
+        for (std::shared_ptr<FStream>& Stream : Registered)
+        {
+            if (std::find(ActiveStreams.begin(), ActiveStreams.end(), Stream) == ActiveStreams.end())
+            {
+                Stream->LastLatencyLogTime = Now;
+            }
+        }
+        ActiveStreams = std::move(Registered);
+        UpdateNumClients();
+
+        {
+            std::lock_guard<std::mutex> Lock(StreamsLock);
+            SyncedStreamsVersion = Version;
+        }
+        StreamsSynced.notify_all();
+    }
+
+    bool FTransmitter::StartTransmission()
+    {
+        if (bIsTransmitting)
+            return false;
+
+        // 1-2. SRT 라이브러리 초기화 + 리스너 (Prepare로 미리 열어 뒀으면 그대로)
+        const double StartTime = GetTimeSeconds();
+        if (!Prepare())
+        {
+            return false;
+        }
+
+        // 3. 스레드 생성 (스레드가 끝나면 소켓 정리)
+        bIsTransmitting = true;
+        bShouldStop = false;
+        {
+            std::lock_guard<std::mutex> Lock(StreamsLock);
+            bThreadRunning = true;
+            for (std::shared_ptr<FStream>& Stream : Streams)
+            {
+                Stream->MarkStart(StartTime);
+            }
+        }
+        bStreamsChanged = true; // 첫 바퀴에서 등록된 스트림을 가져감
+        Thread = std::thread([this]
+        {
+            SetCurrentThreadName("SRTTransmitter");
+            Run();
+            CleanupSRT();
+
+            // RemoveStream 대기 해제 - 이제 어떤 스트림도 참조하지 않음
+            {
+                std::lock_guard<std::mutex> Lock(StreamsLock);
+                bThreadRunning = false;
+            }
+            StreamsSynced.notify_all();
+        });
+        return true;
+    }
+
+    void FTransmitter::StopTransmission()
+    {
+        if (!bIsTransmitting)
+        {
+            return;
+        }
+
+        bIsTransmitting = false;
+        bShouldStop = true;
+        {
+            // Block 정책으로 대기 중인 생산자 해제
+            std::lock_guard<std::mutex> Lock(StreamsLock);
+            for (std::shared_ptr<FStream>& Stream : Streams)
+            {
+                Stream->QueueSpaceEvent.Trigger();
+            }
+        }
+        FrameReadyEvent.Trigger(); // 전송 스레드 깨우기
+
+        // 스레드 종료 대기
+        if (Thread.joinable())
+        {
+            Thread.join();
+        }
+
+        Logf(ELogLevel::Log, "Stopped SRT transmission");
+    }
+
+    std::shared_ptr<FTransmitter::FStream> FTransmitter::CreateStream(const std::string& StreamId)
+    {
+        return std::make_shared<FStream>(*this, StreamId);
+    }
+
+    bool FTransmitter::AddStream(const std::shared_ptr<FStream>& Stream)
+    {
+        if (!Stream || &Stream->Owner != this)
+        {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> Lock(StreamsLock);
+            for (const std::shared_ptr<FStream>& Registered : Streams)
+            {
+                if (Registered == Stream)
+                {
+                    return true;
+                }
+                if (Registered->StreamId == Stream->StreamId)
+                {
+                    Logf(ELogLevel::Error, "Stream id '%s' is already in use on port %d", Stream->StreamId.c_str(), Settings.Port);
+                    return false;
+                }
+            }
+            Stream->bDropUntilKeyframe = false;
+            Stream->bRegistered = true;
+            if (bIsTransmitting)
+            {
+                Stream->MarkStart(GetTimeSeconds());
+            }
+            Streams.push_back(Stream);
+            StreamsVersion++;
+            bStreamsChanged = true;
+        }
+        FrameReadyEvent.Trigger();
+        Logf(ELogLevel::Log, "Stream '%s' added on port %d", Stream->StreamId.c_str(), Settings.Port);
+        return true;
+    }
+
+    void FTransmitter::RemoveStream(const std::shared_ptr<FStream>& Stream)
+    {
+        if (!Stream)
+        {
+            return;
+        }
+        std::unique_lock<std::mutex> Lock(StreamsLock);
+        auto It = std::find(Streams.begin(), Streams.end(), Stream);
+        if (It == Streams.end())
+        {
+            return;
+        }
+        Streams.erase(It);
+        Stream->bRegistered = false;
+        Stream->QueueSpaceEvent.Trigger();
+        const uint64 Version = ++StreamsVersion;
+        bStreamsChanged = true;
+        FrameReadyEvent.Trigger();
+
+        // 전송 스레드가 새 등록부를 가져갈 때까지 (유휴 상태에서도 IdleWaitMs 이내)
+        StreamsSynced.wait(Lock, [this, Version] { return !bThreadRunning || SyncedStreamsVersion >= Version; });
+        Logf(ELogLevel::Log, "Stream '%s' removed from port %d", Stream->StreamId.c_str(), Settings.Port);
+    }
+
+    int32 FTransmitter::GetNumStreams() const
+    {
+        std::lock_guard<std::mutex> Lock(StreamsLock);
+        return (int32)Streams.size();
+    }
+
+    bool FTransmitter::FStream::TransmitFrame(FEncodedFrameRef Frame)
+    {
+        if (!Owner.bIsTransmitting || !bRegistered || !Frame)
+        {
+            return false;
+        }
+
+        // 키프레임 없이 P 프레임만 보내면 디코딩 불가 - 다음 키프레임까지 계속 버림
+        if (bDropUntilKeyframe)
+        {
+            if (!Frame->bKeyframe)
+            {
+                DroppedNonKeyframes++;
+                AddDroppedFrame();
+                return false;
+            }
+            bDropUntilKeyframe = false;
+        }
+
+        Frame->SubmitTime = GetTimeSeconds();
+
+        while (!TransmissionQueue.TryPush(Frame))
+        {
+            switch (Owner.Settings.OverflowPolicy)
+            {
+                case EQueueOverflowPolicy::DropOldest:
+                {
+                    FEncodedFrameRef Evicted;
+                    if (TransmissionQueue.TryPop(Evicted))
+                    {
+                        DroppedOldest++;
+                        AddDroppedFrame();
+                    }
+                    break;
+                }
+                case EQueueOverflowPolicy::DropNonKeyframes:
+                {
+                    if (!Frame->bKeyframe)
+                    {
+                        DroppedNonKeyframes++;
+                        AddDroppedFrame();
+                        bDropUntilKeyframe = true;
+                        return false;
+                    }
+                    // 키프레임은 가장 오래된 프레임을 밀어내고라도 넣음
+                    FEncodedFrameRef Evicted;
+                    if (TransmissionQueue.TryPop(Evicted))
+                    {
+                        DroppedOldest++;
+                        AddDroppedFrame();
+                    }
+                    break;
+                }
+                case EQueueOverflowPolicy::Block:
+                {
+                    if (!QueueSpaceEvent.Wait(Owner.Settings.BlockTimeoutMs) || !Owner.bIsTransmitting || !bRegistered)
+                    {
+                        DroppedBlockTimeout++;
+                        AddDroppedFrame();
+                        bDropUntilKeyframe = true;
+                        return false;
+                    }
+                    break;
+                }
+            }
+        }
+
+        FramesQueued++;
+        Owner.FrameReadyEvent.Trigger();
+        return true;
+    }
+
+    bool FTransmitter::FStream::TransmitAudio(FEncodedAudioRef Audio)
+    {
+        if (!Owner.bIsTransmitting || !bRegistered || !Audio)
+        {
+            return false;
+        }
+
+        Audio->SubmitTime = GetTimeSeconds();
+        if (!AudioQueue.TryPush(Audio))
+        {
+            // 전송 스레드가 멈춰 있음 - 오디오 스레드는 기다리지 않음
+            AudioPacketsDropped++;
+            return false;
+        }
+        Owner.FrameReadyEvent.Trigger();
+        return true;
+    }
+
+    void FTransmitter::FStream::AddDroppedFrame()
+    {
+        if (PipelineStats)
+        {
+            PipelineStats->Add(EPipelineCounter::FramesDropped);
+        }
+    }
+
+    FTransmitter::FStats FTransmitter::FStream::GetStats() const
+    {
+        FStats Stats;
+        Stats.FramesQueued = FramesQueued.load();
+        Stats.FramesSent = FramesSent.load();
+        Stats.DroppedOldest = DroppedOldest.load();
+        Stats.DroppedNonKeyframes = DroppedNonKeyframes.load();
+        Stats.DroppedBlockTimeout = DroppedBlockTimeout.load();
+        Stats.QueueDepth = TransmissionQueue.Num();
+        Stats.NumClients = NumClients.load();
+        Stats.ClientFramesDropped = ClientFramesDropped.load();
+        Stats.SendLatencyP50 = SendLatency.GetPercentileMs(50.0);
+        Stats.SendLatencyP95 = SendLatency.GetPercentileMs(95.0);
+        Stats.SendLatencyP99 = SendLatency.GetPercentileMs(99.0);
+        Stats.SendLatencyMax = SendLatency.GetMaxMs();
+        Stats.ClientsJoinedFromCache = ClientsJoinedFromCache.load();
+        Stats.KeyframesRequested = KeyframesRequested.load();
+        Stats.AudioPacketsSent = AudioPacketsSent.load();
+        Stats.AudioPacketsDropped = AudioPacketsDropped.load();
+        Stats.TimeToFirstPictureP50 = JoinLatency.GetPercentileMs(50.0);
+        Stats.TimeToFirstPictureMax = JoinLatency.GetMaxMs();
+        const double Start = StartTime.load();
+        const double FirstPacket = FirstPacketTime.load();
+        Stats.TimeToFirstPacket = Start >= 0.0 && FirstPacket >= Start ? (FirstPacket - Start) * 1000.0 : -1.0;
+        return Stats;
+    }
+
+    void FTransmitter::FStream::MarkStart(double Time)
+    {
+        FirstPacketTime = -1.0;
+        StartTime = Time;
+    }
+
+    void FTransmitter::MarkFirstPacket(FStream& Stream)
+    {
+        if (Stream.FirstPacketTime.load(std::memory_order_relaxed) >= 0.0)
+        {
+            return;
+        }
+        const double Start = Stream.StartTime.load();
+        const double Now = GetTimeSeconds();
+        Stream.FirstPacketTime = Now;
+        if (Start >= 0.0)
+        {
+            Logf(ELogLevel::Log, "Stream '%s' first packet %.1f ms after start", Stream.StreamId.c_str(), (Now - Start) * 1000.0);
+        }
+    }
+
+    std::vector<FTransmitter::FClientStats> FTransmitter::FStream::GetClientStats() const
+    {
+        std::lock_guard<std::mutex> Lock(ClientStatsLock);
+        return ClientStatsSnapshot;
+    }
+
+    FTransmitter::FLinkStats FTransmitter::FStream::GetLinkStats() const
+    {
+        std::lock_guard<std::mutex> Lock(ClientStatsLock);
+        return LinkStatsSnapshot;
+    }
+
+    void FTransmitter::UpdateSettings(const FSettings& NewSettings)
+    {
+        Settings = NewSettings;
+    }
+
+    bool FTransmitter::StartupSRT()
+    {
+        std::lock_guard<std::mutex> Lock(SRTInitLock);
+        if (SRTUsers++ > 0)
+        {
+            return true;
+        }
+#if WITH_SRT
+        const double StartTime = GetTimeSeconds();
+        if (srt_startup() < 0)
+        {
+            SRTUsers--;
+            Logf(ELogLevel::Error, "Failed to initialize SRT library");
+            return false;
+        }
+        Logf(ELogLevel::Log, "SRT library initialized in %.1f ms", (GetTimeSeconds() - StartTime) * 1000.0);
+#else
+        Logf(ELogLevel::Warning, "SRT library not available - using mock");
+#endif
+        return true;
+    }
+
+    void FTransmitter::ShutdownSRT()
+    {
+        std::lock_guard<std::mutex> Lock(SRTInitLock);
+        if (SRTUsers == 0 || --SRTUsers > 0)
+        {
+            return;
+        }
+#if WITH_SRT
+        srt_cleanup();
+        Logf(ELogLevel::Log, "SRT library shut down");
+#endif
+    }
+
+    bool FTransmitter::InitializeSRT()
+    {
+        // 모듈이 StartupSRT를 잡고 있으면 참조 수만 늘어남 (라이브러리 스레드는 그대로)
+        if (!bHoldsSRT)
+        {
+            bHoldsSRT = StartupSRT();
+        }
+        return bHoldsSRT;
+    }
+
+    bool FTransmitter::IsPrepared() const
+    {
+#if WITH_SRT
+        return ServerSocket != SRT_INVALID_SOCK && HasSameListener(ListenerSettings, Settings);
+#else
+        return false;
+#endif
+    }
+
+    bool FTransmitter::Prepare()
+    {
+        if (bIsTransmitting || IsPrepared())
+        {
+            return true;
+        }
+
+#if WITH_SRT
+        // 미리 열어 둔 뒤 설정이 바뀐 리스너는 닫고 다시
+        if (ServerSocket != SRT_INVALID_SOCK)
+        {
+            CleanupSRT();
+        }
+#endif
+
+        const double StartTime = GetTimeSeconds();
+        if (!InitializeSRT())
+        {
+            Logf(ELogLevel::Error, "[SRT] Failed to initialize SRT library");
+            return false;
+        }
+        if (!ConfigureSocket())
+        {
+            Logf(ELogLevel::Error, "[SRT] Failed to configure socket");
+            CleanupSRT();
+            return false;
+        }
+        ListenerSettings = Settings;
+        Logf(ELogLevel::Log, "SRT listener ready on port %d in %.1f ms", Settings.Port, (GetTimeSeconds() - StartTime) * 1000.0);
+        return true;
+    }
+
+    bool FTransmitter::ConfigureSocket()
+    {
+#if WITH_SRT
+        // 서버 소켓 생성
+        ServerSocket = srt_create_socket();
+        if (ServerSocket == SRT_INVALID_SOCK)
+        {
+            Logf(ELogLevel::Error, "Failed to create SRT socket");
+            return false;
+        }
+
+        // 소켓 옵션 설정
+        srt_setsockopt(ServerSocket, 0, SRTO_LATENCY, &Settings.LatencyTolerance, sizeof(Settings.LatencyTolerance));
+        const int64_t MaxBW = Settings.MaxBW;
+        const int64_t InputBW = Settings.InputBW;
+        srt_setsockopt(ServerSocket, 0, SRTO_MAXBW, &MaxBW, sizeof(MaxBW));
+        srt_setsockopt(ServerSocket, 0, SRTO_INPUTBW, &InputBW, sizeof(InputBW));
+        srt_setsockopt(ServerSocket, 0, SRTO_OHEADBW, &Settings.Overhead, sizeof(Settings.Overhead));
+
+        // 라이브 모드 페이로드 = TS 패킷 7개
+        int PayloadSize = FTSMuxer::PayloadSize;
+        srt_setsockopt(ServerSocket, 0, SRTO_PAYLOADSIZE, &PayloadSize, sizeof(PayloadSize));
+
+        // 바인딩
+        sockaddr_in sa;
+        std::memset(&sa, 0, sizeof sa);
+        sa.sin_family = AF_INET;
+        sa.sin_port = htons((uint16)Settings.Port);
+
+        if (Settings.BindAddress == "0.0.0.0")
+        {
+            sa.sin_addr.s_addr = INADDR_ANY;
+        }
+        else
+        {
+            inet_pton(AF_INET, Settings.BindAddress.c_str(), &sa.sin_addr);
+        }
+
+        if (srt_bind(ServerSocket, (sockaddr*)&sa, sizeof sa) == SRT_ERROR)
+        {
+            Logf(ELogLevel::Error, "Failed to bind SRT socket to port %d: %s", Settings.Port, srt_getlasterror_str());
+            return false;
+        }
+
+        // 리스닝 시작 - MaxClients는 스트림마다라 대기열은 여러 카메라가 동시에 붙어도 넉넉하게
+        if (srt_listen(ServerSocket, std::max(ListenBacklog, Settings.MaxClients)) == SRT_ERROR)
+        {
+            Logf(ELogLevel::Error, "Failed to start listening");
+            return false;
+        }
+
+        // 리스너는 epoll로 감시하므로 accept는 논블로킹
+        bool bBlocking = false;
+        srt_setsockopt(ServerSocket, 0, SRTO_RCVSYN, &bBlocking, sizeof(bBlocking));
+
+        EpollId = srt_epoll_create();
+        const int ListenEvents = SRT_EPOLL_IN | SRT_EPOLL_ERR;
+        if (EpollId < 0 || srt_epoll_add_usock(EpollId, ServerSocket, &ListenEvents) == SRT_ERROR)
+        {
+            Logf(ELogLevel::Error, "Failed to create SRT epoll: %s", srt_getlasterror_str());
+            return false;
+        }
+
+        Logf(ELogLevel::Log, "SRT socket configured successfully");
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#if WITH_SRT
+    void FTransmitter::HandleSocketEvents(const SRT_EPOLL_EVENT* Events, int32 NumEvents)
+    {
+        for (int32 Index = 0; Index < NumEvents; ++Index)
+        {
+            const SRT_EPOLL_EVENT& Event = Events[Index];
+            if (Event.fd == ServerSocket)
+            {
+                if (Event.events & SRT_EPOLL_ERR)
+                {
+                    Logf(ELogLevel::Error, "SRT listener error on port %d", Settings.Port);
+                    if (OnError)
+                    {
+                        OnError("SRT listener error");
+                    }
+                    bShouldStop = true;
+                    return;
+                }
+                while (AcceptClient())
+                {
+                }
+                continue;
+            }
+
+            FClient* Client = nullptr;
+            for (const std::shared_ptr<FStream>& Stream : ActiveStreams)
+            {
+                for (std::unique_ptr<FClient>& Candidate : Stream->Clients)
+                {
+                    if (Candidate->Socket == Event.fd)
+                    {
+                        Client = Candidate.get();
+                        break;
+                    }
+                }
+                if (Client)
+                {
+                    break;
+                }
+            }
+            if (!Client)
+            {
+                continue;
+            }
+
+            if (Event.events & SRT_EPOLL_ERR)
+            {
+                Logf(ELogLevel::Log, "Client %s disconnected", Client->Address.c_str());
+                Client->bDisconnect = true;
+            }
+            else if (Event.events & SRT_EPOLL_OUT)
+            {
+                // 송신 버퍼에 자리가 났으니 다시 끊김만 감시
+                const int ClientEvents = SRT_EPOLL_ERR;
+                srt_epoll_update_usock(EpollId, Client->Socket, &ClientEvents);
+                Client->bWaitingWritable = false;
+            }
+        }
+    }
+#endif
+
+    bool FTransmitter::AcceptClient()
+    {
+#if WITH_SRT
+        sockaddr_in clientAddr;
+        int addrLen = sizeof(clientAddr);
+
+        SRTSOCKET NewSocket = srt_accept(ServerSocket, (sockaddr*)&clientAddr, &addrLen);
+        if (NewSocket == SRT_INVALID_SOCK)
+        {
+            return false;
+        }
+
+        char clientIP[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
+        char AddressBuffer[INET_ADDRSTRLEN + 8];
+        std::snprintf(AddressBuffer, sizeof(AddressBuffer), "%s:%d", clientIP, ntohs(clientAddr.sin_port));
+        const std::string Address = AddressBuffer;
+
+        // 호출자가 요청한 스트림 (srt://host:port?streamid=...)
+        char StreamIdBuffer[513];
+        int StreamIdLength = (int)sizeof(StreamIdBuffer) - 1;
+        std::string CallerStreamId;
+        if (srt_getsockflag(NewSocket, SRTO_STREAMID, StreamIdBuffer, &StreamIdLength) != SRT_ERROR && StreamIdLength > 0)
+        {
+            CallerStreamId = ParseStreamId(std::string(StreamIdBuffer, StreamIdLength));
+        }
+
+        FStream* Stream = FindStream(CallerStreamId);
+        if (!Stream)
+        {
+            Logf(ELogLevel::Warning, "Rejecting client %s - no stream '%s' on port %d", Address.c_str(), CallerStreamId.c_str(), Settings.Port);
+            srt_close(NewSocket);
+            return true;
+        }
+
+        if ((int32)Stream->Clients.size() >= Settings.MaxClients)
+        {
+            Logf(ELogLevel::Warning, "Rejecting client %s - stream '%s' already serving %d clients", Address.c_str(),
+                Stream->StreamId.c_str(), (int32)Stream->Clients.size());
+            srt_close(NewSocket);
+            return true;
+        }
+
+        // 한 클라이언트가 느려도 전송 스레드가 막히지 않도록 논블로킹 송신
+        bool bBlocking = false;
+        srt_setsockopt(NewSocket, 0, SRTO_SNDSYN, &bBlocking, sizeof(bBlocking));
+
+        const int ClientEvents = SRT_EPOLL_ERR;
+        srt_epoll_add_usock(EpollId, NewSocket, &ClientEvents);
+
+        std::unique_ptr<FClient> Client = std::make_unique<FClient>();
+        Client->Socket = NewSocket;
+        Client->Address = Address;
+        Client->SocketStartTime = srt_connection_time(NewSocket);
+        // 핸드셰이크가 끝난 시각 - accept는 다음 프레임이 전송 스레드를 깨울 때까지 늦을 수 있음
+        Client->ConnectTime = GetTimeSeconds() - std::max<int64>(srt_time_now() - Client->SocketStartTime, 0) / 1000000.0;
+        PrimeNewClient(*Stream, *Client);
+        const int32 NumCached = Client->CachedFrames;
+        Stream->Clients.push_back(std::move(Client));
+        UpdateNumClients();
+
+        Logf(ELogLevel::Log, "Client connected from %s to stream '%s' (%d connected, %d cached frames)", Address.c_str(),
+            Stream->StreamId.c_str(), (int32)Stream->Clients.size(), NumCached);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    FTransmitter::FStream* FTransmitter::FindStream(const std::string& CallerStreamId) const
+    {
+        // 정확히 일치하는 스트림, 없으면 빈 id로 등록된 스트림(나머지 전부), 호출자가 id 없이 왔고 스트림이 하나뿐이면 그것
+        FStream* CatchAll = nullptr;
+        for (const std::shared_ptr<FStream>& Stream : ActiveStreams)
+        {
+            if (Stream->StreamId == CallerStreamId)
+            {
+                return Stream.get();
+            }
+            if (Stream->StreamId.empty())
+            {
+                CatchAll = Stream.get();
+            }
+        }
+        if (!CatchAll && CallerStreamId.empty() && ActiveStreams.size() == 1)
+        {
+            CatchAll = ActiveStreams.front().get();
+        }
+        return CatchAll;
+    }
+
+    std::string FTransmitter::ParseStreamId(const std::string& RawStreamId)
+    {
+        static const char AccessControlPrefix[] = "#!::";
+        if (RawStreamId.compare(0, sizeof(AccessControlPrefix) - 1, AccessControlPrefix) != 0)
+        {
+            return RawStreamId;
+        }
+
+        std::size_t Start = sizeof(AccessControlPrefix) - 1;
+        while (Start < RawStreamId.size())
+        {
+            std::size_t End = RawStreamId.find(',', Start);
+            if (End == std::string::npos)
+            {
+                End = RawStreamId.size();
+            }
+            if (RawStreamId.compare(Start, 2, "r=") == 0)
+            {
+                return RawStreamId.substr(Start + 2, End - Start - 2);
+            }
+            Start = End + 1;
+        }
+        return std::string();
+    }
+
+    void FTransmitter::DisconnectClient(FClient& Client)
+    {
+#if WITH_SRT
+        if (Client.Socket != SRT_INVALID_SOCK)
+        {
+            if (EpollId >= 0)
+            {
+                srt_epoll_remove_usock(EpollId, Client.Socket);
+            }
+            srt_close(Client.Socket);
+            Client.Socket = SRT_INVALID_SOCK;
+        }
+#endif
+        Client.Queue.clear();
+        Client.CurrentFrame.reset();
+    }
+
+    void FTransmitter::DisconnectAllClients(FStream& Stream)
+    {
+        for (std::unique_ptr<FClient>& Client : Stream.Clients)
+        {
+            Client->bDisconnect = true;
+        }
+        RemoveDisconnectedClients(Stream);
+    }
+
+    void FTransmitter::RemoveDisconnectedClients(FStream& Stream)
+    {
+        std::vector<std::unique_ptr<FClient>>& Clients = Stream.Clients;
+        const std::size_t NumBefore = Clients.size();
+        Clients.erase(std::remove_if(Clients.begin(), Clients.end(), [this](std::unique_ptr<FClient>& Client)
+        {
+            if (!Client->bDisconnect)
+            {
+                return false;
+            }
+            DisconnectClient(*Client);
+            return true;
+        }), Clients.end());
+
+        if (Clients.size() != NumBefore)
+        {
+            UpdateNumClients();
+            UpdateClientStats(Stream, 0.0);
+            if (Clients.empty())
+            {
+                std::lock_guard<std::mutex> Lock(Stream.ClientStatsLock);
+                Stream.LinkStatsSnapshot = FLinkStats();
+            }
+        }
+    }
+
+    void FTransmitter::UpdateNumClients()
+    {
+        int32 Total = 0;
+        for (const std::shared_ptr<FStream>& Stream : ActiveStreams)
+        {
+            Stream->NumClients.store((int32)Stream->Clients.size(), std::memory_order_relaxed);
+            Total += (int32)Stream->Clients.size();
+        }
+        NumClients.store(Total, std::memory_order_relaxed);
+    }
+
+    FTransmitter::FMuxedFrameRef FTransmitter::AcquireMuxedFrame(FStream& Stream)
+    {
+        // 모든 클라이언트가 다 보낸 버퍼는 풀만 참조하고 있으므로 그대로 재사용
+        for (FMuxedFrameRef& Pooled : Stream.MuxedFramePool)
+        {
+            if (Pooled.use_count() == 1)
+            {
+                Pooled->Payloads.clear();
+                Pooled->bComplete = true;
+                Pooled->bAudioOnly = false;
+                return Pooled;
+            }
+        }
+        FMuxedFrameRef NewFrame = std::make_shared<FMuxedFrame>();
+        Stream.MuxedFramePool.push_back(NewFrame);
+        return NewFrame;
+    }
+
+    void FTransmitter::FanOutFrame(FStream& Stream, const FEncodedFrameRef& Frame)
+    {
+        FMuxedFrameRef Muxed = AcquireMuxedFrame(Stream);
+        Muxed->bKeyframe = Frame->bKeyframe;
+        Muxed->CaptureTime = Frame->CaptureTime;
+        Muxed->SubmitTime = Frame->SubmitTime;
+
+        // 먹서가 188바이트 TS 패킷 7개(1316바이트)를 채울 때마다 버퍼에 이어 붙임
+        const double MuxStartTime = GetTimeSeconds();
+        auto AppendPayload = [&Muxed](const uint8* Payload, int32 PayloadSize)
+        {
+            Muxed->Payloads.insert(Muxed->Payloads.end(), Payload, Payload + PayloadSize);
+            return true;
+        };
+
+        // 오디오 PTS는 비디오와 같은 원점에서 - 인코더가 다시 시작해 원점이 바뀌어도 다음 프레임부터 따라감
+        Stream.PtsOriginTime = Frame->CaptureTime - Frame->Pts / 90000.0;
+
+        // 이 프레임보다 먼저 캡처된 오디오는 PSI 뒤, 프레임 데이터 앞에 - 남는 TS 패킷은 프레임과 같은 페이로드로 나감
+        if (Frame->Partial)
+        {
+            // 인코더가 아직 쓰는 중: PES 헤더만 먹싱하고 큐에 넣은 뒤, 슬라이스는 들어오는 대로 ContinueOpenFrame이 이어 붙임
+            Muxed->bComplete = false;
+            Stream.Muxer.BeginFrame(*Frame, AppendPayload);
+            MuxPendingAudio(Stream, Frame->CaptureTime, AppendPayload);
+            Stream.OpenFrame = Frame;
+            Stream.OpenMuxed = Muxed;
+            Stream.OpenOffset = 0;
+            Stream.OpenMuxSeconds = GetTimeSeconds() - MuxStartTime;
+            Frame->Partial->SetWakeup([this] { FrameReadyEvent.Trigger(); });
+        }
+        else
+        {
+            if (Frame->Data.empty())
+            {
+                return;
+            }
+            Stream.Muxer.BeginFrame(*Frame, AppendPayload);
+            MuxPendingAudio(Stream, Frame->CaptureTime, AppendPayload);
+            Stream.Muxer.WriteFrameData(Frame->Data.data(), (int32)Frame->Data.size(), AppendPayload);
+            Stream.Muxer.EndFrame(AppendPayload);
+        }
+
+        const double Now = GetTimeSeconds();
+        Muxed->MuxedTime = Now;
+        Stream.LastPcrTime = Now;
+        if (Muxed->bKeyframe)
+        {
+            Stream.bKeyframeRequested = false;
+        }
+        UpdateJoinCache(Stream, Muxed);
+        Stream.OpenCachedBytes = (int64)Muxed->Payloads.size();
+        if (Stream.Clients.empty())
+        {
+            return;
+        }
+
+        for (std::unique_ptr<FClient>& Client : Stream.Clients)
+        {
+            if (!Client->bDisconnect)
+            {
+                EnqueueForClient(Stream, *Client, Muxed, Now);
+            }
+        }
+        if (Muxed->bComplete)
+        {
+            if (Stream.PipelineStats)
+            {
+                Stream.PipelineStats->Record(EPipelineStage::Mux, Now - MuxStartTime);
+                Stream.PipelineStats->Add(EPipelineCounter::FramesSent);
+            }
+            Stream.FramesSent++;
+        }
+    }
+
+    bool FTransmitter::ContinueOpenFrame(FStream& Stream)
+    {
+        if (!Stream.OpenFrame)
+        {
+            return true;
+        }
+
+        FMuxedFrameRef& Muxed = Stream.OpenMuxed;
+        auto AppendPayload = [&Muxed](const uint8* Payload, int32 PayloadSize)
+        {
+            Muxed->Payloads.insert(Muxed->Payloads.end(), Payload, Payload + PayloadSize);
+            return true;
+        };
+
+        const double MuxStartTime = GetTimeSeconds();
+        bool bFinished = false;
+        bool bSucceeded = false;
+        Stream.OpenOffset = Stream.OpenFrame->Partial->Read(Stream.OpenOffset, [&Stream, &AppendPayload](const uint8* Data, int32 Size)
+        {
+            Stream.Muxer.WriteFrameData(Data, Size, AppendPayload);
+        }, bFinished, bSucceeded);
+        if (!bFinished)
+        {
+            Stream.OpenMuxSeconds += GetTimeSeconds() - MuxStartTime;
+            return false;
+        }
+
+        // 실패한 프레임도 이미 일부가 나갔으므로 TS는 끝맺음 (수신측 디코더가 그 그림 하나를 버림)
+        Stream.Muxer.EndFrame(AppendPayload);
+        if (!bSucceeded)
+        {
+            Logf(ELogLevel::Warning, "Stream '%s': frame failed to encode after %d bytes were streamed", Stream.StreamId.c_str(), Stream.OpenOffset);
+        }
+        const double Now = GetTimeSeconds();
+        Muxed->bComplete = true;
+        Muxed->MuxedTime = Now;
+
+        // 접속 캐시에 들어간 뒤에 늘어난 만큼 한도 다시 확인
+        if (!Stream.JoinCache.empty() && Stream.JoinCache.back() == Muxed)
+        {
+            Stream.JoinCacheBytes += (int64)Muxed->Payloads.size() - Stream.OpenCachedBytes;
+            if (Stream.JoinCacheBytes > Settings.JoinCacheMaxBytes)
+            {
+                Stream.JoinCache.clear();
+                Stream.JoinCacheBytes = 0;
+                Stream.bJoinCacheOverflow = true;
+            }
+        }
+        if (!Stream.Clients.empty())
+        {
+            if (Stream.PipelineStats)
+            {
+                Stream.PipelineStats->Record(EPipelineStage::Mux, Stream.OpenMuxSeconds + Now - MuxStartTime);
+                Stream.PipelineStats->Add(EPipelineCounter::FramesSent);
+            }
+            Stream.FramesSent++;
+        }
+        AbandonOpenFrame(Stream);
+        return true;
+    }
+
+    void FTransmitter::AbandonOpenFrame(FStream& Stream)
+    {
+        if (Stream.OpenFrame)
+        {
+            Stream.OpenFrame->Partial->SetWakeup(nullptr);
+        }
+        Stream.OpenFrame.reset();
+        Stream.OpenMuxed.reset();
+        Stream.OpenOffset = 0;
+        Stream.OpenMuxSeconds = 0.0;
+    }
+
+    void FTransmitter::MuxPendingAudio(FStream& Stream, double UpToTime, FTSMuxer::FPayloadSink Sink)
+    {
+        while (!Stream.PendingAudio.empty() && Stream.PendingAudio.front()->CaptureTime <= UpToTime)
+        {
+            FEncodedAudio& Audio = *Stream.PendingAudio.front();
+            if (Stream.PtsOriginTime >= 0.0 && Audio.CaptureTime >= Stream.PtsOriginTime)
+            {
+                Audio.Pts = (int64)std::llround((Audio.CaptureTime - Stream.PtsOriginTime) * 90000.0);
+                Stream.Muxer.MuxAudio(Audio, Sink);
+                Stream.AudioPacketsSent++;
+            }
+            else
+            {
+                // 첫 그림보다 먼저 캡처된 소리 - 맞춰 재생할 비디오가 없음
+                Stream.AudioPacketsDropped++;
+            }
+            Stream.PendingAudio.pop_front();
+        }
+    }
+
+    void FTransmitter::FanOutAudio(FStream& Stream, double Now)
+    {
+        // 인코딩 중인 프레임이 있으면 먹서가 그 프레임 한가운데 - 그 프레임이 끝나고 다음 프레임과 같이
+        if (Stream.PendingAudio.empty() || Stream.OpenFrame
+            || (Now - Stream.PendingAudio.front()->SubmitTime) * 1000.0 < AudioHoldMs)
+        {
+            return;
+        }
+
+        // 비디오가 멈췄거나(정지 화면 Skip) 인코딩이 오래 걸림: 기다린 오디오는 혼자 나감
+        FMuxedFrameRef Muxed = AcquireMuxedFrame(Stream);
+        Muxed->bAudioOnly = true;
+        Muxed->CaptureTime = Stream.PendingAudio.front()->CaptureTime;
+        Muxed->SubmitTime = Stream.PendingAudio.front()->SubmitTime;
+        auto AppendPayload = [&Muxed](const uint8* Payload, int32 PayloadSize)
+        {
+            Muxed->Payloads.insert(Muxed->Payloads.end(), Payload, Payload + PayloadSize);
+            return true;
+        };
+        MuxPendingAudio(Stream, Now, AppendPayload);
+        Stream.Muxer.Flush(AppendPayload);
+        if (Muxed->Payloads.empty())
+        {
+            return;
+        }
+
+        Muxed->MuxedTime = GetTimeSeconds();
+        UpdateJoinCache(Stream, Muxed);
+        for (std::unique_ptr<FClient>& Client : Stream.Clients)
+        {
+            if (!Client->bDisconnect)
+            {
+                EnqueueForClient(Stream, *Client, Muxed, Now);
+            }
+        }
+    }
+
+    void FTransmitter::FanOutPcr(FStream& Stream, double Now)
+    {
+        // 인코딩 중인 프레임이 있으면 먹서가 그 프레임 한가운데 - 그 프레임의 패킷이 끝나야 PCR을 끼울 수 있음
+        const int64 LastPcr = Stream.Muxer.GetLastPcr();
+        if (Stream.OpenFrame || Stream.LastPcrTime < 0.0 || LastPcr < 0
+            || (Now - Stream.LastPcrTime) * 1000.0 + PcrPollMs < FTSMuxer::PcrInterval / 90.0)
+        {
+            return;
+        }
+
+        // 마지막 PCR에서 흘러간 시간만큼 - 다음 프레임의 PCR(캡처 시각)보다 앞서면 먹서가 그 프레임의 PCR을 당겨 맞춤.
+        // 캡처 시각으로 환산한 값을 소스 시간으로 달아 수신측 TSBPD도 프레임과 같은 지연에 내보냄. 접속 캐시에는 넣지 않음
+        const int64 Pcr = LastPcr + (int64)((Now - Stream.LastPcrTime) * 90000.0);
+        FMuxedFrameRef Muxed = AcquireMuxedFrame(Stream);
+        Muxed->bAudioOnly = true;
+        Muxed->CaptureTime = Stream.PtsOriginTime + Pcr / 90000.0;
+        Muxed->SubmitTime = Now;
+        auto AppendPayload = [&Muxed](const uint8* Payload, int32 PayloadSize)
+        {
+            Muxed->Payloads.insert(Muxed->Payloads.end(), Payload, Payload + PayloadSize);
+            return true;
+        };
+        Stream.Muxer.WritePcr(Pcr, AppendPayload);
+        Stream.Muxer.Flush(AppendPayload);
+        Stream.LastPcrTime = Now;
+        if (Muxed->Payloads.empty())
+        {
+            return;
+        }
+
+        // 밀린 클라이언트는 큐의 다음 프레임이 PCR을 가져가므로 건너뜀 - 큐 한도를 PCR 패킷이 먹지 않도록
+        Muxed->MuxedTime = Now;
+        for (std::unique_ptr<FClient>& Client : Stream.Clients)
+        {
+            if (!Client->bDisconnect && Client->Queue.empty())
+            {
+                EnqueueForClient(Stream, *Client, Muxed, Now);
+            }
+        }
+    }
+
+    void FTransmitter::UpdateJoinCache(FStream& Stream, const FMuxedFrameRef& Frame)
+    {
+        const int64 MaxBytes = Settings.JoinCacheMaxBytes;
+        if (Frame->bKeyframe || MaxBytes <= 0)
+        {
+            // 새 GOP 시작 - 이전 GOP는 새 클라이언트에 필요 없음 (버퍼는 아무도 안 쓰면 풀로 돌아감)
+            Stream.JoinCache.clear();
+            Stream.JoinCacheBytes = 0;
+            Stream.bJoinCacheOverflow = false;
+            if (MaxBytes <= 0)
+            {
+                return;
+            }
+        }
+        else if (Stream.JoinCache.empty() || Stream.bJoinCacheOverflow)
+        {
+            return; // 시작할 키프레임이 없음
+        }
+
+        const int64 FrameBytes = (int64)Frame->Payloads.size();
+        if (Stream.JoinCacheBytes + FrameBytes > MaxBytes)
+        {
+            // GOP가 한도보다 김 - 반쪽 GOP는 디코딩할 수 없으므로 다음 키프레임까지 비워 둠
+            Stream.JoinCache.clear();
+            Stream.JoinCacheBytes = 0;
+            Stream.bJoinCacheOverflow = true;
+            return;
+        }
+        Stream.JoinCache.push_back(Frame);
+        Stream.JoinCacheBytes += FrameBytes;
+    }
+
+    void FTransmitter::PrimeNewClient(FStream& Stream, FClient& Client)
+    {
+        if (!Stream.JoinCache.empty())
+        {
+            // 캐시된 GOP를 라이브 프레임보다 먼저 - 다음 키프레임을 기다리지 않고 바로 디코딩 시작
+            Client.Queue.assign(Stream.JoinCache.begin(), Stream.JoinCache.end());
+            Client.CachedFrames = (int32)Client.Queue.size();
+            Client.bWaitForKeyframe = false;
+            Stream.ClientsJoinedFromCache++;
+            return;
+        }
+
+        if (Settings.bKeyframeOnJoin && Stream.OnKeyframeRequest && !Stream.bKeyframeRequested)
+        {
+            Stream.bKeyframeRequested = true;
+            Stream.KeyframesRequested++;
+            Stream.OnKeyframeRequest();
+        }
+    }
+
+    void FTransmitter::EnqueueForClient(FStream& Stream, FClient& Client, const FMuxedFrameRef& Frame, double Now)
+    {
+        // 키프레임 없이 P 프레임만 보내면 디코딩 불가
+        if (Client.bWaitForKeyframe)
+        {
+            if (!Frame->bKeyframe)
+            {
+                return;
+            }
+            Client.bWaitForKeyframe = false;
+        }
+
+        if ((int32)Client.Queue.size() - Client.CachedFrames >= Settings.ClientQueueCapacity)
+        {
+            // 느린 클라이언트: 백로그를 비우고 다음 키프레임부터 다시 시작 (다른 클라이언트는 영향 없음)
+            const int32 NumDropped = (int32)Client.Queue.size() + (Client.CurrentFrame ? 1 : 0);
+            Client.Queue.clear();
+            Client.CachedFrames = 0;
+            Client.CurrentFrame.reset();
+            Client.CurrentOffset = 0;
+            Client.bSendingCached = false;
+            Client.FramesDropped += NumDropped;
+            Stream.ClientFramesDropped += NumDropped;
+            if (Client.LaggingSince == 0.0)
+            {
+                Client.LaggingSince = Now;
+            }
+
+            if (!Frame->bKeyframe)
+            {
+                Client.bWaitForKeyframe = true;
+                Client.FramesDropped++;
+                Stream.ClientFramesDropped++;
+                return;
+            }
+        }
+
+        Client.Queue.push_back(Frame);
+    }
+
+    void FTransmitter::FlushClient(FStream& Stream, FClient& Client)
+    {
+#if WITH_SRT
+        while (!Client.bDisconnect)
+        {
+            if (!Client.CurrentFrame)
+            {
+                if (Client.Queue.empty())
+                {
+                    // 백로그를 모두 보냄 - 따라잡음
+                    Client.LaggingSince = 0.0;
+                    return;
+                }
+                Client.CurrentFrame = std::move(Client.Queue.front());
+                Client.Queue.pop_front();
+                Client.CurrentOffset = 0;
+                Client.bSendingCached = Client.CachedFrames > 0;
+                if (Client.bSendingCached)
+                {
+                    Client.CachedFrames--;
+                }
+            }
+
+            // 프레임의 모든 패킷이 같은 캡처 시각을 달고 나감 - 인코딩/큐 지터가 수신측 재생 시점에 섞이지 않음.
+            // 접속 캐시 프레임도 캡처 시각으로 - 다만 지연 허용치의 절반보다 오래된 것은 그만큼으로 당겨서 몰아 보내는 동안
+            // 수신측에서 늦은 패킷이 되지 않게. 클라이언트마다 뒤로 가지 않음 (캐시 -> 라이브, 프레임 사이 PCR의 추정 시각)
+            int64 SourceTime = GetSourceTime(Client, Client.CurrentFrame->CaptureTime);
+            if (SourceTime == 0)
+            {
+                SourceTime = srt_time_now();
+            }
+            else if (Client.bSendingCached)
+            {
+                SourceTime = std::max(SourceTime, srt_time_now() - (int64)Settings.LatencyTolerance * 1000 / 2);
+            }
+            SourceTime = std::max(SourceTime, Client.LastSourceTime);
+            Client.LastSourceTime = SourceTime;
+            SRT_MSGCTRL MsgCtrl = srt_msgctrl_default;
+            MsgCtrl.srctime = SourceTime;
+
+            const std::vector<uint8>& Payloads = Client.CurrentFrame->Payloads;
+            while (Client.CurrentOffset < (int32)Payloads.size())
+            {
+                const int32 Size = std::min(FTSMuxer::PayloadSize, (int32)Payloads.size() - Client.CurrentOffset);
+                const int Result = srt_sendmsg2(Client.Socket, reinterpret_cast<const char*>(Payloads.data() + Client.CurrentOffset), Size, &MsgCtrl);
+                if (Result == SRT_ERROR)
+                {
+                    if (srt_getlasterror(nullptr) == SRT_EASYNCSND)
+                    {
+                        // 송신 버퍼가 참 - 쓰기 가능해지면 이어서 전송
+                        const int ClientEvents = SRT_EPOLL_OUT | SRT_EPOLL_ERR;
+                        srt_epoll_update_usock(EpollId, Client.Socket, &ClientEvents);
+                        Client.bWaitingWritable = true;
+                        return;
+                    }
+
+                    Logf(ELogLevel::Warning, "Failed to send to %s: %s", Client.Address.c_str(), srt_getlasterror_str());
+                    Client.bDisconnect = true;
+                    return;
+                }
+                Client.CurrentOffset += Size;
+                Client.BytesSent += Size;
+                Client.WindowBytes += Size;
+            }
+            if (!Client.CurrentFrame->bComplete)
+            {
+                // 인코딩 중인 프레임을 따라잡음 - 다음 슬라이스가 먹싱되면 이어서
+                Client.LaggingSince = 0.0;
+                return;
+            }
+
+            Client.FramesSent += Client.CurrentFrame->bAudioOnly ? 0 : 1;
+            const double SentTime = GetTimeSeconds();
+            if (Client.TimeToFirstPicture < 0.0 && Client.CurrentFrame->bKeyframe)
+            {
+                Client.TimeToFirstPicture = SentTime - Client.ConnectTime;
+                Stream.JoinLatency.Record(Client.TimeToFirstPicture);
+            }
+            if (Client.bSendingCached || Client.CurrentFrame->bAudioOnly)
+            {
+                // 캐시 프레임의 제출 시각은 접속 전이라 전송 지연 통계에서 뺌 (오디오만 담은 프레임도 프레임 통계 밖)
+                Client.bSendingCached = false;
+                Client.CurrentFrame.reset();
+                continue;
+            }
+            Stream.SendLatency.Record(SentTime - Client.CurrentFrame->SubmitTime);
+            if (Stream.PipelineStats)
+            {
+                Stream.PipelineStats->Record(EPipelineStage::Send, SentTime - Client.CurrentFrame->MuxedTime);
+            }
+            Client.CurrentFrame.reset();
+        }
+#endif
+    }
+
+    int64 FTransmitter::GetSourceTime(const FClient& Client, double CaptureTime)
+    {
+#if WITH_SRT
+        if (CaptureTime <= 0.0)
+        {
+            return 0;
+        }
+
+        // 호스트 시계(GetTimeSeconds)와 SRT 시계는 기준점이 다를 수 있으므로 프레임 나이만 옮겨 씀
+        const int64 AgeUs = (int64)((GetTimeSeconds() - CaptureTime) * 1000000.0);
+        const int64 SourceTime = srt_time_now() - std::max<int64>(AgeUs, 0);
+
+        // 소켓 시작 전 시각은 SRT가 송신을 거부함 (접속 직전에 캡처된 프레임)
+        return std::max(SourceTime, Client.SocketStartTime + 1);
+#else
+        return 0;
+#endif
+    }
+
+    void FTransmitter::UpdateClientStats(FStream& Stream, double ElapsedSeconds)
+    {
+        const double Now = GetTimeSeconds();
+        std::vector<FClientStats> Snapshot;
+        Snapshot.reserve(Stream.Clients.size());
+        for (std::unique_ptr<FClient>& Client : Stream.Clients)
+        {
+            if (ElapsedSeconds > 0.0)
+            {
+                Client->SendRateMbps = Client->WindowBytes * 8.0 / ElapsedSeconds / 1000000.0;
+                Client->WindowBytes = 0;
+            }
+
+            FClientStats Stats;
+            Stats.Address = Client->Address;
+            Stats.SendRateMbps = Client->SendRateMbps;
+            Stats.Backlog = (int32)Client->Queue.size() + (Client->CurrentFrame ? 1 : 0);
+            Stats.FramesSent = Client->FramesSent;
+            Stats.FramesDropped = Client->FramesDropped;
+            Stats.BytesSent = Client->BytesSent;
+            Stats.ConnectedSeconds = Now - Client->ConnectTime;
+            Stats.TimeToFirstPictureMs = Client->TimeToFirstPicture >= 0.0 ? Client->TimeToFirstPicture * 1000.0 : -1.0;
+            Stats.RttMs = Client->RttMs;
+            Stats.BandwidthMbps = Client->BandwidthMbps;
+            Stats.SendBufferMs = Client->SendBufferMs;
+            Stats.PacketsLost = Client->PacketsLost;
+            Stats.PacketsDropped = Client->PacketsDropped;
+            Snapshot.push_back(std::move(Stats));
+        }
+
+        std::lock_guard<std::mutex> Lock(Stream.ClientStatsLock);
+        Stream.ClientStatsSnapshot = std::move(Snapshot);
+    }
+
+    void FTransmitter::SampleLinkStats(FStream& Stream, double ElapsedSeconds)
+    {
+#if WITH_SRT
+        FLinkStats Link;
+        Link.IntervalSeconds = ElapsedSeconds;
+        Link.BandwidthMbps = -1.0;
+        float WorstLossRate = -1.0f;
+        for (std::unique_ptr<FClient>& Client : Stream.Clients)
+        {
+            SRT_TRACEBSTATS Perf;
+            // 구간 카운터는 샘플마다 초기화, 버퍼 크기는 이동 평균 대신 현재값 (빠른 반응)
+            if (Client->bDisconnect || srt_bistats(Client->Socket, &Perf, 1, 1) == SRT_ERROR)
+            {
+                continue;
+            }
+
+            double Bandwidth = Perf.mbpsBandwidth;
+            if (Settings.MaxBW > 0 && Perf.mbpsMaxBW > 0.0)
+            {
+                // 링크 추정치는 MaxBW 제한을 모름 - 제한이 있으면 그게 실제 상한
+                Bandwidth = std::min(Bandwidth, Perf.mbpsMaxBW);
+            }
+            const int32 BufferBytes = Perf.byteSndBuf + Perf.byteAvailSndBuf;
+
+            Client->RttMs = Perf.msRTT;
+            Client->BandwidthMbps = Bandwidth;
+            Client->SendBufferMs = Perf.msSndBuf;
+            Client->PacketsLost += Perf.pktSndLoss;
+            Client->PacketsDropped += Perf.pktSndDrop;
+
+            Link.NumClients++;
+            Link.RttMs = std::max(Link.RttMs, Perf.msRTT);
+            Link.BandwidthMbps = Link.BandwidthMbps < 0.0 ? Bandwidth : std::min(Link.BandwidthMbps, Bandwidth);
+            Link.SendRateMbps = std::max(Link.SendRateMbps, Perf.mbpsSendRate);
+            Link.PacketsDropped += Perf.pktSndDrop;
+            Link.SendBufferMs = std::max(Link.SendBufferMs, Perf.msSndBuf);
+            if (BufferBytes > 0)
+            {
+                Link.SendBufferFill = std::max(Link.SendBufferFill, (float)Perf.byteSndBuf / (float)BufferBytes);
+            }
+
+            const float LossRate = Perf.pktSent > 0 ? (float)Perf.pktSndLoss / (float)Perf.pktSent : 0.0f;
+            if (LossRate > WorstLossRate)
+            {
+                WorstLossRate = LossRate;
+                Link.PacketsSent = Perf.pktSent;
+                Link.PacketsLost = Perf.pktSndLoss;
+            }
+        }
+        Link.BandwidthMbps = std::max(Link.BandwidthMbps, 0.0);
+
+        {
+            std::lock_guard<std::mutex> Lock(Stream.ClientStatsLock);
+            Stream.LinkStatsSnapshot = Link;
+        }
+        if (Stream.OnLinkStats && Link.NumClients > 0)
+        {
+            Stream.OnLinkStats(Link);
+        }
+#else
+        (void)Stream;
+        (void)ElapsedSeconds;
+#endif
+    }
+
+    void FTransmitter::CleanupSRT()
+    {
+#if WITH_SRT
+        for (std::shared_ptr<FStream>& Stream : ActiveStreams)
+        {
+            for (std::unique_ptr<FClient>& Client : Stream->Clients)
+            {
+                DisconnectClient(*Client);
+            }
+            Stream->Clients.clear();
+            Stream->NumClients.store(0, std::memory_order_relaxed);
+            AbandonOpenFrame(*Stream);
+            Stream->JoinCache.clear(); // 다시 시작하면 멈춘 동안의 화면이 아니라 새 키프레임부터
+            Stream->JoinCacheBytes = 0;
+            Stream->bKeyframeRequested = false;
+            std::lock_guard<std::mutex> Lock(Stream->ClientStatsLock);
+            Stream->ClientStatsSnapshot.clear();
+            Stream->LinkStatsSnapshot = FLinkStats();
+        }
+        ActiveStreams.clear();
+        NumClients.store(0, std::memory_order_relaxed);
+
+        if (EpollId >= 0)
+        {
+            srt_epoll_release(EpollId);
+            EpollId = -1;
+        }
+
+        if (ServerSocket != SRT_INVALID_SOCK)
+        {
+            srt_close(ServerSocket);
+            ServerSocket = SRT_INVALID_SOCK;
+        }
+
+        Logf(ELogLevel::Log, "SRT cleanup completed");
+#endif
+
+        if (bHoldsSRT)
+        {
+            bHoldsSRT = false;
+            ShutdownSRT();
+        }
+    }
+}
@@ -0,0 +1,479 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTVideoEncoder.h"
+#include "CineSRTColorConvert.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if WITH_OPENH264
+#include "wels/codec_api.h"
+#endif
+
+#if WITH_LIBJPEGTURBO
+#include <csetjmp>
+#include <cstdio> // jpeglib.h needs FILE
+#include "jpeglib.h"
+#endif
+
+namespace CineSRT
+{
+    std::unique_ptr<IVideoEncoder> CreateVideoEncoder(EEncodingFormat Format, const FVideoEncoderConfig& Config)
+    {
+        switch (Format)
+        {
+            case EEncodingFormat::MJPEG:
+                return std::make_unique<FMJPEGEncoder>(Config);
+            case EEncodingFormat::H264:
+                return std::make_unique<FH264Encoder>(Config);
+            default:
+                return nullptr;
+        }
+    }
+
+    // --- MJPEG 인코더 구현 (libjpeg-turbo) ---
+#if WITH_LIBJPEGTURBO
+    struct FMJPEGCompressor
+    {
+        struct FErrorManager
+        {
+            jpeg_error_mgr Base;
+            std::jmp_buf JumpBuffer;
+            char Message[JMSG_LENGTH_MAX];
+        };
+
+        jpeg_compress_struct Info;
+        FErrorManager Error;
+        jpeg_destination_mgr Destination;
+
+        // Compressed bytes land here first; only the final size is copied into the frame
+        std::unique_ptr<uint8[]> Scratch;
+        std::size_t ScratchSize = 0;
+        std::vector<JSAMPROW> RowPointers;
+    };
+
+    namespace
+    {
+        FMJPEGCompressor* GetCompressor(j_compress_ptr Info)
+        {
+            return static_cast<FMJPEGCompressor*>(Info->client_data);
+        }
+
+        void OnJpegError(j_common_ptr Info)
+        {
+            auto* Error = reinterpret_cast<FMJPEGCompressor::FErrorManager*>(Info->err);
+            (*Info->err->format_message)(Info, Error->Message);
+            std::longjmp(Error->JumpBuffer, 1);
+        }
+
+        void OnJpegMessage(j_common_ptr /*Info*/, int /*Level*/)
+        {
+        }
+
+        void InitDestination(j_compress_ptr Info)
+        {
+            FMJPEGCompressor* Compressor = GetCompressor(Info);
+            Info->dest->next_output_byte = Compressor->Scratch.get();
+            Info->dest->free_in_buffer = Compressor->ScratchSize;
+        }
+
+        boolean GrowDestination(j_compress_ptr Info)
+        {
+            // Only reached when a frame beats the worst-case estimate; keeps the new size for later frames
+            FMJPEGCompressor* Compressor = GetCompressor(Info);
+            const std::size_t OldSize = Compressor->ScratchSize;
+            std::unique_ptr<uint8[]> Grown(new uint8[OldSize * 2]);
+            std::memcpy(Grown.get(), Compressor->Scratch.get(), OldSize);
+            Compressor->Scratch = std::move(Grown);
+            Compressor->ScratchSize = OldSize * 2;
+            Info->dest->next_output_byte = Compressor->Scratch.get() + OldSize;
+            Info->dest->free_in_buffer = OldSize;
+            return TRUE;
+        }
+
+        void TermDestination(j_compress_ptr /*Info*/)
+        {
+        }
+
+        /** Kept free of non-trivial locals: libjpeg reports errors by longjmp-ing back here. */
+        bool CompressBGRA(FMJPEGCompressor& Compressor, int32 Width, int32 Height, int32 Quality, int32 SliceRows,
+            IVideoEncoder::FSliceCallback* OnSlice, std::size_t& OutSize)
+        {
+            jpeg_compress_struct* Info = &Compressor.Info;
+            if (setjmp(Compressor.Error.JumpBuffer))
+            {
+                jpeg_abort_compress(Info);
+                return false;
+            }
+
+            Info->image_width = (JDIMENSION)Width;
+            Info->image_height = (JDIMENSION)Height;
+            Info->input_components = 4;
+            Info->in_color_space = JCS_EXT_BGRA; // libjpeg-turbo의 SIMD BGRA -> YCbCr 변환을 그대로 사용
+            jpeg_set_defaults(Info);              // YCbCr 4:2:0
+            jpeg_set_quality(Info, Quality, TRUE);
+            Info->dct_method = JDCT_IFAST;
+            // 슬라이스마다 리스타트 마커: 구간 경계에서 엔트로피 코더가 비트를 비워서 그때까지의 바이트가 확정됨
+            Info->restart_in_rows = OnSlice ? SliceRows / 16 : 0;
+
+            jpeg_start_compress(Info, TRUE);
+            while (Info->next_scanline < Info->image_height)
+            {
+                const JDIMENSION Rows = Info->image_height - Info->next_scanline;
+                jpeg_write_scanlines(Info, Compressor.RowPointers.data() + Info->next_scanline, OnSlice ? std::min<JDIMENSION>(Rows, (JDIMENSION)SliceRows) : Rows);
+                if (OnSlice && Info->next_scanline < Info->image_height)
+                {
+                    (*OnSlice)(Compressor.Scratch.get(), (int32)(Compressor.ScratchSize - Info->dest->free_in_buffer));
+                }
+            }
+            jpeg_finish_compress(Info);
+
+            OutSize = Compressor.ScratchSize - Info->dest->free_in_buffer;
+            return true;
+        }
+    }
+#else
+    struct FMJPEGCompressor
+    {
+    };
+#endif
+
+    FMJPEGEncoder::FMJPEGEncoder(const FVideoEncoderConfig& InConfig)
+        : Config(InConfig)
+    {
+    }
+
+    FMJPEGEncoder::~FMJPEGEncoder()
+    {
+        Shutdown();
+    }
+
+    bool FMJPEGEncoder::Initialize()
+    {
+#if WITH_LIBJPEGTURBO
+        if (Compressor)
+        {
+            return true;
+        }
+
+        std::unique_ptr<FMJPEGCompressor> NewCompressor = std::make_unique<FMJPEGCompressor>();
+        jpeg_compress_struct& Info = NewCompressor->Info;
+        Info.err = jpeg_std_error(&NewCompressor->Error.Base);
+        NewCompressor->Error.Base.error_exit = OnJpegError;
+        NewCompressor->Error.Base.emit_message = OnJpegMessage;
+        if (setjmp(NewCompressor->Error.JumpBuffer))
+        {
+            Logf(ELogLevel::Error, "Failed to create JPEG compressor: %s", NewCompressor->Error.Message);
+            return false;
+        }
+        jpeg_create_compress(&Info);
+        Info.client_data = NewCompressor.get();
+
+        NewCompressor->Destination.init_destination = InitDestination;
+        NewCompressor->Destination.empty_output_buffer = GrowDestination;
+        NewCompressor->Destination.term_destination = TermDestination;
+        Info.dest = &NewCompressor->Destination;
+
+        // Same worst case as tjBufSize(TJSAMP_420) so the compressor practically never grows the buffer
+        const std::size_t AlignedWidth = ((std::size_t)Config.Width + 15) & ~(std::size_t)15;
+        const std::size_t AlignedHeight = ((std::size_t)Config.Height + 15) & ~(std::size_t)15;
+        NewCompressor->ScratchSize = AlignedWidth * AlignedHeight * 3 / 2 + 2048;
+        NewCompressor->Scratch.reset(new uint8[NewCompressor->ScratchSize]);
+        NewCompressor->RowPointers.resize(Config.Height);
+
+        Compressor = std::move(NewCompressor);
+        return true;
+#else
+        Logf(ELogLevel::Warning, "MJPEG encoder not available in this build (libjpeg-turbo missing)");
+        return false;
+#endif
+    }
+
+    bool FMJPEGEncoder::EncodeFrame(const uint8* BGRA, int32 NumBytes, FEncodedFrame& OutFrame)
+    {
+        std::size_t CompressedSize = 0;
+        if (!Compress(BGRA, NumBytes, nullptr, CompressedSize))
+        {
+            OutFrame.Data.clear();
+            return false;
+        }
+#if WITH_LIBJPEGTURBO
+        // The frame buffer keeps its capacity between uses, so this is a plain copy after warm-up
+        OutFrame.Data.assign(Compressor->Scratch.get(), Compressor->Scratch.get() + CompressedSize);
+#endif
+        OutFrame.bKeyframe = true; // intra-only
+        return !OutFrame.Data.empty();
+    }
+
+    bool FMJPEGEncoder::EncodeFrameSliced(const uint8* BGRA, int32 NumBytes, FEncodedFrame& OutFrame, FSliceCallback OnSlice)
+    {
+        OutFrame.bKeyframe = true; // intra-only, known before the first slice
+        std::size_t CompressedSize = 0;
+        if (!Compress(BGRA, NumBytes, &OnSlice, CompressedSize))
+        {
+            return false;
+        }
+#if WITH_LIBJPEGTURBO
+        OnSlice(Compressor->Scratch.get(), (int32)CompressedSize);
+#endif
+        return CompressedSize > 0;
+    }
+
+    bool FMJPEGEncoder::Compress(const uint8* BGRA, int32 NumBytes, FSliceCallback* OnSlice, std::size_t& OutSize)
+    {
+        if (!BGRA || (int64)NumBytes < (int64)Config.Width * Config.Height * 4) return false;
+#if WITH_LIBJPEGTURBO
+        if (!Compressor) return false;
+
+        const std::size_t RowBytes = (std::size_t)Config.Width * 4;
+        for (int32 Row = 0; Row < Config.Height; ++Row)
+        {
+            Compressor->RowPointers[Row] = const_cast<JSAMPROW>(BGRA + Row * RowBytes);
+        }
+
+        // 4:2:0의 MCU 행(16줄) 단위로만 리스타트 구간을 나눌 수 있음
+        const int32 SliceRows = (std::max(Config.SliceRows, 1) + 15) & ~15;
+        if (!CompressBGRA(*Compressor, Config.Width, Config.Height, Config.JpegQuality, SliceRows, OnSlice, OutSize))
+        {
+            Logf(ELogLevel::Warning, "JPEG compression failed: %s", Compressor->Error.Message);
+            return false;
+        }
+        return true;
+#else
+        (void)OnSlice;
+        (void)OutSize;
+        return false;
+#endif
+    }
+
+    bool FMJPEGEncoder::SetRate(int32 Bitrate, int32 JpegQuality)
+    {
+        // 다음 프레임의 jpeg_set_quality에 그대로 반영됨
+        Config.Bitrate = Bitrate;
+        Config.JpegQuality = std::min(std::max(JpegQuality, 1), 100);
+        return true;
+    }
+
+    void FMJPEGEncoder::Shutdown()
+    {
+#if WITH_LIBJPEGTURBO
+        if (Compressor)
+        {
+            jpeg_destroy_compress(&Compressor->Info);
+            Compressor.reset();
+        }
+#endif
+    }
+
+    // --- H264 인코더 구현 (OpenH264) ---
+#if WITH_OPENH264
+    namespace
+    {
+        EComplexityMode GetComplexityForPreset(const std::string& Preset)
+        {
+            if (Preset == "ultrafast" || Preset == "superfast" || Preset == "veryfast")
+                return LOW_COMPLEXITY;
+            if (Preset == "slow" || Preset == "slower" || Preset == "veryslow")
+                return HIGH_COMPLEXITY;
+            return MEDIUM_COMPLEXITY;
+        }
+    }
+#endif
+
+    FH264Encoder::FH264Encoder(const FVideoEncoderConfig& InConfig) : Config(InConfig) {}
+
+    FH264Encoder::~FH264Encoder()
+    {
+        Shutdown();
+    }
+
+    bool FH264Encoder::Initialize()
+    {
+#if WITH_OPENH264
+        if ((Config.Width % 2) != 0 || (Config.Height % 2) != 0)
+        {
+            Logf(ELogLevel::Error, "H264 encoder requires even dimensions, got %dx%d", Config.Width, Config.Height);
+            return false;
+        }
+
+        ISVCEncoder* SVCEncoder = nullptr;
+        if (WelsCreateSVCEncoder(&SVCEncoder) != 0 || !SVCEncoder)
+        {
+            Logf(ELogLevel::Error, "Failed to create OpenH264 encoder");
+            return false;
+        }
+
+        SEncParamExt Params;
+        SVCEncoder->GetDefaultParams(&Params);
+        Params.iUsageType = CAMERA_VIDEO_REAL_TIME;
+        Params.iPicWidth = Config.Width;
+        Params.iPicHeight = Config.Height;
+        Params.fMaxFrameRate = (float)Config.FPS;
+        Params.iTargetBitrate = Config.Bitrate * 1000;
+        Params.iMaxBitrate = UNSPECIFIED_BIT_RATE;
+        Params.iRCMode = RC_BITRATE_MODE;
+        Params.bEnableFrameSkip = false; // every captured frame must produce an access unit
+        Params.uiIntraPeriod = std::max(Config.KeyframeInterval, 1);
+        Params.eSpsPpsIdStrategy = CONSTANT_ID;
+        Params.bRepeatSps = true;
+        Params.iComplexityMode = GetComplexityForPreset(Config.Preset);
+        Params.iMultipleThreadIdc = std::max(Config.ThreadCount, 1); // 한 프레임을 슬라이스로 나눠 병렬 인코딩
+        Params.iSpatialLayerNum = 1;
+        Params.iTemporalLayerNum = 1;
+
+        SSpatialLayerConfig& Layer = Params.sSpatialLayers[0];
+        Layer.iVideoWidth = Config.Width;
+        Layer.iVideoHeight = Config.Height;
+        Layer.fFrameRate = (float)Config.FPS;
+        Layer.iSpatialBitrate = Params.iTargetBitrate;
+        Layer.iMaxSpatialBitrate = UNSPECIFIED_BIT_RATE;
+        Layer.uiProfileIdc = PRO_BASELINE;
+        Layer.sSliceArgument.uiSliceMode = SM_FIXEDSLCNUM_SLICE;
+        Layer.sSliceArgument.uiSliceNum = Params.iMultipleThreadIdc; // one slice per thread
+
+        // VUI: the converter writes BT.709 limited range; without saying so decoders assume BT.601 or unspecified
+        Layer.bVideoSignalTypeInclude = true;
+        Layer.uiVideoFormat = VF_UNDEF;
+        Layer.bFullRange = false;
+        Layer.bColorDescriptionPresent = true;
+        Layer.uiColorPrimaries = CP_BT709;
+        Layer.uiTransferCharacteristics = TRC_BT709;
+        Layer.uiColorMatrix = CM_BT709;
+
+        if (SVCEncoder->InitializeExt(&Params) != cmResultSuccess)
+        {
+            Logf(ELogLevel::Error, "Failed to initialize OpenH264 encoder (%dx%d @ %d Kbps)", Config.Width, Config.Height, Config.Bitrate);
+            WelsDestroySVCEncoder(SVCEncoder);
+            return false;
+        }
+
+        int DataFormat = videoFormatI420;
+        SVCEncoder->SetOption(ENCODER_OPTION_DATAFORMAT, &DataFormat);
+
+        EncoderHandle = SVCEncoder;
+        PlanarBuffer.resize((std::size_t)Config.Width * Config.Height * 3 / 2);
+        FrameIndex = 0;
+        Logf(ELogLevel::Log, "OpenH264 encoder ready: %dx%d, %d Kbps, GOP %u, preset %s",
+            Config.Width, Config.Height, Config.Bitrate, Params.uiIntraPeriod, Config.Preset.c_str());
+        return true;
+#else
+        Logf(ELogLevel::Warning, "H264 encoder not available in this build (OpenH264 missing)");
+        return false;
+#endif
+    }
+
+    bool FH264Encoder::EncodeFrame(const uint8* BGRA, int32 NumBytes, FEncodedFrame& OutFrame)
+    {
+#if WITH_OPENH264
+        ISVCEncoder* SVCEncoder = static_cast<ISVCEncoder*>(EncoderHandle);
+        const int32 LumaSize = Config.Width * Config.Height;
+        if (!SVCEncoder || !BGRA || NumBytes < LumaSize * 4) return false;
+
+        uint8* PlaneY = PlanarBuffer.data();
+        uint8* PlaneU = PlaneY + LumaSize;
+        uint8* PlaneV = PlaneU + LumaSize / 4;
+        const double ConvertStart = GetTimeSeconds();
+        FColorConverter::ConvertBGRAToI420(BGRA, Config.Width, Config.Height, Config.Width * 4, PlaneY, PlaneU, PlaneV);
+        OutFrame.ConvertSeconds = GetTimeSeconds() - ConvertStart;
+
+        SSourcePicture Picture;
+        std::memset(&Picture, 0, sizeof(Picture));
+        Picture.iColorFormat = videoFormatI420;
+        Picture.iPicWidth = Config.Width;
+        Picture.iPicHeight = Config.Height;
+        Picture.iStride[0] = Config.Width;
+        Picture.iStride[1] = Config.Width / 2;
+        Picture.iStride[2] = Config.Width / 2;
+        Picture.pData[0] = PlaneY;
+        Picture.pData[1] = PlaneU;
+        Picture.pData[2] = PlaneV;
+        // ms 타임스탬프: 캡처 시각이 있으면 실제 간격, 없으면 명목 프레임레이트
+        if (FrameIndex == 0)
+        {
+            FirstCaptureTime = OutFrame.CaptureTime;
+        }
+        Picture.uiTimeStamp = OutFrame.CaptureTime > 0.0
+            ? (long long)((OutFrame.CaptureTime - FirstCaptureTime) * 1000.0)
+            : FrameIndex * 1000 / std::max(Config.FPS, 1);
+        FrameIndex++;
+
+        SFrameBSInfo FrameInfo;
+        std::memset(&FrameInfo, 0, sizeof(FrameInfo));
+        if (SVCEncoder->EncodeFrame(&Picture, &FrameInfo) != cmResultSuccess || FrameInfo.eFrameType == videoFrameTypeSkip)
+        {
+            return false;
+        }
+
+        // Layers are already Annex-B (start-code prefixed); concatenate them into one access unit
+        OutFrame.bKeyframe = FrameInfo.eFrameType == videoFrameTypeIDR;
+        OutFrame.Data.clear();
+        OutFrame.Data.reserve(FrameInfo.iFrameSizeInBytes);
+        for (int32 LayerIndex = 0; LayerIndex < FrameInfo.iLayerNum; ++LayerIndex)
+        {
+            const SLayerBSInfo& LayerInfo = FrameInfo.sLayerInfo[LayerIndex];
+            int32 LayerSize = 0;
+            for (int32 NalIndex = 0; NalIndex < LayerInfo.iNalCount; ++NalIndex)
+            {
+                LayerSize += LayerInfo.pNalLengthInByte[NalIndex];
+            }
+            OutFrame.Data.insert(OutFrame.Data.end(), LayerInfo.pBsBuf, LayerInfo.pBsBuf + LayerSize);
+        }
+        return !OutFrame.Data.empty();
+#else
+        (void)BGRA;
+        (void)NumBytes;
+        (void)OutFrame;
+        return false;
+#endif
+    }
+
+    bool FH264Encoder::SetRate(int32 Bitrate, int32 JpegQuality)
+    {
+        Config.JpegQuality = JpegQuality;
+#if WITH_OPENH264
+        ISVCEncoder* SVCEncoder = static_cast<ISVCEncoder*>(EncoderHandle);
+        if (!SVCEncoder)
+        {
+            return false;
+        }
+
+        // 레이트 컨트롤만 새 목표로 - 인코더 재생성이나 강제 IDR 없음
+        SBitrateInfo BitrateInfo;
+        BitrateInfo.iLayer = SPATIAL_LAYER_ALL;
+        BitrateInfo.iBitrate = std::max(Bitrate, 1) * 1000;
+        if (SVCEncoder->SetOption(ENCODER_OPTION_BITRATE, &BitrateInfo) != cmResultSuccess)
+        {
+            Logf(ELogLevel::Warning, "OpenH264 rejected bitrate %d Kbps", Bitrate);
+            return false;
+        }
+        Config.Bitrate = Bitrate;
+        return true;
+#else
+        Config.Bitrate = Bitrate;
+        return false;
+#endif
+    }
+
+    void FH264Encoder::RequestKeyframe()
+    {
+#if WITH_OPENH264
+        // bRepeatSps라 IDR마다 SPS/PPS가 같이 나감 - 새 수신측이 이 프레임 하나로 디코딩 시작 가능
+        if (ISVCEncoder* SVCEncoder = static_cast<ISVCEncoder*>(EncoderHandle))
+        {
+            SVCEncoder->ForceIntraFrame(true);
+        }
+#endif
+    }
+
+    void FH264Encoder::Shutdown()
+    {
+#if WITH_OPENH264
+        if (ISVCEncoder* SVCEncoder = static_cast<ISVCEncoder*>(EncoderHandle))
+        {
+            SVCEncoder->Uninitialize();
+            WelsDestroySVCEncoder(SVCEncoder);
+        }
+#endif
+        EncoderHandle = nullptr;
+    }
+}
@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+
+#include <memory>
+#include <vector>
+
+namespace CineSRT
+{
+    /** One packet of encoded audio: an SMPTE 302M AES3 packet (header + sample pairs), ready for a private PES. */
+    struct FEncodedAudio
+    {
+        std::vector<uint8> Data;
+        int32 NumFrames = 0;        // samples per channel
+        int32 SampleRate = 48000;
+        double CaptureTime = 0.0;   // GetTimeSeconds() of the first sample, on the same clock as video CaptureTime
+        double SubmitTime = 0.0;    // GetTimeSeconds() when handed to the transmitter
+        int64 Pts = 0;              // 90 kHz, set by the muxer's owner against the video PTS origin
+    };
+
+    /** Encoded audio packets are immutable once produced and shared by reference downstream. */
+    using FEncodedAudioRef = std::shared_ptr<FEncodedAudio>;
+
+    /**
+     * Uncompressed audio for MPEG-TS: interleaved float PCM packed as SMPTE 302M (linear PCM in AES3 subframes,
+     * 48 kHz, 2 to 8 channels, 16/20/24 bit). No codec delay and next to no CPU, at 2.3 Mbps for 24-bit stereo.
+     *
+     * Buffers are stamped on the capture clock: a buffer handed over at Now is taken to end at Now, and the sample
+     * count carries the time forward from there so callback jitter does not reach the PTS. The clock slowly follows
+     * the buffer arrival times to absorb audio device drift, and restarts when they jump (a stall, a device change).
+     * Small buffers are gathered until MinPacketFrames so each PES carries a useful amount of audio.
+     * Call from one thread at a time (the audio render thread).
+     */
+    class CINESRTCORE_API FAudioEncoder
+    {
+    public:
+        static constexpr int32 SampleRate = 48000; // the only rate SMPTE 302M carries
+
+        struct FConfig
+        {
+            int32 NumChannels = 2;          // even, 2-8; extra input channels are dropped, missing ones silent (mono is copied to both)
+            int32 BitsPerSample = 24;       // 16, 20 or 24
+            int32 MinPacketFrames = 480;    // 10 ms: smaller buffers wait for the next one
+            double TimeOffsetSeconds = 0.0; // added to every CaptureTime (lip-sync trim for audio rendered ahead of or behind the picture)
+        };
+
+        /** Receives each finished packet. */
+        using FPacketSink = TCallbackRef<void(FEncodedAudioRef /*Packet*/)>;
+
+        /** Clamps the config to what SMPTE 302M can carry. */
+        explicit FAudioEncoder(const FConfig& InConfig);
+
+        const FConfig& GetConfig() const { return Config; }
+
+        /**
+         * Adds one buffer of interleaved samples that finished rendering at Now. Returns false (and drops the buffer)
+         * when InSampleRate is not 48 kHz.
+         */
+        bool Encode(const float* Samples, int32 NumFrames, int32 InNumChannels, int32 InSampleRate, double Now, FPacketSink Sink);
+
+        /** Forgets the clock and any gathered samples, e.g. when the stream restarts. */
+        void Reset();
+
+        /** Number of times the clock restarted because buffer arrivals jumped away from the sample count. */
+        int32 GetClockResyncs() const { return ClockResyncs; }
+
+    private:
+        FConfig Config;
+        int32 BytesPerFrame = 0; // 한 샘플 시점의 모든 채널 (AES3 서브프레임 쌍 단위)
+        int32 MaxPacketFrames = 0; // PES 길이 필드(16비트)에 들어가는 최대 프레임 수
+
+        // 캡처 시계: 마지막 재동기 시각 + 그 뒤로 받은 샘플 수
+        double ClockOrigin = -1.0;
+        int64 ClockFrames = 0;
+        int32 ClockResyncs = 0;
+        bool bWarnedSampleRate = false;
+
+        // 모으는 중인 패킷 (AES3 헤더는 내보낼 때 채움)
+        FEncodedAudioRef Pending;
+        int32 FramingIndex = 0; // AES3 블록(192 프레임) 안의 위치 - 패킷 사이에도 이어짐
+
+        void PackFrames(const float* Samples, int32 NumFrames, int32 InNumChannels, uint8* Out);
+        void FinishPacket(FPacketSink& Sink);
+    };
+}
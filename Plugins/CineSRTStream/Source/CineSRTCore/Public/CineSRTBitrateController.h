@@ -0,0 +1,79 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+#include "CineSRTTransmitter.h"
+
+#include <vector>
+
+namespace CineSRT
+{
+    /** One step of the adaptive bitrate ladder. */
+    struct FBitrateRung
+    {
+        int32 Bitrate = 8000;    // Kbps (H.264 target; nominal rate of the rung for MJPEG)
+        int32 JpegQuality = 85;  // MJPEG has no rate control, so quality is its bitrate knob
+        int32 Level = -1;        // host-defined resolution/quality step, -1 = keep the current one
+    };
+
+    /**
+     * Closed-loop bitrate controller fed with the transmitter's periodic SRT link samples.
+     * Steps one rung down as soon as the link shows congestion (send buffer backing up towards the
+     * latency window, sender loss, or too-late drops) and one rung up only after the link has stayed
+     * clean for a hold time and the estimated bandwidth has room for the next rung. A step up that
+     * congests the link again doubles the hold time, so a marginal link does not oscillate.
+     * Pure logic with no threads or clock of its own: feed it samples from any single thread.
+     */
+    class CINESRTCORE_API FBitrateController
+    {
+    public:
+        struct FSettings
+        {
+            std::vector<FBitrateRung> Ladder;    // highest rung first
+            int32 StartRung = 0;
+            int32 LatencyMs = 120;               // SRTO_LATENCY: packets older than this are dropped by the sender
+            float DowngradeBufferRatio = 0.5f;   // unacked send buffer span / latency that counts as congestion
+            float DowngradeBufferFill = 0.5f;    // share of the SRT send buffer in use that counts as congestion
+            float DowngradeLossRate = 0.05f;     // lost / sent packets over one sample
+            int32 DowngradeSamples = 2;          // consecutive congested samples before stepping down (drops step at once)
+            double SettleSeconds = 2.0;          // after a change the buffers need time to drain before judging again
+            double UpgradeHoldSeconds = 10.0;    // clean link time before stepping up
+            double MaxUpgradeHoldSeconds = 120.0;
+            float UpgradeHeadroom = 0.8f;        // next rung must fit in this share of the estimated bandwidth
+        };
+
+        explicit FBitrateController(const FSettings& InSettings);
+
+        /** Feeds one link sample taken at Now (seconds). Returns true when the current rung changed. */
+        bool Update(const FTransmitter::FLinkStats& Sample, double Now);
+
+        /** Goes back to the start rung and forgets the link history, e.g. when streaming restarts. */
+        void Reset();
+
+        int32 GetCurrentRungIndex() const { return CurrentRung; }
+        const FBitrateRung& GetCurrentRung() const { return Settings.Ladder[CurrentRung]; }
+        int32 GetNumRungs() const { return (int32)Settings.Ladder.size(); }
+        double GetUpgradeHoldSeconds() const { return UpgradeHold; }
+
+        /** True when the sample alone would count against the current rung. */
+        bool IsCongested(const FTransmitter::FLinkStats& Sample) const;
+
+        /**
+         * Ladder from Top down to roughly a quarter of its bitrate, for hosts without a configured one.
+         * The resolution level is left alone on every rung.
+         */
+        static std::vector<FBitrateRung> MakeDefaultLadder(const FBitrateRung& Top);
+
+    private:
+        FSettings Settings;
+        int32 CurrentRung = 0;
+        int32 CongestedSamples = 0;
+        double CleanSince = -1.0;      // start of the current clean run, -1 = not started
+        double LastChangeTime = -1.0;
+        double LastUpgradeTime = -1.0;
+        double UpgradeHold = 0.0;
+
+        void ChangeRung(int32 NewRung, double Now);
+    };
+}
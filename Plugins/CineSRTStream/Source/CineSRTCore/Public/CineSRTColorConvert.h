@@ -0,0 +1,39 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+
+namespace CineSRT
+{
+    enum class EColorKernel : uint8
+    {
+        Auto,
+        Scalar,
+        SSE41,
+        AVX2
+    };
+
+    /**
+     * BGRA8 -> planar YUV 4:2:0 conversion (BT.709 limited range, 8-bit fixed point).
+     * Writes straight into caller-owned planes so encoders can keep one buffer for their lifetime.
+     * Rows are split into bands and converted in parallel; every kernel is bit-exact with the scalar one.
+     * Width and height must be even. Output planes are tightly packed (Y stride = Width).
+     */
+    class CINESRTCORE_API FColorConverter
+    {
+    public:
+        /** Y plane, then separate U and V planes at half resolution. */
+        static bool ConvertBGRAToI420(const uint8* BGRA, int32 Width, int32 Height, int32 SrcStride,
+            uint8* OutY, uint8* OutU, uint8* OutV, EColorKernel Kernel = EColorKernel::Auto, bool bParallel = true);
+
+        /** Y plane, then one interleaved UV plane at half resolution. */
+        static bool ConvertBGRAToNV12(const uint8* BGRA, int32 Width, int32 Height, int32 SrcStride,
+            uint8* OutY, uint8* OutUV, EColorKernel Kernel = EColorKernel::Auto, bool bParallel = true);
+
+        /** Fastest kernel the running CPU supports. */
+        static EColorKernel GetBestKernel();
+        static bool IsKernelSupported(EColorKernel Kernel);
+        static const char* GetKernelName(EColorKernel Kernel);
+    };
+}
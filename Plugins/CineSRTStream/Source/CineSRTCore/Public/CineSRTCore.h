@@ -0,0 +1,182 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+/**
+ * Engine-independent core of the streaming pipeline (frames, colour conversion, encoders,
+ * MPEG-TS muxing and SRT transmission). Only the C++17 standard library and the codec/SRT
+ * third-party libraries are used here, so the same sources build inside the UE module and in the
+ * standalone CMake benchmark (Plugins/CineSRTStream/Tools/CineSRTBench).
+ *
+ * Engine services the core needs (logging, task parallelism) go through replaceable hooks;
+ * the CineSRTCore UE module routes them to UE_LOG and ParallelFor at startup.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#ifndef CINESRTCORE_API
+#define CINESRTCORE_API
+#endif
+
+#ifndef WITH_SRT
+#define WITH_SRT 0
+#endif
+
+#ifndef WITH_OPENH264
+#define WITH_OPENH264 0
+#endif
+
+#ifndef WITH_LIBJPEGTURBO
+#define WITH_LIBJPEGTURBO 0
+#endif
+
+namespace CineSRT
+{
+    // Same widths as the engine's integer types so code reads the same on both sides
+    using int8 = signed char;
+    using uint8 = unsigned char;
+    using int16 = signed short;
+    using uint16 = unsigned short;
+    using int32 = signed int;
+    using uint32 = unsigned int;
+    using int64 = signed long long;
+    using uint64 = unsigned long long;
+
+    constexpr int32 CacheLineSize = 64;
+
+    // --- Logging ---
+
+    enum class ELogLevel : uint8
+    {
+        Verbose,
+        Log,
+        Warning,
+        Error
+    };
+
+    /** Receives every formatted core log line. The default handler writes to stderr. */
+    using FLogHandler = std::function<void(ELogLevel /*Level*/, const char* /*Message*/)>;
+
+    CINESRTCORE_API void SetLogHandler(FLogHandler Handler);
+
+#if defined(__GNUC__) || defined(__clang__)
+    CINESRTCORE_API void Logf(ELogLevel Level, const char* Format, ...) __attribute__((format(printf, 2, 3)));
+#else
+    CINESRTCORE_API void Logf(ELogLevel Level, const char* Format, ...);
+#endif
+
+    // --- Time ---
+
+    /** Monotonic clock in seconds. Every timestamp the core compares (submit, send, latency) uses it. */
+    inline double GetTimeSeconds()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // --- Threads and tasks ---
+
+    CINESRTCORE_API int32 GetNumberOfCores();
+
+    /** Names the calling thread for debuggers and profilers (best effort). */
+    CINESRTCORE_API void SetCurrentThreadName(const char* Name);
+
+    /** Runs Body(0..Num-1), possibly in parallel, and returns once every index has run. */
+    using FParallelForHandler = std::function<void(int32 /*Num*/, const std::function<void(int32)>& /*Body*/)>;
+
+    /** Replaces the default (one std::thread per index) with the host's task system. */
+    CINESRTCORE_API void SetParallelForHandler(FParallelForHandler Handler);
+
+    CINESRTCORE_API void ParallelFor(int32 Num, const std::function<void(int32)>& Body);
+
+    /** Non-owning reference to a callable, for callbacks that must not allocate (like TFunctionRef). */
+    template<typename FuncType>
+    class TCallbackRef;
+
+    template<typename ReturnType, typename... ArgTypes>
+    class TCallbackRef<ReturnType(ArgTypes...)>
+    {
+    public:
+        template<typename CallableType, typename = std::enable_if_t<!std::is_same<std::decay_t<CallableType>, TCallbackRef>::value>>
+        TCallbackRef(CallableType&& Callable)
+            : Object(const_cast<void*>(static_cast<const void*>(&Callable)))
+            , Invoker([](void* Obj, ArgTypes... Args) -> ReturnType
+            {
+                return (*static_cast<std::remove_reference_t<CallableType>*>(Obj))(std::forward<ArgTypes>(Args)...);
+            })
+        {
+        }
+
+        ReturnType operator()(ArgTypes... Args) const
+        {
+            return Invoker(Object, std::forward<ArgTypes>(Args)...);
+        }
+
+    private:
+        void* Object;
+        ReturnType (*Invoker)(void*, ArgTypes...);
+    };
+
+    /** Waitable flag, the std counterpart of an FEvent from the synch event pool. */
+    class FSyncEvent
+    {
+    public:
+        explicit FSyncEvent(bool bInManualReset = false)
+            : bManualReset(bInManualReset)
+        {
+        }
+
+        void Trigger()
+        {
+            {
+                std::lock_guard<std::mutex> Lock(Mutex);
+                bSignaled = true;
+            }
+            if (bManualReset)
+            {
+                Condition.notify_all();
+            }
+            else
+            {
+                Condition.notify_one();
+            }
+        }
+
+        void Reset()
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            bSignaled = false;
+        }
+
+        /** Returns false on timeout. A negative timeout waits forever. */
+        bool Wait(int32 TimeoutMs = -1)
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            if (TimeoutMs < 0)
+            {
+                Condition.wait(Lock, [this] { return bSignaled; });
+            }
+            else if (!Condition.wait_for(Lock, std::chrono::milliseconds(TimeoutMs), [this] { return bSignaled; }))
+            {
+                return false;
+            }
+            if (!bManualReset)
+            {
+                bSignaled = false;
+            }
+            return true;
+        }
+
+    private:
+        std::mutex Mutex;
+        std::condition_variable Condition;
+        bool bSignaled = false;
+        const bool bManualReset;
+    };
+}
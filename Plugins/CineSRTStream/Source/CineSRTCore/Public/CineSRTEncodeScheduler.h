@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CineSRT
+{
+    class FEncoderPool;
+
+    /**
+     * Fixed set of encode threads shared by the encoder pools of many streams (one pool per camera).
+     * A pool attached with FEncoderPool::SetScheduler starts no threads of its own; its encoder instances
+     * become slots that any scheduler thread runs one frame at a time. Threads visit the pools round-robin,
+     * so a camera with a deep queue cannot starve the others, and the thread count stays the same however
+     * many cameras are streaming.
+     */
+    class CINESRTCORE_API FEncodeScheduler
+    {
+    public:
+        /** NumThreads <= 0 picks one thread per core, minus two for the game and render threads. */
+        explicit FEncodeScheduler(int32 NumThreads = 0);
+        ~FEncodeScheduler();
+
+        FEncodeScheduler(const FEncodeScheduler&) = delete;
+        FEncodeScheduler& operator=(const FEncodeScheduler&) = delete;
+
+        int32 GetNumThreads() const { return (int32)Threads.size(); }
+        int32 GetNumPools() const;
+
+    private:
+        friend class FEncoderPool;
+
+        // 스레드가 풀 안에 있는 동안 RemovePool이 기다릴 수 있도록 호출 수를 셈
+        struct FEntry
+        {
+            FEncoderPool* Pool = nullptr;
+            int32 ActiveCalls = 0; // Mutex 보호
+        };
+
+        mutable std::mutex Mutex;
+        std::condition_variable WorkCondition;
+        std::condition_variable IdleCondition;
+        std::vector<std::shared_ptr<FEntry>> Pools;
+        std::size_t NextPool = 0;  // 다음 스레드가 먼저 볼 풀 (라운드 로빈)
+        uint64 WorkEpoch = 0;      // Notify마다 증가 - 한 바퀴 동안 일이 없던 스레드는 이게 바뀔 때까지 대기
+        bool bShouldStop = false;
+        std::vector<std::thread> Threads;
+
+        void AddPool(FEncoderPool& Pool);
+
+        /** Blocks until no scheduler thread is inside Pool any more. */
+        void RemovePool(FEncoderPool& Pool);
+
+        /** New frames were queued somewhere. */
+        void Notify();
+
+        void Run();
+    };
+}
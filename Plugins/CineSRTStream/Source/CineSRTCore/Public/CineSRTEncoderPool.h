@@ -0,0 +1,318 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+#include "CineSRTFrame.h"
+#include "CineSRTFrameCompare.h"
+#include "CineSRTFrameScaler.h"
+#include "CineSRTLatencyHistogram.h"
+#include "CineSRTPipelineStats.h"
+#include "CineSRTVideoEncoder.h"
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace CineSRT
+{
+    class FEncodeScheduler;
+
+    /** What the encoder pool does with a frame whose picture has not changed since the last one it encoded. */
+    enum class EStaticFramePolicy : uint8
+    {
+        Encode, // encode every frame (detection off)
+        Skip,   // send nothing; receivers hold the last picture
+        Repeat  // re-send the last bitstream with the new timestamp (intra-only codecs; others skip)
+    };
+
+    struct FStaticFrameSettings
+    {
+        EStaticFramePolicy Policy = EStaticFramePolicy::Encode;
+        int32 Tolerance = 0;           // per-byte difference still counted as unchanged (0 = identical pixels)
+        double KeepAliveSeconds = 1.0; // an unchanged picture is still encoded this often, as a refresh for receivers
+    };
+
+    /**
+     * Encodes captured frames on a pool of worker threads.
+     * Intra-only codecs get ThreadCount workers, each with its own encoder instance, encoding whole
+     * frames in parallel; inter codecs keep a single worker and parallelise inside the frame (slices).
+     * A reorder stage releases encoded frames in capture order regardless of which worker finishes first,
+     * either straight into a frame sink on the worker thread or into a bounded output queue for polling.
+     * Reconfigure swaps in a new worker set for new settings without stopping: frames keep their capture
+     * order across the switch, and the old set retires once it has encoded everything routed to it.
+     * With a shared FEncodeScheduler the workers are slots run by the scheduler's threads instead of threads of their own.
+     * With input scaling on, the pool encodes a rendition of a larger capture: each worker resamples the shared frame itself.
+     * With a static-frame policy, SubmitFrame compares each frame with the last one sent to an encoder and skips or
+     * repeats unchanged ones instead of encoding them again.
+     * With missed-slot filling on, a frame that arrives whole frame intervals after the previous one is preceded by
+     * repeats of the previous picture, so receivers see a constant frame rate when the capture loop falls behind.
+     * With slice output (FVideoEncoderConfig::SliceRows on an encoder that supports it) and a sink set, the frame whose
+     * turn it is goes to the sink at its first finished slice, carrying an FPartialBitstream the encoder keeps filling.
+     */
+    class CINESRTCORE_API FEncoderPool
+    {
+    public:
+        struct FStats
+        {
+            int32 FramesEncoded = 0;
+            int32 FramesDropped = 0;
+            float AverageEncodeTime = 0.0f; // seconds per frame on one worker
+            int64 TotalBytesEncoded = 0;
+            int32 WorkerCount = 0;
+            int32 OutputQueueDepth = 0;     // frames waiting for GetEncodedFrame (0 while a sink is set)
+            int32 OutputQueueHighWater = 0; // deepest the output queue has been since Start
+            int32 OutputFramesDropped = 0;  // released frames evicted because nobody drained the queue
+            int32 Reconfigurations = 0;     // worker sets swapped in by Reconfigure since Start
+            int32 StaticFrames = 0;         // unchanged frames skipped or repeated instead of encoded
+            int32 FilledSlots = 0;          // missed output slots filled with a repeat of the previous picture
+            float WarmUpTime = 0.0f;        // seconds the last Start spent on warm-up encodes (see SetWarmUp)
+        };
+
+        /** Receives every encoded frame in capture order, on whichever worker released it. Calls never overlap. */
+        using FEncodedFrameSink = std::function<void(FEncodedFrameRef /*Frame*/)>;
+
+        /** Frames that nobody drains are evicted oldest-first beyond this depth. */
+        static constexpr int32 OutputQueueCapacity = 8;
+
+        FEncoderPool();
+        ~FEncoderPool();
+
+        FEncoderPool(const FEncoderPool&) = delete;
+        FEncoderPool& operator=(const FEncoderPool&) = delete;
+
+        /** Creates the encoders and starts the workers. Fails when the first encoder cannot initialize. */
+        bool Start(EEncodingFormat Format, const FVideoEncoderConfig& InConfig);
+
+        /** Joins the workers and drops every frame still queued or waiting for reordering. */
+        void Stop();
+
+        /**
+         * Switches a running pool to new settings without a restart. The new encoders are created on a
+         * background thread while the current ones keep encoding; when they are ready, frames are routed to
+         * the newest worker set whose size matches theirs. A same-size change therefore switches at once,
+         * and a resolution change switches at the first frame captured at the new size, so the host can keep
+         * capturing at the old size until IsReconfiguring() turns false. The new encoders open with a
+         * keyframe, and the old set encodes what was already routed to it and then shuts down on its own threads.
+         * Falls back to FallbackFormat when Format cannot initialize; if neither can, the current set stays.
+         * Bitrate-only changes do not need this; use SetRate. Returns false when the pool is not running.
+         */
+        bool Reconfigure(EEncodingFormat Format, const FVideoEncoderConfig& InConfig, EEncodingFormat FallbackFormat = EEncodingFormat::None);
+
+        /** True while Reconfigure is still creating the new encoders. */
+        bool IsReconfiguring() const { return bIsBuilding; }
+
+        /** True when a live worker set encodes Width x Height frames; other sizes are dropped on submit (always true with input scaling). */
+        bool CanEncode(int32 Width, int32 Height) const;
+
+        bool IsRunning() const { return bIsRunning; }
+        EEncodingFormat GetFormat() const { return ActiveFormat; }
+
+        /**
+         * Takes a reference to the frame; pixels are not copied. Drops the oldest pending frame when the queue is full.
+         * The frame's CaptureTime (or the submit time when unset) becomes its PTS and SRT source time.
+         */
+        bool SubmitFrame(FRawFrameRef Frame);
+
+        /**
+         * Pushes released frames to Sink instead of the output queue (nullptr restores polling).
+         * Survives Stop/Start, so a restart for new settings keeps feeding the same consumer.
+         */
+        void SetFrameSink(FEncodedFrameSink Sink);
+
+        /**
+         * Retargets every worker's rate control (H.264 bitrate, MJPEG quality) in place.
+         * Thread safe; each worker applies it before its next frame. Start and Reconfigure reset it to their config.
+         */
+        void SetRate(int32 Bitrate, int32 JpegQuality);
+
+        /**
+         * Makes the next frame a worker encodes a keyframe (for a receiver that just joined). Thread safe;
+         * requests made before that frame collapse into one. Intra-only codecs already code every frame on its own.
+         */
+        void RequestKeyframe();
+
+        /**
+         * Records convert and encode times, the encoder's share of the queue wait (carried on each frame
+         * as QueueSeconds) and the encoded/dropped counters into Stats. Call before Start.
+         */
+        void SetPipelineStats(std::shared_ptr<FPipelineStats> InPipelineStats) { PipelineStats = std::move(InPipelineStats); }
+
+        /**
+         * Runs the workers on Scheduler's threads, shared with other pools, instead of one thread per encoder
+         * (nullptr = own threads). Call before Start; the pool detaches from the scheduler in Stop.
+         */
+        void SetScheduler(std::shared_ptr<FEncodeScheduler> InScheduler) { Scheduler = std::move(InScheduler); }
+
+        /**
+         * Scales every frame to the configured size on the worker before encoding instead of dropping frames of
+         * another size, for simulcast renditions fed the same capture as the main stream (FRawFrameRef is shared,
+         * never written). Frames go to the newest worker set whatever their size, so Reconfigure switches at once.
+         * Call before Start.
+         */
+        void SetScaleInput(bool bInScaleInput) { bScaleInput = bInScaleInput; }
+        bool IsScalingInput() const { return bScaleInput; }
+
+        /**
+         * Has every new encoder code one blank frame as soon as it is created (Start and Reconfigure) and fills the
+         * encoded-frame pool, so the first real frames do not pay for lazy codec setup and buffer growth. Inter codecs
+         * are asked for a keyframe afterwards. Call before Start.
+         */
+        void SetWarmUp(bool bInWarmUp) { bWarmUp = bInWarmUp; }
+
+        /**
+         * Static-frame detection: frames that match the last encoded one within Tolerance are skipped or repeated
+         * (see EStaticFramePolicy) until KeepAliveSeconds have passed since that encode. The comparison runs on the
+         * submitting thread and holds a reference to the last encoded frame's buffer. Thread safe; applies from the next frame.
+         */
+        void SetStaticFrameSettings(const FStaticFrameSettings& InSettings);
+
+        /**
+         * For hosts that stamp frames with exact slot times (FFrameCadence): when a frame's CaptureTime is whole multiples of
+         * SlotInterval after the previous frame's, the slots in between are filled with repeats of the previous picture ahead
+         * of it (0 = off). Intra-only codecs only; inter codecs leave the gap and receivers hold the picture.
+         * Gaps over half a second are a stall rather than a late frame and are left as they are. Thread safe.
+         */
+        void SetFillMissedSlots(double InSlotInterval);
+
+        /** Polling path for callers without a sink. */
+        bool GetEncodedFrame(FEncodedFrameRef& OutEncodedFrame);
+
+        FStats GetStats() const;
+
+        /** SubmitFrame -> frame released in order (queueing + encode + reorder wait). */
+        const FLatencyHistogram& GetEncodeLatency() const { return EncodeLatency; }
+
+    private:
+        friend class FEncodeScheduler;
+
+        // 워커 = 스레드 하나(공유 스케줄러가 없을 때) + 전용 인코더 인스턴스
+        class FEncodeWorker;
+
+        // 같은 설정으로 만든 워커 묶음. Reconfigure마다 새로 만들고, 이전 묶음은 받은 프레임을 다 처리하면 퇴역
+        struct FGeneration
+        {
+            FVideoEncoderConfig Config;
+            EEncodingFormat Format = EEncodingFormat::None;
+            std::vector<std::unique_ptr<FEncodeWorker>> Workers;
+            bool bIntraOnly = false;    // 프레임마다 독립이라 이전 비트스트림을 그대로 다시 보낼 수 있음
+            bool bSliceOutput = false;  // 인코더가 슬라이스마다 출력을 내줌 - 차례가 된 프레임은 인코딩 중에 내보냄
+            bool bRetiring = false;     // QueueMutex: 새 프레임을 더 받지 않음
+            int32 RunningWorkers = 0;   // QueueMutex: 루프를 아직 빠져나오지 않은 워커 수 (공유 스케줄러에서는 인코딩 중인 워커 수)
+            double WarmUpSeconds = 0.0; // 만든 직후 예열 인코딩에 쓴 시간 (SetWarmUp)
+        };
+
+        struct FPendingFrame
+        {
+            FRawFrameRef Frame;
+            FGeneration* Generation = nullptr; // 제출 시점에 크기로 정해진 담당 워커 묶음
+            int64 Sequence = 0;
+            double CaptureTime = 0.0;
+            double SubmitTime = 0.0;
+            bool bRepeat = false; // 변화 없는 프레임: 인코딩 없이 순서대로 직전 비트스트림을 다시 보냄 (Frame은 비어 있음)
+        };
+
+        struct FReorderEntry
+        {
+            FEncodedFrameRef Frame; // null when the frame failed or was skipped (a repeat's is filled in on release)
+            double CaptureTime = 0.0;
+            double SubmitTime = 0.0;
+            double EncodeEndTime = 0.0; // 여기부터 내보낼 때까지가 재정렬 대기
+            bool bRepeat = false;
+            bool bSkipped = false; // SkipFrame이 넣은 자리 표시 - 인코딩 없이 버려진 순번
+            bool bStreaming = false; // 인코딩이 끝나기 전에 내보냄 (Frame->Partial). 인코딩 통계는 끝날 때 FinishStreamedFrame에서
+        };
+
+        // 정지 프레임 감지 (StaticMutex 보호, 제출 스레드만 비교) - 기준은 마지막으로 인코더에 보낸 프레임
+        std::mutex StaticMutex;
+        FStaticFrameSettings StaticSettings;
+        FRawFrameRef StaticReference;
+        double StaticReferenceTime = 0.0;
+        std::atomic<bool> bStaticReferenceLost{false}; // 기준 프레임이 버려졌거나 인코딩에 실패함 - 다음 프레임은 인코딩
+
+        std::atomic<EEncodingFormat> ActiveFormat{EEncodingFormat::None};
+        bool bIsRunning = false;
+        std::atomic<bool> bShouldStop{false};
+        bool bScaleInput = false;
+        bool bWarmUp = false;
+
+        // 새 워커 묶음을 만드는 백그라운드 스레드 (Reconfigure 한 번에 하나)
+        std::thread BuildThread;
+        std::atomic<bool> bIsBuilding{false};
+        int32 NextWorkerIndex = 0; // 스레드 이름용
+
+        // 목표 비트레이트(상위 32비트)와 JPEG 품질(하위 32비트) - 워커가 프레임마다 비교해서 바뀌면 적용
+        std::atomic<uint64> PackedRate{0};
+        static uint64 PackRate(int32 Bitrate, int32 JpegQuality) { return ((uint64)(uint32)Bitrate << 32) | (uint32)JpegQuality; }
+
+        // 다음에 인코딩하는 프레임을 키프레임으로 - 먼저 집어 간 워커가 적용
+        std::atomic<bool> bKeyframeRequested{false};
+
+        // 입력 큐 (QueueMutex 보호). 시퀀스 번호는 제출 시점에 붙임 - 워커 묶음이 둘이어도 캡처 순서 유지
+        // 워커는 자기 묶음 몫의 프레임만 꺼내므로 이벤트 대신 조건 변수로 대기
+        std::deque<FPendingFrame> InputQueue;
+        std::vector<std::unique_ptr<FGeneration>> Generations; // 오래된 것부터
+        mutable std::mutex QueueMutex;
+        std::condition_variable QueueCondition;
+        int64 NextInputSequence = 0;
+        double LastSubmitCaptureTime = -1.0; // 빈 슬롯 판정용 직전 프레임 캡처 시각 (정지 프레임으로 건너뛴 것 포함)
+        double FillSlotInterval = 0.0;       // 0 = 빈 슬롯을 채우지 않음
+
+        // 큐가 넘쳐 버린 프레임 로그는 몰아서 (QueueMutex 보호)
+        static constexpr double DropLogIntervalSeconds = 5.0;
+        int32 DropsSinceLog = 0;
+        double LastDropLogTime = -DropLogIntervalSeconds;
+
+        // 싱크 호출 직렬화 (OutputMutex보다 먼저 잡음): 워커가 여럿이어도 캡처 순서대로 한 번에 하나씩 전달
+        std::mutex DeliveryMutex;
+        FEncodedFrameSink FrameSink;
+        std::vector<FEncodedFrameRef> ReadyFrames; // OutputMutex 보호, DeliverReadyFrames가 통째로 가져감
+        // 싱크를 부르지 않는 스레드(SkipFrame)가 풀어 둔 프레임이 있음 - 다음에 깨어나는 워커가 전달 (QueueMutex에서 설정)
+        std::atomic<bool> bDeliveryPending{false};
+
+        // 재정렬 단계 (OutputMutex 보호): 먼저 끝난 워커의 프레임은 앞 순번이 나올 때까지 대기
+        std::map<int64, FReorderEntry> ReorderBuffer;
+        int64 NextOutputSequence = 0;
+        std::deque<FEncodedFrameRef> OutputQueue;
+        std::shared_ptr<FEncodedFramePool> EncodedFramePool;
+        mutable std::mutex OutputMutex;
+        FStats Stats;
+        double PtsOrigin = -1.0; // 첫 프레임의 캡처 시각 = PTS 0 (Start마다 초기화)
+        int64 LastPts = -1;
+        FLatencyHistogram EncodeLatency;
+        FEncodedFrameRef LastReleasedFrame; // 반복 프레임의 원본 (OutputMutex 보호)
+        std::shared_ptr<FPipelineStats> PipelineStats;
+        std::shared_ptr<FEncodeScheduler> Scheduler;
+
+        std::unique_ptr<FGeneration> CreateGeneration(EEncodingFormat Format, const FVideoEncoderConfig& InConfig);
+        bool ActivateGeneration(std::unique_ptr<FGeneration> Generation);
+        double WarmUpGeneration(FGeneration& Generation);
+        FGeneration* FindGeneration(int32 Width, int32 Height) const;
+        void ReapRetiredGenerations();
+        void JoinBuildThread();
+        void WorkerLoop(FEncodeWorker& Worker);
+        void OnWorkerExited(FGeneration& Generation);
+
+        // 공유 스케줄러 스레드에서 호출: 쉬는 워커가 있는 가장 오래된 프레임 하나를 인코딩. 인코딩했으면 true
+        bool RunScheduledFrame();
+        EStaticFramePolicy CheckStaticFrame(const FRawFrameRef& Frame, double CaptureTime);
+        int32 GetSlotsToFill(const FGeneration* Generation, double PreviousCaptureTime, double CaptureTime) const;
+        void EncodePendingFrame(FEncodeWorker& Worker, FPendingFrame& Input);
+        void SkipFrame(int64 Sequence);
+        void CompleteFrame(int64 Sequence, FReorderEntry Entry, double EncodeTime);
+
+        // 슬라이스 스트리밍: 차례가 된 프레임을 첫 슬라이스와 함께 내보냄. 차례가 아니면 false (다음 슬라이스에서 다시 시도)
+        bool StreamFrame(int64 Sequence, FReorderEntry& Entry, const uint8* Bitstream, int32 Size);
+        void FinishStreamedFrame(const FEncodedFrameRef& Frame, bool bSucceeded, double EncodeTime);
+
+        // OutputMutex 안에서: 차례가 된 항목을 싱크 대기(ReadyFrames)나 출력 큐로. DeliverReadyFrames는 DeliveryMutex 안, OutputMutex 밖에서
+        void ReleaseReadyFrames();
+        void RecordEncodeTime(double EncodeTime);
+        void DeliverReadyFrames();
+        // 워커/스케줄러 스레드에서: bDeliveryPending이면 대신 전달. 전달했으면 true
+        bool DeliverPendingFrames();
+    };
+}
@@ -0,0 +1,152 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+
+#include <memory>
+#include <vector>
+
+namespace CineSRT
+{
+    enum class EEncodingFormat : uint8
+    {
+        None,
+        MJPEG,
+        H264,
+        H265
+    };
+
+    /** Raw captured frame (tightly packed BGRA8). Written once by capture, read once by the encoder. */
+    struct FRawFrame
+    {
+        std::vector<uint8> Data;
+        int32 Width = 0;
+        int32 Height = 0;
+        double CaptureTime = 0.0; // GetTimeSeconds() when the scene was captured (or the output slot it stands for); 0 = stamp on submit
+    };
+
+    /** Shared handle to a pooled frame; the buffer goes back to its pool when the last handle is released. */
+    using FRawFrameRef = std::shared_ptr<FRawFrame>;
+
+    /**
+     * Pool of pre-allocated frame buffers. Buffers keep their capacity between uses, so after
+     * warm-up capture and encode run without touching the allocator.
+     * Always owned through a std::shared_ptr; frames outliving the pool are simply freed.
+     */
+    class CINESRTCORE_API FRawFramePool : public std::enable_shared_from_this<FRawFramePool>
+    {
+    public:
+        struct FPoolStats
+        {
+            int32 TotalFrames = 0;
+            int32 FreeFrames = 0;
+            int32 Allocations = 0;
+        };
+
+        ~FRawFramePool();
+
+        /**
+         * Allocates Count buffers of Width x Height up front. bCommit also writes them, so the OS maps their pages now
+         * rather than during the first captures (slow for 4K buffers; use it at load time, not on air).
+         */
+        void Preallocate(int32 Count, int32 Width, int32 Height, bool bCommit = false);
+
+        /** Returns a frame sized for Width x Height. Falls back to a new allocation if the pool is empty. Thread safe. */
+        FRawFrameRef Acquire(int32 Width, int32 Height);
+
+        FPoolStats GetStats() const;
+
+    private:
+        void Release(FRawFrame* Frame);
+
+        mutable std::mutex PoolLock;
+        std::vector<FRawFrame*> FreeList;
+        int32 TotalFrames = 0;
+        int32 Allocations = 0;
+    };
+
+    /**
+     * Progress of a frame released downstream while its encoder is still writing it (slice streaming).
+     * The encoder side publishes the bitstream as it grows, straight into the frame's Data; the consumer
+     * reads what has been published so far from an offset of its own and finishes the frame once Finish
+     * has been called. Data must not be read directly until the frame is finished.
+     */
+    class CINESRTCORE_API FPartialBitstream
+    {
+    public:
+        using FReader = TCallbackRef<void(const uint8* /*Data*/, int32 /*Size*/)>;
+
+        explicit FPartialBitstream(std::vector<uint8>& InData)
+            : Data(InData)
+        {
+        }
+
+        /** Producer: Prefix is the bitstream so far from its first byte; only the bytes not yet published are copied. */
+        void Publish(const uint8* Prefix, int32 Size);
+
+        /** Producer: no more bytes. A failed frame keeps what was published but must not be treated as decodable. */
+        void Finish(bool bSucceeded);
+
+        /**
+         * Consumer: hands Reader the bytes published past Offset and returns the new offset. Reader runs under the
+         * lock the producer publishes with, so it should only copy. bOutFinished is set once everything has been read.
+         */
+        int32 Read(int32 Offset, FReader Reader, bool& bOutFinished, bool& bOutSucceeded);
+
+        /** Blocks until the producer calls Finish; returns whether the frame succeeded. */
+        bool WaitFinished();
+
+        bool IsFinished() const;
+
+        /** Called after every Publish and Finish (under the lock; it must not call back into this object). */
+        void SetWakeup(std::function<void()> InWakeup);
+
+    private:
+        mutable std::mutex Mutex;
+        std::condition_variable FinishedCondition;
+        std::vector<uint8>& Data;
+        std::function<void()> Wakeup;
+        bool bFinished = false;
+        bool bSucceeded = false;
+    };
+
+    // 인코딩된 프레임 (하나의 access unit)
+    struct FEncodedFrame
+    {
+        std::vector<uint8> Data;
+        std::shared_ptr<FPartialBitstream> Partial; // 인코딩이 끝나기 전에 내보낸 프레임만 (슬라이스 스트리밍). 끝나기 전엔 Data 대신 이걸로 읽음
+        EEncodingFormat Format = EEncodingFormat::None;
+        bool bKeyframe = false;
+        int64 Pts = 0; // 90 kHz, derived from CaptureTime
+        double CaptureTime = 0.0; // GetTimeSeconds() at capture; becomes the SRT source time of every packet
+        double SubmitTime = 0.0; // GetTimeSeconds() when handed to the transmitter
+        double ConvertSeconds = 0.0; // colour conversion inside EncodeFrame, set by encoders that convert
+        double QueueSeconds = 0.0; // time spent waiting in the encoder before the transmitter took it
+    };
+
+    /** Encoded frames are immutable once produced and shared by reference downstream. */
+    using FEncodedFrameRef = std::shared_ptr<FEncodedFrame>;
+
+    /**
+     * Recycles encoded frames so encoders write straight into buffers that already have capacity.
+     * Frames return to the pool when the last downstream reference (transmitter, recorder) is dropped.
+     */
+    class CINESRTCORE_API FEncodedFramePool : public std::enable_shared_from_this<FEncodedFramePool>
+    {
+    public:
+        ~FEncodedFramePool();
+
+        /** Returns an empty frame whose Data keeps the capacity of its previous use. Thread safe. */
+        FEncodedFrameRef Acquire();
+
+        /** Makes sure Count free frames exist with at least Bytes of committed capacity each, so the first encodes do not grow their buffers. */
+        void Preallocate(int32 Count, std::size_t Bytes);
+
+    private:
+        void Release(FEncodedFrame* Frame);
+
+        std::mutex PoolLock;
+        std::vector<FEncodedFrame*> FreeList;
+    };
+}
@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+
+namespace CineSRT
+{
+    /**
+     * Output frame clock for a capture loop that runs at someone else's rate (the game frame).
+     * Slots are laid out at exact 1/FrameRate steps of GetTimeSeconds() from Start, independent of when
+     * the host polls. Each poll captures when a slot is due, choosing the poll closest to the slot from
+     * the measured poll period, so a host faster than the frame rate skips the polls between slots and a
+     * slower one reports the slots it missed. Captured frames are stamped with their slot time, so PTS
+     * and SRT source times advance in exact steps whatever the game frame rate; Error is how far the real
+     * capture was from that slot.
+     * Pure logic with no threads or clock of its own: poll it from one thread.
+     */
+    class CINESRTCORE_API FFrameCadence
+    {
+    public:
+        struct FTick
+        {
+            bool bCapture = false; // a slot is due: capture now and stamp the frame with SlotTime
+            double SlotTime = 0.0; // exact time of the slot this capture stands for
+            double Error = 0.0;    // poll time - SlotTime; negative when the poll came just ahead of the slot
+            int32 MissedSlots = 0; // slots since the previous capture that no poll landed on
+        };
+
+        /** Lays the first slot at Now; the first poll captures it. */
+        void Start(double FrameRate, double Now);
+
+        /** Forgets the slot grid; polls capture nothing until the next Start. */
+        void Stop();
+
+        /** New rate from the next slot on. The grid restarts at the last captured slot, so no slot is doubled or lost. */
+        void SetFrameRate(double FrameRate);
+
+        /** Call once per host frame, whether or not it should capture. */
+        FTick Poll(double Now);
+
+        bool IsRunning() const { return Interval > 0.0; }
+        double GetInterval() const { return Interval; }
+
+        /** Smoothed time between polls (the host frame time), 0 before the second poll. */
+        double GetPollPeriod() const { return PollPeriod; }
+
+    private:
+        double Origin = 0.0;
+        double Interval = 0.0;
+        int64 NextSlot = 0;
+        double LastPollTime = -1.0;
+        double PollPeriod = 0.0;
+    };
+}
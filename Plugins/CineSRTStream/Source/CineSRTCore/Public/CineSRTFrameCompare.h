@@ -0,0 +1,30 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+#include "CineSRTColorConvert.h"
+#include "CineSRTFrame.h"
+
+#include <cstddef>
+
+namespace CineSRT
+{
+    /**
+     * Frame difference test for static-frame detection (locked-off cameras, graphics layers).
+     * Compares two buffers byte by byte and stops at the first byte that differs by more than the
+     * tolerance, so a changed picture usually costs a few cache lines and only an unchanged one is read
+     * in full. Every kernel gives the same answer as the scalar one.
+     */
+    class CINESRTCORE_API FFrameCompare
+    {
+    public:
+        /** True when no byte of A differs from the same byte of B by more than Tolerance (0 = identical). */
+        static bool IsWithinTolerance(const uint8* A, const uint8* B, std::size_t Size, int32 Tolerance,
+            EColorKernel Kernel = EColorKernel::Auto);
+
+        /** Same test on two frames; frames of different sizes always differ. */
+        static bool IsWithinTolerance(const FRawFrame& A, const FRawFrame& B, int32 Tolerance,
+            EColorKernel Kernel = EColorKernel::Auto);
+    };
+}
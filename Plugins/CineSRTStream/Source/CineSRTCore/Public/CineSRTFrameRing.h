@@ -0,0 +1,140 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+
+#include <atomic>
+#include <memory>
+
+namespace CineSRT
+{
+    /**
+     * Fixed-capacity lock-free ring of frame handles.
+     *
+     * A Vyukov bounded MPMC queue: each slot carries a sequence number and both ends claim positions
+     * with a compare-exchange, so any thread may push or pop. Callers rely on that - under DropOldest
+     * the transmitter's producer pops the head to evict the oldest frame while the send thread pops too.
+     * Slots are allocated in a power of two for the index mask, but TryPush refuses once the requested
+     * capacity is queued, so a ring made for 5 holds 5.
+     */
+    template<typename ElementType>
+    class TFrameRing
+    {
+    public:
+        explicit TFrameRing(uint32 InCapacity)
+            : Limit(InCapacity < 1 ? 1u : InCapacity)
+            , Capacity(RoundUpToPowerOfTwo(Limit < 2 ? 2u : Limit))
+            , Mask(Capacity - 1)
+            , Cells(new FCell[Capacity])
+        {
+            for (uint32 Index = 0; Index < Capacity; ++Index)
+            {
+                Cells[Index].Sequence.store(Index, std::memory_order_relaxed);
+            }
+        }
+
+        TFrameRing(const TFrameRing&) = delete;
+        TFrameRing& operator=(const TFrameRing&) = delete;
+
+        /** Moves Item into the ring. Returns false (leaving Item untouched) when Max() elements are queued. */
+        bool TryPush(ElementType& Item)
+        {
+            uint64 Position = EnqueuePosition.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                FCell& Cell = Cells[Position & Mask];
+                const uint64 Sequence = Cell.Sequence.load(std::memory_order_acquire);
+                const int64 Diff = (int64)Sequence - (int64)Position;
+                if (Diff == 0)
+                {
+                    // 자리를 잡는 위치마다 한 번만 확인 - 꺼낸 위치는 늘기만 하므로 동시에 넣어도 Limit을 넘지 않음
+                    if ((int64)(Position - DequeuePosition.load(std::memory_order_relaxed)) >= (int64)Limit)
+                    {
+                        return false;
+                    }
+                    if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+                    {
+                        Cell.Value = std::move(Item);
+                        Cell.Sequence.store(Position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (Diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    Position = EnqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** Moves the oldest element out. Returns false when empty. */
+        bool TryPop(ElementType& OutItem)
+        {
+            uint64 Position = DequeuePosition.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                FCell& Cell = Cells[Position & Mask];
+                const uint64 Sequence = Cell.Sequence.load(std::memory_order_acquire);
+                const int64 Diff = (int64)Sequence - (int64)(Position + 1);
+                if (Diff == 0)
+                {
+                    if (DequeuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+                    {
+                        OutItem = std::move(Cell.Value);
+                        Cell.Value = ElementType();
+                        Cell.Sequence.store(Position + Capacity, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (Diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    Position = DequeuePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** Approximate number of queued elements. */
+        int32 Num() const
+        {
+            const uint64 Enqueued = EnqueuePosition.load(std::memory_order_relaxed);
+            const uint64 Dequeued = DequeuePosition.load(std::memory_order_relaxed);
+            return Enqueued > Dequeued ? (int32)(Enqueued - Dequeued) : 0;
+        }
+
+        /** The capacity asked for (the slot count may be larger). */
+        int32 Max() const { return (int32)Limit; }
+
+    private:
+        static uint32 RoundUpToPowerOfTwo(uint32 Value)
+        {
+            uint32 Result = 1;
+            while (Result < Value)
+            {
+                Result <<= 1;
+            }
+            return Result;
+        }
+
+        struct FCell
+        {
+            std::atomic<uint64> Sequence;
+            ElementType Value;
+        };
+
+        const uint32 Limit;    // 요청한 용량 - TryPush가 지킴
+        const uint32 Capacity; // 슬롯 수 (2의 거듭제곱)
+        const uint32 Mask;
+        std::unique_ptr<FCell[]> Cells;
+
+        alignas(CacheLineSize) std::atomic<uint64> EnqueuePosition{0};
+        alignas(CacheLineSize) std::atomic<uint64> DequeuePosition{0};
+    };
+}
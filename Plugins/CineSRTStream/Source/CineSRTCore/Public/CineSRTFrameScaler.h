@@ -0,0 +1,47 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+#include "CineSRTColorConvert.h"
+#include "CineSRTFrame.h"
+
+#include <vector>
+
+namespace CineSRT
+{
+    /**
+     * BGRA8 resampler for simulcast renditions: one captured frame, several smaller encodes.
+     * Whole 2:1 steps are taken with a 2x2 box filter (exact average, so large ratios do not alias),
+     * the remainder with a separable bilinear filter in 7-bit fixed point. Every kernel is bit-exact
+     * with the scalar one. Keeps its intermediate buffers between calls, so one instance per thread;
+     * after the first frame of a given size pair it does not allocate.
+     */
+    class CINESRTCORE_API FFrameScaler
+    {
+    public:
+        /** Both sizes must be at least 2x2. A negative or zero SrcStride means tightly packed rows. */
+        bool Scale(const uint8* Src, int32 SrcWidth, int32 SrcHeight, int32 SrcStride,
+            uint8* Dst, int32 DstWidth, int32 DstHeight, EColorKernel Kernel = EColorKernel::Auto);
+
+        /** Scales Src into Dst's current size (Dst->Data must already hold Width * Height * 4 bytes). */
+        bool Scale(const FRawFrame& Src, FRawFrame& Dst, EColorKernel Kernel = EColorKernel::Auto);
+
+    private:
+        // 2:1 단계 결과를 번갈아 담는 버퍼
+        std::vector<uint8> HalvedBuffers[2];
+
+        // 가로 필터를 거친 원본 행 두 개 (채널당 int16, 7비트 소수)와 그 원본 행 번호
+        std::vector<int16> FilteredRows[2];
+        int32 FilteredRowIndex[2] = { -1, -1 };
+
+        // 출력 열마다 왼쪽 원본 열과 가중치 쌍 ((128 - f) | f << 16) - 가로 크기 쌍이 바뀔 때만 다시 계산
+        std::vector<int32> ColumnOffsets;
+        std::vector<int32> ColumnWeights;
+        int32 TableSrcWidth = 0;
+        int32 TableDstWidth = 0;
+
+        void Bilinear(const uint8* Src, int32 SrcWidth, int32 SrcHeight, int32 SrcStride,
+            uint8* Dst, int32 DstWidth, int32 DstHeight, EColorKernel Kernel);
+    };
+}
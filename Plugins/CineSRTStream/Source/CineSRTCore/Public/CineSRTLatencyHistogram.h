@@ -0,0 +1,122 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace CineSRT
+{
+    /**
+     * Lock-free latency histogram with log-linear buckets (4 per power of two, 1 us to ~4 min).
+     * Record() is lock-free and safe from any thread; percentiles are read approximately.
+     */
+    class FLatencyHistogram
+    {
+    public:
+        static constexpr int32 SubBucketBits = 2;
+        static constexpr int32 SubBuckets = 1 << SubBucketBits;
+        static constexpr int32 NumBuckets = 27 * SubBuckets;
+
+        FLatencyHistogram()
+        {
+            Reset();
+        }
+
+        void Record(double Seconds)
+        {
+            const uint64 Micros = Seconds > 0.0 ? (uint64)(Seconds * 1000000.0) : 0;
+            Buckets[GetBucketIndex(Micros)].fetch_add(1, std::memory_order_relaxed);
+            TotalCount.fetch_add(1, std::memory_order_relaxed);
+            TotalMicros.fetch_add(Micros, std::memory_order_relaxed);
+
+            uint64 CurrentMax = MaxMicros.load(std::memory_order_relaxed);
+            while (Micros > CurrentMax && !MaxMicros.compare_exchange_weak(CurrentMax, Micros, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        /** Upper bound of the bucket holding the given percentile (0-100), in milliseconds. */
+        double GetPercentileMs(double Percentile) const
+        {
+            const uint64 Count = TotalCount.load(std::memory_order_relaxed);
+            if (Count == 0)
+            {
+                return 0.0;
+            }
+
+            const uint64 Target = std::max<uint64>(1, (uint64)std::ceil(Count * std::min(std::max(Percentile, 0.0), 100.0) / 100.0));
+            uint64 Seen = 0;
+            for (int32 Index = 0; Index < NumBuckets; ++Index)
+            {
+                Seen += Buckets[Index].load(std::memory_order_relaxed);
+                if (Seen >= Target)
+                {
+                    return std::min(GetBucketUpperBound(Index), MaxMicros.load(std::memory_order_relaxed)) / 1000.0;
+                }
+            }
+            return MaxMicros.load(std::memory_order_relaxed) / 1000.0;
+        }
+
+        double GetAverageMs() const
+        {
+            const uint64 Count = TotalCount.load(std::memory_order_relaxed);
+            return Count > 0 ? TotalMicros.load(std::memory_order_relaxed) / 1000.0 / Count : 0.0;
+        }
+
+        double GetMaxMs() const { return MaxMicros.load(std::memory_order_relaxed) / 1000.0; }
+        uint64 GetCount() const { return TotalCount.load(std::memory_order_relaxed); }
+
+        void Reset()
+        {
+            for (std::atomic<uint64>& Bucket : Buckets)
+            {
+                Bucket.store(0, std::memory_order_relaxed);
+            }
+            TotalCount.store(0, std::memory_order_relaxed);
+            TotalMicros.store(0, std::memory_order_relaxed);
+            MaxMicros.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        static int32 GetBucketIndex(uint64 Micros)
+        {
+            if (Micros < SubBuckets)
+            {
+                return (int32)Micros;
+            }
+            const int32 Exponent = FloorLog2(Micros);
+            const int32 Mantissa = (int32)((Micros >> (Exponent - SubBucketBits)) & (SubBuckets - 1));
+            return std::min((Exponent - SubBucketBits + 1) * SubBuckets + Mantissa, NumBuckets - 1);
+        }
+
+        static int32 FloorLog2(uint64 Value)
+        {
+            int32 Result = 0;
+            while (Value >>= 1)
+            {
+                Result++;
+            }
+            return Result;
+        }
+
+        static uint64 GetBucketUpperBound(int32 Index)
+        {
+            if (Index < SubBuckets)
+            {
+                return (uint64)Index;
+            }
+            const int32 Exponent = Index / SubBuckets + SubBucketBits - 1;
+            const uint64 Mantissa = (uint64)(Index % SubBuckets);
+            return ((SubBuckets + Mantissa + 1) << (Exponent - SubBucketBits)) - 1;
+        }
+
+        std::atomic<uint64> Buckets[NumBuckets];
+        std::atomic<uint64> TotalCount;
+        std::atomic<uint64> TotalMicros;
+        std::atomic<uint64> MaxMicros;
+    };
+}
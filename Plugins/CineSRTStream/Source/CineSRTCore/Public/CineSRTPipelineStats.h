@@ -0,0 +1,86 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+#include "CineSRTLatencyHistogram.h"
+
+#include <atomic>
+#include <string>
+
+namespace CineSRT
+{
+    /** Stages a frame passes through, in order. Each is timed once per frame (Send once per client). */
+    enum class EPipelineStage : uint8
+    {
+        Cadence,    // distance of the capture from its exact output slot (FFrameCadence), not a duration
+        Capture,    // scene capture call on the game thread
+        Readback,   // GPU copy queued -> pixels in a pooled frame
+        Scale,      // capture size -> rendition size on the encoder thread (simulcast renditions only)
+        Convert,    // BGRA -> planar YUV ahead of the codec (H.264 only)
+        Encode,     // codec time, conversion excluded
+        QueueWait,  // encoder submit -> mux, minus scale, convert and encode (input queue, reorder, transmit ring)
+        Mux,        // access unit -> MPEG-TS payloads
+        Send,       // muxed -> last payload taken by the SRT send buffer
+        Num
+    };
+
+    enum class EPipelineCounter : uint8
+    {
+        FramesCaptured,
+        FramesEncoded,
+        FramesDropped,  // anywhere in the pipeline (readback ring, encoder queue, transmit queue)
+        FramesSent,     // muxed and handed to the client queues
+        BytesEncoded,
+        FramesStatic,   // unchanged pictures skipped or repeated instead of encoded
+        SlotsMissed,    // output slots no capture landed on (the game frame ran longer than one slot)
+        Num
+    };
+
+    /**
+     * Per-stage timing histograms and counters shared by every thread of one stream.
+     * Recording is lock-free (relaxed atomics); readers get an approximate but consistent-enough view.
+     * Owned through a std::shared_ptr and handed to each stage before it starts.
+     */
+    class CINESRTCORE_API FPipelineStats
+    {
+    public:
+        struct FStageSummary
+        {
+            uint64 Count = 0;
+            double AverageMs = 0.0;
+            double P50Ms = 0.0;
+            double P95Ms = 0.0;
+            double P99Ms = 0.0;
+            double MaxMs = 0.0;
+        };
+
+        FPipelineStats();
+
+        void Record(EPipelineStage Stage, double Seconds)
+        {
+            Stages[(int32)Stage].Record(Seconds);
+        }
+
+        void Add(EPipelineCounter Counter, int64 Value = 1)
+        {
+            Counters[(int32)Counter].fetch_add(Value, std::memory_order_relaxed);
+        }
+
+        FStageSummary GetStage(EPipelineStage Stage) const;
+        int64 GetCounter(EPipelineCounter Counter) const { return Counters[(int32)Counter].load(std::memory_order_relaxed); }
+
+        /** Clears every histogram and counter, e.g. when streaming restarts. Samples recorded concurrently may be lost. */
+        void Reset();
+
+        /** One line per stage that has samples plus the counters, for periodic log summaries. */
+        std::string FormatSummary() const;
+
+        static const char* GetStageName(EPipelineStage Stage);
+        static const char* GetCounterName(EPipelineCounter Counter);
+
+    private:
+        FLatencyHistogram Stages[(int32)EPipelineStage::Num];
+        std::atomic<int64> Counters[(int32)EPipelineCounter::Num];
+    };
+}
@@ -0,0 +1,126 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+#include "CineSRTFrame.h"
+#include "CineSRTFrameRing.h"
+#include "CineSRTLatencyHistogram.h"
+#include "CineSRTTSMuxer.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace CineSRT
+{
+    /**
+     * Local ISO recording of one encoder's output, tapped off the same encoded frames the transmitter sends.
+     * RecordFrame never blocks: it only puts a reference to the frame into a bounded ring, and a writer thread
+     * of its own muxes the frames to MPEG-TS and writes them to disk in large aligned blocks. When the disk falls
+     * behind, the backlog is capped in frames and bytes; frames over either limit are dropped and counted, and an
+     * inter codec then skips to the next keyframe so the file stays decodable.
+     * Frames released while still encoding (slice streaming) are written once they finish, on the writer thread.
+     */
+    class CINESRTCORE_API FRecorder
+    {
+    public:
+        /** Disk writes are whole multiples of this, from a buffer aligned to it (except the last write of a file). */
+        static constexpr int32 WriteAlignment = 4096;
+
+        struct FSettings
+        {
+            int32 QueueCapacity = 240;                         // frames waiting for the writer (4 s at 60 fps)
+            int64 MaxBacklogBytes = 512ll * 1024 * 1024;        // encoded bytes waiting for the writer
+            int32 WriteBlockBytes = 4 * 1024 * 1024;            // one disk write, rounded up to WriteAlignment
+            double FlushIntervalSeconds = 1.0;                  // a partly filled block goes to disk after this long
+        };
+
+        struct FStats
+        {
+            int64 FramesRecorded = 0;
+            int64 BytesWritten = 0;       // TS bytes on disk
+            int64 FramesDropped = 0;      // over the backlog limits, or waiting for a keyframe after such a drop
+            int64 BytesDropped = 0;
+            int64 FramesFailed = 0;       // streamed frames whose encode failed after they were queued
+            int32 BacklogFrames = 0;
+            int32 BacklogHighWater = 0;   // deepest the backlog has been since Start
+            int64 BacklogBytes = 0;       // frames still encoding count from when the writer takes them
+            int64 Writes = 0;
+            double WriteMBps = 0.0;       // bytes written over the time since Start
+            bool bWriteFailed = false;    // the disk refused a write; nothing more is recorded until the next Start
+        };
+
+        explicit FRecorder(const FSettings& InSettings);
+        ~FRecorder();
+
+        FRecorder(const FRecorder&) = delete;
+        FRecorder& operator=(const FRecorder&) = delete;
+
+        /** Creates (or truncates) Path and starts the writer thread. Fails when the file cannot be opened. */
+        bool Start(const std::string& InPath);
+
+        /** Writes everything still queued, closes the file and joins the writer. */
+        void Stop();
+
+        bool IsRecording() const { return bIsRecording.load(std::memory_order_relaxed); }
+        const std::string& GetPath() const { return Path; }
+
+        /**
+         * Queues a reference to the frame for the writer; never waits for the disk. Returns false when the frame was
+         * dropped or the recorder is not running. Call from one thread at a time, e.g. the encoder pool's frame sink.
+         */
+        bool RecordFrame(const FEncodedFrameRef& Frame);
+
+        FStats GetStats() const;
+
+        /** Time of each disk write. */
+        const FLatencyHistogram& GetWriteLatency() const { return WriteLatency; }
+
+    private:
+        struct FQueuedFrame
+        {
+            FEncodedFrameRef Frame;
+            int64 Bytes = 0; // BacklogBytes에 더한 크기 (인코딩 중인 프레임은 0)
+        };
+
+        FSettings Settings;
+        std::string Path;
+        std::atomic<bool> bIsRecording{false};
+        std::atomic<bool> bShouldStop{false};
+        std::thread Thread;
+
+        // 인코더 싱크(생산자 하나) -> 기록 스레드(소비자 하나)
+        TFrameRing<FQueuedFrame> Queue;
+        FSyncEvent FrameReadyEvent;
+        bool bDropUntilKeyframe = false; // 생산자 전용 (Start는 bIsRecording을 켜기 전에 씀)
+
+        std::atomic<int64> BacklogBytes{0};
+        std::atomic<int32> BacklogHighWater{0};
+        std::atomic<int64> FramesDropped{0};
+        std::atomic<int64> BytesDropped{0};
+        std::atomic<int64> FramesRecorded{0};
+        std::atomic<int64> FramesFailed{0};
+        std::atomic<int64> BytesWritten{0};
+        std::atomic<int64> Writes{0};
+        std::atomic<bool> bWriteFailed{false};
+        double StartTime = 0.0;
+        double StopTime = 0.0;
+        FLatencyHistogram WriteLatency;
+
+        // 이하 기록 스레드 전용
+        std::FILE* File = nullptr;
+        FTSMuxer Muxer;
+        std::unique_ptr<uint8[]> BlockStorage;
+        uint8* Block = nullptr; // BlockStorage 안에서 WriteAlignment에 맞춘 시작
+        int32 BlockCapacity = 0;
+        int32 BlockSize = 0;
+        double BlockStartTime = 0.0; // 블록에 첫 바이트가 들어간 시각
+
+        void Run();
+        void WriteFrame(FEncodedFrame& Frame);
+        void AppendToBlock(const uint8* Data, int32 Size);
+        void WriteBlock();
+    };
+}
@@ -0,0 +1,20 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+
+namespace CineSRT
+{
+    /**
+     * Test picture for the benchmarks (CineSRT.Bench.* in the engine, CineSRTBench outside it): a moving gradient
+     * with per-frame noise, so the codec cannot coast on identical frames. The same FrameIndex always gives the same
+     * picture, so runs on either side compare.
+     */
+    class CINESRTCORE_API FSyntheticFrame
+    {
+    public:
+        /** Fills Width x Height BGRA pixels (tightly packed rows) with picture FrameIndex. */
+        static void Fill(uint8* BGRA, int32 Width, int32 Height, int32 FrameIndex);
+    };
+}
@@ -0,0 +1,139 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+#include "CineSRTAudioEncoder.h"
+#include "CineSRTFrame.h"
+
+namespace CineSRT
+{
+    /**
+     * Minimal MPEG transport stream muxer for a single program: one video stream and, once audio is muxed, one
+     * SMPTE 302M audio stream.
+     * Wraps each encoded access unit in a PES packet, splits it into 188-byte TS packets
+     * (PAT/PMT on keyframes and every 100 ms, PCR on the first packet of every frame and at least every
+     * PcrInterval in between) and hands them out seven at a time so every SRT message is exactly 1316 bytes.
+     * All output goes through one fixed payload buffer; nothing is allocated per packet.
+     *
+     * MJPEG has no stream_type in ISO/IEC 13818-1. It goes out as private data: stream_type 0x06 with an 'MJPG'
+     * registration descriptor in the PMT and PES stream_id 0xBD (private_stream_1). The tag is a private convention,
+     * so generic demuxers list the stream as data and most players will not decode it without being told to. Only
+     * video stream_ids may leave PES_packet_length at 0, so an MJPEG frame goes out as bounded PES packets of at most
+     * 64 KB: the first carries the PTS, the rest continue the same access unit without one. Each ends on a TS packet
+     * boundary except the frame's last, so cutting a frame into several costs no stuffing.
+     */
+    class CINESRTCORE_API FTSMuxer
+    {
+    public:
+        static constexpr int32 PacketSize = 188;
+        static constexpr int32 PacketsPerPayload = 7;
+        static constexpr int32 PayloadSize = PacketSize * PacketsPerPayload; // SRT_LIVE_DEF_PLSIZE
+        static constexpr int64 PcrInterval = 3600; // 40 ms at 90 kHz (the standard allows up to 100 ms)
+
+        /** Receives one complete 1316-byte payload. Returning false aborts the current frame. */
+        using FPayloadSink = TCallbackRef<bool(const uint8* /*Data*/, int32 /*Size*/)>;
+
+        FTSMuxer();
+
+        /** Muxes one access unit. The last payload of the frame is padded with null packets and flushed. */
+        bool MuxFrame(const FEncodedFrame& Frame, FPayloadSink Sink);
+
+        /**
+         * MuxFrame in pieces, for a frame whose bitstream arrives while it is still being encoded (slice streaming).
+         * BeginFrame takes the frame's timing, format and keyframe flag (not its Data); WriteFrameData packetizes
+         * each piece as it arrives, holding back less than one TS packet, and every full payload goes out at once;
+         * EndFrame pads and flushes the tail. The same bytes in one piece or many give the same stream, except that
+         * the bounded PES packets of an MJPEG frame still encoding (Frame.Partial) are cut from what has arrived.
+         */
+        bool BeginFrame(const FEncodedFrame& Frame, FPayloadSink Sink);
+        bool WriteFrameData(const uint8* Data, int32 Size, FPayloadSink Sink);
+        bool EndFrame(FPayloadSink Sink);
+
+        /**
+         * Muxes one audio packet at Audio.Pts (90 kHz, same origin as the video PTS). Goes between video frames, or
+         * after BeginFrame and before the frame's data so the PSI of a keyframe comes first. The audio TS packets
+         * share payloads with what follows instead of being padded out on their own; call Flush when nothing follows.
+         * The first call adds the audio stream to the PMT.
+         */
+        bool MuxAudio(const FEncodedAudio& Audio, FPayloadSink Sink);
+
+        /**
+         * Writes an adaptation-field-only packet carrying Pcr (90 kHz, same origin as the video PTS) so the program
+         * clock keeps ticking while no frame is going out, e.g. at low frame rates. Between frames only; does nothing
+         * when it would not move the clock forward. Joins the payload in progress; call Flush when nothing follows.
+         * BeginFrame also fills a gap longer than PcrInterval since the last PCR on its own, but only a caller that
+         * writes these on time gives receivers a clock that ticks in real time.
+         */
+        bool WritePcr(int64 Pcr, FPayloadSink Sink);
+
+        /** The last PCR written (unwrapped, same origin as the video PTS), or -1 before the first frame. */
+        int64 GetLastPcr() const { return LastPcr; }
+
+        /** Pads the payload in progress with null packets and hands it out (nothing when it is empty). */
+        bool Flush(FPayloadSink Sink) { return FlushPadded(Sink); }
+
+        /** Forces PAT/PMT ahead of the next frame, e.g. when a new receiver connects. */
+        void Reset();
+
+    private:
+        static constexpr uint16 PmtPid = 0x1000;
+        static constexpr uint16 VideoPid = 0x0100;
+        static constexpr uint16 AudioPid = 0x0101;
+        static constexpr uint16 NullPid = 0x1FFF;
+        static constexpr int64 PsiInterval = 9000; // 100 ms at 90 kHz
+        static constexpr int64 PtsOffset = 9000;   // PTS leads PCR to give the decoder buffer time
+        static constexpr int64 PcrJumpLimit = 90000; // 1 s: a larger jump is a new timeline (encoder restart), not a gap to fill
+
+        void WritePsi(uint16 Pid, const uint8* Section, int32 SectionSize, uint8& Continuity);
+        void WritePat();
+        void WritePmt();
+        uint8* BeginPacket();
+        bool FinishPacket(FPayloadSink& Sink);
+        bool FlushPadded(FPayloadSink& Sink);
+        bool WritePcrPacket(int64 Pcr, FPayloadSink& Sink);
+        static void WritePcrField(uint8* Out, int64 Pcr);
+
+        // 프레임의 다음 PES 헤더 (DataSize < 0: 길이 없음), 크기를 돌려줌
+        int32 WritePesHeader(uint8* Out, int32 DataSize) const;
+
+        // 길이 있는 PES(MJPEG): 크기를 알면 남은 만큼, 모르면 모인 바이트로 TS 패킷을 꼭 채우는 PES. 프레임 끝에서는 남은 것까지
+        bool WriteBoundedPes(const uint8* Data, int32 Size, bool bEndOfFrame, FPayloadSink& Sink);
+
+        // 자투리 PendingVideo + Data로 비디오 TS 패킷 하나 (모자라면 스터핑)
+        bool WriteVideoPacket(const uint8* Data, int32 Size, FPayloadSink& Sink);
+        int32 GetVideoCapacity() const { return PacketSize - 4 - (bFirstVideoPacket ? 8 : 0); }
+
+        static uint8 GetStreamType(EEncodingFormat Format);
+        static uint8 GetPesStreamId(EEncodingFormat Format);
+
+        uint8 Payload[PayloadSize];
+        int32 PacketsInPayload = 0;
+
+        uint8 PatContinuity = 0;
+        uint8 PmtContinuity = 0;
+        uint8 VideoContinuity = 0;
+        uint8 AudioContinuity = 0;
+        bool bHasAudio = false;
+        uint8 PmtVersion = 0;
+        EEncodingFormat CurrentFormat = EEncodingFormat::None;
+        int64 LastPsiPts = 0;
+        bool bPsiPending = true;
+        int64 LastPcr = -1;
+
+        // 먹싱 중인 프레임 (BeginFrame ~ EndFrame)
+        uint8 PendingVideo[PacketSize]; // 아직 패킷을 채우지 못한 PES 헤더/프레임 바이트
+        int32 PendingVideoSize = 0;
+        bool bFirstVideoPacket = false;
+        bool bPesStart = false;   // PendingVideo가 PES 헤더로 시작 - 다음 패킷에 payload_unit_start
+        bool bBoundedPes = false; // 이 프레임의 PES에 길이를 적음 (비디오 stream_id가 아닌 MJPEG)
+        bool bFirstPes = false;   // 다음 PES가 프레임의 첫 PES (PTS/DTS를 실음)
+        int64 FrameBytesLeft = 0; // 아직 WriteFrameData로 받지 않은 바이트, 인코딩 중인 프레임은 -1 (모름)
+        int32 PesLeft = 0;        // 열린 PES에서 아직 패킷에 넣지 않은 바이트 (헤더, 보관 중인 자투리 포함)
+        bool bFrameOpen = false;
+        bool bFrameKeyframe = false;
+        bool bFrameHasData = false;
+        int64 FramePcr = 0;
+        int64 FramePts = 0;
+    };
+}
@@ -0,0 +1,459 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+#include "CineSRTFrame.h"
+#include "CineSRTFrameRing.h"
+#include "CineSRTLatencyHistogram.h"
+#include "CineSRTPipelineStats.h"
+#include "CineSRTTSMuxer.h"
+
+#include <deque>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// SRT 헤더 포함
+#if WITH_SRT
+#include "srt/srt.h"
+#endif
+
+namespace CineSRT
+{
+    enum class EQueueOverflowPolicy : uint8
+    {
+        DropOldest,
+        DropNonKeyframes,
+        Block
+    };
+
+    /**
+     * SRT listener that serves one or more streams (cameras) on a single port. Callers pick a stream
+     * with the SRT streamid; each stream muxes its encoded frames to MPEG-TS once and fans the payloads
+     * out to its own callers. One thread drives accept, per-client send queues and slow-client policy
+     * for every stream from SRT epoll; producers hand frames over through a bounded lock-free ring per stream.
+     * Each stream keeps its muxed frames since the last keyframe, so a new caller starts from that GOP at once
+     * instead of waiting for the next keyframe. Every packet carries its frame's capture time as the SRT source time,
+     * cached GOP included: capture times older than the connection, or older than half of LatencyTolerance when the
+     * burst goes out, are raised to that floor so the receiver plays the burst on arrival instead of dropping it as late.
+     * Source times never go backwards for a client, so TSBPD-based latency at the receiver holds for the burst too
+     * (it reads as the floor, not the true age of the cached pictures).
+     * Audio handed to a stream is interleaved into the same TS by capture time: each packet goes out in the payloads
+     * of the first video frame captured after it, or on its own when no frame follows within AudioHoldMs.
+     */
+    class CINESRTCORE_API FTransmitter
+    {
+    public:
+        struct FSettings
+        {
+            std::string BindAddress = "0.0.0.0";
+            int32 Port = 9001;
+            int32 LatencyTolerance = 120; // ms
+            int32 MaxBW = 0; // 0 = unlimited
+            int32 InputBW = 0; // 0 = unlimited
+            int32 Overhead = 25; // %
+            int32 QueueCapacity = 16; // frames
+            EQueueOverflowPolicy OverflowPolicy = EQueueOverflowPolicy::DropNonKeyframes;
+            int32 BlockTimeoutMs = 50;
+            int32 MaxClients = 8;
+            int32 ClientQueueCapacity = 8; // frames per client
+            int32 SlowClientTimeoutMs = 3000; // 밀린 클라이언트가 이 시간 안에 따라잡지 못하면 연결 해제
+            int32 LinkStatsPeriodMs = 500; // srt_bistats 샘플 주기 (OnLinkStats 호출 간격)
+            int32 JoinCacheMaxBytes = 8 * 1024 * 1024; // 새 클라이언트에 먼저 보낼 마지막 키프레임부터의 GOP 한도 (0 = 다음 키프레임까지 대기)
+            bool bKeyframeOnJoin = true; // 캐시로 시작할 수 없는 클라이언트가 들어오면 OnKeyframeRequest 호출
+        };
+
+        // 클라이언트별 전송 통계 (1초마다 갱신되는 스냅샷)
+        struct FClientStats
+        {
+            std::string Address;
+            double SendRateMbps = 0.0;
+            int32 Backlog = 0;          // 대기 중인 프레임 수
+            int64 FramesSent = 0;
+            int64 FramesDropped = 0;    // 느린 클라이언트 정책으로 버린 프레임
+            int64 BytesSent = 0;
+            double ConnectedSeconds = 0.0;
+            double TimeToFirstPictureMs = -1.0; // 접속 -> 첫 키프레임 송신 완료, 아직이면 -1
+
+            // 마지막 링크 샘플 (SRT_TRACEBSTATS)
+            double RttMs = 0.0;
+            double BandwidthMbps = 0.0; // 추정 링크 용량 (MaxBW가 있으면 그 이하)
+            int32 SendBufferMs = 0;     // 아직 ACK되지 않은 송신 버퍼 구간
+            int64 PacketsLost = 0;      // 누적
+            int64 PacketsDropped = 0;   // 누적, 지연 한도를 넘겨 송신측에서 버린 패킷
+        };
+
+        /**
+         * Worst case over every connected client for one sample period (srt_bistats, cleared per sample).
+         * Every client gets the same stream, so the slowest link is the one the encoder has to fit.
+         */
+        struct FLinkStats
+        {
+            int32 NumClients = 0;
+            double IntervalSeconds = 0.0;
+            double RttMs = 0.0;            // highest msRTT
+            double BandwidthMbps = 0.0;    // lowest mbpsBandwidth, capped by MaxBW when one is set
+            double SendRateMbps = 0.0;     // highest mbpsSendRate
+            int64 PacketsSent = 0;         // on the client with the highest loss ratio
+            int64 PacketsLost = 0;         // pktSndLoss on that client
+            int64 PacketsDropped = 0;      // pktSndDrop summed over clients (too late to send)
+            int32 SendBufferMs = 0;        // highest msSndBuf
+            float SendBufferFill = 0.0f;   // highest byteSndBuf / (byteSndBuf + byteAvailSndBuf)
+        };
+
+        struct FStats
+        {
+            int64 FramesQueued = 0;
+            int64 FramesSent = 0;
+            int64 DroppedOldest = 0;        // evicted to make room (DropOldest, or a keyframe under DropNonKeyframes)
+            int64 DroppedNonKeyframes = 0;  // rejected until the next keyframe (DropNonKeyframes)
+            int64 DroppedBlockTimeout = 0;  // producer gave up waiting for space (Block)
+            int32 QueueDepth = 0;
+            int32 NumClients = 0;
+            int64 ClientFramesDropped = 0;  // 모든 클라이언트 큐에서 버린 프레임 합계
+            int64 ClientsJoinedFromCache = 0; // 캐시된 GOP로 바로 시작한 클라이언트
+            int64 KeyframesRequested = 0;     // 캐시가 없어 OnKeyframeRequest를 부른 횟수
+            int64 AudioPacketsSent = 0;       // TS에 먹싱된 오디오 패킷
+            int64 AudioPacketsDropped = 0;    // 오디오 큐가 가득 찼거나 첫 비디오 프레임보다 먼저 캡처된 패킷
+
+            // TransmitFrame -> 클라이언트별 srt_send 완료까지 지연 (ms)
+            double SendLatencyP50 = 0.0;
+            double SendLatencyP95 = 0.0;
+            double SendLatencyP99 = 0.0;
+            double SendLatencyMax = 0.0;
+
+            // 접속 -> 첫 키프레임이 SRT에 다 넘어가기까지 (ms). 수신측 화면은 여기에 SRT 지연만큼 더해서 나옴
+            double TimeToFirstPictureP50 = 0.0;
+            double TimeToFirstPictureMax = 0.0;
+
+            // 스트림 시작 -> 첫 프레임의 TS 패킷이 전송 큐를 떠나기까지 (ms, 아직이면 -1). FStream::MarkStart 참고
+            double TimeToFirstPacket = -1.0;
+        };
+
+        class CINESRTCORE_API FStream;
+
+        explicit FTransmitter(const FSettings& InSettings);
+        ~FTransmitter();
+
+        FTransmitter(const FTransmitter&) = delete;
+        FTransmitter& operator=(const FTransmitter&) = delete;
+
+        /**
+         * Starts the SRT library for the whole process ahead of the first transmitter (module startup), so starting a
+         * stream does not pay for it and stopping the last one does not tear its threads down. Pair with ShutdownSRT.
+         */
+        static bool StartupSRT();
+        static void ShutdownSRT();
+
+        /**
+         * Binds and listens ahead of StartTransmission, so the port is ready the moment streaming starts and callers can
+         * finish their handshake early; they are served from StartTransmission on. StartTransmission reuses the listener
+         * while its settings still match; StopTransmission closes it as usual.
+         */
+        bool Prepare();
+        bool IsPrepared() const;
+
+        // 전송 시작/중지 (등록된 스트림은 그대로 유지)
+        bool StartTransmission();
+        void StopTransmission();
+
+        // 전송 상태 확인
+        bool IsTransmitting() const { return bIsTransmitting; }
+
+        // 설정 업데이트
+        void UpdateSettings(const FSettings& NewSettings);
+
+        /**
+         * Creates a stream served by this listener under StreamId. It receives no callers until AddStream.
+         * An empty StreamId takes every caller no other stream matches (the single-camera setup).
+         */
+        std::shared_ptr<FStream> CreateStream(const std::string& StreamId);
+
+        /** Starts routing callers to Stream. Fails when another registered stream already uses its id. Works before and after StartTransmission. */
+        bool AddStream(const std::shared_ptr<FStream>& Stream);
+
+        /**
+         * Disconnects the stream's callers and stops routing to it. Blocks until the transmitter thread has let
+         * go of the stream, so its callbacks may be destroyed afterwards. Do not call from OnLinkStats.
+         */
+        void RemoveStream(const std::shared_ptr<FStream>& Stream);
+
+        int32 GetNumStreams() const;
+
+        /** Callers connected to every stream together. */
+        int32 GetNumClients() const { return NumClients.load(std::memory_order_relaxed); }
+
+        /** Called on the transmitter thread when the listener fails. */
+        std::function<void(const std::string& /*Error*/)> OnError;
+
+    private:
+        static int32 SRTUsers; // StartupSRT 호출 수 - 0이 되면 srt_cleanup
+        static std::mutex SRTInitLock;
+        bool bHoldsSRT = false; // 이 송신기가 StartupSRT 참조를 잡고 있음
+        FSettings Settings;
+        FSettings ListenerSettings; // 열려 있는 리스너를 만든 설정 (Prepare 후 설정이 바뀌었는지 확인용)
+        std::atomic<bool> bIsTransmitting{false};
+        std::atomic<bool> bShouldStop{false};
+
+        // 한 번 먹싱된 TS 페이로드 묶음 - 모든 클라이언트 큐가 참조로 공유 (전송 스레드 전용)
+        struct FMuxedFrame
+        {
+            std::vector<uint8> Payloads; // FTSMuxer::PayloadSize 단위
+            bool bComplete = true; // false: 슬라이스 스트리밍으로 먹싱 중 - 지금까지의 페이로드만 보낼 수 있음
+            bool bKeyframe = false;
+            bool bAudioOnly = false; // 비디오 프레임 없이 혼자 나가는 오디오나 PCR - 프레임 통계에 세지 않음
+            double CaptureTime = 0.0;
+            double SubmitTime = 0.0;
+            double MuxedTime = 0.0;
+        };
+        using FMuxedFrameRef = std::shared_ptr<FMuxedFrame>;
+
+        // 연결된 수신측 하나 (전송 스레드 전용)
+        struct FClient
+        {
+#if WITH_SRT
+            SRTSOCKET Socket = SRT_INVALID_SOCK;
+#endif
+            std::string Address;
+            std::deque<FMuxedFrameRef> Queue;
+            FMuxedFrameRef CurrentFrame;  // 전송 중인 프레임
+            int32 CurrentOffset = 0;
+            int32 CachedFrames = 0;          // 큐 앞쪽의 접속 캐시 프레임 수 - 큐 용량에 세지 않음
+            bool bSendingCached = false;     // CurrentFrame이 접속 캐시에서 온 프레임
+            bool bWaitForKeyframe = true;    // 접속 직후/백로그 폐기 후에는 키프레임부터
+            bool bWaitingWritable = false;   // SRT 송신 버퍼가 가득 차 EPOLL_OUT 대기 중
+            bool bDisconnect = false;
+            double ConnectTime = 0.0;
+            double TimeToFirstPicture = -1.0; // 초, 첫 키프레임을 다 보내면 기록
+            int64 SocketStartTime = 0;       // srt_connection_time (SRT 시계, us) - 이보다 이른 srctime은 거부됨
+            int64 LastSourceTime = 0;        // 마지막으로 단 srctime - 접속 캐시, 라이브, PCR 패킷을 지나며 단조 증가
+            double LaggingSince = 0.0;       // 0 = 밀리지 않음
+            int64 FramesSent = 0;
+            int64 FramesDropped = 0;
+            int64 BytesSent = 0;
+            int64 WindowBytes = 0;
+            double SendRateMbps = 0.0;
+            double RttMs = 0.0;
+            double BandwidthMbps = 0.0;
+            int32 SendBufferMs = 0;
+            int64 PacketsLost = 0;
+            int64 PacketsDropped = 0;
+        };
+
+        // SRT 소켓
+#if WITH_SRT
+        SRTSOCKET ServerSocket = SRT_INVALID_SOCK;
+        int EpollId = -1;
+#endif
+        std::atomic<int32> NumClients{0}; // 모든 스트림 합계
+
+        // 스트림 등록부 (StreamsLock 보호). 전송 스레드는 버전이 바뀌면 ActiveStreams로 복사해서 씀
+        mutable std::mutex StreamsLock;
+        std::condition_variable StreamsSynced;
+        std::vector<std::shared_ptr<FStream>> Streams;
+        uint64 StreamsVersion = 0;
+        uint64 SyncedStreamsVersion = 0;
+        bool bThreadRunning = false;
+        std::atomic<bool> bStreamsChanged{false};
+        std::vector<std::shared_ptr<FStream>> ActiveStreams; // 전송 스레드 전용
+
+        // TransmitFrame이 신호하는 웨이크업 이벤트 (고정 Sleep 대신 사용, 모든 스트림 공용)
+        FSyncEvent FrameReadyEvent;
+        static constexpr int32 IdleWaitMs = 100;
+        static constexpr int32 WritableWaitMs = 2; // SRT 송신 버퍼가 찬 클라이언트가 있을 때의 epoll 대기
+        static constexpr int32 JoinPollMs = 5; // 프레임 사이에 새 호출자를 accept하는 최대 지연
+        static constexpr int32 AudioHoldMs = 30; // 오디오가 같이 나갈 비디오 프레임을 기다리는 최대 시간 (이후엔 혼자 먹싱)
+        static constexpr int32 PcrPollMs = 10; // 프레임 간격이 FTSMuxer::PcrInterval보다 길 때 PCR 패킷이 늦지 않도록 깨는 주기
+        static constexpr int32 AudioQueueCapacity = 64; // 스트림당 전송 대기 오디오 패킷
+        static constexpr int32 ListenBacklog = 64;
+
+        // 스레드 관리
+        std::thread Thread;
+
+        void Run();
+
+        // 등록부 변경을 전송 스레드에 반영 - 빠진 스트림의 클라이언트는 끊음
+        void SyncStreams();
+
+        // 한 바퀴 돌면서 스트림 하나의 큐를 비우고 클라이언트에 전송
+        void ServiceStream(FStream& Stream, double Now);
+
+        // SRT 초기화 (이 송신기 몫의 StartupSRT 참조)
+        bool InitializeSRT();
+
+        // 소켓 설정
+        bool ConfigureSocket();
+
+#if WITH_SRT
+        // 리스너/클라이언트 epoll 이벤트 처리
+        void HandleSocketEvents(const SRT_EPOLL_EVENT* Events, int32 NumEvents);
+#endif
+
+        // 논블로킹 accept (리스너가 읽기 가능할 때만 호출). 호출자의 streamid로 스트림을 고름
+        bool AcceptClient();
+        FStream* FindStream(const std::string& CallerStreamId) const;
+        void DisconnectClient(FClient& Client);
+        void DisconnectAllClients(FStream& Stream);
+        void RemoveDisconnectedClients(FStream& Stream);
+        void UpdateNumClients();
+
+        // "#!::r=cam1,m=request" 형식(SRT 접근 제어 문법)이면 리소스 이름만, 아니면 그대로
+        static std::string ParseStreamId(const std::string& RawStreamId);
+
+        // 한 번 먹싱해서 스트림의 모든 클라이언트 큐에 참조로 분배
+        void FanOutFrame(FStream& Stream, const FEncodedFrameRef& Frame);
+
+        // 스트림의 첫 프레임이 전송 큐를 떠난 시각 기록 (TimeToFirstPacket)
+        void MarkFirstPacket(FStream& Stream);
+
+        // 인코딩 중에 받은 프레임(FPartialBitstream)의 새 슬라이스를 먹싱. 열린 프레임이 없거나 끝났으면 true
+        bool ContinueOpenFrame(FStream& Stream);
+        void AbandonOpenFrame(FStream& Stream);
+
+        // 캡처가 UpToTime 이하인 대기 오디오를 비디오 PTS 원점 기준으로 먹싱 (비디오 프레임 앞, 또는 혼자)
+        void MuxPendingAudio(FStream& Stream, double UpToTime, FTSMuxer::FPayloadSink Sink);
+        // AudioHoldMs 동안 같이 나갈 프레임이 없었던 오디오를 오디오만 담은 먹싱 프레임으로 분배
+        void FanOutAudio(FStream& Stream, double Now);
+        // 마지막 PCR 뒤로 FTSMuxer::PcrInterval이 지나도록 먹싱할 것이 없으면 PCR만 담은 패킷을 분배 (저fps, 정지 화면)
+        void FanOutPcr(FStream& Stream, double Now);
+        FMuxedFrameRef AcquireMuxedFrame(FStream& Stream);
+        void EnqueueForClient(FStream& Stream, FClient& Client, const FMuxedFrameRef& Frame, double Now);
+
+        // 마지막 키프레임부터 지금까지의 먹싱된 프레임을 보관 - 새 클라이언트는 다음 키프레임을 기다리지 않고 여기서 시작
+        void UpdateJoinCache(FStream& Stream, const FMuxedFrameRef& Frame);
+        void PrimeNewClient(FStream& Stream, FClient& Client);
+
+        // 클라이언트 큐를 SRT 송신 버퍼가 찰 때까지 1316바이트 단위로 전송
+        void FlushClient(FStream& Stream, FClient& Client);
+
+        // 캡처 시각 -> SRT 소스 시간 (SRT_MSGCTRL::srctime). 0이면 SRT가 송신 시각을 씀
+        static int64 GetSourceTime(const FClient& Client, double CaptureTime);
+
+        void UpdateClientStats(FStream& Stream, double ElapsedSeconds);
+
+        // 클라이언트마다 SRT 통계를 읽어 최악값으로 합치고 OnLinkStats 호출
+        void SampleLinkStats(FStream& Stream, double ElapsedSeconds);
+
+        // SRT 정리
+        void CleanupSRT();
+
+    public:
+        /**
+         * One camera's output on the shared listener: its own transmit ring, muxer, callers and statistics.
+         * Created by FTransmitter::CreateStream and only valid while that transmitter exists.
+         */
+        class CINESRTCORE_API FStream
+        {
+        public:
+            FStream(FTransmitter& InOwner, const std::string& InStreamId);
+
+            FStream(const FStream&) = delete;
+            FStream& operator=(const FStream&) = delete;
+
+            // 프레임 전송 (인코딩된 프레임은 전송 스레드에서 MPEG-TS로 먹싱됨). 생산자 스레드 하나에서만 호출
+            // 패킷은 Frame->CaptureTime을 SRT 소스 시간으로 달고 나가므로 수신측 TSBPD는 캡처 + LatencyTolerance에 재생
+            // (LatencyTolerance가 캡처 -> 송신 지연보다 작으면 패킷이 늦은 것으로 버려짐)
+            // 등록되지 않았거나 리스너가 멈춰 있으면 false
+            bool TransmitFrame(FEncodedFrameRef Frame);
+
+            /**
+             * Queues one audio packet for this stream's TS; never blocks (a full queue drops it). Call from one thread
+             * at a time (the audio thread). Audio->CaptureTime must be on the GetTimeSeconds() clock like the frames'.
+             */
+            bool TransmitAudio(FEncodedAudioRef Audio);
+
+            const std::string& GetStreamId() const { return StreamId; }
+            bool IsRegistered() const { return bRegistered.load(std::memory_order_relaxed); }
+
+            // 통계
+            FStats GetStats() const;
+            std::vector<FClientStats> GetClientStats() const;
+            int32 GetNumClients() const { return NumClients.load(std::memory_order_relaxed); }
+
+            /** Most recent link sample of this stream's callers (NumClients is 0 before the first one). */
+            FLinkStats GetLinkStats() const;
+
+            /** Called on the transmitter thread every LinkStatsPeriodMs while this stream has at least one client. */
+            std::function<void(const FLinkStats& /*Stats*/)> OnLinkStats;
+
+            /**
+             * Called on the transmitter thread when a caller joins and no cached GOP can start it (cache off, over
+             * JoinCacheMaxBytes, or nothing sent yet) and bKeyframeOnJoin is set. The host should make the encoder's
+             * next frame a keyframe; further joins do not call again until that keyframe has gone out.
+             */
+            std::function<void()> OnKeyframeRequest;
+
+            /** Records queue wait, mux and send times and the sent/dropped counters into Stats. Call before AddStream. */
+            void SetPipelineStats(std::shared_ptr<FPipelineStats> InPipelineStats) { PipelineStats = std::move(InPipelineStats); }
+
+            /**
+             * Restarts FStats::TimeToFirstPacket from Time (GetTimeSeconds()). StartTransmission and AddStream on a running
+             * listener mark it themselves; a host can move it earlier to count its own start-up too.
+             */
+            void MarkStart(double Time);
+
+        private:
+            friend class FTransmitter;
+
+            FTransmitter& Owner;
+            const std::string StreamId;
+            std::atomic<bool> bRegistered{false};
+
+            // 전송 큐 (고정 크기 MPMC 링) - 생산자가 넣고 전송 스레드가 꺼냄. DropOldest/DropNonKeyframes에서는 생산자도 머리를 꺼내 버림
+            TFrameRing<FEncodedFrameRef> TransmissionQueue;
+            TFrameRing<FEncodedAudioRef> AudioQueue; // 오디오 스레드 -> 전송 스레드
+            FSyncEvent QueueSpaceEvent;
+            bool bDropUntilKeyframe = false; // 생산자 전용
+
+            std::atomic<int64> FramesQueued{0};
+            std::atomic<int64> FramesSent{0};
+            std::atomic<int64> DroppedOldest{0};
+            std::atomic<int64> DroppedNonKeyframes{0};
+            std::atomic<int64> DroppedBlockTimeout{0};
+            std::atomic<int64> ClientFramesDropped{0};
+            std::atomic<int32> NumClients{0};
+            std::atomic<int64> ClientsJoinedFromCache{0};
+            std::atomic<int64> KeyframesRequested{0};
+            std::atomic<int64> AudioPacketsSent{0};
+            std::atomic<int64> AudioPacketsDropped{0};
+            std::atomic<double> StartTime{-1.0};       // MarkStart
+            std::atomic<double> FirstPacketTime{-1.0}; // 시작 후 첫 프레임이 전송 큐를 떠난 시각
+            FLatencyHistogram SendLatency;
+            FLatencyHistogram JoinLatency; // 접속 -> 첫 키프레임 송신 완료
+            std::shared_ptr<FPipelineStats> PipelineStats;
+
+            // 이하 전송 스레드 전용
+            std::vector<std::unique_ptr<FClient>> Clients;
+            FTSMuxer Muxer; // 이 스트림의 모든 클라이언트가 같은 TS를 받음
+            std::vector<FMuxedFrameRef> MuxedFramePool; // 다 쓴 먹싱 버퍼 재사용 (참조가 풀에만 남은 항목)
+            std::vector<FMuxedFrameRef> JoinCache; // 마지막 키프레임부터 먹싱된 프레임 (비었으면 시작할 키프레임 없음)
+            int64 JoinCacheBytes = 0;
+            bool bJoinCacheOverflow = false; // 이번 GOP가 한도를 넘음 - 다음 키프레임까지 캐시 없음
+            bool bKeyframeRequested = false; // OnKeyframeRequest 후 키프레임이 나갈 때까지
+            FEncodedFrameRef OpenFrame;     // 인코더가 아직 쓰고 있는 프레임 - 끝날 때까지 다음 프레임은 먹싱하지 않음
+            FMuxedFrameRef OpenMuxed;       // 그 프레임의 먹싱 결과 (클라이언트 큐에 이미 들어감)
+            int32 OpenOffset = 0;           // OpenFrame의 비트스트림 중 먹서에 넘긴 바이트
+            int64 OpenCachedBytes = 0;      // 접속 캐시에 넣을 때 센 페이로드 크기
+            double OpenMuxSeconds = 0.0;
+            std::deque<FEncodedAudioRef> PendingAudio; // 링에서 꺼냈지만 아직 같이 나갈 프레임을 기다리는 오디오
+            double PtsOriginTime = -1.0;    // 비디오 PTS 0의 캡처 시각 (프레임마다 갱신) - 오디오 PTS도 여기서 셈
+            double LastPcrTime = -1.0;      // Muxer.GetLastPcr()를 먹싱한 시각 - 프레임 사이 PCR은 여기서 흘러간 만큼
+            double LastStatsTime = 0.0;
+            double LastLinkStatsTime = 0.0;
+            double LastLatencyLogTime = 0.0;
+
+            // 클라이언트 통계 스냅샷
+            mutable std::mutex ClientStatsLock;
+            std::vector<FClientStats> ClientStatsSnapshot;
+            FLinkStats LinkStatsSnapshot; // ClientStatsLock 보호
+
+            // 전송 큐 정책으로 버린 프레임을 파이프라인 통계에 반영 (생산자 스레드)
+            void AddDroppedFrame();
+        };
+    };
+}
@@ -0,0 +1,105 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CineSRTCore.h"
+#include "CineSRTFrame.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CineSRT
+{
+    struct FVideoEncoderConfig
+    {
+        int32 Width = 1920;
+        int32 Height = 1080;
+        int32 FPS = 30;
+        int32 Bitrate = 8000; // Kbps
+        int32 JpegQuality = 85;
+        int32 KeyframeInterval = 60;
+        std::string Preset = "fast";
+        int32 ThreadCount = 4; // 인트라 코덱은 프레임 병렬 워커 수, H.264는 슬라이스 스레드 수
+        int32 SliceRows = 0; // >0: 이 행 수마다 나온 비트스트림을 바로 내보냄 (MJPEG 리스타트 구간, 16의 배수로 올림). 0 = 프레임 단위
+    };
+
+    // 인코더 인터페이스
+    class IVideoEncoder
+    {
+    public:
+        virtual ~IVideoEncoder() = default;
+        virtual bool Initialize() = 0;
+        /**
+         * Encodes one tightly packed BGRA8 frame of the configured size.
+         * Fills OutFrame.Data and OutFrame.bKeyframe (and ConvertSeconds when the pixels are converted first);
+         * timing and format are set by the caller (OutFrame.CaptureTime is already set on entry when known, for rate control).
+         * OutFrame.Data is caller-owned and may already hold capacity; encoders overwrite it in place.
+         */
+        virtual bool EncodeFrame(const uint8* BGRA, int32 NumBytes, FEncodedFrame& OutFrame) = 0;
+        /** Receives the bitstream so far, always from its first byte, each time another slice of the frame is finished. */
+        using FSliceCallback = TCallbackRef<void(const uint8* /*Data*/, int32 /*Size*/)>;
+        /** True when EncodeFrameSliced reports output slice by slice (the codec and its config support it). */
+        virtual bool SupportsSliceOutput() const { return false; }
+        /**
+         * EncodeFrame that hands the bitstream out as it is produced instead of writing OutFrame.Data, which the
+         * caller may already be streaming. OutFrame.bKeyframe is final before the first callback; the last
+         * callback carries the whole frame, and its bytes stay valid until the next call into the encoder.
+         * Only called when SupportsSliceOutput() is true.
+         */
+        virtual bool EncodeFrameSliced(const uint8* /*BGRA*/, int32 /*NumBytes*/, FEncodedFrame& /*OutFrame*/, FSliceCallback /*OnSlice*/) { return false; }
+        /** Changes the target bitrate (Kbps) and JPEG quality between frames without reinitializing. */
+        virtual bool SetRate(int32 Bitrate, int32 JpegQuality) = 0;
+        /** Makes the next encoded frame a keyframe (with its parameter sets). Intra-only codecs ignore it. */
+        virtual void RequestKeyframe() {}
+        virtual void Shutdown() = 0;
+        virtual EEncodingFormat GetFormat() const = 0;
+        /** True when every frame is coded on its own, so separate instances can encode frames in parallel. */
+        virtual bool IsIntraOnly() const { return false; }
+    };
+
+    /** Creates an uninitialized encoder for Format, or nullptr when the format has no backend. */
+    CINESRTCORE_API std::unique_ptr<IVideoEncoder> CreateVideoEncoder(EEncodingFormat Format, const FVideoEncoderConfig& Config);
+
+    struct FMJPEGCompressor;
+
+    class CINESRTCORE_API FMJPEGEncoder : public IVideoEncoder
+    {
+    public:
+        explicit FMJPEGEncoder(const FVideoEncoderConfig& InConfig);
+        virtual ~FMJPEGEncoder();
+        virtual bool Initialize() override;
+        virtual bool EncodeFrame(const uint8* BGRA, int32 NumBytes, FEncodedFrame& OutFrame) override;
+        virtual bool SupportsSliceOutput() const override { return Config.SliceRows > 0; }
+        virtual bool EncodeFrameSliced(const uint8* BGRA, int32 NumBytes, FEncodedFrame& OutFrame, FSliceCallback OnSlice) override;
+        virtual bool SetRate(int32 Bitrate, int32 JpegQuality) override;
+        virtual void Shutdown() override;
+        virtual EEncodingFormat GetFormat() const override { return EEncodingFormat::MJPEG; }
+        virtual bool IsIntraOnly() const override { return true; }
+    private:
+        FVideoEncoderConfig Config;
+        // 프레임마다 새로 만들지 않고 Initialize에서 한 번 생성해 재사용 (libjpeg-turbo)
+        std::unique_ptr<FMJPEGCompressor> Compressor;
+
+        bool Compress(const uint8* BGRA, int32 NumBytes, IVideoEncoder::FSliceCallback* OnSlice, std::size_t& OutSize);
+    };
+
+    class CINESRTCORE_API FH264Encoder : public IVideoEncoder
+    {
+    public:
+        explicit FH264Encoder(const FVideoEncoderConfig& InConfig);
+        virtual ~FH264Encoder();
+        virtual bool Initialize() override;
+        virtual bool EncodeFrame(const uint8* BGRA, int32 NumBytes, FEncodedFrame& OutFrame) override;
+        virtual bool SetRate(int32 Bitrate, int32 JpegQuality) override;
+        virtual void RequestKeyframe() override;
+        virtual void Shutdown() override;
+        virtual EEncodingFormat GetFormat() const override { return EEncodingFormat::H264; }
+    private:
+        FVideoEncoderConfig Config;
+        void* EncoderHandle = nullptr; // ISVCEncoder*
+        std::vector<uint8> PlanarBuffer; // I420 input reused across frames
+        int64 FrameIndex = 0;
+        double FirstCaptureTime = 0.0;
+    };
+}
@@ -2,6 +2,7 @@
 
 #include "CineSRTStream.h"
 #include "CineSRTStreamSettings.h"
+#include "CineSRTTransmitter.h"
 
 #if WITH_EDITOR
 #include "ISettingsModule.h"
@@ -14,13 +15,22 @@ DEFINE_LOG_CATEGORY(LogCineSRT);
 void FCineSRTStreamModule::StartupModule()
 {
     UE_LOG(LogCineSRT, Log, TEXT("CineSRTStream module starting up"));
-    
+
+    // SRT 라이브러리는 모듈 수명 동안 한 번만 초기화 - 스트림 시작마다 srt_startup/srt_cleanup을 반복하지 않음
+    // (실패하면 코어가 로그를 남기고, 송신기가 시작할 때 다시 시도함)
+    bSRTStarted = CineSRT::FTransmitter::StartupSRT();
 }
 
 void FCineSRTStreamModule::ShutdownModule()
 {
     UE_LOG(LogCineSRT, Log, TEXT("CineSRTStream module shutting down"));
-    
+
+    // 아직 살아 있는 송신기가 있으면 그쪽 참조가 남아 마지막 송신기가 닫힐 때 정리됨
+    if (bSRTStarted)
+    {
+        CineSRT::FTransmitter::ShutdownSRT();
+        bSRTStarted = false;
+    }
 }
 
 #undef LOCTEXT_NAMESPACE
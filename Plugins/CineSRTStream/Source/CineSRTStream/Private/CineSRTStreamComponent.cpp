@@ -3,22 +3,114 @@
 #include "CineSRTStreamComponent.h"
 #include "CineSRTStream.h"
 #include "CineSRTStreamSettings.h"
+#include "CineSRTStreamSubsystem.h"
 #include "SRTEncoder.h"
 #include "SRTTransmitter.h"
+#include "SRTFrameReadback.h"
+#include "SRTAudioCapture.h"
+#include "CineSRTBitrateController.h"
+#include "CineSRTPipelineStats.h"
+#include "CineSRTRecorder.h"
+#include "Async/Async.h"
 #include "Camera/CameraComponent.h"
 #include "CineCameraComponent.h"
 #include "Components/SceneCaptureComponent2D.h"
 #include "Engine/TextureRenderTarget2D.h"
 #include "Kismet/GameplayStatics.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
 #include "Engine/Engine.h"
 #include "RenderingThread.h"
 #include "RHI.h"
 #include "HAL/RunnableThread.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Encoder Output Queue"), STAT_CineSRT_EncoderOutputQueue, STATGROUP_CineSRT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Encoder Output Queue High Water"), STAT_CineSRT_EncoderOutputHighWater, STATGROUP_CineSRT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Encoder Output Dropped"), STAT_CineSRT_EncoderOutputDropped, STATGROUP_CineSRT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Adaptive Bitrate Rung"), STAT_CineSRT_BitrateRung, STATGROUP_CineSRT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Adaptive Bitrate (Kbps)"), STAT_CineSRT_AdaptiveBitrate, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Link RTT (ms)"), STAT_CineSRT_LinkRtt, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Link Bandwidth (Mbps)"), STAT_CineSRT_LinkBandwidth, STATGROUP_CineSRT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Link Send Buffer (ms)"), STAT_CineSRT_LinkSendBuffer, STATGROUP_CineSRT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Link Packets Dropped"), STAT_CineSRT_LinkDropped, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Cadence Error p50 (ms)"), STAT_CineSRT_CadenceP50, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Cadence Error p95 (ms)"), STAT_CineSRT_CadenceP95, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Cadence Error p99 (ms)"), STAT_CineSRT_CadenceP99, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Capture p50 (ms)"), STAT_CineSRT_CaptureP50, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Capture p95 (ms)"), STAT_CineSRT_CaptureP95, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Capture p99 (ms)"), STAT_CineSRT_CaptureP99, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Readback p50 (ms)"), STAT_CineSRT_ReadbackP50, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Readback p95 (ms)"), STAT_CineSRT_ReadbackP95, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Readback p99 (ms)"), STAT_CineSRT_ReadbackP99, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Convert p50 (ms)"), STAT_CineSRT_ConvertP50, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Convert p95 (ms)"), STAT_CineSRT_ConvertP95, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Convert p99 (ms)"), STAT_CineSRT_ConvertP99, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Encode p50 (ms)"), STAT_CineSRT_EncodeP50, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Encode p95 (ms)"), STAT_CineSRT_EncodeP95, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Encode p99 (ms)"), STAT_CineSRT_EncodeP99, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Queue Wait p50 (ms)"), STAT_CineSRT_QueueWaitP50, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Queue Wait p95 (ms)"), STAT_CineSRT_QueueWaitP95, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Queue Wait p99 (ms)"), STAT_CineSRT_QueueWaitP99, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mux p50 (ms)"), STAT_CineSRT_MuxP50, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mux p95 (ms)"), STAT_CineSRT_MuxP95, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mux p99 (ms)"), STAT_CineSRT_MuxP99, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Send p50 (ms)"), STAT_CineSRT_SendP50, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Send p95 (ms)"), STAT_CineSRT_SendP95, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Send p99 (ms)"), STAT_CineSRT_SendP99, STATGROUP_CineSRT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pipeline Frames Dropped"), STAT_CineSRT_PipelineDropped, STATGROUP_CineSRT);
+
+CSV_DEFINE_CATEGORY(CineSRT, true);
+
+// 시뮬캐스트 렌디션 하나: 주 스트림의 캡처 프레임을 참조로 받아 자기 인코더 스레드에서 축소 후 인코딩
+struct FSRTRenditionStream
+{
+    FString StreamID;
+    TSharedPtr<FSRTEncoder> Encoder;
+    TSharedPtr<FSRTTransmitter> Transmitter;
+    std::shared_ptr<CineSRT::FPipelineStats> PipelineStats;
+    
+    // 프리셋 FPS로 솎아내기 - 리드백 싱크(렌더 스레드) 또는 동기 캡처(게임 스레드) 한 곳에서만 접근
+    double FrameInterval = 0.0;
+    double NextFrameTime = 0.0;
+    
+    void SubmitFrame(const FSRTFrameRef& Frame)
+    {
+        if (Frame->CaptureTime + FrameInterval * 0.25 < NextFrameTime)
+        {
+            return;
+        }
+        NextFrameTime = FMath::Max(NextFrameTime + FrameInterval, Frame->CaptureTime);
+        PipelineStats->Add(CineSRT::EPipelineCounter::FramesCaptured);
+        Encoder->SubmitFrame(Frame);
+    }
+};
+
+static FString GetRenditionSuffix(ESRTStreamQuality Quality)
+{
+    switch (Quality)
+    {
+        case ESRTStreamQuality::Preview_480p:
+            return TEXT("_480p");
+        case ESRTStreamQuality::HD_720p:
+            return TEXT("_720p");
+        case ESRTStreamQuality::HD_1080p:
+            return TEXT("_1080p");
+        case ESRTStreamQuality::HD_1080p60:
+            return TEXT("_1080p60");
+        case ESRTStreamQuality::UHD_4K:
+            return TEXT("_2160p");
+        default:
+            return TEXT("_custom");
+    }
+}
 
 USRTStreamComponent::USRTStreamComponent()
 {
     PrimaryComponentTick.bCanEverTick = true;
     PrimaryComponentTick.bStartWithTickEnabled = false;
+    // Capture what this game frame will render, after cameras and animation have moved
+    PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
     
     // Load default settings
     const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
@@ -35,8 +127,11 @@ void USRTStreamComponent::BeginPlay()
 {
     Super::BeginPlay();
     
-    UE_LOG(LogCineSRT, Log, TEXT("SRT Stream Component BeginPlay - StreamID: %s, Port: %d"), 
-        *StreamID, StreamPort);
+    UE_LOG(LogCineSRT, Log, TEXT("SRT Stream Component BeginPlay - StreamID: %s, URL: %s"), 
+        *StreamID, *GetStreamURL());
+    
+    PipelineStats = std::make_shared<CineSRT::FPipelineStats>();
+    bEndingPlay = false;
     
     // Find camera
     FindCameraComponent();
@@ -55,28 +150,65 @@ void USRTStreamComponent::BeginPlay()
     // Initialize encoder and transmitter
     InitializeEncoder();
     InitializeTransmitter();
+    InitializeRenditions();
+    InitializeBitrateController();
+    InitializeCapture();
     
-    // Auto start if enabled
+    // Auto start if enabled; otherwise bind the listener now so StartStreaming only has to start sending
     if (bAutoStartStream)
     {
         StartStreaming();
     }
+    else
+    {
+        PrewarmTransmitter();
+    }
 }
 
 void USRTStreamComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+    bEndingPlay = true;
     StopStreaming();
     
+    // Make sure the render thread no longer delivers frames into this component
+    if (FrameReadback)
+    {
+        FrameReadback->Reset();
+        FrameReadback.Reset();
+    }
+    
     // Cleanup
+    PendingRenderTarget = nullptr;
     if (SceneCaptureComponent)
     {
         SceneCaptureComponent->DestroyComponent();
         SceneCaptureComponent = nullptr;
     }
     
-    // Cleanup encoder and transmitter
+    // Cleanup encoder and transmitter (rendition streams first, they sit on the main stream's listener).
+    // Once its stream is removed the transmitter thread no longer calls back, so the callbacks that reach
+    // across (frame sink, keyframe requests, link stats) can go and Reset() really destroys the objects
+    for (const TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>& Rendition : RenditionStreams)
+    {
+        Rendition->Transmitter->StopTransmission();
+        Rendition->Transmitter->OnKeyframeRequest.Unbind();
+        Rendition->Encoder->SetFrameSink(nullptr);
+    }
+    if (Transmitter)
+    {
+        Transmitter->StopTransmission();
+        Transmitter->OnKeyframeRequest.Unbind();
+        Transmitter->OnLinkStats.Unbind();
+    }
+    if (Encoder)
+    {
+        Encoder->SetFrameSink(nullptr);
+    }
+    RenditionStreams.Reset();
     Encoder.Reset();
+    AudioCapture.Reset();
     Transmitter.Reset();
+    Recorder.Reset();
     
     Super::EndPlay(EndPlayReason);
 }
@@ -85,23 +217,46 @@ void USRTStreamComponent::TickComponent(float DeltaTime, ELevelTick TickType,
     FActorComponentTickFunction* ThisTickFunction)
 {
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-    static int TickCount = 0;
-    if (TickCount++ % 30 == 0)
-    {
-        UE_LOG(LogCineSRT, Warning, TEXT("Tick running, streaming: %s"), bIsStreaming ? TEXT("YES") : TEXT("NO"));
-    }
     
     if (!bIsStreaming || !SceneCaptureComponent)
     {
         return;
     }
     
-    TimeSinceLastCapture += DeltaTime;
+    // Deliver readbacks the GPU finished since the last tick
+    if (FrameReadback)
+    {
+        FrameReadback->PollCompleted();
+    }
     
-    if (TimeSinceLastCapture >= CaptureInterval)
+    // Frames captured from here on have the new size; the encoder routes them to the new encoder set
+    if (PendingRenderTarget && Encoder && !Encoder->IsReconfiguring())
     {
-        CaptureFrame();
-        TimeSinceLastCapture -= CaptureInterval;
+        SwapPendingRenderTarget();
+    }
+    
+    // Encoded frames go straight from the encoder threads to the transmitter; the queue must stay empty
+    if (Encoder)
+    {
+        const FSRTEncoder::FEncoderStats EncoderStats = Encoder->GetStats();
+        SET_DWORD_STAT(STAT_CineSRT_EncoderOutputQueue, EncoderStats.OutputQueueDepth);
+        SET_DWORD_STAT(STAT_CineSRT_EncoderOutputHighWater, EncoderStats.OutputQueueHighWater);
+        SET_DWORD_STAT(STAT_CineSRT_EncoderOutputDropped, EncoderStats.OutputFramesDropped);
+    }
+    
+    ReportPipelineStats();
+    
+    // Slots come from the cadence clock, not DeltaTime: the game frame nearest each slot captures it and is stamped
+    // with the slot's exact time, frames between slots capture nothing, and the encoders fill slots a long frame missed
+    const CineSRT::FFrameCadence::FTick Tick = CaptureCadence.Poll(CineSRT::GetTimeSeconds());
+    if (Tick.bCapture)
+    {
+        PipelineStats->Record(CineSRT::EPipelineStage::Cadence, FMath::Abs(Tick.Error));
+        if (Tick.MissedSlots > 0)
+        {
+            PipelineStats->Add(CineSRT::EPipelineCounter::SlotsMissed, Tick.MissedSlots);
+        }
+        CaptureFrame(Tick.SlotTime);
     }
 }
 
@@ -132,10 +287,7 @@ void USRTStreamComponent::CreateRenderTarget()
     
     FIntPoint Resolution = GetTargetResolution();
     
-    // Create render target
-    RenderTarget = NewObject<UTextureRenderTarget2D>(this);
-    RenderTarget->InitAutoFormat(Resolution.X, Resolution.Y);
-    RenderTarget->UpdateResourceImmediate(true);
+    RenderTarget = CreateCaptureTarget(Resolution, true);
     
     // Create scene capture component
     SceneCaptureComponent = NewObject<USceneCaptureComponent2D>(GetOwner());
@@ -154,16 +306,60 @@ void USRTStreamComponent::CreateRenderTarget()
     SceneCaptureComponent->bUseCustomProjectionMatrix = false;
 }
 
-void USRTStreamComponent::InitializeEncoder()
+UTextureRenderTarget2D* USRTStreamComponent::CreateCaptureTarget(const FIntPoint& Resolution, bool bImmediate)
 {
-    FSRTEncoder::FEncoderSettings EncoderSettings;
-    EncoderSettings.Width = GetTargetResolution().X;
-    EncoderSettings.Height = GetTargetResolution().Y;
-    EncoderSettings.FPS = TargetFPS;
-    EncoderSettings.Bitrate = Bitrate;
-    EncoderSettings.EncoderType = EncoderType;
+    // BGRA8 so readback bytes can go straight to the encoder
+    UTextureRenderTarget2D* Target = NewObject<UTextureRenderTarget2D>(this);
+    Target->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA8;
+    Target->InitAutoFormat(Resolution.X, Resolution.Y);
+    if (bImmediate)
+    {
+        Target->UpdateResourceImmediate(true);
+    }
+    else
+    {
+        // The RHI texture is created on the render thread, ahead of any capture queued after this
+        Target->UpdateResource();
+    }
+    return Target;
+}
+
+void USRTStreamComponent::SwapPendingRenderTarget()
+{
+    if (!Encoder->CanEncode(PendingRenderTarget->SizeX, PendingRenderTarget->SizeY))
+    {
+        // The encoder could not be rebuilt for the new size; keep streaming at the old one
+        UE_LOG(LogCineSRT, Error, TEXT("No encoder for %dx%d, keeping the %dx%d render target"),
+            PendingRenderTarget->SizeX, PendingRenderTarget->SizeY, RenderTarget->SizeX, RenderTarget->SizeY);
+        PendingRenderTarget = nullptr;
+        return;
+    }
     
-    Encoder = MakeShared<FSRTEncoder>(EncoderSettings);
+    // Captures already queued on the render thread still read the old target; GC releases it after them
+    SceneCaptureComponent->TextureTarget = PendingRenderTarget;
+    RenderTarget = PendingRenderTarget;
+    PendingRenderTarget = nullptr;
+    
+    UE_LOG(LogCineSRT, Log, TEXT("Capture switched to %dx%d"), RenderTarget->SizeX, RenderTarget->SizeY);
+}
+
+// 공유 리스너 모드일 때만 서브시스템을 씀
+static UCineSRTStreamSubsystem* GetSharedStreamSubsystem()
+{
+    return GEngine && UCineSRTStreamSubsystem::IsSharedListenerEnabled() ? GEngine->GetEngineSubsystem<UCineSRTStreamSubsystem>() : nullptr;
+}
+
+void USRTStreamComponent::InitializeEncoder()
+{
+    Encoder = MakeShared<FSRTEncoder>(BuildEncoderSettings());
+    Encoder->SetPipelineStats(PipelineStats);
+    if (UCineSRTStreamSubsystem* Subsystem = GetSharedStreamSubsystem())
+    {
+        // Every camera encodes on the same bounded thread set instead of starting its own workers
+        Encoder->SetScheduler(Subsystem->GetEncodeScheduler());
+    }
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    Encoder->SetWarmUp(Settings && Settings->bPrewarmPipeline);
     
     if (!Encoder->Initialize())
     {
@@ -182,7 +378,37 @@ void USRTStreamComponent::InitializeTransmitter()
     TransmitterSettings.InputBW = 0; // Unlimited
     TransmitterSettings.Overhead = 25; // 25%
     
-    Transmitter = MakeShared<FSRTTransmitter>(TransmitterSettings);
+    if (const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>())
+    {
+        TransmitterSettings.QueueCapacity = Settings->TransmitQueueCapacity;
+        TransmitterSettings.OverflowPolicy = Settings->TransmitOverflowPolicy;
+        TransmitterSettings.BlockTimeoutMs = Settings->TransmitBlockTimeoutMs;
+        TransmitterSettings.MaxClients = Settings->MaxClients;
+        TransmitterSettings.ClientQueueCapacity = Settings->ClientQueueCapacity;
+        TransmitterSettings.SlowClientTimeoutMs = Settings->SlowClientTimeoutMs;
+        TransmitterSettings.LinkStatsPeriodMs = Settings->LinkStatsPeriodMs;
+        TransmitterSettings.JoinCacheMaxBytes = Settings->JoinCacheMaxMB * 1024 * 1024;
+        TransmitterSettings.bKeyframeOnJoin = Settings->bKeyframeOnJoin;
+    }
+    
+    CineSRT::FRecorder::FSettings RecorderSettings;
+    if (const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>())
+    {
+        RecorderSettings.QueueCapacity = Settings->RecordingQueueFrames;
+        RecorderSettings.MaxBacklogBytes = (int64)Settings->RecordingBacklogMB * 1024 * 1024;
+        RecorderSettings.WriteBlockBytes = Settings->RecordingWriteBlockMB * 1024 * 1024;
+    }
+    Recorder = MakeShared<CineSRT::FRecorder, ESPMode::ThreadSafe>(RecorderSettings);
+    
+    if (UCineSRTStreamSubsystem* Subsystem = GetSharedStreamSubsystem())
+    {
+        Transmitter = Subsystem->CreateTransmitter(StreamID, TransmitterSettings);
+    }
+    else
+    {
+        Transmitter = MakeShared<FSRTTransmitter>(TransmitterSettings);
+    }
+    Transmitter->SetPipelineStats(PipelineStats);
     
     // Bind delegates
     Transmitter->OnFrameTransmitted.BindLambda([this](const TArray<uint8>& FrameData)
@@ -201,6 +427,276 @@ void USRTStreamComponent::InitializeTransmitter()
     {
         OnStreamingErrorInternal(Error);
     });
+    
+    // Encoder threads hand frames to the transmitter as soon as they are released in order,
+    // so delivery no longer waits for the next capture tick. The recorder only queues a reference
+    // to the same frame, so recording never holds up the live path
+    if (Encoder)
+    {
+        TSharedPtr<FSRTTransmitter> TransmitterRef = Transmitter;
+        TSharedPtr<CineSRT::FRecorder, ESPMode::ThreadSafe> RecorderRef = Recorder;
+        Encoder->SetFrameSink([TransmitterRef, RecorderRef](FSRTEncodedFrameRef EncodedFrame)
+        {
+            RecorderRef->RecordFrame(EncodedFrame);
+            TransmitterRef->TransmitFrame(MoveTemp(EncodedFrame));
+        });
+        
+        // A receiver joined with no cached GOP to start from: the next encoded frame becomes an IDR.
+        // Weak: the encoder's sink already holds the transmitter, a strong reference back would keep both alive
+        TWeakPtr<FSRTEncoder> WeakEncoder = Encoder;
+        Transmitter->OnKeyframeRequest.BindLambda([WeakEncoder]()
+        {
+            if (TSharedPtr<FSRTEncoder> EncoderRef = WeakEncoder.Pin())
+            {
+                EncoderRef->RequestKeyframe();
+            }
+        });
+    }
+    
+    // Audio goes to the main stream only; the transmitter muxes it between the video frames it belongs with
+    AudioCapture.Reset();
+    const UCineSRTStreamSettings* StreamSettings = GetDefault<UCineSRTStreamSettings>();
+    if (StreamSettings && StreamSettings->bStreamAudio)
+    {
+        FSRTAudioCapture::FAudioCaptureSettings AudioSettings;
+        AudioSettings.Submix = StreamSettings->AudioSubmix;
+        AudioSettings.NumChannels = StreamSettings->AudioChannels;
+        AudioSettings.BitsPerSample = StreamSettings->AudioBitsPerSample;
+        AudioSettings.PacketMs = StreamSettings->AudioPacketMs;
+        AudioSettings.SyncOffsetMs = StreamSettings->AudioSyncOffsetMs;
+        AudioCapture = MakeShared<FSRTAudioCapture, ESPMode::ThreadSafe>(AudioSettings);
+        
+        TSharedPtr<FSRTTransmitter> TransmitterRef = Transmitter;
+        AudioCapture->SetSink([TransmitterRef](CineSRT::FEncodedAudioRef Packet)
+        {
+            TransmitterRef->TransmitAudio(MoveTemp(Packet));
+        });
+    }
+}
+
+void USRTStreamComponent::InitializeRenditions()
+{
+    RenditionStreams.Reset();
+    if (!Encoder || !Encoder->IsInitialized() || !Transmitter)
+    {
+        return;
+    }
+    
+    const FIntPoint CaptureResolution = GetTargetResolution();
+    UCineSRTStreamSubsystem* Subsystem = GetSharedStreamSubsystem();
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    for (const FSRTRendition& Rendition : Renditions)
+    {
+        const FString RenditionID = StreamID + (Rendition.StreamIDSuffix.IsEmpty() ? GetRenditionSuffix(Rendition.Quality) : Rendition.StreamIDSuffix);
+        if (Rendition.Quality == ESRTStreamQuality::Custom)
+        {
+            UE_LOG(LogCineSRT, Warning, TEXT("Rendition %s skipped: Custom quality has no preset size"), *RenditionID);
+            continue;
+        }
+        
+        FSRTEncoder::FEncoderSettings RenditionSettings = BuildEncoderSettings();
+        RenditionSettings.StreamQuality = Rendition.Quality;
+        TSharedPtr<FSRTEncoder> RenditionEncoder = MakeShared<FSRTEncoder>(RenditionSettings);
+        
+        // Downscaling only: an upscaled rendition costs more than the stream it is derived from
+        if (RenditionEncoder->GetSettings().Width > CaptureResolution.X || RenditionEncoder->GetSettings().Height > CaptureResolution.Y)
+        {
+            UE_LOG(LogCineSRT, Warning, TEXT("Rendition %s skipped: %dx%d is larger than the %dx%d capture"), *RenditionID,
+                RenditionEncoder->GetSettings().Width, RenditionEncoder->GetSettings().Height, CaptureResolution.X, CaptureResolution.Y);
+            continue;
+        }
+        
+        TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe> RenditionStream = MakeShared<FSRTRenditionStream, ESPMode::ThreadSafe>();
+        RenditionStream->StreamID = RenditionID;
+        RenditionStream->PipelineStats = std::make_shared<CineSRT::FPipelineStats>();
+        RenditionStream->Encoder = RenditionEncoder;
+        RenditionEncoder->SetPipelineStats(RenditionStream->PipelineStats);
+        RenditionEncoder->SetScaleInput(true);
+        if (Subsystem)
+        {
+            RenditionEncoder->SetScheduler(Subsystem->GetEncodeScheduler());
+        }
+        RenditionEncoder->SetWarmUp(Settings && Settings->bPrewarmPipeline);
+        if (!RenditionEncoder->Initialize())
+        {
+            UE_LOG(LogCineSRT, Error, TEXT("Failed to initialize the encoder for rendition %s"), *RenditionID);
+            continue;
+        }
+        if (Rendition.Bitrate > 0)
+        {
+            RenditionEncoder->SetRate(Rendition.Bitrate, RenditionEncoder->GetSettings().JpegQuality);
+        }
+        // Never faster than the stream itself; the capture cadence is the upper bound anyway
+        RenditionStream->FrameInterval = 1.0 / FMath::Min(RenditionEncoder->GetSettings().FPS, TargetFPS);
+        
+        // Sibling stream on the main stream's listener: its own port when standalone, the shared one otherwise
+        RenditionStream->Transmitter = MakeShared<FSRTTransmitter>(Transmitter->GetListener(), RenditionID);
+        RenditionStream->Transmitter->SetPipelineStats(RenditionStream->PipelineStats);
+        TSharedPtr<FSRTTransmitter> TransmitterRef = RenditionStream->Transmitter;
+        RenditionEncoder->SetFrameSink([TransmitterRef](FSRTEncodedFrameRef EncodedFrame)
+        {
+            TransmitterRef->TransmitFrame(MoveTemp(EncodedFrame));
+        });
+        // Weak, like the main stream's: the sink above already holds the transmitter
+        TWeakPtr<FSRTEncoder> WeakRenditionEncoder = RenditionEncoder;
+        RenditionStream->Transmitter->OnKeyframeRequest.BindLambda([WeakRenditionEncoder]()
+        {
+            if (TSharedPtr<FSRTEncoder> EncoderRef = WeakRenditionEncoder.Pin())
+            {
+                EncoderRef->RequestKeyframe();
+            }
+        });
+        
+        RenditionStreams.Add(RenditionStream);
+        UE_LOG(LogCineSRT, Log, TEXT("Rendition %dx%d @ %d fps on %s"), RenditionEncoder->GetSettings().Width,
+            RenditionEncoder->GetSettings().Height, FMath::Min(RenditionEncoder->GetSettings().FPS, TargetFPS), *MakeStreamURL(RenditionID));
+    }
+}
+
+void USRTStreamComponent::InitializeBitrateController()
+{
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    if (!Settings || !Settings->bAdaptiveBitrate || !Encoder || !Transmitter)
+    {
+        return;
+    }
+    
+    CineSRT::FBitrateController::FSettings ControllerSettings;
+    ControllerSettings.LatencyMs = 120; // matches InitializeTransmitter
+    ControllerSettings.DowngradeBufferRatio = Settings->DowngradeBufferRatio;
+    ControllerSettings.UpgradeHoldSeconds = Settings->UpgradeHoldSeconds;
+    bLadderChangesQuality = false;
+    for (const FSRTBitrateRung& Source : Settings->BitrateLadder)
+    {
+        CineSRT::FBitrateRung Rung;
+        Rung.Bitrate = Source.Bitrate;
+        Rung.JpegQuality = Source.JpegQuality;
+        Rung.Level = Source.bChangeQuality ? (int32)Source.Quality : -1;
+        bLadderChangesQuality |= Source.bChangeQuality;
+        ControllerSettings.Ladder.push_back(Rung);
+    }
+    if (ControllerSettings.Ladder.empty())
+    {
+        // The encoder has already resolved the quality preset into a bitrate and JPEG quality
+        CineSRT::FBitrateRung Top;
+        Top.Bitrate = Encoder->GetSettings().Bitrate;
+        Top.JpegQuality = Encoder->GetSettings().JpegQuality;
+        ControllerSettings.Ladder = CineSRT::FBitrateController::MakeDefaultLadder(Top);
+    }
+    BaseStreamQuality = StreamQuality;
+    BitrateController = MakeShared<CineSRT::FBitrateController, ESPMode::ThreadSafe>(ControllerSettings);
+    
+    // Runs on the transmitter thread every LinkStatsPeriodMs; the transmitter stops that thread before it is destroyed.
+    // The encoder is held weakly: its sink holds the transmitter, and EndPlay unbinds this before releasing both
+    TSharedPtr<CineSRT::FBitrateController, ESPMode::ThreadSafe> Controller = BitrateController;
+    TWeakPtr<FSRTEncoder> WeakEncoder = Encoder;
+    TWeakObjectPtr<USRTStreamComponent> WeakThis(this);
+    const bool bChangesQuality = bLadderChangesQuality;
+    Transmitter->OnLinkStats.BindLambda([Controller, WeakEncoder, WeakThis, bChangesQuality](const FSRTTransmitter::FLinkStats& Link)
+    {
+        SET_FLOAT_STAT(STAT_CineSRT_LinkRtt, (float)Link.RttMs);
+        SET_FLOAT_STAT(STAT_CineSRT_LinkBandwidth, (float)Link.BandwidthMbps);
+        SET_DWORD_STAT(STAT_CineSRT_LinkSendBuffer, Link.SendBufferMs);
+        INC_DWORD_STAT_BY(STAT_CineSRT_LinkDropped, Link.PacketsDropped);
+        
+        if (!Controller->Update(Link, CineSRT::GetTimeSeconds()))
+        {
+            return;
+        }
+        
+        const CineSRT::FBitrateRung& Rung = Controller->GetCurrentRung();
+        SET_DWORD_STAT(STAT_CineSRT_BitrateRung, Controller->GetCurrentRungIndex());
+        SET_DWORD_STAT(STAT_CineSRT_AdaptiveBitrate, Rung.Bitrate);
+        if (!bChangesQuality)
+        {
+            if (TSharedPtr<FSRTEncoder> EncoderRef = WeakEncoder.Pin())
+            {
+                EncoderRef->SetRate(Rung.Bitrate, Rung.JpegQuality);
+            }
+            return;
+        }
+        
+        // Resolution changes touch the render target, so they go through the game thread
+        const int32 Level = Rung.Level;
+        const int32 RungBitrate = Rung.Bitrate;
+        const int32 RungJpegQuality = Rung.JpegQuality;
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, Level, RungBitrate, RungJpegQuality]()
+        {
+            if (USRTStreamComponent* This = WeakThis.Get())
+            {
+                This->ApplyBitrateRung_GameThread(Level, RungBitrate, RungJpegQuality);
+            }
+        });
+    });
+    
+    UE_LOG(LogCineSRT, Log, TEXT("Adaptive bitrate enabled: %d rungs, %d -> %d Kbps"), BitrateController->GetNumRungs(),
+        ControllerSettings.Ladder.front().Bitrate, ControllerSettings.Ladder.back().Bitrate);
+}
+
+void USRTStreamComponent::ApplyBitrateRung_GameThread(int32 Level, int32 RungBitrate, int32 RungJpegQuality)
+{
+    if (!bIsStreaming || !Encoder)
+    {
+        return;
+    }
+    
+    // Rungs without their own quality go back to the one the stream was configured with
+    SetStreamQuality(Level >= 0 ? static_cast<ESRTStreamQuality>(Level) : BaseStreamQuality);
+    
+    // The quality preset resets the encoder's rate; the rung's rate wins
+    Encoder->SetRate(RungBitrate, RungJpegQuality);
+}
+
+void USRTStreamComponent::InitializeCapture()
+{
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    const int32 CaptureBufferCount = Settings ? Settings->CaptureBufferCount : 3;
+    
+    // Enough frames for every readback slot plus a full encoder input queue; renditions hold a
+    // captured frame until their encoder thread has scaled it, and static-frame detection keeps the last encoded one.
+    // Prewarmed pools are committed now so the first frames do not page-fault their buffers in
+    FramePool = std::make_shared<FSRTFramePool>();
+    const FIntPoint Resolution = GetTargetResolution();
+    FramePool->Preallocate(CaptureBufferCount + 8 + 2 * RenditionStreams.Num(), Resolution.X, Resolution.Y, Settings && Settings->bPrewarmPipeline);
+    
+    if (!Settings || !Settings->bUseAsyncCapture)
+    {
+        return;
+    }
+    
+    FrameReadback = MakeShared<FSRTFrameReadback, ESPMode::ThreadSafe>(CaptureBufferCount, FramePool);
+    FrameReadback->SetPipelineStats(PipelineStats);
+    
+    // Runs on the render thread; SubmitFrame is thread safe and the sink is cleared in EndPlay
+    TSharedPtr<FSRTEncoder> EncoderRef = Encoder;
+    TArray<TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>> RenditionRefs = RenditionStreams;
+    FrameReadback->SetSink([EncoderRef, RenditionRefs](FSRTFrameRef Frame)
+    {
+        // Every rendition shares the captured pixels; the main encoder takes the last reference
+        for (const TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>& Rendition : RenditionRefs)
+        {
+            Rendition->SubmitFrame(Frame);
+        }
+        if (EncoderRef)
+        {
+            EncoderRef->SubmitFrame(MoveTemp(Frame));
+        }
+    });
+}
+
+void USRTStreamComponent::PrewarmTransmitter()
+{
+    // 리스너를 미리 열어 두면 수신측이 StartStreaming 전에 핸드셰이크를 끝내고 첫 프레임부터 받음
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    if (!Transmitter || bIsStreaming || !Settings || !Settings->bPrewarmPipeline)
+    {
+        return;
+    }
+    if (!Transmitter->Prewarm())
+    {
+        // StartStreaming이 다시 시도하고 실패를 알림
+        UE_LOG(LogCineSRT, Warning, TEXT("Could not prepare the SRT listener for %s ahead of streaming"), *GetStreamURL());
+    }
 }
 
 void USRTStreamComponent::StartStreaming()
@@ -232,6 +728,22 @@ void USRTStreamComponent::StartStreaming()
         return;
     }
     
+    // Every stream starts on the top rung; the transmitter thread is not running yet
+    if (BitrateController)
+    {
+        BitrateController->Reset();
+        if (bLadderChangesQuality)
+        {
+            SetStreamQuality(BaseStreamQuality);
+        }
+        const CineSRT::FBitrateRung& Rung = BitrateController->GetCurrentRung();
+        Encoder->SetRate(Rung.Bitrate, Rung.JpegQuality);
+    }
+    
+    // Stage timings cover this stream only
+    PipelineStats->Reset();
+    LastTelemetryLogTime = FPlatformTime::Seconds();
+    
     // Start transmitter
     if (!Transmitter->StartTransmission())
     {
@@ -240,15 +752,38 @@ void USRTStreamComponent::StartStreaming()
         return;
     }
     
-    // Update capture interval
+    // Renditions join the listener the main stream just started
+    for (const TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>& Rendition : RenditionStreams)
+    {
+        Rendition->PipelineStats->Reset();
+        if (!Rendition->Transmitter->StartTransmission())
+        {
+            UE_LOG(LogCineSRT, Error, TEXT("Failed to start rendition %s (streamid already in use?)"), *Rendition->StreamID);
+        }
+    }
+    
+    // Audio packets wait in the transmitter until the first video frame sets the PTS origin
+    if (AudioCapture)
+    {
+        AudioCapture->Start(GetWorld());
+    }
+    
+    // Output slots run on their own clock from here; the next game frame captures the first one
+    CaptureCadence.Start(TargetFPS, CineSRT::GetTimeSeconds());
     UpdateCaptureInterval();
     
-    // Enable tick
-    PrimaryComponentTick.bStartWithTickEnabled = true;
+    // The tick drives capture, so it has to run whatever the component was created with
+    SetComponentTickEnabled(true);
     
     bIsStreaming = true;
     
-    UE_LOG(LogCineSRT, Log, TEXT("Started SRT streaming on port %d"), StreamPort);
+    UE_LOG(LogCineSRT, Log, TEXT("Started SRT streaming on %s"), *GetStreamURL());
+    
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    if (Settings && Settings->bRecordISO)
+    {
+        StartRecording();
+    }
     
     // Broadcast event
     OnStreamingStateChanged.Broadcast(true);
@@ -261,19 +796,37 @@ void USRTStreamComponent::StopStreaming()
         return;
     }
     
-    // Stop transmitter
+    // Writes out what is still queued for the disk
+    StopRecording();
+    
+    if (AudioCapture)
+    {
+        AudioCapture->Stop();
+    }
+    
+    // Stop transmitter (renditions first; a standalone listener closes with the main stream)
+    for (const TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>& Rendition : RenditionStreams)
+    {
+        Rendition->Transmitter->StopTransmission();
+    }
     if (Transmitter)
     {
         Transmitter->StopTransmission();
     }
     
-    // Disable tick
-    PrimaryComponentTick.bStartWithTickEnabled = false;
+    CaptureCadence.Stop();
+    SetComponentTickEnabled(false);
     
     bIsStreaming = false;
     
     UE_LOG(LogCineSRT, Log, TEXT("Stopped SRT streaming"));
     
+    // Ready for the next take
+    if (!bEndingPlay)
+    {
+        PrewarmTransmitter();
+    }
+    
     // Broadcast event
     OnStreamingStateChanged.Broadcast(false);
 }
@@ -286,26 +839,36 @@ void USRTStreamComponent::SetStreamQuality(ESRTStreamQuality NewQuality)
     }
     
     StreamQuality = NewQuality;
+    const FIntPoint NewResolution = GetTargetResolution();
     
-    // Update resolution if streaming
-    if (bIsStreaming && RenderTarget)
+    // Update encoder settings (a new size is built in the background while the current encoder keeps running)
+    if (Encoder)
     {
-        FIntPoint NewResolution = GetTargetResolution();
-        RenderTarget->InitAutoFormat(NewResolution.X, NewResolution.Y);
-        RenderTarget->UpdateResourceImmediate(true);
+        Encoder->UpdateSettings(BuildEncoderSettings());
     }
     
-    // Update encoder settings
-    if (Encoder)
+    if (FramePool)
     {
-        FSRTEncoder::FEncoderSettings NewSettings;
-        NewSettings.Width = GetTargetResolution().X;
-        NewSettings.Height = GetTargetResolution().Y;
-        NewSettings.FPS = TargetFPS;
-        NewSettings.Bitrate = Bitrate;
-        NewSettings.EncoderType = EncoderType;
-        
-        Encoder->UpdateSettings(NewSettings);
+        FramePool->Preallocate(0, NewResolution.X, NewResolution.Y);
+    }
+    
+    // Update resolution
+    UTextureRenderTarget2D* LatestTarget = PendingRenderTarget ? PendingRenderTarget : RenderTarget;
+    if (LatestTarget && (LatestTarget->SizeX != NewResolution.X || LatestTarget->SizeY != NewResolution.Y))
+    {
+        if (bIsStreaming)
+        {
+            // Double buffered: capture keeps rendering into the current target until the encoder
+            // for the new size is ready, then TickComponent swaps the targets between two captures
+            const bool bBackToCurrent = RenderTarget->SizeX == NewResolution.X && RenderTarget->SizeY == NewResolution.Y;
+            PendingRenderTarget = bBackToCurrent ? nullptr : CreateCaptureTarget(NewResolution, false);
+        }
+        else
+        {
+            PendingRenderTarget = nullptr;
+            RenderTarget->InitAutoFormat(NewResolution.X, NewResolution.Y);
+            RenderTarget->UpdateResourceImmediate(true);
+        }
     }
     
     // Update capture interval
@@ -323,17 +886,10 @@ void USRTStreamComponent::SetDynamicBitrate(int32 NewBitrate)
     
     Bitrate = FMath::Clamp(NewBitrate, 500, 50000);
     
-    // Update encoder settings
+    // Rate control is retargeted in place; the quality preset's bitrate only applies on the next quality change
     if (Encoder)
     {
-        FSRTEncoder::FEncoderSettings NewSettings;
-        NewSettings.Width = GetTargetResolution().X;
-        NewSettings.Height = GetTargetResolution().Y;
-        NewSettings.FPS = TargetFPS;
-        NewSettings.Bitrate = Bitrate;
-        NewSettings.EncoderType = EncoderType;
-        
-        Encoder->UpdateSettings(NewSettings);
+        Encoder->SetRate(Bitrate, Encoder->GetSettings().JpegQuality);
     }
     
     UE_LOG(LogCineSRT, Log, TEXT("Bitrate changed to %d Kbps"), Bitrate);
@@ -341,48 +897,78 @@ void USRTStreamComponent::SetDynamicBitrate(int32 NewBitrate)
 
 FString USRTStreamComponent::GetStreamURL() const
 {
-    return FString::Printf(TEXT("srt://localhost:%d"), StreamPort);
+    // 단독 리스너의 주 스트림은 스트림 ID 없이 모든 호출자를 받음
+    return MakeStreamURL(GetSharedStreamSubsystem() ? StreamID : FString());
 }
 
-void USRTStreamComponent::CaptureFrame()
+FString USRTStreamComponent::MakeStreamURL(const FString& InStreamID) const
+{
+    UCineSRTStreamSubsystem* Subsystem = GetSharedStreamSubsystem();
+    const int32 Port = Subsystem ? Subsystem->GetSharedListenerPort() : StreamPort;
+    if (InStreamID.IsEmpty())
+    {
+        return FString::Printf(TEXT("srt://localhost:%d"), Port);
+    }
+    return FString::Printf(TEXT("srt://localhost:%d?streamid=%s"), Port, *InStreamID);
+}
+
+TArray<FString> USRTStreamComponent::GetRenditionStreamURLs() const
+{
+    TArray<FString> Result;
+    for (const TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>& Rendition : RenditionStreams)
+    {
+        Result.Add(MakeStreamURL(Rendition->StreamID));
+    }
+    return Result;
+}
+
+int32 USRTStreamComponent::GetConnectedClientCount() const
+{
+    return Transmitter ? Transmitter->GetNumClients() : 0;
+}
+
+void USRTStreamComponent::CaptureFrame(double SlotTime)
 {
-    UE_LOG(LogCineSRT, Warning, TEXT("=== CaptureFrame called ==="));
     if (!SceneCaptureComponent || !RenderTarget)
     {
-        UE_LOG(LogCineSRT, Error, TEXT("No capture components!"));
         return;
     }
     
-    // Capture the frame
+    // Capture the frame (the slot time, not this instant, becomes its PTS and SRT source time)
+    const double CaptureStartTime = CineSRT::GetTimeSeconds();
     SceneCaptureComponent->CaptureScene();
+    PipelineStats->Record(CineSRT::EPipelineStage::Capture, CineSRT::GetTimeSeconds() - CaptureStartTime);
+    PipelineStats->Add(CineSRT::EPipelineCounter::FramesCaptured);
+    
+    if (FrameReadback)
+    {
+        // Copy is queued behind the capture on the render thread and submitted to the encoder when ready
+        FrameReadback->EnqueueCapture(RenderTarget->GameThread_GetRenderTargetResource(), SlotTime);
+        return;
+    }
     
-    // Get frame data from render target
-    TArray<uint8> FrameData;
-    if (GetFrameDataFromRenderTarget(FrameData))
+    // Get frame data from render target (flushes the render thread, so this is the readback time)
+    const double ReadbackStartTime = CineSRT::GetTimeSeconds();
+    FSRTFrameRef Frame;
+    if (GetFrameDataFromRenderTarget(Frame))
     {
-        UE_LOG(LogCineSRT, Warning, TEXT("Frame captured: %d bytes"), FrameData.Num());
-        // Encode frame
-        if (Encoder && Encoder->SubmitFrame(FrameData))
+        PipelineStats->Record(CineSRT::EPipelineStage::Readback, CineSRT::GetTimeSeconds() - ReadbackStartTime);
+        Frame->CaptureTime = SlotTime;
+        for (const TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>& Rendition : RenditionStreams)
         {
-            UE_LOG(LogCineSRT, Warning, TEXT("Frame submitted to encoder"));
-            TArray<uint8> EncodedData;
-            if (Encoder->GetEncodedFrame(EncodedData))
-            {
-                UE_LOG(LogCineSRT, Warning, TEXT("Encoded data: %d bytes"), EncodedData.Num());
-                // Transmit encoded frame
-                if (Transmitter)
-                {
-                    Transmitter->TransmitFrame(EncodedData);
-                    UE_LOG(LogCineSRT, Warning, TEXT("Frame transmitted"));
-                }
-            }
+            Rendition->SubmitFrame(Frame);
+        }
+        // Encode frame (the encoder's frame sink forwards it to the transmitter)
+        if (Encoder)
+        {
+            Encoder->SubmitFrame(MoveTemp(Frame));
         }
     }
 }
 
-bool USRTStreamComponent::GetFrameDataFromRenderTarget(TArray<uint8>& OutFrameData)
+bool USRTStreamComponent::GetFrameDataFromRenderTarget(FSRTFrameRef& OutFrame)
 {
-    if (!RenderTarget || !RenderTarget->GetRenderTargetResource())
+    if (!RenderTarget || !FramePool || !RenderTarget->GetRenderTargetResource())
     {
         return false;
     }
@@ -394,19 +980,16 @@ bool USRTStreamComponent::GetFrameDataFromRenderTarget(TArray<uint8>& OutFrameDa
         return false;
     }
     
-    // Read pixels from render target
-    FIntPoint Size = RenderTarget->SizeX;
-    TArray<FColor> Pixels;
-    Pixels.SetNum(Size.X * Size.Y);
+    // Read pixels straight into a pooled frame (FColor is BGRA8 in memory)
+    FIntPoint Size(RenderTarget->SizeX, RenderTarget->SizeY);
+    FSRTFrameRef Frame = FramePool->Acquire(Size.X, Size.Y);
     
     FReadSurfaceDataFlags ReadFlags;
     ReadFlags.SetLinearToGamma(false);
     
-    if (RTResource->ReadPixels(Pixels, ReadFlags))
+    if (RTResource->ReadPixelsPtr(reinterpret_cast<FColor*>(Frame->Data.data()), ReadFlags))
     {
-        // Convert to raw data
-        OutFrameData.SetNum(Pixels.Num() * 4); // RGBA
-        FMemory::Memcpy(OutFrameData.GetData(), Pixels.GetData(), OutFrameData.Num());
+        OutFrame = MoveTemp(Frame);
         return true;
     }
     
@@ -415,7 +998,39 @@ bool USRTStreamComponent::GetFrameDataFromRenderTarget(TArray<uint8>& OutFrameDa
 
 void USRTStreamComponent::UpdateCaptureInterval()
 {
-    CaptureInterval = 1.0f / TargetFPS;
+    // Keeps the slot grid's phase; the encoders fill missed slots at the spacing of the frames they are fed
+    CaptureCadence.SetFrameRate(TargetFPS);
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    const bool bRepeatMissedFrames = !Settings || Settings->bRepeatMissedFrames;
+    if (Encoder)
+    {
+        Encoder->SetFillMissedSlots(bRepeatMissedFrames ? 1.0 / TargetFPS : 0.0);
+    }
+    for (const TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>& Rendition : RenditionStreams)
+    {
+        Rendition->Encoder->SetFillMissedSlots(bRepeatMissedFrames ? Rendition->FrameInterval : 0.0);
+    }
+}
+
+FSRTEncoder::FEncoderSettings USRTStreamComponent::BuildEncoderSettings() const
+{
+    FSRTEncoder::FEncoderSettings EncoderSettings;
+    EncoderSettings.Width = GetTargetResolution().X;
+    EncoderSettings.Height = GetTargetResolution().Y;
+    EncoderSettings.FPS = TargetFPS;
+    EncoderSettings.Bitrate = Bitrate;
+    EncoderSettings.StreamQuality = StreamQuality;
+    EncoderSettings.EncoderType = EncoderType;
+    EncoderSettings.Format = FSRTEncoder::GetDefaultFormat(EncoderType);
+    if (const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>())
+    {
+        EncoderSettings.ThreadCount = Settings->EncoderThreadCount;
+        EncoderSettings.SliceRows = Settings->SliceStreamingRows;
+        EncoderSettings.StaticFramePolicy = Settings->StaticFramePolicy;
+        EncoderSettings.StaticFrameTolerance = Settings->StaticFrameTolerance;
+        EncoderSettings.StaticFrameKeepAliveSeconds = Settings->StaticFrameKeepAliveSeconds;
+    }
+    return EncoderSettings;
 }
 
 FIntPoint USRTStreamComponent::GetTargetResolution() const
@@ -438,6 +1053,188 @@ FIntPoint USRTStreamComponent::GetTargetResolution() const
     }
 }
 
+static FSRTStreamStats ToStreamStats(const CineSRT::FPipelineStats& PipelineStats, const FSRTTransmitter* Transmitter)
+{
+    FSRTStreamStats Result;
+    auto ToStageStats = [&PipelineStats](CineSRT::EPipelineStage Stage)
+    {
+        const CineSRT::FPipelineStats::FStageSummary Summary = PipelineStats.GetStage(Stage);
+        FSRTStageStats StageStats;
+        StageStats.Samples = (int32)FMath::Min<uint64>(Summary.Count, MAX_int32);
+        StageStats.AverageMs = (float)Summary.AverageMs;
+        StageStats.P50Ms = (float)Summary.P50Ms;
+        StageStats.P95Ms = (float)Summary.P95Ms;
+        StageStats.P99Ms = (float)Summary.P99Ms;
+        StageStats.MaxMs = (float)Summary.MaxMs;
+        return StageStats;
+    };
+    Result.Cadence = ToStageStats(CineSRT::EPipelineStage::Cadence);
+    Result.Capture = ToStageStats(CineSRT::EPipelineStage::Capture);
+    Result.Readback = ToStageStats(CineSRT::EPipelineStage::Readback);
+    Result.Scale = ToStageStats(CineSRT::EPipelineStage::Scale);
+    Result.Convert = ToStageStats(CineSRT::EPipelineStage::Convert);
+    Result.Encode = ToStageStats(CineSRT::EPipelineStage::Encode);
+    Result.QueueWait = ToStageStats(CineSRT::EPipelineStage::QueueWait);
+    Result.Mux = ToStageStats(CineSRT::EPipelineStage::Mux);
+    Result.Send = ToStageStats(CineSRT::EPipelineStage::Send);
+    Result.FramesCaptured = (int32)PipelineStats.GetCounter(CineSRT::EPipelineCounter::FramesCaptured);
+    Result.FramesEncoded = (int32)PipelineStats.GetCounter(CineSRT::EPipelineCounter::FramesEncoded);
+    Result.FramesDropped = (int32)PipelineStats.GetCounter(CineSRT::EPipelineCounter::FramesDropped);
+    Result.FramesSent = (int32)PipelineStats.GetCounter(CineSRT::EPipelineCounter::FramesSent);
+    Result.FramesStatic = (int32)PipelineStats.GetCounter(CineSRT::EPipelineCounter::FramesStatic);
+    Result.SlotsMissed = (int32)PipelineStats.GetCounter(CineSRT::EPipelineCounter::SlotsMissed);
+    if (Transmitter)
+    {
+        const FSRTTransmitter::FTransmitterStats TransmitterStats = Transmitter->GetStats();
+        Result.ConnectedClients = TransmitterStats.NumClients;
+        Result.ClientsJoinedFromCache = (int32)TransmitterStats.ClientsJoinedFromCache;
+        Result.TimeToFirstPictureP50Ms = (float)TransmitterStats.TimeToFirstPictureP50;
+        Result.TimeToFirstPictureMaxMs = (float)TransmitterStats.TimeToFirstPictureMax;
+        Result.TimeToFirstPacketMs = (float)TransmitterStats.TimeToFirstPacket;
+        Result.AudioPacketsSent = (int32)TransmitterStats.AudioPacketsSent;
+        Result.AudioPacketsDropped = (int32)TransmitterStats.AudioPacketsDropped;
+    }
+    return Result;
+}
+
+FSRTStreamStats USRTStreamComponent::GetStreamStats() const
+{
+    FSRTStreamStats Result = PipelineStats ? ToStreamStats(*PipelineStats, Transmitter.Get()) : FSRTStreamStats();
+    if (Recorder)
+    {
+        const CineSRT::FRecorder::FStats RecorderStats = Recorder->GetStats();
+        Result.FramesRecorded = (int32)RecorderStats.FramesRecorded;
+        Result.RecordingFramesDropped = (int32)RecorderStats.FramesDropped;
+    }
+    return Result;
+}
+
+TArray<FSRTStreamStats> USRTStreamComponent::GetRenditionStreamStats() const
+{
+    TArray<FSRTStreamStats> Result;
+    for (const TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>& Rendition : RenditionStreams)
+    {
+        Result.Add(ToStreamStats(*Rendition->PipelineStats, Rendition->Transmitter.Get()));
+    }
+    return Result;
+}
+
+bool USRTStreamComponent::StartRecording(const FString& FilePath)
+{
+    if (!Recorder || !bIsStreaming)
+    {
+        UE_LOG(LogCineSRT, Warning, TEXT("Recording needs a running stream"));
+        return false;
+    }
+    if (Recorder->IsRecording())
+    {
+        return true;
+    }
+
+    FString Path = FilePath;
+    if (Path.IsEmpty())
+    {
+        const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+        FString Directory = Settings ? Settings->RecordingDirectory : FString();
+        if (Directory.IsEmpty())
+        {
+            Directory = FPaths::ProjectSavedDir() / TEXT("CineSRT") / TEXT("Recordings");
+        }
+        Path = Directory / FString::Printf(TEXT("%s_%s.ts"), *StreamID, *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+    }
+    Path = FPaths::ConvertRelativePathToFull(Path);
+    IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+
+    if (!Recorder->Start(TCHAR_TO_UTF8(*Path)))
+    {
+        OnStreamingErrorInternal(FString::Printf(TEXT("Failed to start recording to %s"), *Path));
+        return false;
+    }
+
+    // The file starts with a keyframe; MJPEG frames all are, H.264 gets one now instead of at the next GOP
+    if (Encoder)
+    {
+        Encoder->RequestKeyframe();
+    }
+    return true;
+}
+
+void USRTStreamComponent::StopRecording()
+{
+    if (Recorder)
+    {
+        Recorder->Stop();
+    }
+}
+
+bool USRTStreamComponent::IsRecording() const
+{
+    return Recorder && Recorder->IsRecording();
+}
+
+FString USRTStreamComponent::GetRecordingPath() const
+{
+    return Recorder ? FString(UTF8_TO_TCHAR(Recorder->GetPath().c_str())) : FString();
+}
+
+// Stage percentiles go to the stat group and the CSV profiler under matching names
+#define CINESRT_REPORT_STAGE(Stage) \
+    { \
+        const CineSRT::FPipelineStats::FStageSummary Summary = PipelineStats->GetStage(CineSRT::EPipelineStage::Stage); \
+        SET_FLOAT_STAT(STAT_CineSRT_##Stage##P50, (float)Summary.P50Ms); \
+        SET_FLOAT_STAT(STAT_CineSRT_##Stage##P95, (float)Summary.P95Ms); \
+        SET_FLOAT_STAT(STAT_CineSRT_##Stage##P99, (float)Summary.P99Ms); \
+        CSV_CUSTOM_STAT(CineSRT, Stage##P50, (float)Summary.P50Ms, ECsvCustomStatOp::Set); \
+        CSV_CUSTOM_STAT(CineSRT, Stage##P99, (float)Summary.P99Ms, ECsvCustomStatOp::Set); \
+    }
+
+void USRTStreamComponent::ReportPipelineStats()
+{
+    if (!PipelineStats)
+    {
+        return;
+    }
+    
+#if STATS || CSV_PROFILER
+    CINESRT_REPORT_STAGE(Cadence);
+    CINESRT_REPORT_STAGE(Capture);
+    CINESRT_REPORT_STAGE(Readback);
+    CINESRT_REPORT_STAGE(Convert);
+    CINESRT_REPORT_STAGE(Encode);
+    CINESRT_REPORT_STAGE(QueueWait);
+    CINESRT_REPORT_STAGE(Mux);
+    CINESRT_REPORT_STAGE(Send);
+    const int64 FramesDropped = PipelineStats->GetCounter(CineSRT::EPipelineCounter::FramesDropped);
+    SET_DWORD_STAT(STAT_CineSRT_PipelineDropped, FramesDropped);
+    CSV_CUSTOM_STAT(CineSRT, FramesDropped, (int32)FramesDropped, ECsvCustomStatOp::Set);
+#endif
+    
+    // One summary per interval instead of a line per frame
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    const double Interval = Settings ? Settings->TelemetryLogIntervalSeconds : 10.0;
+    const double Now = FPlatformTime::Seconds();
+    if (Interval > 0.0 && Now - LastTelemetryLogTime >= Interval)
+    {
+        UE_LOG(LogCineSRT, Log, TEXT("Stream %s pipeline timing since start (%d clients):\n%s"), *StreamID,
+            GetConnectedClientCount(), UTF8_TO_TCHAR(PipelineStats->FormatSummary().c_str()));
+        for (const TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>& Rendition : RenditionStreams)
+        {
+            UE_LOG(LogCineSRT, Log, TEXT("Rendition %s pipeline timing since start (%d clients):\n%s"), *Rendition->StreamID,
+                Rendition->Transmitter->GetNumClients(), UTF8_TO_TCHAR(Rendition->PipelineStats->FormatSummary().c_str()));
+        }
+        if (Recorder && Recorder->IsRecording())
+        {
+            const CineSRT::FRecorder::FStats RecorderStats = Recorder->GetStats();
+            UE_LOG(LogCineSRT, Log, TEXT("Stream %s recording: %lld frames, %.1f MB/s, %lld dropped, backlog %d frames (peak %d), write p99 %.1f ms"),
+                *StreamID, RecorderStats.FramesRecorded, RecorderStats.WriteMBps, RecorderStats.FramesDropped, RecorderStats.BacklogFrames,
+                RecorderStats.BacklogHighWater, Recorder->GetWriteLatency().GetPercentileMs(99.0));
+        }
+        LastTelemetryLogTime = Now;
+    }
+}
+
+#undef CINESRT_REPORT_STAGE
+
 void USRTStreamComponent::OnStreamingErrorInternal(const FString& Error)
 {
     UE_LOG(LogCineSRT, Error, TEXT("Streaming error: %s"), *Error);
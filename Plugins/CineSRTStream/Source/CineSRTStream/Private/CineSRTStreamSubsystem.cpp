@@ -0,0 +1,56 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTStreamSubsystem.h"
+#include "CineSRTStream.h"
+#include "CineSRTStreamSettings.h"
+
+bool UCineSRTStreamSubsystem::IsSharedListenerEnabled()
+{
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    return Settings && Settings->bSharedListener;
+}
+
+TSharedPtr<FSRTTransmitter> UCineSRTStreamSubsystem::CreateTransmitter(const FString& StreamID, const FSRTTransmitter::FTransmitterSettings& Settings)
+{
+    std::shared_ptr<CineSRT::FTransmitter> SharedListener = Listener.lock();
+    if (!SharedListener)
+    {
+        FSRTTransmitter::FTransmitterSettings ListenerSettings = Settings;
+        ListenerSettings.Port = GetSharedListenerPort();
+        SharedListener = std::make_shared<CineSRT::FTransmitter>(FSRTTransmitter::ToCoreSettings(ListenerSettings));
+
+        // 여러 스트림이 공유하므로 특정 컴포넌트로 보내지 않고 로그만 남김 (전송 스레드에서 호출됨)
+        SharedListener->OnError = [](const std::string& Error)
+        {
+            UE_LOG(LogCineSRT, Error, TEXT("Shared SRT listener: %s"), UTF8_TO_TCHAR(Error.c_str()));
+        };
+        Listener = SharedListener;
+
+        UE_LOG(LogCineSRT, Log, TEXT("Shared SRT listener created on %s:%d"), *ListenerSettings.BindAddress, ListenerSettings.Port);
+    }
+    return MakeShared<FSRTTransmitter>(MoveTemp(SharedListener), StreamID);
+}
+
+std::shared_ptr<CineSRT::FEncodeScheduler> UCineSRTStreamSubsystem::GetEncodeScheduler()
+{
+    std::shared_ptr<CineSRT::FEncodeScheduler> Scheduler = EncodeScheduler.lock();
+    if (!Scheduler)
+    {
+        const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+        Scheduler = std::make_shared<CineSRT::FEncodeScheduler>(Settings ? Settings->SharedEncoderThreads : 0);
+        EncodeScheduler = Scheduler;
+    }
+    return Scheduler;
+}
+
+int32 UCineSRTStreamSubsystem::GetSharedListenerPort() const
+{
+    const UCineSRTStreamSettings* Settings = GetDefault<UCineSRTStreamSettings>();
+    return Settings ? Settings->SharedListenerPort : 9000;
+}
+
+int32 UCineSRTStreamSubsystem::GetNumSharedStreams() const
+{
+    const std::shared_ptr<CineSRT::FTransmitter> SharedListener = Listener.lock();
+    return SharedListener ? SharedListener->GetNumStreams() : 0;
+}
@@ -0,0 +1,133 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SRTAudioCapture.h"
+#include "CineSRTStream.h"
+#include "AudioDevice.h"
+#include "Engine/World.h"
+#include "Sound/SoundSubmix.h"
+
+namespace
+{
+    CineSRT::FAudioEncoder::FConfig ToEncoderConfig(const FSRTAudioCapture::FAudioCaptureSettings& InSettings)
+    {
+        CineSRT::FAudioEncoder::FConfig Config;
+        Config.NumChannels = InSettings.NumChannels;
+        Config.BitsPerSample = InSettings.BitsPerSample;
+        Config.MinPacketFrames = CineSRT::FAudioEncoder::SampleRate * FMath::Max(InSettings.PacketMs, 1) / 1000;
+        Config.TimeOffsetSeconds = InSettings.SyncOffsetMs / 1000.0;
+        return Config;
+    }
+}
+
+FSRTAudioCapture::FSRTAudioCapture(const FAudioCaptureSettings& InSettings)
+    : Settings(InSettings)
+    , Encoder(ToEncoderConfig(InSettings))
+{
+}
+
+FSRTAudioCapture::~FSRTAudioCapture()
+{
+    // 리스너 등록이 이 객체를 잡고 있으므로 여기까지 왔다면 이미 Stop된 상태
+    check(!AudioDevice.IsValid());
+}
+
+void FSRTAudioCapture::SetSink(FPacketSink InSink)
+{
+    FScopeLock ScopeLock(&Lock);
+    Sink = MoveTemp(InSink);
+}
+
+bool FSRTAudioCapture::Start(UWorld* World)
+{
+    if (IsCapturing() || !World)
+    {
+        return false;
+    }
+
+    FAudioDeviceHandle Device = World->GetAudioDevice();
+    if (!Device.IsValid() || !Device->IsAudioMixerEnabled())
+    {
+        UE_LOG(LogCineSRT, Warning, TEXT("No audio mixer device in this world; streaming without audio"));
+        return false;
+    }
+
+    USoundSubmix* Submix = Cast<USoundSubmix>(Settings.Submix.TryLoad());
+    if (!Submix)
+    {
+        if (Settings.Submix.IsValid())
+        {
+            UE_LOG(LogCineSRT, Warning, TEXT("Audio submix %s not found; capturing the main submix"), *Settings.Submix.ToString());
+        }
+        Submix = &Device->GetMainSubmixObject();
+    }
+
+    {
+        FScopeLock ScopeLock(&Lock);
+        Encoder.Reset();
+        Stats = FAudioCaptureStats();
+        bActive = true;
+    }
+
+    Device->RegisterSubmixBufferListener(AsShared(), *Submix);
+    AudioDevice = MoveTemp(Device);
+    ListenedSubmix = Submix;
+
+    UE_LOG(LogCineSRT, Log, TEXT("Capturing audio from %s: %d ch %d-bit SMPTE 302M"), *Submix->GetName(),
+        Encoder.GetConfig().NumChannels, Encoder.GetConfig().BitsPerSample);
+    return true;
+}
+
+void FSRTAudioCapture::Stop()
+{
+    if (!IsCapturing())
+    {
+        return;
+    }
+
+    if (USoundSubmix* Submix = ListenedSubmix.Get())
+    {
+        AudioDevice->UnregisterSubmixBufferListener(AsShared(), *Submix);
+    }
+
+    // 해제 요청과 겹쳐 돌고 있는 콜백은 잠금에서 기다렸다가 bActive를 보고 그냥 나감
+    {
+        FScopeLock ScopeLock(&Lock);
+        bActive = false;
+    }
+    AudioDevice.Reset();
+    ListenedSubmix.Reset();
+}
+
+FSRTAudioCapture::FAudioCaptureStats FSRTAudioCapture::GetStats() const
+{
+    FScopeLock ScopeLock(&Lock);
+    return Stats;
+}
+
+void FSRTAudioCapture::OnNewSubmixBuffer(const USoundSubmix* OwningSubmix, float* AudioData, int32 NumSamples, int32 NumChannels,
+    const int32 SampleRate, double AudioClock)
+{
+    // 믹서 클록(AudioClock)이 아니라 비디오 캡처와 같은 시계로 찍음
+    const double Now = CineSRT::GetTimeSeconds();
+
+    FScopeLock ScopeLock(&Lock);
+    if (!bActive || !Sink || NumChannels <= 0)
+    {
+        return;
+    }
+
+    Stats.BuffersCaptured++;
+    Stats.SampleRate = SampleRate;
+    Encoder.Encode(AudioData, NumSamples / NumChannels, NumChannels, SampleRate, Now, [this](CineSRT::FEncodedAudioRef Packet)
+    {
+        Stats.PacketsEncoded++;
+        Sink(MoveTemp(Packet));
+    });
+    Stats.ClockResyncs = Encoder.GetClockResyncs();
+}
+
+const FString& FSRTAudioCapture::GetListenerName() const
+{
+    static const FString ListenerName(TEXT("CineSRTAudioCapture"));
+    return ListenerName;
+}
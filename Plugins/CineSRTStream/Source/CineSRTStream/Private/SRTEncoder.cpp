@@ -2,150 +2,138 @@
 
 #include "SRTEncoder.h"
 #include "CineSRTStream.h"
-#include "HAL/PlatformProcess.h"
-#include "IImageWrapper.h"
-#include "IImageWrapperModule.h"
-#include "Modules/ModuleManager.h"
 
 FSRTEncoder::FSRTEncoder(const FEncoderSettings& InSettings)
     : Settings(InSettings)
 {
-    FrameEvent = FPlatformProcess::GetSynchEventFromPool();
+    // GetSettings reports the preset's size and rate before Initialize too
+    ApplyQualitySettings();
 }
 
 FSRTEncoder::~FSRTEncoder()
 {
     Shutdown();
-    FPlatformProcess::ReturnSynchEventToPool(FrameEvent);
 }
 
 bool FSRTEncoder::Initialize()
 {
-    if (bIsInitialized)
+    if (Pool.IsRunning())
         return true;
     ApplyQualitySettings();
-    Encoder = CreateEncoder();
-    if (!Encoder || !Encoder->Initialize())
+    ApplyStaticFrameSettings();
+    if (!Pool.Start(Settings.Format, MakeConfig()) && Settings.Format != EEncodingFormat::MJPEG)
     {
-        UE_LOG(LogCineSRT, Error, TEXT("Failed to create encoder"));
-        return false;
+        UE_LOG(LogCineSRT, Warning, TEXT("Encoder format %d failed to initialize, falling back to MJPEG"), (int32)Settings.Format);
+        Settings.Format = EEncodingFormat::MJPEG;
+        Pool.Start(Settings.Format, MakeConfig());
     }
-    Thread = FRunnableThread::Create(this, TEXT("SRTEncoderThread"));
-    if (!Thread)
+    if (!Pool.IsRunning())
     {
-        UE_LOG(LogCineSRT, Error, TEXT("Failed to create encoder thread"));
+        UE_LOG(LogCineSRT, Error, TEXT("Failed to create encoder"));
         return false;
     }
-    bIsInitialized = true;
+
     UE_LOG(LogCineSRT, Log, TEXT("SRT Encoder initialized:"));
     UE_LOG(LogCineSRT, Log, TEXT("  - Resolution: %dx%d"), Settings.Width, Settings.Height);
     UE_LOG(LogCineSRT, Log, TEXT("  - FPS: %d"), Settings.FPS);
     UE_LOG(LogCineSRT, Log, TEXT("  - Bitrate: %d Kbps"), Settings.Bitrate);
     UE_LOG(LogCineSRT, Log, TEXT("  - Format: %d"), (int32)Settings.Format);
+    UE_LOG(LogCineSRT, Log, TEXT("  - Workers: %d"), Pool.GetStats().WorkerCount);
     return true;
 }
 
 void FSRTEncoder::Shutdown()
 {
-    if (!bIsInitialized) return;
-    bShouldStop = true;
-    FrameEvent->Trigger();
-    if (Thread)
-    {
-        Thread->WaitForCompletion();
-        delete Thread;
-        Thread = nullptr;
-    }
-    if (Encoder)
-    {
-        Encoder->Shutdown();
-        Encoder.Reset();
-    }
-    bIsInitialized = false;
+    Pool.Stop();
 }
 
-bool FSRTEncoder::SubmitFrame(const TArray<uint8>& FrameData)
+bool FSRTEncoder::SubmitFrame(FSRTFrameRef Frame)
 {
-    if (!bIsInitialized) return false;
-    FScopeLock Lock(&QueueMutex);
-    if (InputQueueSize > 5)
-    {
-        TArray<uint8> DroppedFrame;
-        InputQueue.Dequeue(DroppedFrame);
-        InputQueueSize--;
-        Stats.FramesDropped++;
-        UE_LOG(LogCineSRT, Warning, TEXT("Encoder queue full, dropping frame"));
-    }
-    InputQueue.Enqueue(FrameData);
-    InputQueueSize++;
-    FrameEvent->Trigger();
-    return true;
+    return Pool.SubmitFrame(MoveTemp(Frame));
 }
 
-bool FSRTEncoder::GetEncodedFrame(TArray<uint8>& OutEncodedData)
+bool FSRTEncoder::GetEncodedFrame(FSRTEncodedFrameRef& OutEncodedFrame)
 {
-    FScopeLock Lock(&QueueMutex);
-    return OutputQueue.Dequeue(OutEncodedData);
+    return Pool.GetEncodedFrame(OutEncodedFrame);
 }
 
 void FSRTEncoder::UpdateSettings(const FEncoderSettings& NewSettings)
 {
-    bool bNeedsRestart = (Settings.Width != NewSettings.Width ||
-                         Settings.Height != NewSettings.Height ||
-                         Settings.Format != NewSettings.Format);
+    // Compare after the preset is resolved; presets override the size, rate and quality they define
+    const FEncoderSettings PreviousSettings = Settings;
     Settings = NewSettings;
     ApplyQualitySettings();
-    if (bNeedsRestart && bIsInitialized)
+    ApplyStaticFrameSettings();
+    if (!Pool.IsRunning())
     {
-        UE_LOG(LogCineSRT, Log, TEXT("Encoder settings changed, restarting..."));
-        Shutdown();
-        Initialize();
+        return;
+    }
+    
+    const bool bNeedsNewEncoders = (PreviousSettings.Width != Settings.Width ||
+                                    PreviousSettings.Height != Settings.Height ||
+                                    PreviousSettings.FPS != Settings.FPS ||
+                                    PreviousSettings.Format != Settings.Format ||
+                                    PreviousSettings.KeyframeInterval != Settings.KeyframeInterval ||
+                                    PreviousSettings.Preset != Settings.Preset ||
+                                    PreviousSettings.ThreadCount != Settings.ThreadCount ||
+                                    PreviousSettings.SliceRows != Settings.SliceRows);
+    if (bNeedsNewEncoders)
+    {
+        // New encoders are built in the background and take over at their first keyframe; nothing is dropped
+        UE_LOG(LogCineSRT, Log, TEXT("Encoder settings changed, reconfiguring to %dx%d @ %d fps"), Settings.Width, Settings.Height, Settings.FPS);
+        Pool.Reconfigure(Settings.Format, MakeConfig(), EEncodingFormat::MJPEG);
+    }
+    else if (PreviousSettings.Bitrate != Settings.Bitrate || PreviousSettings.JpegQuality != Settings.JpegQuality)
+    {
+        Pool.SetRate(Settings.Bitrate, Settings.JpegQuality);
     }
 }
 
-bool FSRTEncoder::Init() { return true; }
-
-uint32 FSRTEncoder::Run()
+void FSRTEncoder::SetRate(int32 Bitrate, int32 JpegQuality)
 {
-    while (!bShouldStop)
-    {
-        FrameEvent->Wait();
-        TArray<uint8> InputFrame;
-        while (InputQueue.Dequeue(InputFrame))
-        {
-            InputQueueSize--;
-            if (bShouldStop) break;
-            double StartTime = FPlatformTime::Seconds();
-            TArray<uint8> EncodedFrame;
-            if (Encoder && Encoder->EncodeFrame(InputFrame, EncodedFrame))
-            {
-                FScopeLock Lock(&QueueMutex);
-                OutputQueue.Enqueue(MoveTemp(EncodedFrame));
-                Stats.FramesEncoded++;
-                Stats.TotalBytesEncoded += EncodedFrame.Num();
-                double EncodeTime = FPlatformTime::Seconds() - StartTime;
-                Stats.AverageEncodeTime = (Stats.AverageEncodeTime * (Stats.FramesEncoded - 1) + EncodeTime) / Stats.FramesEncoded;
-            }
-        }
-    }
-    return 0;
+    Pool.SetRate(Bitrate, JpegQuality);
 }
 
-void FSRTEncoder::Stop() { bShouldStop = true; }
+CineSRT::FVideoEncoderConfig FSRTEncoder::MakeConfig() const
+{
+    CineSRT::FVideoEncoderConfig Config;
+    Config.Width = Settings.Width;
+    Config.Height = Settings.Height;
+    Config.FPS = Settings.FPS;
+    Config.Bitrate = Settings.Bitrate;
+    Config.JpegQuality = Settings.JpegQuality;
+    Config.KeyframeInterval = Settings.KeyframeInterval;
+    Config.Preset = TCHAR_TO_UTF8(*Settings.Preset);
+    Config.ThreadCount = Settings.ThreadCount;
+    Config.SliceRows = Settings.SliceRows;
+    return Config;
+}
 
-TUniquePtr<IVideoEncoder> FSRTEncoder::CreateEncoder()
+void FSRTEncoder::ApplyStaticFrameSettings()
 {
-    switch (Settings.Format)
+    CineSRT::FStaticFrameSettings StaticSettings;
+    switch (Settings.StaticFramePolicy)
     {
-        case EEncodingFormat::MJPEG:
-            return MakeUnique<FMJPEGEncoder>(Settings);
-        case EEncodingFormat::H264:
-            UE_LOG(LogCineSRT, Warning, TEXT("H264 encoder not implemented, falling back to MJPEG"));
-            Settings.Format = EEncodingFormat::MJPEG;
-            return MakeUnique<FMJPEGEncoder>(Settings);
+        case ESRTStaticFramePolicy::Skip:
+            StaticSettings.Policy = CineSRT::EStaticFramePolicy::Skip; break;
+        case ESRTStaticFramePolicy::Repeat:
+            StaticSettings.Policy = CineSRT::EStaticFramePolicy::Repeat; break;
         default:
-            return nullptr;
+            StaticSettings.Policy = CineSRT::EStaticFramePolicy::Encode; break;
     }
+    StaticSettings.Tolerance = Settings.StaticFrameTolerance;
+    StaticSettings.KeepAliveSeconds = Settings.StaticFrameKeepAliveSeconds;
+    Pool.SetStaticFrameSettings(StaticSettings);
+}
+
+EEncodingFormat FSRTEncoder::GetDefaultFormat(ESRTEncoderType EncoderType)
+{
+    // Hardware encoders are not wired up yet; every type uses the software H.264 path when available
+#if WITH_OPENH264
+    return EEncodingFormat::H264;
+#else
+    return EEncodingFormat::MJPEG;
+#endif
 }
 
 void FSRTEncoder::ApplyQualitySettings()
@@ -166,32 +154,3 @@ void FSRTEncoder::ApplyQualitySettings()
             break;
     }
 }
-
-// --- MJPEG 인코더 구현 ---
-FMJPEGEncoder::FMJPEGEncoder(const FSRTEncoder::FEncoderSettings& InSettings)
-    : Settings(InSettings)
-{
-}
-
-bool FMJPEGEncoder::Initialize()
-{
-    return true;
-}
-
-bool FMJPEGEncoder::EncodeFrame(const TArray<uint8>& RawData, TArray<uint8>& OutEncodedData)
-{
-    IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
-    TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
-    if (!ImageWrapper.IsValid()) return false;
-    if (!ImageWrapper->SetRaw(RawData.GetData(), RawData.Num(), Settings.Width, Settings.Height, ERGBFormat::BGRA, 8)) return false;
-    OutEncodedData = ImageWrapper->GetCompressed(Settings.JpegQuality);
-    return OutEncodedData.Num() > 0;
-}
-
-void FMJPEGEncoder::Shutdown() {}
-
-// --- H264 인코더 스텁 ---
-FH264Encoder::FH264Encoder(const FSRTEncoder::FEncoderSettings& InSettings) : Settings(InSettings) {}
-bool FH264Encoder::Initialize() { return false; }
-bool FH264Encoder::EncodeFrame(const TArray<uint8>&, TArray<uint8>&) { return false; }
-void FH264Encoder::Shutdown() {} 
\ No newline at end of file
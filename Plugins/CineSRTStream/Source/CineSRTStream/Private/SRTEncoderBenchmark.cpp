@@ -0,0 +1,327 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "CineSRTStream.h"
+#include "SRTEncoder.h"
+#include "SRTFramePool.h"
+#include "CineSRTColorConvert.h"
+#include "CineSRTSyntheticFrame.h"
+#include "HAL/IConsoleManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Modules/ModuleManager.h"
+
+// Encoder benchmark on synthetic BGRA frames. Needs no GPU, so it runs on a headless box:
+//   UnrealEditor-Cmd <Project> -nullrhi -ExecCmds="CineSRT.Bench.Encode H264 1920 1080 300, Quit"
+//   UnrealEditor-Cmd <Project> -nullrhi -ExecCmds="CineSRT.Bench.EncodePool MJPEG 3840 2160 300 8, Quit"
+//   UnrealEditor-Cmd <Project> -nullrhi -ExecCmds="CineSRT.Bench.MJPEG 120, Quit"
+//   UnrealEditor-Cmd <Project> -nullrhi -ExecCmds="CineSRT.Bench.ColorConvert 3840 2160 50, Quit"
+
+namespace
+{
+    void RunEncodeBenchmark(const TArray<FString>& Args)
+    {
+        const EEncodingFormat Format = (Args.Num() > 0 && Args[0].Equals(TEXT("MJPEG"), ESearchCase::IgnoreCase)) ? EEncodingFormat::MJPEG : EEncodingFormat::H264;
+        CineSRT::FVideoEncoderConfig Settings;
+        Settings.Width = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1920;
+        Settings.Height = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1080;
+        const int32 NumFrames = Args.Num() > 3 ? FMath::Max(FCString::Atoi(*Args[3]), 1) : 300;
+        Settings.Bitrate = Args.Num() > 4 ? FCString::Atoi(*Args[4]) : 8000;
+        if (Args.Num() > 5)
+        {
+            Settings.Preset = TCHAR_TO_UTF8(*Args[5]);
+        }
+
+        std::unique_ptr<IVideoEncoder> Encoder = CineSRT::CreateVideoEncoder(Format, Settings);
+        if (!Encoder || !Encoder->Initialize())
+        {
+            UE_LOG(LogCineSRT, Error, TEXT("Bench: encoder format %d failed to initialize"), (int32)Format);
+            return;
+        }
+
+        // Pre-generate a short loop so frame synthesis is not part of the measurement
+        const int32 NumSourceFrames = 8;
+        TArray<TArray<uint8>> SourceFrames;
+        SourceFrames.SetNum(NumSourceFrames);
+        for (int32 Index = 0; Index < NumSourceFrames; ++Index)
+        {
+            SourceFrames[Index].SetNumUninitialized(Settings.Width * Settings.Height * 4);
+            CineSRT::FSyntheticFrame::Fill(SourceFrames[Index].GetData(), Settings.Width, Settings.Height, Index);
+        }
+
+        FSRTEncodedFrame Encoded;
+        int64 TotalBytes = 0;
+        double MaxFrameMs = 0.0;
+        const double StartTime = FPlatformTime::Seconds();
+        for (int32 Index = 0; Index < NumFrames; ++Index)
+        {
+            const double FrameStart = FPlatformTime::Seconds();
+            const TArray<uint8>& Source = SourceFrames[Index % NumSourceFrames];
+            if (Encoder->EncodeFrame(Source.GetData(), Source.Num(), Encoded))
+            {
+                TotalBytes += Encoded.Data.size();
+            }
+            MaxFrameMs = FMath::Max(MaxFrameMs, (FPlatformTime::Seconds() - FrameStart) * 1000.0);
+        }
+        const double Elapsed = FPlatformTime::Seconds() - StartTime;
+        Encoder->Shutdown();
+
+        const double FramesPerSecond = NumFrames / Elapsed;
+        UE_LOG(LogCineSRT, Display, TEXT("Bench %s %dx%d: %d frames in %.2f s -> %.1f fps, avg %.2f ms, max %.2f ms, %.1f KB/frame, %.2f Mbps at %d fps"),
+            Format == EEncodingFormat::H264 ? TEXT("H264") : TEXT("MJPEG"),
+            Settings.Width, Settings.Height, NumFrames, Elapsed, FramesPerSecond,
+            Elapsed * 1000.0 / NumFrames, MaxFrameMs,
+            TotalBytes / 1024.0 / NumFrames,
+            TotalBytes * 8.0 / NumFrames * Settings.FPS / 1000000.0, Settings.FPS);
+    }
+
+    /** Runs the full FSRTEncoder worker pool and checks that output comes back in capture order. */
+    void RunEncodePoolBenchmark(const TArray<FString>& Args)
+    {
+        FSRTEncoder::FEncoderSettings Settings;
+        Settings.StreamQuality = ESRTStreamQuality::Custom;
+        Settings.Format = (Args.Num() > 0 && Args[0].Equals(TEXT("H264"), ESearchCase::IgnoreCase)) ? EEncodingFormat::H264 : EEncodingFormat::MJPEG;
+        Settings.Width = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 3840;
+        Settings.Height = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 2160;
+        const int32 NumFrames = Args.Num() > 3 ? FMath::Max(FCString::Atoi(*Args[3]), 1) : 300;
+        Settings.ThreadCount = Args.Num() > 4 ? FMath::Max(FCString::Atoi(*Args[4]), 1) : 4;
+
+        FSRTEncoder Encoder(Settings);
+        if (!Encoder.Initialize())
+        {
+            UE_LOG(LogCineSRT, Error, TEXT("Bench: encoder pool failed to initialize"));
+            return;
+        }
+        const int32 NumWorkers = Encoder.GetStats().WorkerCount;
+
+        const int32 NumSourceFrames = 8;
+        std::shared_ptr<FSRTFramePool> Pool = std::make_shared<FSRTFramePool>();
+        TArray<TArray<uint8>> SourceFrames;
+        SourceFrames.SetNum(NumSourceFrames);
+        for (int32 Index = 0; Index < NumSourceFrames; ++Index)
+        {
+            SourceFrames[Index].SetNumUninitialized(Settings.Width * Settings.Height * 4);
+            CineSRT::FSyntheticFrame::Fill(SourceFrames[Index].GetData(), Settings.Width, Settings.Height, Index);
+        }
+        Pool->Preallocate(NumWorkers * 2 + 2, Settings.Width, Settings.Height);
+
+        // Keep every worker busy without tripping the input queue's drop path
+        const int32 MaxInFlight = NumWorkers * 2;
+        int32 Submitted = 0;
+        int32 Received = 0;
+        int32 OutOfOrder = 0;
+        int64 LastPts = -1;
+        const double StartTime = FPlatformTime::Seconds();
+        while (Received < NumFrames)
+        {
+            while (Submitted < NumFrames && Submitted - Received < MaxInFlight)
+            {
+                FSRTFrameRef Frame = Pool->Acquire(Settings.Width, Settings.Height);
+                FMemory::Memcpy(Frame->Data.data(), SourceFrames[Submitted % NumSourceFrames].GetData(), Frame->Data.size());
+                Encoder.SubmitFrame(MoveTemp(Frame));
+                Submitted++;
+            }
+
+            FSRTEncodedFrameRef Encoded;
+            bool bGotFrame = false;
+            while (Encoder.GetEncodedFrame(Encoded))
+            {
+                OutOfOrder += Encoded->Pts <= LastPts ? 1 : 0;
+                LastPts = Encoded->Pts;
+                Received++;
+                bGotFrame = true;
+            }
+            if (!bGotFrame)
+            {
+                if (Received + Encoder.GetStats().FramesDropped >= NumFrames)
+                {
+                    break;
+                }
+                FPlatformProcess::Sleep(0.0005f);
+            }
+        }
+        const double Elapsed = FPlatformTime::Seconds() - StartTime;
+        const FSRTEncoder::FEncoderStats Stats = Encoder.GetStats();
+        Encoder.Shutdown();
+
+        UE_LOG(LogCineSRT, Display, TEXT("Bench pool %s %dx%d, %d workers: %d frames in %.2f s -> %.1f fps (%.2f ms/frame per worker), %d dropped, %d out of order"),
+            Settings.Format == EEncodingFormat::H264 ? TEXT("H264") : TEXT("MJPEG"),
+            Settings.Width, Settings.Height, NumWorkers, Received, Elapsed, Received / Elapsed,
+            Stats.AverageEncodeTime * 1000.0f, Stats.FramesDropped, OutOfOrder);
+    }
+
+    FAutoConsoleCommand EncodePoolBenchmarkCommand(
+        TEXT("CineSRT.Bench.EncodePool"),
+        TEXT("Encodes synthetic BGRA frames through the FSRTEncoder worker pool. Usage: CineSRT.Bench.EncodePool [MJPEG|H264] [Width] [Height] [Frames] [Threads]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunEncodePoolBenchmark));
+
+    /** Old FMJPEGEncoder path: module lookup, a new image wrapper and a fresh output array for every frame. */
+    bool EncodeJpegPerFrameWrapper(const TArray<uint8>& RawData, int32 Width, int32 Height, int32 Quality, TArray<uint8>& OutData)
+    {
+        IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+        TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG);
+        if (!ImageWrapper.IsValid() || !ImageWrapper->SetRaw(RawData.GetData(), RawData.Num(), Width, Height, ERGBFormat::BGRA, 8))
+        {
+            return false;
+        }
+        OutData = TArray<uint8>(ImageWrapper->GetCompressed(Quality));
+        return OutData.Num() > 0;
+    }
+
+    /** Single-thread MJPEG throughput before (per-frame wrapper) and after (persistent compressor) at 720p, 1080p and 4K. */
+    void RunMJPEGBenchmark(const TArray<FString>& Args)
+    {
+        const int32 NumFrames = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 120;
+        const FIntPoint Resolutions[] = { FIntPoint(1280, 720), FIntPoint(1920, 1080), FIntPoint(3840, 2160) };
+        const int32 NumSourceFrames = 4;
+
+        for (const FIntPoint& Resolution : Resolutions)
+        {
+            CineSRT::FVideoEncoderConfig Settings;
+            Settings.Width = Resolution.X;
+            Settings.Height = Resolution.Y;
+
+            TArray<TArray<uint8>> SourceFrames;
+            SourceFrames.SetNum(NumSourceFrames);
+            for (int32 Index = 0; Index < NumSourceFrames; ++Index)
+            {
+                SourceFrames[Index].SetNumUninitialized(Settings.Width * Settings.Height * 4);
+                CineSRT::FSyntheticFrame::Fill(SourceFrames[Index].GetData(), Settings.Width, Settings.Height, Index);
+            }
+
+            TArray<uint8> BaselineOutput;
+            int64 BaselineBytes = 0;
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 Index = 0; Index < NumFrames; ++Index)
+            {
+                if (EncodeJpegPerFrameWrapper(SourceFrames[Index % NumSourceFrames], Settings.Width, Settings.Height, Settings.JpegQuality, BaselineOutput))
+                {
+                    BaselineBytes += BaselineOutput.Num();
+                }
+            }
+            const double BaselineElapsed = FPlatformTime::Seconds() - StartTime;
+
+            CineSRT::FMJPEGEncoder Encoder(Settings);
+            if (!Encoder.Initialize())
+            {
+                UE_LOG(LogCineSRT, Error, TEXT("Bench: MJPEG encoder failed to initialize"));
+                return;
+            }
+            FSRTEncodedFrame Encoded;
+            int64 CachedBytes = 0;
+            StartTime = FPlatformTime::Seconds();
+            for (int32 Index = 0; Index < NumFrames; ++Index)
+            {
+                const TArray<uint8>& Source = SourceFrames[Index % NumSourceFrames];
+                if (Encoder.EncodeFrame(Source.GetData(), Source.Num(), Encoded))
+                {
+                    CachedBytes += Encoded.Data.size();
+                }
+            }
+            const double CachedElapsed = FPlatformTime::Seconds() - StartTime;
+            Encoder.Shutdown();
+
+            UE_LOG(LogCineSRT, Display, TEXT("Bench MJPEG %dx%d: per-frame wrapper %.1f fps (%.1f KB/frame), persistent compressor %.1f fps (%.1f KB/frame), %.2fx"),
+                Settings.Width, Settings.Height,
+                NumFrames / BaselineElapsed, BaselineBytes / 1024.0 / NumFrames,
+                NumFrames / CachedElapsed, CachedBytes / 1024.0 / NumFrames,
+                BaselineElapsed / FMath::Max(CachedElapsed, 1e-9));
+        }
+    }
+
+    FAutoConsoleCommand MJPEGBenchmarkCommand(
+        TEXT("CineSRT.Bench.MJPEG"),
+        TEXT("Compares the old per-frame ImageWrapper JPEG path with the persistent MJPEG compressor at 720p, 1080p and 4K. Usage: CineSRT.Bench.MJPEG [Frames]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunMJPEGBenchmark));
+
+    /**
+     * Checks every SIMD colour kernel against the scalar reference (random pixels, odd widths that
+     * exercise the scalar tail, a padded source stride), then times each kernel single- and multi-threaded.
+     */
+    void RunColorConvertBenchmark(const TArray<FString>& Args)
+    {
+        const int32 BenchWidth = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 3840;
+        const int32 BenchHeight = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 2160;
+        const int32 Iterations = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 50;
+        const CineSRT::EColorKernel Kernels[] = { CineSRT::EColorKernel::Scalar, CineSRT::EColorKernel::SSE41, CineSRT::EColorKernel::AVX2 };
+
+        // Bit accuracy
+        const FIntPoint CheckSizes[] = { FIntPoint(2, 2), FIntPoint(18, 4), FIntPoint(34, 6), FIntPoint(66, 70), FIntPoint(1920, 1080) };
+        FRandomStream Random(0x5EED);
+        int32 NumMismatches = 0;
+        for (const FIntPoint& Size : CheckSizes)
+        {
+            const int32 Stride = Size.X * 4 + 64;
+            TArray<uint8> Source;
+            Source.SetNumUninitialized(Stride * Size.Y);
+            for (uint8& Byte : Source)
+            {
+                Byte = (uint8)Random.RandHelper(256);
+            }
+
+            const int32 LumaSize = Size.X * Size.Y;
+            TArray<uint8> RefI420, RefNV12;
+            RefI420.SetNumUninitialized(LumaSize * 3 / 2);
+            RefNV12.SetNumUninitialized(LumaSize * 3 / 2);
+            CineSRT::FColorConverter::ConvertBGRAToI420(Source.GetData(), Size.X, Size.Y, Stride, RefI420.GetData(), RefI420.GetData() + LumaSize, RefI420.GetData() + LumaSize * 5 / 4, CineSRT::EColorKernel::Scalar, false);
+            CineSRT::FColorConverter::ConvertBGRAToNV12(Source.GetData(), Size.X, Size.Y, Stride, RefNV12.GetData(), RefNV12.GetData() + LumaSize, CineSRT::EColorKernel::Scalar, false);
+
+            for (CineSRT::EColorKernel Kernel : Kernels)
+            {
+                if (Kernel == CineSRT::EColorKernel::Scalar || !CineSRT::FColorConverter::IsKernelSupported(Kernel))
+                {
+                    continue;
+                }
+                TArray<uint8> I420, NV12;
+                I420.SetNumUninitialized(RefI420.Num());
+                NV12.SetNumUninitialized(RefNV12.Num());
+                CineSRT::FColorConverter::ConvertBGRAToI420(Source.GetData(), Size.X, Size.Y, Stride, I420.GetData(), I420.GetData() + LumaSize, I420.GetData() + LumaSize * 5 / 4, Kernel);
+                CineSRT::FColorConverter::ConvertBGRAToNV12(Source.GetData(), Size.X, Size.Y, Stride, NV12.GetData(), NV12.GetData() + LumaSize, Kernel);
+                if (I420 != RefI420 || NV12 != RefNV12)
+                {
+                    UE_LOG(LogCineSRT, Error, TEXT("Bench: %s kernel differs from scalar at %dx%d"), UTF8_TO_TCHAR(CineSRT::FColorConverter::GetKernelName(Kernel)), Size.X, Size.Y);
+                    NumMismatches++;
+                }
+            }
+        }
+        UE_LOG(LogCineSRT, Display, TEXT("Bench colour conversion bit accuracy: %s"), NumMismatches == 0 ? TEXT("all kernels match scalar") : TEXT("MISMATCH"));
+
+        // Throughput
+        TArray<uint8> Source;
+        Source.SetNumUninitialized(BenchWidth * BenchHeight * 4);
+        CineSRT::FSyntheticFrame::Fill(Source.GetData(), BenchWidth, BenchHeight, 0);
+        TArray<uint8> Planar;
+        Planar.SetNumUninitialized(BenchWidth * BenchHeight * 3 / 2);
+        uint8* PlaneY = Planar.GetData();
+        uint8* PlaneU = PlaneY + BenchWidth * BenchHeight;
+        uint8* PlaneV = PlaneU + BenchWidth * BenchHeight / 4;
+        for (CineSRT::EColorKernel Kernel : Kernels)
+        {
+            if (!CineSRT::FColorConverter::IsKernelSupported(Kernel))
+            {
+                continue;
+            }
+            for (bool bParallel : { false, true })
+            {
+                const double StartTime = FPlatformTime::Seconds();
+                for (int32 Index = 0; Index < Iterations; ++Index)
+                {
+                    CineSRT::FColorConverter::ConvertBGRAToI420(Source.GetData(), BenchWidth, BenchHeight, 0, PlaneY, PlaneU, PlaneV, Kernel, bParallel);
+                }
+                const double FrameMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Iterations;
+                UE_LOG(LogCineSRT, Display, TEXT("Bench BGRA->I420 %dx%d %s%s: %.2f ms/frame (%.0f fps)"),
+                    BenchWidth, BenchHeight, UTF8_TO_TCHAR(CineSRT::FColorConverter::GetKernelName(Kernel)), bParallel ? TEXT(" parallel") : TEXT(""),
+                    FrameMs, 1000.0 / FMath::Max(FrameMs, 1e-6));
+            }
+        }
+    }
+
+    FAutoConsoleCommand ColorConvertBenchmarkCommand(
+        TEXT("CineSRT.Bench.ColorConvert"),
+        TEXT("Verifies SIMD BGRA->I420/NV12 kernels against scalar and times them. Usage: CineSRT.Bench.ColorConvert [Width] [Height] [Iterations]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunColorConvertBenchmark));
+
+    FAutoConsoleCommand EncodeBenchmarkCommand(
+        TEXT("CineSRT.Bench.Encode"),
+        TEXT("Encodes synthetic BGRA frames. Usage: CineSRT.Bench.Encode [H264|MJPEG] [Width] [Height] [Frames] [BitrateKbps] [Preset]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunEncodeBenchmark));
+}
@@ -0,0 +1,187 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SRTFrameReadback.h"
+#include "CineSRTStream.h"
+#include "RHIGPUReadback.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Readback Latency (frames)"), STAT_CineSRT_ReadbackLatencyFrames, STATGROUP_CineSRT);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Readback Latency (ms)"), STAT_CineSRT_ReadbackLatencyMs, STATGROUP_CineSRT);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Readback Slots In Flight"), STAT_CineSRT_ReadbackInFlight, STATGROUP_CineSRT);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Readback Dropped Captures"), STAT_CineSRT_ReadbackDropped, STATGROUP_CineSRT);
+
+FSRTFrameReadback::FSRTFrameReadback(int32 InBufferCount, std::shared_ptr<FSRTFramePool> InFramePool)
+    : FramePool(MoveTemp(InFramePool))
+{
+    const int32 BufferCount = FMath::Clamp(InBufferCount, 1, 10);
+    Slots.SetNum(BufferCount);
+    for (int32 Index = 0; Index < BufferCount; ++Index)
+    {
+        Slots[Index].Readback = MakeUnique<FRHIGPUTextureReadback>(*FString::Printf(TEXT("SRTFrameReadback_%d"), Index));
+    }
+}
+
+FSRTFrameReadback::~FSRTFrameReadback()
+{
+    // Owners call Reset() before the last reference goes away; render commands hold their own reference.
+}
+
+void FSRTFrameReadback::SetSink(FFrameSink InSink)
+{
+    ENQUEUE_RENDER_COMMAND(SRTReadbackSetSink)(
+        [This = AsShared(), NewSink = MoveTemp(InSink)](FRHICommandListImmediate& RHICmdList) mutable
+        {
+            This->Sink = MoveTemp(NewSink);
+        });
+}
+
+void FSRTFrameReadback::EnqueueCapture(FTextureRenderTargetResource* RenderTargetResource, double CaptureTime)
+{
+    check(IsInGameThread());
+    if (!RenderTargetResource)
+    {
+        return;
+    }
+
+    const uint64 FrameNumber = GFrameCounter;
+    ENQUEUE_RENDER_COMMAND(SRTReadbackEnqueueCopy)(
+        [This = AsShared(), RenderTargetResource, FrameNumber, CaptureTime](FRHICommandListImmediate& RHICmdList)
+        {
+            // Drain first so a slot that finished this frame can be reused immediately
+            This->PollCompleted_RenderThread();
+            This->EnqueueCopy_RenderThread(RHICmdList, RenderTargetResource, FrameNumber, CaptureTime);
+        });
+}
+
+void FSRTFrameReadback::PollCompleted()
+{
+    ENQUEUE_RENDER_COMMAND(SRTReadbackPoll)(
+        [This = AsShared()](FRHICommandListImmediate& RHICmdList)
+        {
+            This->PollCompleted_RenderThread();
+        });
+}
+
+void FSRTFrameReadback::Reset()
+{
+    check(IsInGameThread());
+    ENQUEUE_RENDER_COMMAND(SRTReadbackReset)(
+        [This = AsShared()](FRHICommandListImmediate& RHICmdList)
+        {
+            This->Sink = nullptr;
+            for (FSlot& Slot : This->Slots)
+            {
+                Slot.bInFlight = false;
+            }
+            This->WriteIndex = 0;
+            This->ReadIndex = 0;
+            This->NumInFlight = 0;
+        });
+    FlushRenderingCommands();
+}
+
+FSRTFrameReadback::FReadbackStats FSRTFrameReadback::GetStats() const
+{
+    FScopeLock Lock(&StatsLock);
+    return Stats;
+}
+
+void FSRTFrameReadback::EnqueueCopy_RenderThread(FRHICommandListImmediate& RHICmdList, FTextureRenderTargetResource* RenderTargetResource, uint64 FrameNumber, double CaptureTime)
+{
+    check(IsInRenderingThread());
+
+    if (NumInFlight >= Slots.Num())
+    {
+        // Every staging buffer is still waiting on the GPU; skip this capture rather than stall
+        FScopeLock Lock(&StatsLock);
+        Stats.FramesDropped++;
+        INC_DWORD_STAT(STAT_CineSRT_ReadbackDropped);
+        if (PipelineStats)
+        {
+            PipelineStats->Add(CineSRT::EPipelineCounter::FramesDropped);
+        }
+        return;
+    }
+
+    FRHITexture* Texture = RenderTargetResource->GetRenderTargetTexture();
+    if (!Texture)
+    {
+        return;
+    }
+
+    FSlot& Slot = Slots[WriteIndex];
+    Slot.Size = Texture->GetSizeXY();
+    Slot.SubmitFrameNumber = FrameNumber;
+    Slot.SubmitTime = FPlatformTime::Seconds();
+    Slot.CaptureTime = CaptureTime;
+    Slot.bInFlight = true;
+    Slot.Readback->EnqueueCopy(RHICmdList, Texture);
+
+    WriteIndex = (WriteIndex + 1) % Slots.Num();
+    NumInFlight++;
+    SET_DWORD_STAT(STAT_CineSRT_ReadbackInFlight, NumInFlight);
+}
+
+void FSRTFrameReadback::PollCompleted_RenderThread()
+{
+    check(IsInRenderingThread());
+
+    // Slots complete in submission order, so stop at the first one that is not ready yet
+    while (NumInFlight > 0)
+    {
+        FSlot& Slot = Slots[ReadIndex];
+        if (!Slot.bInFlight || !Slot.Readback->IsReady())
+        {
+            break;
+        }
+
+        int32 RowPitchInPixels = 0;
+        const uint8* Source = static_cast<const uint8*>(Slot.Readback->Lock(RowPitchInPixels));
+        if (Source && Sink)
+        {
+            // Staging memory is copied straight into the pooled frame the encoder will read
+            FSRTFrameRef Frame = FramePool->Acquire(Slot.Size.X, Slot.Size.Y);
+            Frame->CaptureTime = Slot.CaptureTime;
+            const int32 RowBytes = Slot.Size.X * 4;
+            if (RowPitchInPixels == Slot.Size.X)
+            {
+                FMemory::Memcpy(Frame->Data.data(), Source, Frame->Data.size());
+            }
+            else
+            {
+                for (int32 Row = 0; Row < Slot.Size.Y; ++Row)
+                {
+                    FMemory::Memcpy(Frame->Data.data() + Row * RowBytes, Source + Row * RowPitchInPixels * 4, RowBytes);
+                }
+            }
+            Slot.Readback->Unlock();
+            Sink(MoveTemp(Frame));
+        }
+        else if (Source)
+        {
+            Slot.Readback->Unlock();
+        }
+
+        const int32 LatencyFrames = static_cast<int32>(GFrameCounterRenderThread - Slot.SubmitFrameNumber);
+        const double LatencySeconds = FPlatformTime::Seconds() - Slot.SubmitTime;
+        const float LatencyMs = static_cast<float>(LatencySeconds * 1000.0);
+        if (PipelineStats)
+        {
+            PipelineStats->Record(CineSRT::EPipelineStage::Readback, LatencySeconds);
+        }
+        SET_DWORD_STAT(STAT_CineSRT_ReadbackLatencyFrames, LatencyFrames);
+        SET_FLOAT_STAT(STAT_CineSRT_ReadbackLatencyMs, LatencyMs);
+        {
+            FScopeLock Lock(&StatsLock);
+            Stats.FramesRead++;
+            Stats.LastLatencyFrames = LatencyFrames;
+            Stats.LastLatencyMs = LatencyMs;
+        }
+
+        Slot.bInFlight = false;
+        ReadIndex = (ReadIndex + 1) % Slots.Num();
+        NumInFlight--;
+    }
+    SET_DWORD_STAT(STAT_CineSRT_ReadbackInFlight, NumInFlight);
+}
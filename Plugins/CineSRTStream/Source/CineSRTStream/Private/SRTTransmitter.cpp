@@ -2,321 +2,146 @@
 
 #include "SRTTransmitter.h"
 #include "CineSRTStream.h"
-#include "HAL/RunnableThread.h"
-
-bool FSRTTransmitter::bSRTInitialized = false;
-FCriticalSection FSRTTransmitter::SRTInitLock;
 
 FSRTTransmitter::FSRTTransmitter(const FTransmitterSettings& InSettings)
-    : Settings(InSettings)
-{
-}
-
-FSRTTransmitter::~FSRTTransmitter()
-{
-    StopTransmission();
-    CleanupSRT();
-}
-
-bool FSRTTransmitter::Init()
+    : Listener(std::make_shared<CineSRT::FTransmitter>(ToCoreSettings(InSettings)))
+    , bOwnsListener(true)
 {
     UE_LOG(LogCineSRT, Log, TEXT("Initializing SRT Transmitter - %s:%d"), 
-        *Settings.BindAddress, Settings.Port);
-    
-    return InitializeSRT();
-}
+        *InSettings.BindAddress, InSettings.Port);
 
-uint32 FSRTTransmitter::Run()
-{
-    UE_LOG(LogCineSRT, Log, TEXT("Transmitter thread started"));
-
-    int ConnectionAttempts = 0;
-    const int MaxAttempts = 10; // 10번만 시도
-    FDateTime LastLogTime = FDateTime::Now();
+    // 빈 스트림 ID = 이 포트로 들어오는 모든 호출자
+    Stream = Listener->CreateStream(std::string());
 
-    while (!bShouldStop && ConnectionAttempts < MaxAttempts)
+    // 전송 스레드에서 호출됨
+    Listener->OnError = [this](const std::string& Error)
     {
-        if (ClientSocket == SRT_INVALID_SOCK)
-        {
-            ConnectionAttempts++;
-
-            // 5초에 한 번만 로그
-            if ((FDateTime::Now() - LastLogTime).GetTotalSeconds() > 5.0)
-            {
-                UE_LOG(LogCineSRT, Log, TEXT("Waiting for connection on port %d (attempt %d/%d)"), Settings.Port, ConnectionAttempts, MaxAttempts);
-                LastLogTime = FDateTime::Now();
-            }
-
-            if (!WaitForClient())
-            {
-                FPlatformProcess::Sleep(1.0f);
-                continue;
-            }
-
-            // 연결 성공
-            UE_LOG(LogCineSRT, Log, TEXT("Client connected!"));
-            ConnectionAttempts = 0; // 리셋
-        }
-
-        // TransmissionQueue 처리 및 전송 로그 추가
-        while (!bShouldStop && ClientSocket != SRT_INVALID_SOCK)
-        {
-            TArray<uint8> FrameData;
-            {
-                FScopeLock Lock(&QueueCriticalSection);
-                if (TransmissionQueue.Num() == 0)
-                {
-                    break;
-                }
-                FrameData = TransmissionQueue[0];
-                TransmissionQueue.RemoveAt(0);
-            }
-            UE_LOG(LogCineSRT, Warning, TEXT("Sending frame: %d bytes"), FrameData.Num());
-            int sent = srt_send(ClientSocket, (char*)FrameData.GetData(), FrameData.Num());
-            if (sent == SRT_ERROR)
-            {
-                UE_LOG(LogCineSRT, Error, TEXT("Send failed"));
-                break;
-            }
-            else
-            {
-                UE_LOG(LogCineSRT, Warning, TEXT("Sent %d bytes successfully"), sent);
-            }
-            FPlatformProcess::Sleep(0.001f);
-        }
+        OnError.ExecuteIfBound(UTF8_TO_TCHAR(Error.c_str()));
+    };
+    BindStreamCallbacks();
+}
 
-        FPlatformProcess::Sleep(0.033f); // 약 30 FPS
-    }
+FSRTTransmitter::FSRTTransmitter(std::shared_ptr<CineSRT::FTransmitter> InListener, const FString& StreamID)
+    : Listener(MoveTemp(InListener))
+    , bOwnsListener(false)
+{
+    UE_LOG(LogCineSRT, Log, TEXT("Initializing SRT Transmitter - stream '%s' on the shared listener"), *StreamID);
 
-    UE_LOG(LogCineSRT, Log, TEXT("Transmitter thread stopped"));
-    return 0;
+    // 리스너 에러는 구독자가 여럿이라 서브시스템이 로그로 처리
+    Stream = Listener->CreateStream(TCHAR_TO_UTF8(*StreamID));
+    BindStreamCallbacks();
 }
 
-void FSRTTransmitter::Stop()
+FSRTTransmitter::~FSRTTransmitter()
 {
-    bShouldStop = true;
+    // 스트림 해제는 전송 스레드가 반영할 때까지 기다리므로 이후 콜백이 소멸 중인 델리게이트를 건드리지 않음
+    StopTransmission();
 }
 
-void FSRTTransmitter::Exit()
+void FSRTTransmitter::BindStreamCallbacks()
 {
-    CleanupSRT();
+    Stream->OnLinkStats = [this](const FLinkStats& Stats)
+    {
+        OnLinkStats.ExecuteIfBound(Stats);
+    };
+    Stream->OnKeyframeRequest = [this]()
+    {
+        OnKeyframeRequest.ExecuteIfBound();
+    };
 }
 
 bool FSRTTransmitter::StartTransmission()
 {
-    if (bIsTransmitting)
-        return false;
-
-    // 1. SRT 라이브러리 초기화 (반드시 제일 먼저!)
-    UE_LOG(LogCineSRT, Log, TEXT("[SRT] Initializing SRT library..."));
-    if (!InitializeSRT())
-    {
-        UE_LOG(LogCineSRT, Error, TEXT("[SRT] Failed to initialize SRT library"));
-        return false;
-    }
-
-    // 2. 소켓 설정
-    UE_LOG(LogCineSRT, Log, TEXT("[SRT] Configuring SRT socket..."));
-    if (!ConfigureSocket())
+    // 공유 리스너는 먼저 시작한 스트림이 띄우고 마지막 FSRTTransmitter가 사라질 때 닫힘
+    if (!Listener->IsTransmitting() && !Listener->StartTransmission())
     {
-        UE_LOG(LogCineSRT, Error, TEXT("[SRT] Failed to configure socket"));
         return false;
     }
-
-    // 3. 스레드 생성
-    bIsTransmitting = true;
-    bShouldStop = false;
-    if (!Thread)
+    if (!Listener->AddStream(Stream))
     {
-        UE_LOG(LogCineSRT, Warning, TEXT("[SRT] Creating transmitter thread..."));
-        Thread = FRunnableThread::Create(this, TEXT("SRTTransmitterThread"));
-        if (!Thread)
+        // 같은 스트림 ID가 이미 등록됨 (코어가 로그를 남김)
+        if (bOwnsListener)
         {
-            UE_LOG(LogCineSRT, Error, TEXT("[SRT] Failed to create thread"));
-            return false;
+            Listener->StopTransmission();
         }
-        UE_LOG(LogCineSRT, Warning, TEXT("[SRT] Thread created successfully"));
+        return false;
     }
     return true;
 }
 
-void FSRTTransmitter::StopTransmission()
+bool FSRTTransmitter::Prewarm()
 {
-    if (!bIsTransmitting)
-    {
-        return;
-    }
-    
-    bIsTransmitting = false;
-    bShouldStop = true;
-    
-    // 스레드 종료 대기 및 정리
-    if (Thread)
-    {
-        Thread->WaitForCompletion();
-        delete Thread;
-        Thread = nullptr;
-    }
-    
-    UE_LOG(LogCineSRT, Log, TEXT("Stopped SRT transmission"));
+    return Listener->IsTransmitting() || Listener->Prepare();
 }
 
-bool FSRTTransmitter::TransmitFrame(const TArray<uint8>& FrameData)
+void FSRTTransmitter::StopTransmission()
 {
-    if (!bIsTransmitting)
+    Listener->RemoveStream(Stream);
+    if (bOwnsListener)
     {
-        return false;
+        Listener->StopTransmission();
     }
-    
-    FScopeLock Lock(&QueueCriticalSection);
-    TransmissionQueue.Add(FrameData);
-    
-    return true;
 }
 
-void FSRTTransmitter::UpdateSettings(const FTransmitterSettings& NewSettings)
+bool FSRTTransmitter::TransmitFrame(FSRTEncodedFrameRef Frame)
 {
-    Settings = NewSettings;
+    return Stream->TransmitFrame(MoveTemp(Frame));
 }
 
-bool FSRTTransmitter::InitializeSRT()
+bool FSRTTransmitter::TransmitAudio(CineSRT::FEncodedAudioRef Packet)
 {
-    FScopeLock Lock(&SRTInitLock);
-    if (bSRTInitialized)
-    {
-        UE_LOG(LogCineSRT, Log, TEXT("SRT already initialized"));
-        return true;
-    }
-#if WITH_SRT
-    if (srt_startup() == 0)
-    {
-        bSRTInitialized = true;
-        UE_LOG(LogCineSRT, Log, TEXT("SRT library initialized"));
-        return true;
-    }
-    else
-    {
-        UE_LOG(LogCineSRT, Error, TEXT("Failed to initialize SRT library"));
-        return false;
-    }
-#else
-    bSRTInitialized = true;
-    UE_LOG(LogCineSRT, Warning, TEXT("SRT library not available - using mock"));
-    return true;
-#endif
+    return Stream->TransmitAudio(MoveTemp(Packet));
 }
 
-bool FSRTTransmitter::ConfigureSocket()
+void FSRTTransmitter::UpdateSettings(const FTransmitterSettings& NewSettings)
 {
-#if WITH_SRT
-    // 서버 소켓 생성
-    ServerSocket = srt_create_socket();
-    if (ServerSocket == SRT_INVALID_SOCK)
-    {
-        UE_LOG(LogCineSRT, Error, TEXT("Failed to create SRT socket"));
-        return false;
-    }
-    
-    // 소켓 옵션 설정
-    srt_setsockopt(ServerSocket, 0, SRTO_LATENCY, &Settings.LatencyTolerance, sizeof(Settings.LatencyTolerance));
-    srt_setsockopt(ServerSocket, 0, SRTO_MAXBW, &Settings.MaxBW, sizeof(Settings.MaxBW));
-    srt_setsockopt(ServerSocket, 0, SRTO_INPUTBW, &Settings.InputBW, sizeof(Settings.InputBW));
-    srt_setsockopt(ServerSocket, 0, SRTO_OHEADBW, &Settings.Overhead, sizeof(Settings.Overhead));
-    
-    // 바인딩
-    sockaddr_in sa;
-    memset(&sa, 0, sizeof sa);
-    sa.sin_family = AF_INET;
-    sa.sin_port = htons(Settings.Port);
-    
-    if (Settings.BindAddress == TEXT("0.0.0.0"))
-    {
-        sa.sin_addr.s_addr = INADDR_ANY;
-    }
-    else
-    {
-        inet_pton(AF_INET, TCHAR_TO_UTF8(*Settings.BindAddress), &sa.sin_addr);
-    }
-    
-    if (srt_bind(ServerSocket, (sockaddr*)&sa, sizeof sa) == SRT_ERROR)
+    // 공유 리스너의 포트/지연 설정은 프로젝트 설정이 정함
+    if (bOwnsListener)
     {
-        UE_LOG(LogCineSRT, Error, TEXT("Failed to bind SRT socket to port %d"), Settings.Port);
-        return false;
+        Listener->UpdateSettings(ToCoreSettings(NewSettings));
     }
-    
-    // 리스닝 시작
-    if (srt_listen(ServerSocket, 1) == SRT_ERROR)
-    {
-        UE_LOG(LogCineSRT, Error, TEXT("Failed to start listening"));
-        return false;
-    }
-    
-    UE_LOG(LogCineSRT, Log, TEXT("SRT socket configured successfully"));
-    return true;
-#else
-    return false;
-#endif
 }
 
-bool FSRTTransmitter::WaitForClient()
+TArray<FSRTTransmitter::FSRTClientStats> FSRTTransmitter::GetClientStats() const
 {
-#if WITH_SRT
-    sockaddr_in clientAddr;
-    int addrLen = sizeof(clientAddr);
-    
-    ClientSocket = srt_accept(ServerSocket, (sockaddr*)&clientAddr, &addrLen);
-    if (ClientSocket != SRT_INVALID_SOCK)
-    {
-        char clientIP[INET_ADDRSTRLEN];
-        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
-        UE_LOG(LogCineSRT, Log, TEXT("Client connected from %s:%d"), UTF8_TO_TCHAR(clientIP), ntohs(clientAddr.sin_port));
-        return true;
-    }
-    
-    return false;
-#else
-    return false;
-#endif
+    TArray<FSRTClientStats> Result;
+    for (const CineSRT::FTransmitter::FClientStats& Source : Stream->GetClientStats())
+    {
+        FSRTClientStats& Stats = Result.AddDefaulted_GetRef();
+        Stats.Address = UTF8_TO_TCHAR(Source.Address.c_str());
+        Stats.SendRateMbps = Source.SendRateMbps;
+        Stats.Backlog = Source.Backlog;
+        Stats.FramesSent = Source.FramesSent;
+        Stats.FramesDropped = Source.FramesDropped;
+        Stats.BytesSent = Source.BytesSent;
+        Stats.ConnectedSeconds = Source.ConnectedSeconds;
+        Stats.TimeToFirstPictureMs = Source.TimeToFirstPictureMs;
+        Stats.RttMs = Source.RttMs;
+        Stats.BandwidthMbps = Source.BandwidthMbps;
+        Stats.SendBufferMs = Source.SendBufferMs;
+        Stats.PacketsLost = Source.PacketsLost;
+        Stats.PacketsDropped = Source.PacketsDropped;
+    }
+    return Result;
 }
 
-bool FSRTTransmitter::SendFrameData(const TArray<uint8>& FrameData)
+CineSRT::FTransmitter::FSettings FSRTTransmitter::ToCoreSettings(const FTransmitterSettings& InSettings)
 {
-#if WITH_SRT
-    if (ClientSocket == SRT_INVALID_SOCK)
-    {
-        return false;
-    }
-    
-    int sent = srt_send(ClientSocket, (char*)FrameData.GetData(), FrameData.Num());
-    if (sent == SRT_ERROR)
-    {
-        UE_LOG(LogCineSRT, Error, TEXT("Failed to send frame data: %s"), UTF8_TO_TCHAR(srt_getlasterror_str()));
-        OnError.ExecuteIfBound(FString::Printf(TEXT("Send error: %s"), UTF8_TO_TCHAR(srt_getlasterror_str())));
-        return false;
-    }
-    
-    return true;
-#else
-    return false;
-#endif
+    CineSRT::FTransmitter::FSettings CoreSettings;
+    CoreSettings.BindAddress = TCHAR_TO_UTF8(*InSettings.BindAddress);
+    CoreSettings.Port = InSettings.Port;
+    CoreSettings.LatencyTolerance = InSettings.LatencyTolerance;
+    CoreSettings.MaxBW = InSettings.MaxBW;
+    CoreSettings.InputBW = InSettings.InputBW;
+    CoreSettings.Overhead = InSettings.Overhead;
+    CoreSettings.QueueCapacity = InSettings.QueueCapacity;
+    CoreSettings.OverflowPolicy = static_cast<CineSRT::EQueueOverflowPolicy>(InSettings.OverflowPolicy);
+    CoreSettings.BlockTimeoutMs = InSettings.BlockTimeoutMs;
+    CoreSettings.MaxClients = InSettings.MaxClients;
+    CoreSettings.ClientQueueCapacity = InSettings.ClientQueueCapacity;
+    CoreSettings.SlowClientTimeoutMs = InSettings.SlowClientTimeoutMs;
+    CoreSettings.LinkStatsPeriodMs = InSettings.LinkStatsPeriodMs;
+    CoreSettings.JoinCacheMaxBytes = InSettings.JoinCacheMaxBytes;
+    CoreSettings.bKeyframeOnJoin = InSettings.bKeyframeOnJoin;
+    return CoreSettings;
 }
-
-void FSRTTransmitter::CleanupSRT()
-{
-#if WITH_SRT
-    if (ClientSocket != SRT_INVALID_SOCK)
-    {
-        srt_close(ClientSocket);
-        ClientSocket = SRT_INVALID_SOCK;
-    }
-    
-    if (ServerSocket != SRT_INVALID_SOCK)
-    {
-        srt_close(ServerSocket);
-        ServerSocket = SRT_INVALID_SOCK;
-    }
-    
-    srt_cleanup();
-    UE_LOG(LogCineSRT, Log, TEXT("SRT cleanup completed"));
-#endif
-} 
\ No newline at end of file
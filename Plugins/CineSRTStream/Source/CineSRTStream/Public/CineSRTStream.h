@@ -4,8 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogCineSRT, Log, All);
+DECLARE_STATS_GROUP(TEXT("CineSRT"), STATGROUP_CineSRT, STATCAT_Advanced);
 
 class FCineSRTStreamModule : public IModuleInterface
 {
@@ -25,4 +27,7 @@ public:
     {
         return FModuleManager::Get().IsModuleLoaded("CineSRTStream");
     }
+
+private:
+    bool bSRTStarted = false; // StartupModule에서 잡은 SRT 라이브러리 참조
 };
@@ -6,17 +6,144 @@
 #include "Components/ActorComponent.h"
 #include "Engine/TextureRenderTarget2D.h"
 #include "CineSRTStreamSettings.h"
+#include "SRTFramePool.h"
+#include "SRTEncoder.h"
+#include "CineSRTFrameCadence.h"
 #include "CineSRTStreamComponent.generated.h"
 
 // Forward declarations
 class UCameraComponent;
 class USceneCaptureComponent2D;
-class FSRTEncoder;
 class FSRTTransmitter;
+class FSRTFrameReadback;
+class FSRTAudioCapture;
+struct FSRTRenditionStream;
+namespace CineSRT { class FBitrateController; class FPipelineStats; class FRecorder; }
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStreamingStateChanged, bool, bIsStreaming);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStreamingError, const FString&, ErrorMessage);
 
+/** Timing of one pipeline stage since streaming started. */
+USTRUCT(BlueprintType)
+struct FSRTStageStats
+{
+    GENERATED_BODY()
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 Samples = 0;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    float AverageMs = 0.0f;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    float P50Ms = 0.0f;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    float P95Ms = 0.0f;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    float P99Ms = 0.0f;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    float MaxMs = 0.0f;
+};
+
+/** Per-stage timing and frame counters of one stream, from capture to the SRT send buffer. */
+USTRUCT(BlueprintType)
+struct FSRTStreamStats
+{
+    GENERATED_BODY()
+    
+    /** How far each capture landed from its exact TargetFPS slot; game frames that do not line up with the output rate show here, not as judder */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    FSRTStageStats Cadence;
+    
+    /** Scene capture call on the game thread */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    FSRTStageStats Capture;
+    
+    /** GPU copy queued until the pixels reach a pooled frame */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    FSRTStageStats Readback;
+    
+    /** Downscale from the capture size on the encoder threads (renditions only) */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    FSRTStageStats Scale;
+    
+    /** BGRA to YUV conversion ahead of H.264 (no samples for MJPEG) */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    FSRTStageStats Convert;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    FSRTStageStats Encode;
+    
+    /** Waiting in the encoder input queue, the reorder stage and the transmit queue */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    FSRTStageStats QueueWait;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    FSRTStageStats Mux;
+    
+    /** Muxed until the SRT send buffer took the last packet, per client */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    FSRTStageStats Send;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 FramesCaptured = 0;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 FramesEncoded = 0;
+    
+    /** Readback ring, encoder queue and transmit queue drops together */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 FramesDropped = 0;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 FramesSent = 0;
+    
+    /** Unchanged pictures skipped or repeated instead of encoded (see StaticFramePolicy) */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 FramesStatic = 0;
+    
+    /** Output slots no capture landed on because a game frame ran long (repeated for MJPEG, see bRepeatMissedFrames) */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 SlotsMissed = 0;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 ConnectedClients = 0;
+    
+    /** Receivers that started from the cached GOP instead of waiting for the next keyframe (see JoinCacheMaxMB) */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 ClientsJoinedFromCache = 0;
+    
+    /** Connect to first keyframe handed to SRT, median and worst over every receiver; the picture shows one SRT latency later */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    float TimeToFirstPictureP50Ms = 0.0f;
+    
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    float TimeToFirstPictureMaxMs = 0.0f;
+    
+    /** StartStreaming to the first frame's packets leaving the transmit queue, -1 until then (see bPrewarmPipeline) */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    float TimeToFirstPacketMs = -1.0f;
+    
+    /** Frames written to the local ISO recording (main stream only, see StartRecording) */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 FramesRecorded = 0;
+    
+    /** Frames left out of the recording because the disk fell behind; the live stream is not affected */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 RecordingFramesDropped = 0;
+    
+    /** Audio packets muxed into the stream (see bStreamAudio) */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 AudioPacketsSent = 0;
+    
+    /** Audio packets dropped: the audio queue was full, or they were captured before the first video frame */
+    UPROPERTY(BlueprintReadOnly, Category = "SRT Stream")
+    int32 AudioPacketsDropped = 0;
+};
+
 UCLASS(ClassGroup=(Streaming), meta=(BlueprintSpawnableComponent, DisplayName="SRT Stream"))
 class CINESRTSTREAM_API USRTStreamComponent : public UActorComponent
 {
@@ -26,9 +153,11 @@ public:
     USRTStreamComponent();
 
     // Editor properties
+    /** Own listener port; unused when the project's shared listener is on */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SRT Settings", meta=(ClampMin=1024, ClampMax=65535))
     int32 StreamPort = 9001;
     
+    /** SRT streamid callers ask for on the shared listener; must be unique among streaming components */
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SRT Settings")
     FString StreamID = TEXT("Camera1");
     
@@ -51,6 +180,13 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Quality")
     ESRTEncoderType EncoderType = ESRTEncoderType::Auto;
     
+    /**
+     * Simulcast: extra encodes of the same scene capture at smaller presets, each on its own streamid
+     * (StreamID + suffix) on this stream's listener. Frames are scaled on the encoder threads; set before BeginPlay.
+     */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulcast")
+    TArray<FSRTRendition> Renditions;
+    
     // Runtime control
     UFUNCTION(BlueprintCallable, Category = "SRT Stream")
     void StartStreaming();
@@ -70,6 +206,38 @@ public:
     UFUNCTION(BlueprintCallable, Category = "SRT Stream")
     FString GetStreamURL() const;
     
+    UFUNCTION(BlueprintCallable, Category = "SRT Stream")
+    int32 GetConnectedClientCount() const;
+    
+    /** URLs of the running simulcast renditions, in the order of Renditions (skipped entries left out) */
+    UFUNCTION(BlueprintCallable, Category = "SRT Stream")
+    TArray<FString> GetRenditionStreamURLs() const;
+    
+    /** Per-stage timing percentiles and frame counters since streaming started */
+    UFUNCTION(BlueprintCallable, Category = "SRT Stream")
+    FSRTStreamStats GetStreamStats() const;
+    
+    /** Same as GetStreamStats for each running rendition, in the order of GetRenditionStreamURLs */
+    UFUNCTION(BlueprintCallable, Category = "SRT Stream")
+    TArray<FSRTStreamStats> GetRenditionStreamStats() const;
+    
+    /**
+     * Records this stream's encoded frames to a local MPEG-TS file next to the live stream, from the next keyframe
+     * on. Empty FilePath = RecordingDirectory/<StreamID>_<date-time>.ts. Requires streaming; StopStreaming ends it.
+     */
+    UFUNCTION(BlueprintCallable, Category = "SRT Stream")
+    bool StartRecording(const FString& FilePath = TEXT(""));
+    
+    UFUNCTION(BlueprintCallable, Category = "SRT Stream")
+    void StopRecording();
+    
+    UFUNCTION(BlueprintCallable, Category = "SRT Stream")
+    bool IsRecording() const;
+    
+    /** File of the current (or last) recording */
+    UFUNCTION(BlueprintCallable, Category = "SRT Stream")
+    FString GetRecordingPath() const;
+    
     // Events
     UPROPERTY(BlueprintAssignable, Category = "SRT Stream")
     FOnStreamingStateChanged OnStreamingStateChanged;
@@ -93,24 +261,62 @@ private:
     UPROPERTY()
     UTextureRenderTarget2D* RenderTarget;
     
+    // Next render target after a resolution change on air; replaces RenderTarget once the encoder can take its size
+    UPROPERTY()
+    UTextureRenderTarget2D* PendingRenderTarget = nullptr;
+    
     // SRT components
     TSharedPtr<FSRTEncoder> Encoder;
     TSharedPtr<FSRTTransmitter> Transmitter;
     
+    // Simulcast renditions fed from the same captured frames (built in BeginPlay, fixed while playing)
+    TArray<TSharedPtr<FSRTRenditionStream, ESPMode::ThreadSafe>> RenditionStreams;
+    
+    // Async GPU readback ring (null when bUseAsyncCapture is off)
+    TSharedPtr<FSRTFrameReadback, ESPMode::ThreadSafe> FrameReadback;
+    
+    // Reusable frame buffers shared by capture and the encoder
+    std::shared_ptr<FSRTFramePool> FramePool;
+    
+    // Adaptive bitrate (null when bAdaptiveBitrate is off); updated only on the transmitter thread while streaming
+    TSharedPtr<CineSRT::FBitrateController, ESPMode::ThreadSafe> BitrateController;
+    ESRTStreamQuality BaseStreamQuality = ESRTStreamQuality::HD_1080p; // quality for rungs that do not change it
+    bool bLadderChangesQuality = false;
+    
+    // Local ISO recording tap on the main encoder's output (created in InitializeTransmitter, idle until StartRecording)
+    TSharedPtr<CineSRT::FRecorder, ESPMode::ThreadSafe> Recorder;
+    
+    // Submix tap feeding the main stream (null when bStreamAudio is off); listens only while streaming
+    TSharedPtr<FSRTAudioCapture, ESPMode::ThreadSafe> AudioCapture;
+    
+    // Per-stage timing shared with the readback, encoder and transmitter threads
+    std::shared_ptr<CineSRT::FPipelineStats> PipelineStats;
+    double LastTelemetryLogTime = 0.0;
+    
     // State
     bool bIsStreaming = false;
-    float TimeSinceLastCapture = 0.0f;
-    float CaptureInterval = 0.033f; // 30 FPS default
+    bool bEndingPlay = false; // StopStreaming from EndPlay: the listener is about to go, do not bind it again
+    CineSRT::FFrameCadence CaptureCadence; // output slots at exact TargetFPS steps, polled once per game frame
     
     // Internal methods
     void FindCameraComponent();
     void CreateRenderTarget();
+    UTextureRenderTarget2D* CreateCaptureTarget(const FIntPoint& Resolution, bool bImmediate);
+    void SwapPendingRenderTarget();
     void InitializeEncoder();
     void InitializeTransmitter();
-    void CaptureFrame();
+    void InitializeRenditions();
+    void InitializeBitrateController();
+    void ApplyBitrateRung_GameThread(int32 Level, int32 RungBitrate, int32 RungJpegQuality);
+    void InitializeCapture();
+    void PrewarmTransmitter();
+    void CaptureFrame(double SlotTime);
     void UpdateCaptureInterval();
     FIntPoint GetTargetResolution() const;
-    bool GetFrameDataFromRenderTarget(TArray<uint8>& OutFrameData);
+    FSRTEncoder::FEncoderSettings BuildEncoderSettings() const;
+    bool GetFrameDataFromRenderTarget(FSRTFrameRef& OutFrame);
+    FString MakeStreamURL(const FString& InStreamID) const;
+    void ReportPipelineStats(); // stat group, CSV profiler and the periodic log summary
     
     // Callbacks
     void OnStreamingErrorInternal(const FString& Error);
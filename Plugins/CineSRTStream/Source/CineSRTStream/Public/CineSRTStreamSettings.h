@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DeveloperSettings.h"
+#include "UObject/SoftObjectPath.h"
 #include "CineSRTStreamSettings.generated.h"
 
 UENUM(BlueprintType)
@@ -24,7 +25,64 @@ enum class ESRTEncoderType : uint8
     NVENC           UMETA(DisplayName = "NVIDIA NVENC"),
     AMF             UMETA(DisplayName = "AMD AMF"),
     QuickSync       UMETA(DisplayName = "Intel QuickSync"),
-    Software        UMETA(DisplayName = "Software (x264)")
+    Software        UMETA(DisplayName = "Software (OpenH264)")
+};
+
+UENUM(BlueprintType)
+enum class ESRTQueueOverflowPolicy : uint8
+{
+    DropOldest          UMETA(DisplayName = "Drop Oldest"),
+    DropNonKeyframes    UMETA(DisplayName = "Drop Non-Keyframes"),
+    Block               UMETA(DisplayName = "Block Producer")
+};
+
+UENUM(BlueprintType)
+enum class ESRTStaticFramePolicy : uint8
+{
+    Encode      UMETA(DisplayName = "Always Encode"),
+    Skip        UMETA(DisplayName = "Skip Unchanged Frames"),
+    Repeat      UMETA(DisplayName = "Repeat Last Frame (MJPEG)")
+};
+
+/** One step of the adaptive bitrate ladder, highest first. */
+USTRUCT(BlueprintType)
+struct FSRTBitrateRung
+{
+    GENERATED_BODY()
+    
+    /** Target bitrate in Kbps (H.264); also the nominal rate of the rung when judging whether the link fits it */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Bitrate", meta = (ClampMin = 100, ClampMax = 50000))
+    int32 Bitrate = 8000;
+    
+    /** MJPEG has no rate control; quality is its bitrate knob */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Bitrate", meta = (ClampMin = 10, ClampMax = 100))
+    int32 JpegQuality = 85;
+    
+    /** Also switch resolution/frame rate on this rung (restarts the encoder) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Bitrate")
+    bool bChangeQuality = false;
+    
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Adaptive Bitrate", meta = (EditCondition = "bChangeQuality"))
+    ESRTStreamQuality Quality = ESRTStreamQuality::HD_720p;
+};
+
+/** One extra encode of a stream's capture at a smaller preset, served on its own SRT streamid. */
+USTRUCT(BlueprintType)
+struct FSRTRendition
+{
+    GENERATED_BODY()
+
+    /** Size, frame rate and rate of the rendition; must not be larger than the stream's own quality (Custom is not supported) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulcast")
+    ESRTStreamQuality Quality = ESRTStreamQuality::HD_720p;
+
+    /** Appended to the stream's StreamID to form the rendition's streamid; empty = from the quality ("_720p", ...) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulcast")
+    FString StreamIDSuffix;
+
+    /** Bitrate in Kbps; 0 = the quality preset's */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Simulcast", meta = (ClampMin = 0, ClampMax = 50000))
+    int32 Bitrate = 0;
 };
 
 UCLASS(config = CineSRTStream, defaultconfig, meta = (DisplayName = "Cine SRT Stream"))
@@ -52,9 +110,14 @@ public:
     UPROPERTY(config, EditAnywhere, Category = "Encoder")
     bool bUseHardwareAcceleration = true;
     
+    /** Parallel frame encoders for intra-only codecs (MJPEG); slice threads per frame for H.264 */
     UPROPERTY(config, EditAnywhere, Category = "Encoder", meta = (ClampMin = 1, ClampMax = 10))
     int32 EncoderThreadCount = 4;
     
+    /** Send MJPEG frames in strips of this many rows while they are still being encoded, cutting latency on large frames (0 = whole frames; H.264 always sends whole frames) */
+    UPROPERTY(config, EditAnywhere, Category = "Encoder", meta = (ClampMin = 0, ClampMax = 1024))
+    int32 SliceStreamingRows = 0;
+    
     /** Network settings */
     UPROPERTY(config, EditAnywhere, Category = "Network")
     FString DefaultBindAddress = TEXT("0.0.0.0");
@@ -65,6 +128,144 @@ public:
     UPROPERTY(config, EditAnywhere, Category = "Network", meta = (ClampMin = 1000, ClampMax = 30000))
     int32 ReconnectDelayMs = 5000;
     
+    /** Encoded frames buffered ahead of the send thread before the overflow policy applies */
+    UPROPERTY(config, EditAnywhere, Category = "Network", meta = (ClampMin = 2, ClampMax = 256))
+    int32 TransmitQueueCapacity = 16;
+    
+    UPROPERTY(config, EditAnywhere, Category = "Network")
+    ESRTQueueOverflowPolicy TransmitOverflowPolicy = ESRTQueueOverflowPolicy::DropNonKeyframes;
+    
+    /** How long a blocked producer waits for space before dropping the frame */
+    UPROPERTY(config, EditAnywhere, Category = "Network", meta = (ClampMin = 1, ClampMax = 1000,
+        EditCondition = "TransmitOverflowPolicy == ESRTQueueOverflowPolicy::Block"))
+    int32 TransmitBlockTimeoutMs = 50;
+    
+    /** Receivers (monitors, recorders, playout) that can pull the stream at once */
+    UPROPERTY(config, EditAnywhere, Category = "Network", meta = (ClampMin = 1, ClampMax = 64))
+    int32 MaxClients = 8;
+    
+    /** Frames buffered per receiver; a receiver that overflows it loses its backlog and resyncs on the next keyframe */
+    UPROPERTY(config, EditAnywhere, Category = "Network", meta = (ClampMin = 2, ClampMax = 256))
+    int32 ClientQueueCapacity = 8;
+    
+    /** A receiver that keeps overflowing for this long is disconnected */
+    UPROPERTY(config, EditAnywhere, Category = "Network", meta = (ClampMin = 100, ClampMax = 60000))
+    int32 SlowClientTimeoutMs = 3000;
+    
+    /**
+     * Most recent GOP (keyframe and everything since) kept per stream and sent to each new receiver ahead of live
+     * frames, so it shows a picture at once instead of waiting for the next keyframe (0 = off). A GOP larger than
+     * this is not cached.
+     */
+    UPROPERTY(config, EditAnywhere, Category = "Network", meta = (ClampMin = 0, ClampMax = 64))
+    int32 JoinCacheMaxMB = 8;
+    
+    /** Ask the encoder for an immediate keyframe when a receiver joins and no cached GOP can start it */
+    UPROPERTY(config, EditAnywhere, Category = "Network")
+    bool bKeyframeOnJoin = true;
+    
+    /** Steer encoder bitrate (and optionally stream quality) from SRT link statistics */
+    UPROPERTY(config, EditAnywhere, Category = "Adaptive Bitrate")
+    bool bAdaptiveBitrate = false;
+    
+    /** Rungs from highest to lowest; empty = five steps down from the stream's own bitrate and JPEG quality */
+    UPROPERTY(config, EditAnywhere, Category = "Adaptive Bitrate", meta = (EditCondition = "bAdaptiveBitrate"))
+    TArray<FSRTBitrateRung> BitrateLadder;
+    
+    /** How often the SRT link statistics are sampled */
+    UPROPERTY(config, EditAnywhere, Category = "Adaptive Bitrate", meta = (ClampMin = 100, ClampMax = 5000, EditCondition = "bAdaptiveBitrate"))
+    int32 LinkStatsPeriodMs = 500;
+    
+    /** Share of the SRT latency window the unacknowledged send buffer may span before stepping down */
+    UPROPERTY(config, EditAnywhere, Category = "Adaptive Bitrate", meta = (ClampMin = 0.1, ClampMax = 1.0, EditCondition = "bAdaptiveBitrate"))
+    float DowngradeBufferRatio = 0.5f;
+    
+    /** Clean link time before stepping back up; doubles each time a step up congests the link again */
+    UPROPERTY(config, EditAnywhere, Category = "Adaptive Bitrate", meta = (ClampMin = 1.0, ClampMax = 300.0, EditCondition = "bAdaptiveBitrate"))
+    float UpgradeHoldSeconds = 10.0f;
+    
+    /**
+     * Serve every stream component from one SRT listener on SharedListenerPort; callers pick a camera with
+     * srt://host:port?streamid=<StreamID>. Off = each component listens on its own StreamPort.
+     */
+    UPROPERTY(config, EditAnywhere, Category = "Multi-Camera")
+    bool bSharedListener = false;
+    
+    UPROPERTY(config, EditAnywhere, Category = "Multi-Camera", meta = (ClampMin = 1024, ClampMax = 65535, EditCondition = "bSharedListener"))
+    int32 SharedListenerPort = 9000;
+    
+    /** Encode threads shared by every stream on the shared listener (0 = cores - 2); EncoderThreadCount then only caps how many frames of one stream encode at once */
+    UPROPERTY(config, EditAnywhere, Category = "Multi-Camera", meta = (ClampMin = 0, ClampMax = 64, EditCondition = "bSharedListener"))
+    int32 SharedEncoderThreads = 0;
+    
+    /**
+     * Unchanged frames (locked-off cameras, graphics layers) are compared with the last encoded one before encoding.
+     * Skip sends nothing until the picture changes; Repeat re-sends the last MJPEG frame so receivers keep their
+     * frame rate (H.264 falls back to Skip). Saves encode CPU, and with Skip bandwidth too.
+     */
+    UPROPERTY(config, EditAnywhere, Category = "Static Frames")
+    ESRTStaticFramePolicy StaticFramePolicy = ESRTStaticFramePolicy::Encode;
+    
+    /** Per-channel difference still treated as unchanged (0 = identical pixels); small values absorb dithering and noise */
+    UPROPERTY(config, EditAnywhere, Category = "Static Frames", meta = (ClampMin = 0, ClampMax = 32,
+        EditCondition = "StaticFramePolicy != ESRTStaticFramePolicy::Encode"))
+    int32 StaticFrameTolerance = 0;
+    
+    /** An unchanged picture is still encoded this often, so late joiners and lossy links get a refresh */
+    UPROPERTY(config, EditAnywhere, Category = "Static Frames", meta = (ClampMin = 0.1, ClampMax = 60.0,
+        EditCondition = "StaticFramePolicy != ESRTStaticFramePolicy::Encode"))
+    float StaticFrameKeepAliveSeconds = 1.0f;
+
+    /**
+     * Record every stream's encoded output to a local MPEG-TS file (ISO recording) while it streams. Frames go to disk
+     * on a writer thread per stream; a disk that cannot keep up drops recorded frames, never live ones.
+     */
+    UPROPERTY(config, EditAnywhere, Category = "Recording")
+    bool bRecordISO = false;
+
+    /** Where recordings are written as <StreamID>_<date-time>.ts (empty = Saved/CineSRT/Recordings) */
+    UPROPERTY(config, EditAnywhere, Category = "Recording")
+    FString RecordingDirectory;
+
+    /** Encoded frames allowed to wait for the disk before recording drops frames */
+    UPROPERTY(config, EditAnywhere, Category = "Recording", meta = (ClampMin = 8, ClampMax = 3600))
+    int32 RecordingQueueFrames = 240;
+
+    /** Encoded bytes allowed to wait for the disk before recording drops frames */
+    UPROPERTY(config, EditAnywhere, Category = "Recording", meta = (ClampMin = 16, ClampMax = 8192))
+    int32 RecordingBacklogMB = 512;
+
+    /** Size of each disk write; large writes keep several 4K recordings on one drive sequential */
+    UPROPERTY(config, EditAnywhere, Category = "Recording", meta = (ClampMin = 1, ClampMax = 64))
+    int32 RecordingWriteBlockMB = 4;
+
+    /**
+     * Mux the game's audio into each component's main stream as uncompressed SMPTE 302M PCM, stamped on the same capture
+     * clock as the video. Needs the audio mixer at 48 kHz; recordings and renditions stay video-only.
+     */
+    UPROPERTY(config, EditAnywhere, Category = "Audio")
+    bool bStreamAudio = false;
+
+    /** Submix to capture (empty = the main submix, i.e. everything the listener hears) */
+    UPROPERTY(config, EditAnywhere, Category = "Audio", meta = (AllowedClasses = "/Script/Engine.SoundSubmix", EditCondition = "bStreamAudio"))
+    FSoftObjectPath AudioSubmix;
+
+    /** Channels in the stream (2 to 8, even); extra submix channels are dropped, missing ones are silent */
+    UPROPERTY(config, EditAnywhere, Category = "Audio", meta = (ClampMin = 2, ClampMax = 8, EditCondition = "bStreamAudio"))
+    int32 AudioChannels = 2;
+
+    /** Bits per sample: 16, 20 or 24 (24-bit stereo is about 2.3 Mbps) */
+    UPROPERTY(config, EditAnywhere, Category = "Audio", meta = (ClampMin = 16, ClampMax = 24, EditCondition = "bStreamAudio"))
+    int32 AudioBitsPerSample = 24;
+
+    /** Audio rendered in smaller buffers is gathered into packets of at least this length */
+    UPROPERTY(config, EditAnywhere, Category = "Audio", meta = (ClampMin = 1, ClampMax = 40, EditCondition = "bStreamAudio"))
+    int32 AudioPacketMs = 10;
+
+    /** Added to every audio timestamp to line sound up with the picture (positive = audio plays later) */
+    UPROPERTY(config, EditAnywhere, Category = "Audio", meta = (ClampMin = -500, ClampMax = 500, EditCondition = "bStreamAudio"))
+    int32 AudioSyncOffsetMs = 0;
+
     /** Performance settings */
     UPROPERTY(config, EditAnywhere, Category = "Performance")
     bool bUseAsyncCapture = true;
@@ -72,5 +273,23 @@ public:
     UPROPERTY(config, EditAnywhere, Category = "Performance", meta = (ClampMin = 1, ClampMax = 10))
     int32 CaptureBufferCount = 3;
     
+    /**
+     * Captures follow an exact TargetFPS clock rather than the game frame. When a long game frame misses output slots,
+     * re-send the last MJPEG frame for them so receivers keep a constant frame rate (H.264 leaves the gap).
+     */
+    UPROPERTY(config, EditAnywhere, Category = "Performance")
+    bool bRepeatMissedFrames = true;
+    
+    /**
+     * Get the pipeline ready before streaming starts: bind the listener at BeginPlay, encode a blank frame on every
+     * encoder worker and commit the capture buffers, so the first captured frame goes out within one frame interval.
+     */
+    UPROPERTY(config, EditAnywhere, Category = "Performance")
+    bool bPrewarmPipeline = true;
+    
+    /** How often each stream logs its per-stage timing summary (0 = never) */
+    UPROPERTY(config, EditAnywhere, Category = "Performance", meta = (ClampMin = 0.0, ClampMax = 600.0))
+    float TelemetryLogIntervalSeconds = 10.0f;
+    
     virtual FName GetCategoryName() const override { return TEXT("Streaming"); }
 }; 
\ No newline at end of file
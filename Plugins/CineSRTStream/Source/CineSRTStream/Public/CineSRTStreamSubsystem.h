@@ -0,0 +1,45 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "SRTTransmitter.h"
+#include "CineSRTEncodeScheduler.h"
+#include "CineSRTStreamSubsystem.generated.h"
+
+/**
+ * Shared multi-camera infrastructure used when UCineSRTStreamSettings::bSharedListener is on:
+ * one SRT listener that routes each caller to a camera by its SRT streamid, and one bounded
+ * encode thread pool that every camera's encoder runs on.
+ * Both are created on first use and released when the last stream using them goes away,
+ * so the port and threads are only held while something is streaming. Game thread only.
+ */
+UCLASS()
+class CINESRTSTREAM_API UCineSRTStreamSubsystem : public UEngineSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    static bool IsSharedListenerEnabled();
+
+    /**
+     * A transmitter serving StreamID on the shared listener. Settings configure the listener when this
+     * creates it (the port is always SharedListenerPort); later callers share whatever is running.
+     */
+    TSharedPtr<FSRTTransmitter> CreateTransmitter(const FString& StreamID, const FSRTTransmitter::FTransmitterSettings& Settings);
+
+    /** Encode threads shared by every stream; hand to FSRTEncoder::SetScheduler before Initialize. */
+    std::shared_ptr<CineSRT::FEncodeScheduler> GetEncodeScheduler();
+
+    int32 GetSharedListenerPort() const;
+
+    /** Streams currently registered on the shared listener (0 while it is closed). */
+    UFUNCTION(BlueprintCallable, Category = "SRT Stream")
+    int32 GetNumSharedStreams() const;
+
+private:
+    // 소유는 각 스트림의 FSRTTransmitter/FSRTEncoder - 마지막 사용자가 사라지면 포트와 스레드도 정리됨
+    std::weak_ptr<CineSRT::FTransmitter> Listener;
+    std::weak_ptr<CineSRT::FEncodeScheduler> EncodeScheduler;
+};
@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SharedPointer.h"
+#include "AudioDeviceHandle.h"
+#include "ISubmixBufferListener.h"
+#include "CineSRTAudioEncoder.h"
+
+class UWorld;
+class USoundSubmix;
+
+/**
+ * Taps a submix on the world's audio mixer and packs what it renders as SMPTE 302M PCM for the transmitter.
+ * Each buffer is stamped with CineSRT::GetTimeSeconds() when the mixer hands it over, the clock video frames are
+ * captured on, so the transmitter can give audio and video PTS from the same origin.
+ */
+class CINESRTSTREAM_API FSRTAudioCapture : public ISubmixBufferListener, public TSharedFromThis<FSRTAudioCapture, ESPMode::ThreadSafe>
+{
+public:
+    /** Called on the audio render thread with each finished packet. */
+    using FPacketSink = TFunction<void(CineSRT::FEncodedAudioRef /*Packet*/)>;
+
+    struct FAudioCaptureSettings
+    {
+        FSoftObjectPath Submix; // empty = main submix
+        int32 NumChannels = 2;
+        int32 BitsPerSample = 24;
+        int32 PacketMs = 10;
+        int32 SyncOffsetMs = 0;
+    };
+
+    struct FAudioCaptureStats
+    {
+        int64 BuffersCaptured = 0;
+        int64 PacketsEncoded = 0;
+        int32 ClockResyncs = 0;
+        int32 SampleRate = 0; // 마지막으로 받은 믹서 샘플레이트 (48000이 아니면 전송 안 됨)
+    };
+
+    explicit FSRTAudioCapture(const FAudioCaptureSettings& InSettings);
+    virtual ~FSRTAudioCapture() override;
+
+    /** Game thread: sets where packets are delivered. Call before Start. */
+    void SetSink(FPacketSink InSink);
+
+    /** Game thread: starts listening on World's audio device. False when the world has no audio mixer device. */
+    bool Start(UWorld* World);
+
+    /** Game thread: stops listening. No packet reaches the sink after this returns. */
+    void Stop();
+
+    bool IsCapturing() const { return AudioDevice.IsValid(); }
+
+    FAudioCaptureStats GetStats() const;
+
+    //~ Begin ISubmixBufferListener
+    virtual void OnNewSubmixBuffer(const USoundSubmix* OwningSubmix, float* AudioData, int32 NumSamples, int32 NumChannels, const int32 SampleRate, double AudioClock) override;
+    virtual const FString& GetListenerName() const override;
+    //~ End ISubmixBufferListener
+
+private:
+    FAudioCaptureSettings Settings;
+    FAudioDeviceHandle AudioDevice;
+    TWeakObjectPtr<USoundSubmix> ListenedSubmix;
+
+    // 오디오 렌더 스레드와 Stop 사이: Stop이 돌아온 뒤에는 싱크를 부르지 않도록 잠금 안에서 인코딩
+    mutable FCriticalSection Lock;
+    bool bActive = false;
+    FPacketSink Sink;
+    CineSRT::FAudioEncoder Encoder;
+    FAudioCaptureStats Stats;
+};
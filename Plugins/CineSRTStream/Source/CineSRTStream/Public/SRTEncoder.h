@@ -4,30 +4,24 @@
 
 #include "CoreMinimal.h"
 #include "CineSRTStreamSettings.h"
-#include "HAL/Runnable.h"
-#include "HAL/RunnableThread.h"
+#include "SRTFramePool.h"
+#include "CineSRTEncoderPool.h"
+#include "CineSRTEncodeScheduler.h"
 
-UENUM()
-enum class EEncodingFormat : uint8
-{
-    None,
-    MJPEG,
-    H264,
-    H265
-};
+using EEncodingFormat = CineSRT::EEncodingFormat;
 
-// 인코더 인터페이스
-class IVideoEncoder
-{
-public:
-    virtual ~IVideoEncoder() = default;
-    virtual bool Initialize() = 0;
-    virtual bool EncodeFrame(const TArray<uint8>& RawData, TArray<uint8>& OutEncodedData) = 0;
-    virtual void Shutdown() = 0;
-    virtual EEncodingFormat GetFormat() const = 0;
-};
+// 인코딩된 프레임 (하나의 access unit) - 엔진 독립 코어 타입
+using FSRTEncodedFrame = CineSRT::FEncodedFrame;
+using FSRTEncodedFrameRef = CineSRT::FEncodedFrameRef;
+using FSRTEncodedFramePool = CineSRT::FEncodedFramePool;
+using IVideoEncoder = CineSRT::IVideoEncoder;
 
-class CINESRTSTREAM_API FSRTEncoder : public FRunnable
+/**
+ * Engine-side front end of the encoder pool in CineSRTCore.
+ * Resolves the quality preset and encoder type from the plugin settings, then runs
+ * CineSRT::FEncoderPool, falling back to MJPEG when the requested codec cannot start.
+ */
+class CINESRTSTREAM_API FSRTEncoder
 {
 public:
     struct FEncoderSettings
@@ -42,6 +36,11 @@ public:
         int32 JpegQuality = 85;
         int32 KeyframeInterval = 60;
         FString Preset = TEXT("fast");
+        int32 ThreadCount = 4; // 인트라 코덱은 프레임 병렬 워커 수, H.264는 슬라이스 스레드 수
+        int32 SliceRows = 0; // >0: MJPEG 프레임을 이 행 수마다 인코딩 중에 전송 (0 = 프레임 단위)
+        ESRTStaticFramePolicy StaticFramePolicy = ESRTStaticFramePolicy::Encode;
+        int32 StaticFrameTolerance = 0;
+        float StaticFrameKeepAliveSeconds = 1.0f;
     };
 
     FSRTEncoder(const FEncoderSettings& InSettings);
@@ -49,62 +48,49 @@ public:
 
     bool Initialize();
     void Shutdown();
-    bool SubmitFrame(const TArray<uint8>& FrameData);
-    bool GetEncodedFrame(TArray<uint8>& OutEncodedData);
+    /** Takes a reference to the frame; pixels are not copied. */
+    bool SubmitFrame(FSRTFrameRef Frame);
+    bool GetEncodedFrame(FSRTEncodedFrameRef& OutEncodedFrame);
+    /** Pushes encoded frames to Sink on the encoder threads, in capture order, instead of queueing them for GetEncodedFrame. */
+    void SetFrameSink(CineSRT::FEncoderPool::FEncodedFrameSink Sink) { Pool.SetFrameSink(MoveTemp(Sink)); }
+    /** Encodes on the shared scheduler's threads instead of starting workers of its own; call before Initialize. */
+    void SetScheduler(std::shared_ptr<CineSRT::FEncodeScheduler> Scheduler) { Pool.SetScheduler(MoveTemp(Scheduler)); }
+    /** Scales submitted frames of any size to this encoder's size on its own threads (simulcast renditions); call before Initialize. */
+    void SetScaleInput(bool bScaleInput) { Pool.SetScaleInput(bScaleInput); }
+    /** Repeats the last MJPEG frame for capture slots SlotInterval apart that no frame arrived for (0 = off); thread safe. */
+    void SetFillMissedSlots(double SlotInterval) { Pool.SetFillMissedSlots(SlotInterval); }
+    /** Records convert/encode timing and frame counters into Stats; call before Initialize. */
+    void SetPipelineStats(std::shared_ptr<CineSRT::FPipelineStats> Stats) { Pool.SetPipelineStats(MoveTemp(Stats)); }
+    /** Encodes a blank frame on every worker and fills the output pool while starting, so the first real frame does not pay for it; call before Initialize. */
+    void SetWarmUp(bool bWarmUp) { Pool.SetWarmUp(bWarmUp); }
+    /**
+     * Applies new settings to a running encoder without stopping it. Size, frame rate, codec or thread
+     * changes build a new encoder set in the background (see IsReconfiguring); rate-only changes apply in place.
+     */
     void UpdateSettings(const FEncoderSettings& NewSettings);
-    bool IsInitialized() const { return bIsInitialized; }
+    /** Retargets bitrate (Kbps) and JPEG quality in place; thread safe, no restart. */
+    void SetRate(int32 Bitrate, int32 JpegQuality);
+    /** Makes the next encoded frame a keyframe (a receiver just joined); thread safe. */
+    void RequestKeyframe() { Pool.RequestKeyframe(); }
+    bool IsInitialized() const { return Pool.IsRunning(); }
+    /** True while encoders for the last UpdateSettings are still being created; keep capturing at the old size until then. */
+    bool IsReconfiguring() const { return Pool.IsReconfiguring(); }
+    /** True when frames of this size will be encoded rather than dropped. */
+    bool CanEncode(int32 Width, int32 Height) const { return Pool.CanEncode(Width, Height); }
+    /** Settings after the quality preset was applied. */
+    const FEncoderSettings& GetSettings() const { return Settings; }
 
-    struct FEncoderStats
-    {
-        int32 FramesEncoded = 0;
-        int32 FramesDropped = 0;
-        float AverageEncodeTime = 0.0f;
-        int64 TotalBytesEncoded = 0;
-    };
-    FEncoderStats GetStats() const { return Stats; }
+    /** Codec used for an encoder type: H.264 when a software backend is compiled in, MJPEG otherwise. */
+    static EEncodingFormat GetDefaultFormat(ESRTEncoderType EncoderType);
 
-    // FRunnable
-    virtual bool Init() override;
-    virtual uint32 Run() override;
-    virtual void Stop() override;
+    using FEncoderStats = CineSRT::FEncoderPool::FStats;
+    FEncoderStats GetStats() const { return Pool.GetStats(); }
 
 private:
     FEncoderSettings Settings;
-    TUniquePtr<IVideoEncoder> Encoder;
-    bool bIsInitialized = false;
-    FRunnableThread* Thread = nullptr;
-    FThreadSafeBool bShouldStop = false;
-    TQueue<TArray<uint8>> InputQueue;
-    TQueue<TArray<uint8>> OutputQueue;
-    FCriticalSection QueueMutex;
-    FEvent* FrameEvent = nullptr;
-    FEncoderStats Stats;
-    int32 InputQueueSize = 0;
-    TUniquePtr<IVideoEncoder> CreateEncoder();
-    void ApplyQualitySettings();
-};
+    CineSRT::FEncoderPool Pool;
 
-class FMJPEGEncoder : public IVideoEncoder
-{
-public:
-    FMJPEGEncoder(const FSRTEncoder::FEncoderSettings& Settings);
-    virtual bool Initialize() override;
-    virtual bool EncodeFrame(const TArray<uint8>& RawData, TArray<uint8>& OutEncodedData) override;
-    virtual void Shutdown() override;
-    virtual EEncodingFormat GetFormat() const override { return EEncodingFormat::MJPEG; }
-private:
-    FSRTEncoder::FEncoderSettings Settings;
+    CineSRT::FVideoEncoderConfig MakeConfig() const;
+    void ApplyStaticFrameSettings();
+    void ApplyQualitySettings();
 };
-
-class FH264Encoder : public IVideoEncoder
-{
-public:
-    FH264Encoder(const FSRTEncoder::FEncoderSettings& Settings);
-    virtual bool Initialize() override;
-    virtual bool EncodeFrame(const TArray<uint8>& RawData, TArray<uint8>& OutEncodedData) override;
-    virtual void Shutdown() override;
-    virtual EEncodingFormat GetFormat() const override { return EEncodingFormat::H264; }
-private:
-    FSRTEncoder::FEncoderSettings Settings;
-    void* EncoderHandle = nullptr;
-}; 
\ No newline at end of file
@@ -0,0 +1,15 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CineSRTFrame.h"
+
+/** Raw captured frame (tightly packed BGRA8). Written once by capture, read once by the encoder. */
+using FSRTFrame = CineSRT::FRawFrame;
+
+/** Shared handle to a pooled frame; the buffer goes back to its pool when the last handle is released. */
+using FSRTFrameRef = CineSRT::FRawFrameRef;
+
+/** Pool of pre-allocated frame buffers, shared between capture and the encoder through a std::shared_ptr. */
+using FSRTFramePool = CineSRT::FRawFramePool;
@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SharedPointer.h"
+#include "SRTFramePool.h"
+#include "CineSRTPipelineStats.h"
+
+class FRHIGPUTextureReadback;
+class FTextureRenderTargetResource;
+class FRHICommandListImmediate;
+
+/**
+ * Ring of GPU staging buffers used to read the capture render target back without
+ * stalling the game thread. Copies are enqueued on the render thread and polled there;
+ * completed frames are handed to the sink one or more frames after they were captured.
+ */
+class CINESRTSTREAM_API FSRTFrameReadback : public TSharedFromThis<FSRTFrameReadback, ESPMode::ThreadSafe>
+{
+public:
+    /** Called on the render thread with a pooled frame holding tightly packed BGRA8 pixels. */
+    using FFrameSink = TFunction<void(FSRTFrameRef /*Frame*/)>;
+
+    struct FReadbackStats
+    {
+        int32 FramesRead = 0;
+        int32 FramesDropped = 0;
+        int32 LastLatencyFrames = 0;
+        float LastLatencyMs = 0.0f;
+    };
+
+    FSRTFrameReadback(int32 InBufferCount, std::shared_ptr<FSRTFramePool> InFramePool);
+    ~FSRTFrameReadback();
+
+    /** Game thread: sets where completed frames are delivered. */
+    void SetSink(FFrameSink InSink);
+
+    /** Game thread, before the first capture: records readback times and ring-full drops into Stats. */
+    void SetPipelineStats(std::shared_ptr<CineSRT::FPipelineStats> Stats) { PipelineStats = MoveTemp(Stats); }
+
+    /**
+     * Game thread: queues a copy of the render target's current contents into the next free slot.
+     * CaptureTime (the output slot the capture stands for, on the CineSRT::GetTimeSeconds() clock) is carried to the delivered frame.
+     */
+    void EnqueueCapture(FTextureRenderTargetResource* RenderTargetResource, double CaptureTime);
+
+    /** Game thread: queues a poll that delivers every readback the GPU has finished. */
+    void PollCompleted();
+
+    /** Game thread: drops the sink and all in-flight readbacks. Blocks until the render thread has caught up. */
+    void Reset();
+
+    FReadbackStats GetStats() const;
+
+private:
+    struct FSlot
+    {
+        TUniquePtr<FRHIGPUTextureReadback> Readback;
+        FIntPoint Size = FIntPoint::ZeroValue;
+        uint64 SubmitFrameNumber = 0;
+        double SubmitTime = 0.0;
+        double CaptureTime = 0.0;
+        bool bInFlight = false;
+    };
+
+    // Render thread only
+    void EnqueueCopy_RenderThread(FRHICommandListImmediate& RHICmdList, FTextureRenderTargetResource* RenderTargetResource, uint64 FrameNumber, double CaptureTime);
+    void PollCompleted_RenderThread();
+
+    TArray<FSlot> Slots;
+    int32 WriteIndex = 0;
+    int32 ReadIndex = 0;
+    int32 NumInFlight = 0;
+    FFrameSink Sink;
+    std::shared_ptr<FSRTFramePool> FramePool;
+    std::shared_ptr<CineSRT::FPipelineStats> PipelineStats;
+
+    mutable FCriticalSection StatsLock;
+    FReadbackStats Stats;
+};
@@ -3,13 +3,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "HAL/Runnable.h"
-#include "HAL/ThreadSafeBool.h"
-
-// SRT 헤더 포함
-#if WITH_SRT
-#include "srt/srt.h"
-#endif
+#include "SRTEncoder.h"
+#include "CineSRTTransmitter.h"
+#include "CineSRTStreamSettings.h"
 
 // 전송 완료 델리게이트
 DECLARE_DELEGATE_OneParam(FOnFrameTransmitted, const TArray<uint8>&);
@@ -17,7 +13,18 @@ DECLARE_DELEGATE_OneParam(FOnFrameTransmitted, const TArray<uint8>&);
 // 에러 델리게이트
 DECLARE_DELEGATE_OneParam(FOnTransmissionError, const FString&);
 
-class FSRTTransmitter : public FRunnable
+// 링크 통계 델리게이트 (전송 스레드에서 LinkStatsPeriodMs마다 호출)
+DECLARE_DELEGATE_OneParam(FOnLinkStats, const CineSRT::FTransmitter::FLinkStats&);
+
+// 새 클라이언트가 캐시 없이 들어와 키프레임이 필요할 때 (전송 스레드에서 호출)
+DECLARE_DELEGATE(FOnKeyframeRequest);
+
+/**
+ * Engine-side front end of one CineSRT::FTransmitter stream.
+ * Either owns its own listener (one port per camera) or serves a stream ID on a listener shared through
+ * UCineSRTStreamSubsystem; muxing, fan-out and the transmitter thread live in CineSRTCore.
+ */
+class FSRTTransmitter
 {
 public:
     struct FTransmitterSettings
@@ -28,66 +35,89 @@ public:
         int32 MaxBW = 0; // 0 = unlimited
         int32 InputBW = 0; // 0 = unlimited
         int32 Overhead = 25; // %
+        int32 QueueCapacity = 16; // frames
+        ESRTQueueOverflowPolicy OverflowPolicy = ESRTQueueOverflowPolicy::DropNonKeyframes;
+        int32 BlockTimeoutMs = 50;
+        int32 MaxClients = 8;
+        int32 ClientQueueCapacity = 8; // frames per client
+        int32 SlowClientTimeoutMs = 3000; // 밀린 클라이언트가 이 시간 안에 따라잡지 못하면 연결 해제
+        int32 LinkStatsPeriodMs = 500; // SRT 링크 통계 샘플 주기
+        int32 JoinCacheMaxBytes = 8 * 1024 * 1024; // 새 클라이언트에 먼저 보낼 최근 GOP 한도 (0 = 다음 키프레임까지 대기)
+        bool bKeyframeOnJoin = true; // 캐시로 시작할 수 없는 클라이언트가 들어오면 OnKeyframeRequest
+    };
+
+    // 클라이언트별 전송 통계 (1초마다 갱신되는 스냅샷)
+    struct FSRTClientStats
+    {
+        FString Address;
+        double SendRateMbps = 0.0;
+        int32 Backlog = 0;          // 대기 중인 프레임 수
+        int64 FramesSent = 0;
+        int64 FramesDropped = 0;    // 느린 클라이언트 정책으로 버린 프레임
+        int64 BytesSent = 0;
+        double ConnectedSeconds = 0.0;
+        double TimeToFirstPictureMs = -1.0; // 접속 -> 첫 키프레임 송신 완료, 아직이면 -1
+        double RttMs = 0.0;
+        double BandwidthMbps = 0.0; // 추정 링크 용량
+        int32 SendBufferMs = 0;
+        int64 PacketsLost = 0;
+        int64 PacketsDropped = 0;   // 지연 한도를 넘겨 송신측에서 버린 패킷
     };
 
+    using FTransmitterStats = CineSRT::FTransmitter::FStats;
+    using FLinkStats = CineSRT::FTransmitter::FLinkStats;
+
+    /** Standalone: listens on InSettings.Port and takes every caller. */
     FSRTTransmitter(const FTransmitterSettings& InSettings);
+    /** Shared: serves callers asking for StreamID on Listener, which the caller's settings do not reconfigure. */
+    FSRTTransmitter(std::shared_ptr<CineSRT::FTransmitter> InListener, const FString& StreamID);
     ~FSRTTransmitter();
 
-    // FRunnable 인터페이스
-    virtual bool Init() override;
-    virtual uint32 Run() override;
-    virtual void Stop() override;
-    virtual void Exit() override;
-
-    // 전송 시작/중지
+    // 전송 시작/중지 (공유 리스너는 스트림 등록/해제만 하고 리스너는 계속 돎)
     bool StartTransmission();
     void StopTransmission();
+
+    // 스트리밍 시작 전에 리스너를 미리 바인드 (공유 리스너는 이미 돌고 있으면 그대로)
+    bool Prewarm();
     
-    // 프레임 전송
-    bool TransmitFrame(const TArray<uint8>& FrameData);
+    // 프레임 전송 (인코딩된 프레임은 전송 스레드에서 MPEG-TS로 먹싱됨)
+    bool TransmitFrame(FSRTEncodedFrameRef Frame);
+    
+    // 오디오 패킷 전송 (오디오 렌더 스레드에서 호출, 다음 비디오 프레임과 함께 먹싱됨)
+    bool TransmitAudio(CineSRT::FEncodedAudioRef Packet);
     
     // 전송 상태 확인
-    bool IsTransmitting() const { return bIsTransmitting; }
+    bool IsTransmitting() const { return Listener->IsTransmitting() && Stream->IsRegistered(); }
+    bool IsSharedListener() const { return !bOwnsListener; }
+
+    // 같은 리스너에 스트림 ID를 달리해 형제 스트림(시뮬캐스트 렌디션)을 붙일 때 사용
+    std::shared_ptr<CineSRT::FTransmitter> GetListener() const { return Listener; }
     
-    // 설정 업데이트
+    // 설정 업데이트 (공유 리스너에서는 무시)
     void UpdateSettings(const FTransmitterSettings& NewSettings);
     
+    // 통계
+    FTransmitterStats GetStats() const { return Stream->GetStats(); }
+    TArray<FSRTClientStats> GetClientStats() const;
+    int32 GetNumClients() const { return Stream->GetNumClients(); }
+    FLinkStats GetLinkStats() const { return Stream->GetLinkStats(); }
+    
+    // 큐 대기/먹싱/송신 시간 기록 (StartTransmission 전에 설정)
+    void SetPipelineStats(std::shared_ptr<CineSRT::FPipelineStats> Stats) { Stream->SetPipelineStats(MoveTemp(Stats)); }
+    
+    static CineSRT::FTransmitter::FSettings ToCoreSettings(const FTransmitterSettings& InSettings);
+    
     // 델리게이트
     FOnFrameTransmitted OnFrameTransmitted;
     FOnTransmissionError OnError;
+    FOnLinkStats OnLinkStats;
+    FOnKeyframeRequest OnKeyframeRequest;
 
 private:
-    static bool bSRTInitialized;
-    static FCriticalSection SRTInitLock;
-    FTransmitterSettings Settings;
-    bool bIsTransmitting = false;
-    FThreadSafeBool bShouldStop = false;
-    
-    // SRT 소켓
-#if WITH_SRT
-    SRTSOCKET ServerSocket = SRT_INVALID_SOCK;
-    SRTSOCKET ClientSocket = SRT_INVALID_SOCK;
-#endif
-    
-    // 전송 큐
-    TArray<TArray<uint8>> TransmissionQueue;
-    FCriticalSection QueueCriticalSection;
-    
-    // 스레드 관리
-    FRunnableThread* Thread = nullptr;
-    
-    // SRT 초기화
-    bool InitializeSRT();
-    
-    // 소켓 설정
-    bool ConfigureSocket();
-    
-    // 클라이언트 연결 대기
-    bool WaitForClient();
-    
-    // 프레임 전송 내부 함수
-    bool SendFrameData(const TArray<uint8>& FrameData);
-    
-    // SRT 정리
-    void CleanupSRT();
-}; 
\ No newline at end of file
+    // 스트림은 리스너를 참조하므로 리스너보다 먼저 소멸해야 함 (선언 순서 유지)
+    std::shared_ptr<CineSRT::FTransmitter> Listener;
+    std::shared_ptr<CineSRT::FTransmitter::FStream> Stream;
+    bool bOwnsListener = true;
+
+    void BindStreamCallbacks();
+};
@@ -0,0 +1,3042 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+// Capture-to-wire benchmark for CineSRTCore without the engine.
+// Paces synthetic BGRA frames at the requested rate through the encoder pool, the TS muxer and the
+// SRT transmitter, receives them on loopback SRT callers and reports throughput, per-stage latency
+// percentiles, CPU and memory. Meant to run on a build box to catch regressions before they hit set.
+//
+//   CineSRTBench --codec mjpeg --width 1920 --height 1080 --fps 60 --seconds 10 --threads 4 --clients 2
+//   CineSRTBench --codec mjpeg --width 1280 --height 720 --fps 30 --seconds 30 --link-mbps 20 --abr
+//   CineSRTBench --codec h264 --width 1920 --height 1080 --fps 60 --seconds 10 --switch-at 5 --switch-width 1280 --switch-height 720
+//   CineSRTBench --codec mjpeg --width 1280 --height 720 --fps 30 --seconds 10 --game-fps 45 --game-jitter 3
+//   CineSRTBench --check convert     (self-checks: reorder, convert, mux, ring, abr, audio, cadence, recorder; also run by ctest)
+
+#include "CineSRTAudioEncoder.h"
+#include "CineSRTBitrateController.h"
+#include "CineSRTColorConvert.h"
+#include "CineSRTCore.h"
+#include "CineSRTEncodeScheduler.h"
+#include "CineSRTEncoderPool.h"
+#include "CineSRTFrame.h"
+#include "CineSRTFrameCadence.h"
+#include "CineSRTFrameCompare.h"
+#include "CineSRTFrameRing.h"
+#include "CineSRTFrameScaler.h"
+#include "CineSRTLatencyHistogram.h"
+#include "CineSRTPipelineStats.h"
+#include "CineSRTRecorder.h"
+#include "CineSRTSyntheticFrame.h"
+#include "CineSRTTSMuxer.h"
+#include "CineSRTTransmitter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#if WITH_SRT && !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#endif
+
+using namespace CineSRT;
+
+namespace
+{
+    struct FBenchOptions
+    {
+        EEncodingFormat Format = EEncodingFormat::MJPEG;
+        int32 Width = 1920;
+        int32 Height = 1080;
+        int32 FPS = 60;
+        double Seconds = 10.0;
+        int32 Threads = 4;
+        int32 Clients = 1;
+        int32 Port = 9301;
+        int32 LatencyMs = 120;
+        int32 JpegQuality = 85;
+        int32 Bitrate = 8000;
+        int32 LinkMbps = 0; // 0 = loopback at full speed
+        bool bAdaptiveBitrate = false;
+        double SwitchAt = 0.0; // 0 = no on-air reconfiguration
+        int32 SwitchWidth = 1280;
+        int32 SwitchHeight = 720;
+        int32 Cameras = 1;
+        int32 SharedThreads = 0; // 0 = scheduler default
+        std::vector<std::pair<int32, int32>> Renditions; // extra sizes scaled from the main camera's frames
+        EStaticFramePolicy StaticPolicy = EStaticFramePolicy::Encode;
+        int32 Still = 1; // the picture changes every N frames
+        int32 StaticTolerance = 0;
+        double KeepAlive = 1.0;
+        int32 GameFPS = 0; // 0 = capture on a timer at --fps; otherwise a simulated game loop polls the capture cadence
+        double GameJitterMs = 0.0;
+        bool bNoFill = false;
+        double JoinEvery = 0.0; // 0 = every receiver connects before the first frame
+        int32 JoinCacheMB = 8;
+        bool bKeyframeOnJoin = true;
+        int32 Gop = 60;
+        int32 SliceRows = 0; // 0 = whole frames
+        std::string RecordDir; // empty = no recording
+        int32 RecordBlockMB = 4;
+        bool bAudio = false;
+        int32 AudioChannels = 2;
+        int32 AudioBits = 24;
+        int32 AudioBufferFrames = 1024; // per render callback, like the engine's default audio buffer
+        bool bPrewarm = false;
+        std::string Check; // --check: run a self-check instead of the benchmark
+        bool bPoll = false;
+        bool bVerbose = false;
+    };
+
+    void PrintUsage()
+    {
+        std::printf(
+            "Usage: CineSRTBench [options]\n"
+            "  --codec mjpeg|h264   encoder (default mjpeg)\n"
+            "  --width N --height N frame size (default 1920x1080)\n"
+            "  --fps N              capture rate (default 60)\n"
+            "  --seconds N          run time (default 10)\n"
+            "  --threads N          encoder worker threads (default 4)\n"
+            "  --clients N          loopback SRT receivers, 0 = encode + mux only (default 1)\n"
+            "  --port N             SRT listener port (default 9301)\n"
+            "  --latency N          SRTO_LATENCY in ms (default 120)\n"
+            "  --quality N          JPEG quality (default 85)\n"
+            "  --bitrate N          H.264 bitrate in Kbps (default 8000)\n"
+            "  --link-mbps N        simulate a constrained link: cap the SRT send rate (SRTO_MAXBW) at N Mbps\n"
+            "  --abr                steer bitrate/JPEG quality from SRT link statistics (default ladder)\n"
+            "  --switch-at S        reconfigure the running encoder to the switch size S seconds in\n"
+            "  --switch-width N --switch-height N  size after the switch (default 1280x720)\n"
+            "  --cameras N          cameras served on the one listener by streamid cam0..camN-1, each with its own\n"
+            "                       encoder pool; more than one shares --shared-threads encode threads (default 1)\n"
+            "  --shared-threads N   encode threads shared by all cameras, 0 = cores - 2 (default 0)\n"
+            "  --renditions WxH[,WxH...]  simulcast: also encode the main camera's frames at these sizes, each\n"
+            "                       scaled on its own encoder's threads and served as streamid WxH\n"
+            "  --static skip|repeat skip or repeat unchanged frames instead of encoding them (default: encode all)\n"
+            "  --still N            the synthetic picture only changes every N frames (default 1)\n"
+            "  --tolerance N        per-byte difference still counted as unchanged (default 0)\n"
+            "  --keepalive S        encode an unchanged picture at least every S seconds (default 1)\n"
+            "  --game-fps N         drive capture from a simulated game loop at N fps through the frame cadence clock\n"
+            "  --game-jitter MS     random +/- spread of each game frame time (default 0)\n"
+            "  --no-fill            do not repeat the last frame for slots the game loop missed\n"
+            "  --join-every S       connect another receiver every S seconds while streaming and report time to first picture\n"
+            "  --join-cache-mb N    GOP kept per stream for receivers that join (default 8, 0 = wait for the next keyframe)\n"
+            "  --no-keyframe-on-join  do not ask the encoder for a keyframe when a receiver joins with nothing cached\n"
+            "  --gop N              H.264 keyframe interval in frames (default 60)\n"
+            "  --slice-rows N       stream MJPEG frames to the transmitter every N rows while they are encoded (default 0 = whole frames)\n"
+            "  --record DIR         also record every camera's main stream to DIR/<streamid>.ts and report write throughput\n"
+            "  --record-block-mb N  size of each recording disk write (default 4)\n"
+            "  --audio              mux a 48 kHz test tone (SMPTE 302M PCM) into the main stream and check A/V timing at the receivers\n"
+            "  --audio-channels N   audio channels, even 2-8 (default 2)\n"
+            "  --audio-bits N       audio sample size, 16/20/24 (default 24)\n"
+            "  --audio-buffer N     samples per channel in each audio render callback (default 1024)\n"
+            "  --prewarm            warm the encoders, commit the frame pool and bind the listener before the stream starts\n"
+            "  --check NAME         self-check instead of the benchmark, exits non-zero on failure:\n"
+            "                       reorder = queue drops + repeated frames + sliced MJPEG through one encoder pool\n"
+            "                       convert = SIMD colour conversion, scaling and frame compare against the scalar kernels\n"
+            "                       mux = TS muxer output at a low frame rate: PSI, continuity, PCR interval, PES contents\n"
+            "                       ring = transmission ring capacity, order, and DropOldest with both ends popping\n"
+            "                       abr = bitrate ladder steps down on congestion and back up after the hold time\n"
+            "                       audio = SMPTE 302M packing of 16- and 24-bit samples against the AES3 byte layout\n"
+            "                       cadence = frame cadence slots for on-time, late and early capture polls\n"
+            "                       recorder = local recording drops frames until a keyframe, then writes them in order\n"
+            "  --poll               drain the encoder once per captured frame instead of through its sink\n"
+            "  --verbose            print core log output\n");
+    }
+
+    bool ParseOptions(int Argc, char** Argv, FBenchOptions& Options)
+    {
+        for (int Index = 1; Index < Argc; ++Index)
+        {
+            const std::string Arg = Argv[Index];
+            const char* Value = Index + 1 < Argc ? Argv[Index + 1] : nullptr;
+            auto NextInt = [&Index, Value](int32& Out)
+            {
+                if (!Value)
+                {
+                    return false;
+                }
+                Out = std::atoi(Value);
+                Index++;
+                return true;
+            };
+
+            bool bOk = true;
+            if (Arg == "--codec" && Value)
+            {
+                const std::string Codec = Value;
+                Options.Format = Codec == "h264" ? EEncodingFormat::H264 : EEncodingFormat::MJPEG;
+                bOk = Codec == "h264" || Codec == "mjpeg";
+                Index++;
+            }
+            else if (Arg == "--seconds" && Value)
+            {
+                Options.Seconds = std::atof(Value);
+                Index++;
+            }
+            else if (Arg == "--renditions" && Value)
+            {
+                std::string List = Value;
+                size_t Start = 0;
+                while (bOk && Start <= List.size())
+                {
+                    const size_t End = std::min(List.find(',', Start), List.size());
+                    int32 RenditionWidth = 0;
+                    int32 RenditionHeight = 0;
+                    bOk = std::sscanf(List.substr(Start, End - Start).c_str(), "%dx%d", &RenditionWidth, &RenditionHeight) == 2
+                        && RenditionWidth >= 2 && RenditionHeight >= 2 && (RenditionWidth % 2) == 0 && (RenditionHeight % 2) == 0;
+                    Options.Renditions.emplace_back(RenditionWidth, RenditionHeight);
+                    Start = End + 1;
+                }
+                Index++;
+            }
+            else if (Arg == "--static" && Value)
+            {
+                const std::string Policy = Value;
+                Options.StaticPolicy = Policy == "repeat" ? EStaticFramePolicy::Repeat : EStaticFramePolicy::Skip;
+                bOk = Policy == "skip" || Policy == "repeat";
+                Index++;
+            }
+            else if (Arg == "--record" && Value)
+            {
+                Options.RecordDir = Value;
+                Index++;
+            }
+            else if (Arg == "--keepalive" && Value)
+            {
+                Options.KeepAlive = std::atof(Value);
+                Index++;
+            }
+            else if (Arg == "--game-jitter" && Value)
+            {
+                Options.GameJitterMs = std::atof(Value);
+                Index++;
+            }
+            else if (Arg == "--join-every" && Value)
+            {
+                Options.JoinEvery = std::atof(Value);
+                Index++;
+            }
+            else if (Arg == "--switch-at" && Value)
+            {
+                Options.SwitchAt = std::atof(Value);
+                Index++;
+            }
+            else if (Arg == "--width") bOk = NextInt(Options.Width);
+            else if (Arg == "--height") bOk = NextInt(Options.Height);
+            else if (Arg == "--fps") bOk = NextInt(Options.FPS);
+            else if (Arg == "--threads") bOk = NextInt(Options.Threads);
+            else if (Arg == "--clients") bOk = NextInt(Options.Clients);
+            else if (Arg == "--port") bOk = NextInt(Options.Port);
+            else if (Arg == "--latency") bOk = NextInt(Options.LatencyMs);
+            else if (Arg == "--quality") bOk = NextInt(Options.JpegQuality);
+            else if (Arg == "--bitrate") bOk = NextInt(Options.Bitrate);
+            else if (Arg == "--link-mbps") bOk = NextInt(Options.LinkMbps);
+            else if (Arg == "--switch-width") bOk = NextInt(Options.SwitchWidth);
+            else if (Arg == "--switch-height") bOk = NextInt(Options.SwitchHeight);
+            else if (Arg == "--cameras") bOk = NextInt(Options.Cameras);
+            else if (Arg == "--shared-threads") bOk = NextInt(Options.SharedThreads);
+            else if (Arg == "--still") bOk = NextInt(Options.Still);
+            else if (Arg == "--tolerance") bOk = NextInt(Options.StaticTolerance);
+            else if (Arg == "--game-fps") bOk = NextInt(Options.GameFPS);
+            else if (Arg == "--no-fill") Options.bNoFill = true;
+            else if (Arg == "--join-cache-mb") bOk = NextInt(Options.JoinCacheMB);
+            else if (Arg == "--no-keyframe-on-join") Options.bKeyframeOnJoin = false;
+            else if (Arg == "--gop") bOk = NextInt(Options.Gop);
+            else if (Arg == "--slice-rows") bOk = NextInt(Options.SliceRows);
+            else if (Arg == "--record-block-mb") bOk = NextInt(Options.RecordBlockMB);
+            else if (Arg == "--audio") Options.bAudio = true;
+            else if (Arg == "--audio-channels") bOk = NextInt(Options.AudioChannels);
+            else if (Arg == "--audio-bits") bOk = NextInt(Options.AudioBits);
+            else if (Arg == "--audio-buffer") bOk = NextInt(Options.AudioBufferFrames);
+            else if (Arg == "--abr") Options.bAdaptiveBitrate = true;
+            else if (Arg == "--prewarm") Options.bPrewarm = true;
+            else if (Arg == "--check" && Value)
+            {
+                Options.Check = Value;
+                bOk = Options.Check == "reorder" || Options.Check == "convert" || Options.Check == "mux" || Options.Check == "ring" || Options.Check == "abr" || Options.Check == "audio" || Options.Check == "cadence" || Options.Check == "recorder";
+                Index++;
+            }
+            else if (Arg == "--poll") Options.bPoll = true;
+            else if (Arg == "--verbose") Options.bVerbose = true;
+            else bOk = false;
+
+            if (!bOk)
+            {
+                std::fprintf(stderr, "Unknown or incomplete option: %s\n", Arg.c_str());
+                return false;
+            }
+        }
+        return Options.Width > 0 && Options.Height > 0 && (Options.Width % 2) == 0 && (Options.Height % 2) == 0
+            && Options.FPS > 0 && Options.Seconds > 0.0 && Options.Clients >= 0 && Options.LinkMbps >= 0
+            && Options.SwitchAt >= 0.0 && Options.SwitchWidth > 0 && Options.SwitchHeight > 0
+            && (Options.SwitchWidth % 2) == 0 && (Options.SwitchHeight % 2) == 0 && Options.Cameras >= 1 && Options.SharedThreads >= 0
+            && Options.Still >= 1 && Options.StaticTolerance >= 0 && Options.KeepAlive > 0.0
+            && Options.GameFPS >= 0 && Options.GameJitterMs >= 0.0 && Options.RecordBlockMB >= 1;
+    }
+
+    struct FResourceUsage
+    {
+        double CpuSeconds = 0.0;
+        int64 PeakRssKB = 0;
+    };
+
+    FResourceUsage GetResourceUsage()
+    {
+        FResourceUsage Usage;
+#if defined(__linux__) || defined(__APPLE__)
+        rusage Self;
+        if (getrusage(RUSAGE_SELF, &Self) == 0)
+        {
+            Usage.CpuSeconds = Self.ru_utime.tv_sec + Self.ru_utime.tv_usec / 1e6 + Self.ru_stime.tv_sec + Self.ru_stime.tv_usec / 1e6;
+#if defined(__APPLE__)
+            Usage.PeakRssKB = Self.ru_maxrss / 1024;
+#else
+            Usage.PeakRssKB = Self.ru_maxrss;
+#endif
+        }
+#endif
+        return Usage;
+    }
+
+    int64 GetCurrentRssKB()
+    {
+#if defined(__linux__)
+        if (FILE* File = std::fopen("/proc/self/statm", "r"))
+        {
+            long long Pages = 0;
+            long long Resident = 0;
+            const int NumRead = std::fscanf(File, "%lld %lld", &Pages, &Resident);
+            std::fclose(File);
+            if (NumRead == 2)
+            {
+                return Resident * (sysconf(_SC_PAGESIZE) / 1024);
+            }
+        }
+#endif
+        return GetResourceUsage().PeakRssKB;
+    }
+
+    int32 GetThreadCount()
+    {
+#if defined(__linux__)
+        if (FILE* File = std::fopen("/proc/self/status", "r"))
+        {
+            char Line[256];
+            int32 Threads = 0;
+            while (std::fgets(Line, sizeof(Line), File))
+            {
+                if (std::sscanf(Line, "Threads: %d", &Threads) == 1)
+                {
+                    break;
+                }
+            }
+            std::fclose(File);
+            return Threads;
+        }
+#endif
+        return 0;
+    }
+
+    void PrintLatency(const char* Stage, const FLatencyHistogram& Histogram)
+    {
+        if (Histogram.GetCount() == 0)
+        {
+            std::printf("  %-26s n/a\n", Stage);
+            return;
+        }
+        std::printf("  %-26s p50 %7.2f  p95 %7.2f  p99 %7.2f  max %7.2f ms  (%llu samples)\n", Stage,
+            Histogram.GetPercentileMs(50.0), Histogram.GetPercentileMs(95.0), Histogram.GetPercentileMs(99.0),
+            Histogram.GetMaxMs(), Histogram.GetCount());
+    }
+
+    /**
+     * Pixel kernels: every SIMD kernel the CPU has must match the scalar one bit for bit, on sizes that are not a
+     * multiple of the vector width, on padded (strided) rows, serial and banded; the scalar colour conversion must
+     * stay within one code value of BT.709 computed in floating point, and every kernel must map greys to neutral
+     * chroma with black and white at 16 and 235. Also times 1080p conversion per kernel.
+     */
+    int RunConvertCheck()
+    {
+        std::mt19937 Random(20240607);
+        int32 Cases = 0;
+        int32 Failures = 0;
+        auto Fail = [&Failures](const std::string& Message)
+        {
+            if (Failures++ < 20)
+            {
+                std::fprintf(stderr, "convert: FAILED - %s\n", Message.c_str());
+            }
+        };
+        auto FillRandom = [&Random](std::vector<uint8>& Buffer)
+        {
+            for (uint8& Byte : Buffer)
+            {
+                Byte = (uint8)Random();
+            }
+        };
+
+        std::vector<EColorKernel> Kernels = { EColorKernel::Scalar };
+        for (EColorKernel Kernel : { EColorKernel::SSE41, EColorKernel::AVX2 })
+        {
+            if (FColorConverter::IsKernelSupported(Kernel))
+            {
+                Kernels.push_back(Kernel);
+            }
+            else
+            {
+                std::printf("convert: %s not supported on this CPU, not checked\n", FColorConverter::GetKernelName(Kernel));
+            }
+        }
+
+        // Guard bytes after every output plane catch kernels that write past the end of a row or plane
+        const int32 GuardBytes = 64;
+        const uint8 GuardValue = 0xA5;
+        auto GuardIntact = [&](const std::vector<uint8>& Plane, std::size_t Size)
+        {
+            return std::all_of(Plane.begin() + Size, Plane.end(), [GuardValue](uint8 Byte) { return Byte == GuardValue; });
+        };
+
+        // --- BGRA -> I420 / NV12 ---
+        int32 MaxReferenceError = 0;
+        for (int32 Width : { 2, 4, 6, 14, 16, 18, 30, 34, 62, 66, 98, 130, 258 })
+        {
+            for (int32 Height : { 2, 4, 6, 10, 34 })
+            {
+                for (int32 Padding : { 0, 4, 68 })
+                {
+                    const int32 Stride = Width * 4 + Padding;
+                    std::vector<uint8> Source((std::size_t)Stride * Height);
+                    FillRandom(Source);
+                    const std::size_t LumaSize = (std::size_t)Width * Height;
+                    const std::size_t ChromaSize = LumaSize / 4;
+                    const std::string Size = std::to_string(Width) + "x" + std::to_string(Height) + " stride " + std::to_string(Stride);
+
+                    for (bool bInterleaved : { false, true })
+                    {
+                        const char* Layout = bInterleaved ? "NV12" : "I420";
+                        std::vector<uint8> RefY(LumaSize), RefU(bInterleaved ? ChromaSize * 2 : ChromaSize), RefV(ChromaSize);
+                        auto Convert = [&](EColorKernel Kernel, bool bParallel, uint8* Y, uint8* U, uint8* V)
+                        {
+                            return bInterleaved
+                                ? FColorConverter::ConvertBGRAToNV12(Source.data(), Width, Height, Stride, Y, U, Kernel, bParallel)
+                                : FColorConverter::ConvertBGRAToI420(Source.data(), Width, Height, Stride, Y, U, V, Kernel, bParallel);
+                        };
+                        if (!Convert(EColorKernel::Scalar, false, RefY.data(), RefU.data(), RefV.data()))
+                        {
+                            Fail(std::string(Layout) + " scalar conversion refused " + Size);
+                            continue;
+                        }
+
+                        // Scalar against floating-point BT.709 limited range (chroma from the rounded 2x2 average)
+                        for (int32 Y = 0; Y < Height; ++Y)
+                        {
+                            for (int32 X = 0; X < Width; ++X)
+                            {
+                                const uint8* Pixel = Source.data() + (std::size_t)Y * Stride + X * 4;
+                                const double Luma = 16.0 + 219.0 / 255.0 * (0.2126 * Pixel[2] + 0.7152 * Pixel[1] + 0.0722 * Pixel[0]);
+                                MaxReferenceError = std::max(MaxReferenceError, (int32)std::lround(std::abs(Luma - RefY[(std::size_t)Y * Width + X])));
+                                if ((X | Y) & 1)
+                                {
+                                    continue;
+                                }
+                                double Average[3];
+                                for (int32 Channel = 0; Channel < 3; ++Channel)
+                                {
+                                    Average[Channel] = (double)((Pixel[Channel] + Pixel[4 + Channel] + Pixel[Stride + Channel] + Pixel[Stride + 4 + Channel] + 2) >> 2);
+                                }
+                                const double Cb = 128.0 + 224.0 / 255.0 * (-0.1146 * Average[2] - 0.3854 * Average[1] + 0.5 * Average[0]);
+                                const double Cr = 128.0 + 224.0 / 255.0 * (0.5 * Average[2] - 0.4542 * Average[1] - 0.0458 * Average[0]);
+                                const std::size_t Chroma = (std::size_t)(Y / 2) * (Width / 2) + X / 2;
+                                const uint8 OutCb = bInterleaved ? RefU[Chroma * 2] : RefU[Chroma];
+                                const uint8 OutCr = bInterleaved ? RefU[Chroma * 2 + 1] : RefV[Chroma];
+                                MaxReferenceError = std::max(MaxReferenceError, (int32)std::lround(std::abs(Cb - OutCb)));
+                                MaxReferenceError = std::max(MaxReferenceError, (int32)std::lround(std::abs(Cr - OutCr)));
+                            }
+                        }
+
+                        for (EColorKernel Kernel : Kernels)
+                        {
+                            for (bool bParallel : { false, true })
+                            {
+                                Cases++;
+                                std::vector<uint8> OutY(LumaSize + GuardBytes, GuardValue);
+                                std::vector<uint8> OutU(RefU.size() + GuardBytes, GuardValue);
+                                std::vector<uint8> OutV(RefV.size() + GuardBytes, GuardValue);
+                                const std::string Case = std::string(Layout) + " " + FColorConverter::GetKernelName(Kernel)
+                                    + (bParallel ? " banded " : " serial ") + Size;
+                                if (!Convert(Kernel, bParallel, OutY.data(), OutU.data(), OutV.data()))
+                                {
+                                    Fail(Case + ": refused");
+                                }
+                                else if (!std::equal(RefY.begin(), RefY.end(), OutY.begin()) || !std::equal(RefU.begin(), RefU.end(), OutU.begin())
+                                    || (!bInterleaved && !std::equal(RefV.begin(), RefV.end(), OutV.begin())))
+                                {
+                                    Fail(Case + ": differs from scalar");
+                                }
+                                else if (!GuardIntact(OutY, LumaSize) || !GuardIntact(OutU, RefU.size()) || !GuardIntact(OutV, RefV.size()))
+                                {
+                                    Fail(Case + ": wrote past the end of a plane");
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        if (MaxReferenceError > 1)
+        {
+            Fail("scalar conversion is " + std::to_string(MaxReferenceError) + " code values off BT.709");
+        }
+
+        // Absolute levels: matching the scalar kernel is not enough if the scalar kernel itself is off. Every grey must
+        // come out with Cb = Cr = 128 (chroma rows that do not sum to zero tint it), black and white at 16 and 235
+        {
+            const int32 Width = 64;
+            const int32 Height = 2;
+            std::vector<uint8> Source((std::size_t)Width * Height * 4);
+            std::vector<uint8> Y((std::size_t)Width * Height), U(Y.size() / 2), V(Y.size() / 4);
+            for (int32 Grey = 0; Grey < 256; ++Grey)
+            {
+                std::fill(Source.begin(), Source.end(), (uint8)Grey);
+                const int32 ExpectedLuma = Grey == 0 ? 16 : Grey == 255 ? 235 : Grey == 128 ? 126 : -1;
+                for (EColorKernel Kernel : Kernels)
+                {
+                    for (bool bInterleaved : { false, true })
+                    {
+                        Cases++;
+                        const bool bConverted = bInterleaved
+                            ? FColorConverter::ConvertBGRAToNV12(Source.data(), Width, Height, 0, Y.data(), U.data(), Kernel)
+                            : FColorConverter::ConvertBGRAToI420(Source.data(), Width, Height, 0, Y.data(), U.data(), V.data(), Kernel);
+                        const std::size_t ChromaSize = Y.size() / 4;
+                        const bool bNeutral = std::all_of(U.begin(), U.begin() + ChromaSize * (bInterleaved ? 2 : 1), [](uint8 Value) { return Value == 128; })
+                            && (bInterleaved || std::all_of(V.begin(), V.begin() + ChromaSize, [](uint8 Value) { return Value == 128; }));
+                        const bool bFlat = std::all_of(Y.begin(), Y.end(), [&Y](uint8 Value) { return Value == Y[0]; });
+                        const double Luma = 16.0 + 219.0 / 255.0 * Grey;
+                        const std::string Case = std::string(bInterleaved ? "NV12 " : "I420 ") + FColorConverter::GetKernelName(Kernel)
+                            + " grey " + std::to_string(Grey);
+                        if (!bConverted || !bNeutral)
+                        {
+                            Fail(Case + ": chroma is not 128");
+                        }
+                        else if (!bFlat || std::abs(Y[0] - Luma) > 1.0 || (ExpectedLuma >= 0 && Y[0] != ExpectedLuma))
+                        {
+                            Fail(Case + ": luma " + std::to_string(Y[0]));
+                        }
+                    }
+                }
+            }
+        }
+
+        // Odd sizes cannot be subsampled 4:2:0 and must be refused by every kernel, not half converted
+        {
+            std::vector<uint8> Source(7 * 5 * 4), Y(64), U(64), V(64);
+            for (EColorKernel Kernel : Kernels)
+            {
+                Cases++;
+                if (FColorConverter::ConvertBGRAToI420(Source.data(), 7, 4, 0, Y.data(), U.data(), V.data(), Kernel)
+                    || FColorConverter::ConvertBGRAToNV12(Source.data(), 6, 5, 0, Y.data(), U.data(), Kernel))
+                {
+                    Fail(std::string(FColorConverter::GetKernelName(Kernel)) + " accepted an odd size");
+                }
+            }
+        }
+
+        // --- Scaler: box steps + bilinear remainder, odd sizes and padded source rows ---
+        const int32 ScaleSizes[][4] = {
+            { 1920, 1080, 640, 360 }, { 1920, 1080, 1280, 720 }, { 1280, 720, 854, 480 }, { 33, 17, 10, 5 },
+            { 130, 66, 65, 33 }, { 64, 64, 63, 2 }, { 37, 29, 37, 29 }, { 101, 3, 7, 2 }, { 2, 2, 2, 2 }, { 258, 130, 17, 9 } };
+        for (const int32* Sizes : ScaleSizes)
+        {
+            for (int32 Padding : { 0, 36 })
+            {
+                const int32 Stride = Sizes[0] * 4 + Padding;
+                std::vector<uint8> Source((std::size_t)Stride * Sizes[1]);
+                FillRandom(Source);
+                const std::size_t OutSize = (std::size_t)Sizes[2] * Sizes[3] * 4;
+                const std::string Size = std::to_string(Sizes[0]) + "x" + std::to_string(Sizes[1]) + " -> " + std::to_string(Sizes[2]) + "x"
+                    + std::to_string(Sizes[3]) + " stride " + std::to_string(Stride);
+                std::vector<uint8> Reference(OutSize);
+                FFrameScaler ReferenceScaler;
+                if (!ReferenceScaler.Scale(Source.data(), Sizes[0], Sizes[1], Stride, Reference.data(), Sizes[2], Sizes[3], EColorKernel::Scalar))
+                {
+                    Fail("scalar scale refused " + Size);
+                    continue;
+                }
+                for (EColorKernel Kernel : Kernels)
+                {
+                    // Twice through one scaler: the second call reuses its tables and buffers
+                    FFrameScaler Scaler;
+                    for (int32 Pass = 0; Pass < 2; ++Pass)
+                    {
+                        Cases++;
+                        std::vector<uint8> Out(OutSize + GuardBytes, GuardValue);
+                        const std::string Case = std::string("scale ") + FColorConverter::GetKernelName(Kernel) + " " + Size;
+                        if (!Scaler.Scale(Source.data(), Sizes[0], Sizes[1], Stride, Out.data(), Sizes[2], Sizes[3], Kernel))
+                        {
+                            Fail(Case + ": refused");
+                        }
+                        else if (!std::equal(Reference.begin(), Reference.end(), Out.begin()))
+                        {
+                            Fail(Case + ": differs from scalar");
+                        }
+                        else if (!GuardIntact(Out, OutSize))
+                        {
+                            Fail(Case + ": wrote past the end");
+                        }
+                    }
+                }
+            }
+        }
+
+        // --- Frame compare: one byte changed at the start, middle or tail (past the last full vector) ---
+        for (int32 Iteration = 0; Iteration < 2000; ++Iteration)
+        {
+            const std::size_t Size = Iteration < 1000 ? 1 + Random() % 300 : 1 + Random() % 70000;
+            std::vector<uint8> A(Size);
+            FillRandom(A);
+            std::vector<uint8> B = A;
+            const int32 Tolerance = (int32)(Random() % 40);
+            if (Iteration % 4 != 0)
+            {
+                const std::size_t Position = Iteration % 4 == 1 ? 0 : Iteration % 4 == 2 ? Size / 2 : Size - 1 - Random() % std::min<std::size_t>(Size, 31);
+                B[Position] = (uint8)(A[Position] + (int32)(Random() % (2 * Tolerance + 3)) - Tolerance - 1);
+            }
+            bool bExpected = true;
+            for (std::size_t Index = 0; Index < Size; ++Index)
+            {
+                bExpected = bExpected && std::abs((int32)A[Index] - (int32)B[Index]) <= Tolerance;
+            }
+            for (EColorKernel Kernel : Kernels)
+            {
+                Cases++;
+                if (FFrameCompare::IsWithinTolerance(A.data(), B.data(), Size, Tolerance, Kernel) != bExpected)
+                {
+                    Fail(std::string("compare ") + FColorConverter::GetKernelName(Kernel) + " size " + std::to_string(Size) + " tolerance "
+                        + std::to_string(Tolerance) + ": wrong answer");
+                }
+            }
+        }
+
+        // --- 1080p conversion time per kernel ---
+        {
+            const int32 Width = 1920;
+            const int32 Height = 1080;
+            std::vector<uint8> Source((std::size_t)Width * Height * 4);
+            FSyntheticFrame::Fill(Source.data(), Width, Height, 0);
+            std::vector<uint8> Y((std::size_t)Width * Height), U(Y.size() / 4), V(Y.size() / 4);
+            const int32 Iterations = 20;
+            for (EColorKernel Kernel : Kernels)
+            {
+                for (bool bParallel : { false, true })
+                {
+                    const double Begin = GetTimeSeconds();
+                    for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+                    {
+                        FColorConverter::ConvertBGRAToI420(Source.data(), Width, Height, 0, Y.data(), U.data(), V.data(), Kernel, bParallel);
+                    }
+                    std::printf("convert: 1080p BGRA->I420 %-6s %-6s %6.2f ms\n", FColorConverter::GetKernelName(Kernel), bParallel ? "banded" : "serial",
+                        (GetTimeSeconds() - Begin) * 1000.0 / Iterations);
+                }
+            }
+        }
+
+        std::printf("convert: %d cases, %d failed, scalar within %d of floating-point BT.709\n", Cases, Failures, MaxReferenceError);
+        return Failures == 0 ? 0 : 1;
+    }
+
+    /**
+     * Reorder stage under overload: bursts frames at an MJPEG pool faster than it encodes, so the input queue drops,
+     * while unchanged pictures and capture gaps queue repeats and frames stream out slice by slice. Every sequence
+     * must come out exactly once (delivered or counted as dropped) in PTS order, without another submit to push it.
+     */
+    int RunReorderCheck(const FBenchOptions& Options)
+    {
+        const int32 Width = 320;
+        const int32 Height = 240;
+        const double Interval = 1.0 / 60.0;
+
+        FVideoEncoderConfig Config;
+        Config.Width = Width;
+        Config.Height = Height;
+        Config.FPS = 60;
+        Config.JpegQuality = 80;
+        Config.ThreadCount = std::max(Options.Threads, 2);
+        Config.SliceRows = Options.SliceRows > 0 ? Options.SliceRows : 16;
+
+        FEncoderPool Pool;
+        FStaticFrameSettings StaticSettings;
+        StaticSettings.Policy = EStaticFramePolicy::Repeat;
+        StaticSettings.KeepAliveSeconds = 1000.0;
+        Pool.SetStaticFrameSettings(StaticSettings);
+        Pool.SetFillMissedSlots(Interval);
+
+        std::mutex SinkMutex;
+        int64 Delivered = 0;
+        std::vector<FEncodedFrameRef> StreamedFrames; // checked after the run: the sink may be called from the worker still encoding them
+        int64 PtsOutOfOrder = 0;
+        int64 LastPts = -1;
+        Pool.SetFrameSink([&](FEncodedFrameRef Frame)
+        {
+            // Calls never overlap; the lock only publishes the counters to the checking thread
+            std::lock_guard<std::mutex> Lock(SinkMutex);
+            if (Frame->Partial)
+            {
+                StreamedFrames.push_back(Frame);
+            }
+            PtsOutOfOrder += Frame->Pts <= LastPts ? 1 : 0;
+            LastPts = Frame->Pts;
+            Delivered++;
+        });
+        if (!Pool.Start(EEncodingFormat::MJPEG, Config))
+        {
+            std::fprintf(stderr, "reorder: MJPEG encoder failed to start\n");
+            return 1;
+        }
+
+        const int32 NumPictures = 4;
+        std::vector<std::vector<uint8>> Pictures(NumPictures, std::vector<uint8>((size_t)Width * Height * 4));
+        for (int32 Index = 0; Index < NumPictures; ++Index)
+        {
+            FSyntheticFrame::Fill(Pictures[Index].data(), Width, Height, Index);
+        }
+        std::shared_ptr<FRawFramePool> FramePool = std::make_shared<FRawFramePool>();
+
+        // Bursts of 12 back-to-back submits; every picture is held for 3 frames (repeats) and every 7th frame
+        // skips two slots (filled with repeats), then a short pause lets slices stream while the queue drains
+        const int32 NumFrames = 600;
+        int64 Submitted = 0;
+        double CaptureTime = GetTimeSeconds();
+        for (int32 Index = 0; Index < NumFrames; ++Index)
+        {
+            CaptureTime += Index % 7 == 6 ? 3 * Interval : Interval;
+            FRawFrameRef Frame = FramePool->Acquire(Width, Height);
+            const std::vector<uint8>& Picture = Pictures[(Index / 3) % NumPictures];
+            std::memcpy(Frame->Data.data(), Picture.data(), Picture.size());
+            Frame->CaptureTime = CaptureTime;
+            Submitted += Pool.SubmitFrame(std::move(Frame)) ? 1 : 0;
+            if (Index % 12 == 11)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(8));
+            }
+        }
+
+        // No more submits: whatever is left has to come out on its own
+        const double Deadline = GetTimeSeconds() + 5.0;
+        FEncoderPool::FStats Stats;
+        int64 Expected = 0;
+        bool bDrained = false;
+        while (!bDrained && GetTimeSeconds() < Deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            Stats = Pool.GetStats();
+            Expected = Submitted + Stats.FilledSlots;
+            std::lock_guard<std::mutex> Lock(SinkMutex);
+            bDrained = Delivered + Stats.FramesDropped >= Expected;
+        }
+        Pool.Stop();
+
+        std::lock_guard<std::mutex> Lock(SinkMutex);
+        const int64 Streamed = (int64)StreamedFrames.size();
+        const int64 StreamFailures = std::count_if(StreamedFrames.begin(), StreamedFrames.end(),
+            [](const FEncodedFrameRef& Frame) { return !Frame->Partial->IsFinished(); });
+        const int64 Repeats = Delivered - Stats.FramesEncoded;
+        std::printf("reorder: %lld sequences, %lld delivered (%lld streamed by slice, %lld repeats), %d dropped, %d filled slots, %d static\n",
+            (long long)Expected, (long long)Delivered, (long long)Streamed, (long long)Repeats, Stats.FramesDropped, Stats.FilledSlots,
+            Stats.StaticFrames);
+
+        bool bOk = true;
+        auto Fail = [&bOk](const char* Message)
+        {
+            std::fprintf(stderr, "reorder: FAILED - %s\n", Message);
+            bOk = false;
+        };
+        if (Delivered + Stats.FramesDropped != Expected)
+        {
+            Fail("delivered + dropped does not match the sequences submitted (frames stuck in the reorder stage or counted twice)");
+        }
+        if (PtsOutOfOrder > 0)
+        {
+            Fail("PTS went backwards");
+        }
+        if (StreamFailures > 0)
+        {
+            Fail("a slice-streamed frame was never finished");
+        }
+        if (Stats.FramesDropped == 0 || Repeats <= 0 || Streamed == 0)
+        {
+            Fail("the run did not exercise drops, repeats and slice streaming together");
+        }
+        return bOk ? 0 : 1;
+    }
+
+    /**
+     * TS muxer at a low frame rate (8 fps, like the 4K preset): the stream must carry PAT/PMT with valid CRCs (MJPEG as
+     * private data with its "MJPG" registration descriptor), unbroken continuity counters, a PCR at least every
+     * FTSMuxer::PcrInterval that never runs backwards, and PES packets holding exactly the frames that went in, whole
+     * or in pieces. H.264 goes in one unbounded PES per frame; MJPEG (private_stream_1) in bounded PES packets whose
+     * PES_packet_length matches what they carry, frames over 64 KB in several with the PTS on the first only, and no
+     * more TS packets than the frame's bytes and headers need.
+     */
+    int RunMuxCheck()
+    {
+        int32 Failures = 0;
+        auto Fail = [&Failures](const std::string& Message)
+        {
+            if (Failures++ < 20)
+            {
+                std::fprintf(stderr, "mux: FAILED - %s\n", Message.c_str());
+            }
+        };
+        auto GetSectionCrc = [](const uint8* Data, int32 Size)
+        {
+            uint32 Crc = 0xFFFFFFFFu;
+            for (int32 Index = 0; Index < Size; ++Index)
+            {
+                Crc ^= (uint32)Data[Index] << 24;
+                for (int32 Bit = 0; Bit < 8; ++Bit)
+                {
+                    Crc = (Crc & 0x80000000u) ? (Crc << 1) ^ 0x04C11DB7u : (Crc << 1);
+                }
+            }
+            return Crc; // 0 over a section that ends in its own CRC
+        };
+
+        std::mt19937 Random(20240611);
+        for (EEncodingFormat Format : { EEncodingFormat::MJPEG, EEncodingFormat::H264 })
+        {
+            const bool bMjpeg = Format == EEncodingFormat::MJPEG;
+            const std::string Name = bMjpeg ? "MJPEG" : "H.264";
+            FTSMuxer Muxer;
+            std::vector<uint8> Output;
+            auto Sink = [&Output](const uint8* Payload, int32 PayloadSize)
+            {
+                Output.insert(Output.end(), Payload, Payload + PayloadSize);
+                return true;
+            };
+
+            // --- mux: one frame in pieces as slice streaming hands it over, and WritePcr every 30 ms between two frames
+            // running ahead of the next frame's capture time, as the transmitter's does when the capture-to-mux delay grows ---
+            const int64 FrameInterval = 90000 / 8;
+            std::vector<FEncodedFrame> Frames(40);
+            for (int32 Index = 0; Index < (int32)Frames.size(); ++Index)
+            {
+                FEncodedFrame& Frame = Frames[Index];
+                Frame.Format = Format;
+                Frame.Pts = 90000 + Index * FrameInterval;
+                Frame.bKeyframe = Index % 10 == 0;
+                Frame.Data.resize(Index % 4 == 1 ? 70000 + Random() % 150000 : 500 + Random() % 20000);
+                for (uint8& Byte : Frame.Data)
+                {
+                    Byte = (uint8)Random();
+                }
+                const uint8 Start[] = { 0xFF, 0xD8, 0x00, 0x00, 0x00, 0x01, 0x09, 0xF0 }; // SOI, or an H.264 AUD
+                const int32 StartSize = bMjpeg ? 2 : 6;
+                std::memcpy(Frame.Data.data(), Start + (bMjpeg ? 0 : 2), StartSize);
+
+                if (Index == 25)
+                {
+                    Muxer.WritePcr(Muxer.GetLastPcr() - 100, Sink); // behind the clock: ignored
+                    for (int64 Pcr = Muxer.GetLastPcr() + 2700; Pcr < Frame.Pts + 2000; Pcr += 2700)
+                    {
+                        Muxer.WritePcr(Pcr, Sink);
+                    }
+                    Muxer.Flush(Sink);
+                }
+                if (Index == 30)
+                {
+                    const int32 Size = (int32)Frame.Data.size();
+                    Muxer.BeginFrame(Frame, Sink);
+                    Muxer.WriteFrameData(Frame.Data.data(), 8, Sink); // the AUD check looks at the first piece only
+                    Muxer.WriteFrameData(Frame.Data.data() + 8, 180, Sink);
+                    Muxer.WriteFrameData(Frame.Data.data() + 188, Size - 188, Sink);
+                    Muxer.EndFrame(Sink);
+                }
+                else if (Index == 33)
+                {
+                    // Still encoding: the muxer does not know the size, pieces are slice-sized, some smaller than a TS packet
+                    FEncodedFrame Streamed;
+                    Streamed.Format = Frame.Format;
+                    Streamed.Pts = Frame.Pts;
+                    Streamed.Partial = std::make_shared<FPartialBitstream>(Streamed.Data);
+                    Muxer.BeginFrame(Streamed, Sink);
+                    for (int32 Offset = 0; Offset < (int32)Frame.Data.size();)
+                    {
+                        const int32 Piece = std::min((int32)(1 + Random() % 6000), (int32)Frame.Data.size() - Offset);
+                        Muxer.WriteFrameData(Frame.Data.data() + Offset, Piece, Sink);
+                        Offset += Piece;
+                    }
+                    Muxer.EndFrame(Sink);
+                }
+                else
+                {
+                    Muxer.MuxFrame(Frame, Sink);
+                }
+            }
+
+            // --- demux ---
+            int32 CheckedFrames = 0;
+            int32 Packets = 0;
+            int64 LastPcr = -1;
+            int64 MaxPcrGap = 0;
+            int32 PcrPackets = 0;
+            bool bPmtSeen = false;
+            int32 Continuity[0x2000];
+            std::fill(std::begin(Continuity), std::end(Continuity), -1);
+            std::vector<uint8> PesData;
+            int64 PesPts = -1;
+            int64 PesLength = -1; // data bytes the current bounded PES declares
+            int64 PesBytes = 0;
+            int32 FramePes = 0;
+            int32 FramePackets = 0;
+            int64 FrameShortPes = 0; // bounded PES packets short of the 64 KB limit that were not the frame's last
+            int32 TotalPes = 0;
+            auto FinishBoundedPes = [&]()
+            {
+                if (PesLength >= 0 && PesBytes != PesLength)
+                {
+                    Fail(Name + ": PES_packet_length says " + std::to_string(PesLength) + " data bytes, the PES carries " + std::to_string(PesBytes));
+                }
+                if (PesLength >= 0 && PesBytes < 0xFFFF - 13 - (FTSMuxer::PacketSize - 4))
+                {
+                    FrameShortPes++;
+                }
+                PesLength = -1;
+                PesBytes = 0;
+            };
+            auto FinishPes = [&]()
+            {
+                FinishBoundedPes();
+                if (PesPts < 0)
+                {
+                    return;
+                }
+                if (bMjpeg && CheckedFrames < (int32)Frames.size())
+                {
+                    // First packet: 8 bytes of PCR adaptation field; every PES after the first adds a 9-byte header
+                    const int64 Bytes = (int64)Frames[CheckedFrames].Data.size() + 19 + 9 * (FramePes - 1) + 8;
+                    if (FramePackets != (Bytes + FTSMuxer::PacketSize - 5) / (FTSMuxer::PacketSize - 4))
+                    {
+                        Fail(Name + ": frame " + std::to_string(CheckedFrames) + " in " + std::to_string(FramePes) + " PES packets takes "
+                            + std::to_string(FramePackets) + " TS packets, stuffing between them");
+                    }
+                    // The last PES was counted as short too; a frame of known size only ends a PES early at its end
+                    if (CheckedFrames != 33 && FrameShortPes > 1)
+                    {
+                        Fail(Name + ": frame " + std::to_string(CheckedFrames) + " of " + std::to_string(Frames[CheckedFrames].Data.size())
+                            + " bytes in " + std::to_string(FramePes) + " PES packets, more than the 64 KB limit needs");
+                    }
+                }
+                if (CheckedFrames >= (int32)Frames.size())
+                {
+                    Fail(Name + ": more PES packets than frames");
+                }
+                else if (PesPts != Frames[CheckedFrames].Pts + 9000 || PesData != Frames[CheckedFrames].Data)
+                {
+                    Fail(Name + ": PES " + std::to_string(CheckedFrames) + " does not hold the frame that went in");
+                }
+                CheckedFrames++;
+                PesData.clear();
+                PesPts = -1;
+            };
+
+            for (std::size_t Offset = 0; Offset + FTSMuxer::PacketSize <= Output.size(); Offset += FTSMuxer::PacketSize)
+            {
+                const uint8* Packet = Output.data() + Offset;
+                Packets++;
+                const uint16 Pid = (uint16)(((Packet[1] & 0x1F) << 8) | Packet[2]);
+                const bool bPayloadStart = (Packet[1] & 0x40) != 0;
+                const int32 AdaptationControl = (Packet[3] >> 4) & 0x03;
+                const int32 Counter = Packet[3] & 0x0F;
+                if (Packet[0] != 0x47 || AdaptationControl == 0)
+                {
+                    Fail(Name + ": bad TS packet header at byte " + std::to_string(Offset));
+                    continue;
+                }
+                if (Pid == 0x1FFF)
+                {
+                    continue;
+                }
+
+                // The counter moves on with every packet that has a payload and stays put on adaptation-only ones
+                const bool bHasPayload = (AdaptationControl & 0x01) != 0;
+                if (Continuity[Pid] >= 0 && Counter != (bHasPayload ? (Continuity[Pid] + 1) & 0x0F : Continuity[Pid]))
+                {
+                    Fail(Name + ": continuity counter jumps on PID " + std::to_string(Pid));
+                }
+                Continuity[Pid] = Counter;
+
+                int32 PayloadOffset = 4;
+                if (AdaptationControl & 0x02)
+                {
+                    const int32 AdaptationLength = Packet[4];
+                    if (Pid == 0x0100 && AdaptationLength >= 7 && (Packet[5] & 0x10))
+                    {
+                        const int64 Pcr = ((int64)Packet[6] << 25) | ((int64)Packet[7] << 17) | ((int64)Packet[8] << 9)
+                            | ((int64)Packet[9] << 1) | (Packet[10] >> 7);
+                        if (LastPcr >= 0 && Pcr <= LastPcr)
+                        {
+                            Fail(Name + ": PCR went backwards or repeated");
+                        }
+                        MaxPcrGap = LastPcr >= 0 ? std::max(MaxPcrGap, Pcr - LastPcr) : 0;
+                        LastPcr = Pcr;
+                        PcrPackets++;
+                    }
+                    PayloadOffset += 1 + AdaptationLength;
+                }
+                if (!bHasPayload)
+                {
+                    continue;
+                }
+                const uint8* Payload = Packet + PayloadOffset;
+                const int32 PayloadSize = FTSMuxer::PacketSize - PayloadOffset;
+
+                if (Pid == 0x0000 || Pid == 0x1000)
+                {
+                    // One section per packet, right after a zero pointer_field
+                    const uint8* Section = Payload + 1;
+                    const int32 SectionSize = 3 + (((Section[1] & 0x0F) << 8) | Section[2]);
+                    if (!bPayloadStart || Payload[0] != 0 || SectionSize > PayloadSize - 1 || GetSectionCrc(Section, SectionSize) != 0)
+                    {
+                        Fail(Name + ": PSI section on PID " + std::to_string(Pid) + " is malformed or fails its CRC");
+                        continue;
+                    }
+                    if (Pid == 0x0000 && (((Section[10] & 0x1F) << 8) | Section[11]) != 0x1000)
+                    {
+                        Fail(Name + ": PAT does not point at the PMT");
+                    }
+                    if (Pid == 0x1000)
+                    {
+                        bPmtSeen = true;
+                        const int32 ProgramInfoLength = ((Section[10] & 0x0F) << 8) | Section[11];
+                        bool bVideoEntry = false;
+                        for (int32 Entry = 12 + ProgramInfoLength; Entry + 5 <= SectionSize - 4;)
+                        {
+                            const uint16 EntryPid = (uint16)(((Section[Entry + 1] & 0x1F) << 8) | Section[Entry + 2]);
+                            const int32 InfoLength = ((Section[Entry + 3] & 0x0F) << 8) | Section[Entry + 4];
+                            if (EntryPid == 0x0100)
+                            {
+                                bVideoEntry = true;
+                                const uint8 Registration[] = { 0x05, 4, 'M', 'J', 'P', 'G' };
+                                const bool bRegistered = InfoLength >= 6 && std::memcmp(Section + Entry + 5, Registration, 6) == 0;
+                                if (Section[Entry] != (bMjpeg ? 0x06 : 0x1B) || bRegistered != bMjpeg)
+                                {
+                                    Fail(Name + ": PMT video entry has the wrong stream_type or registration descriptor");
+                                }
+                            }
+                            Entry += 5 + InfoLength;
+                        }
+                        if (!bVideoEntry || (((Section[8] & 0x1F) << 8) | Section[9]) != 0x0100)
+                        {
+                            Fail(Name + ": PMT has no video entry or the PCR_PID is not the video PID");
+                        }
+                    }
+                    continue;
+                }
+                if (Pid != 0x0100)
+                {
+                    Fail(Name + ": packet on unexpected PID " + std::to_string(Pid));
+                    continue;
+                }
+
+                if (bPayloadStart)
+                {
+                    const bool bHasPts = (Payload[7] & 0x80) != 0;
+                    if (bHasPts)
+                    {
+                        FinishPes();
+                    }
+                    else
+                    {
+                        FinishBoundedPes();
+                    }
+                    if (!bPmtSeen)
+                    {
+                        Fail(Name + ": video before the first PMT");
+                    }
+                    if (Payload[0] != 0 || Payload[1] != 0 || Payload[2] != 1 || Payload[3] != (bMjpeg ? 0xBD : 0xE0))
+                    {
+                        Fail(Name + ": PES header has the wrong start code or stream_id");
+                        continue;
+                    }
+                    const int32 HeaderSize = 9 + Payload[8];
+                    const int32 Length = (Payload[4] << 8) | Payload[5];
+                    if (bMjpeg ? Length == 0 : Length != 0)
+                    {
+                        Fail(Name + (bMjpeg ? ": unbounded PES on private_stream_1" : ": bounded video PES"));
+                    }
+                    if (bHasPts)
+                    {
+                        PesPts = ((int64)(Payload[9] & 0x0E) << 29) | ((int64)Payload[10] << 22) | ((int64)(Payload[11] & 0xFE) << 14)
+                            | ((int64)Payload[12] << 7) | ((int64)Payload[13] >> 1);
+                        FramePes = 0;
+                        FramePackets = 0;
+                        FrameShortPes = 0;
+                    }
+                    else if (!bMjpeg || PesPts < 0)
+                    {
+                        Fail(Name + ": PES without a PTS that does not continue an MJPEG frame");
+                        continue;
+                    }
+                    PesLength = bMjpeg ? Length - 3 - Payload[8] : -1;
+                    PesBytes = PayloadSize - HeaderSize;
+                    FramePes++;
+                    FramePackets++;
+                    TotalPes++;
+                    PesData.insert(PesData.end(), Payload + HeaderSize, Payload + PayloadSize);
+                }
+                else if (PesPts >= 0)
+                {
+                    PesBytes += PayloadSize;
+                    FramePackets++;
+                    PesData.insert(PesData.end(), Payload, Payload + PayloadSize);
+                }
+            }
+            FinishPes();
+
+            if (Output.size() % FTSMuxer::PayloadSize != 0)
+            {
+                Fail(Name + ": output is not whole 1316-byte payloads");
+            }
+            if (CheckedFrames != (int32)Frames.size())
+            {
+                Fail(Name + ": " + std::to_string(CheckedFrames) + " of " + std::to_string(Frames.size()) + " frames came out");
+            }
+            if (MaxPcrGap > FTSMuxer::PcrInterval)
+            {
+                Fail(Name + ": PCR gap of " + std::to_string(MaxPcrGap / 90) + " ms");
+            }
+            std::printf("mux: %-5s %d frames at 8 fps in %d PES, %d TS packets, %d with PCR, PCR gap max %.1f ms\n", Name.c_str(),
+                CheckedFrames, TotalPes, Packets, PcrPackets, MaxPcrGap / 90.0);
+        }
+
+        std::printf("mux: %d failed\n", Failures);
+        return Failures == 0 ? 0 : 1;
+    }
+
+    /**
+     * Transmission ring: holds exactly the capacity asked for (5 is not rounded up to 8), keeps FIFO order across
+     * wrap-around, and under DropOldest - the producer popping the head while the consumer pops too - every frame
+     * comes out exactly once, to the consumer or as evicted, and each side sees them in order.
+     */
+    int RunRingCheck()
+    {
+        bool bOk = true;
+        auto Fail = [&bOk](const std::string& Message)
+        {
+            std::fprintf(stderr, "ring: FAILED - %s\n", Message.c_str());
+            bOk = false;
+        };
+
+        for (int32 Capacity : { 1, 2, 3, 5, 8, 16 })
+        {
+            TFrameRing<int64> Ring((uint32)Capacity);
+            const std::string Name = "capacity " + std::to_string(Capacity);
+            int64 Next = 0;
+            int64 Expected = 0;
+            for (int32 Round = 0; Round < 5; ++Round)
+            {
+                int32 Pushed = 0;
+                for (int64 Value = Next; Ring.TryPush(Value); Value = ++Next)
+                {
+                    Pushed++;
+                }
+                if (Pushed != Capacity || Ring.Num() != Capacity || Ring.Max() != Capacity)
+                {
+                    Fail(Name + ": took " + std::to_string(Pushed) + " before refusing");
+                    break;
+                }
+                int64 Value = -1;
+                while (Ring.TryPop(Value))
+                {
+                    if (Value != Expected++)
+                    {
+                        Fail(Name + ": out of order after wrapping");
+                    }
+                }
+            }
+        }
+
+        // DropOldest: one producer evicting the head, one consumer draining it
+        {
+            const int64 Count = 500000;
+            TFrameRing<int64> Ring(5);
+            std::atomic<bool> bProducerDone{false};
+            std::vector<int64> Evicted;
+            std::vector<int64> Consumed;
+            Evicted.reserve(Count);
+            Consumed.reserve(Count);
+            std::thread Producer([&]
+            {
+                for (int64 Value = 0; Value < Count; ++Value)
+                {
+                    int64 Item = Value;
+                    while (!Ring.TryPush(Item))
+                    {
+                        int64 Oldest;
+                        if (Ring.TryPop(Oldest))
+                        {
+                            Evicted.push_back(Oldest);
+                        }
+                    }
+                    if (Value % 8 == 0)
+                    {
+                        std::this_thread::yield(); // let the consumer in, even on one core
+                    }
+                }
+                bProducerDone = true;
+            });
+            int32 MaxDepth = 0;
+            for (;;)
+            {
+                const bool bDone = bProducerDone.load();
+                MaxDepth = std::max(MaxDepth, Ring.Num());
+                int64 Item;
+                if (Ring.TryPop(Item))
+                {
+                    Consumed.push_back(Item);
+                }
+                else if (bDone)
+                {
+                    break;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+            Producer.join();
+
+            if (!std::is_sorted(Consumed.begin(), Consumed.end()) || std::adjacent_find(Consumed.begin(), Consumed.end()) != Consumed.end())
+            {
+                Fail("DropOldest: the consumer saw frames out of order or twice");
+            }
+            if (!std::is_sorted(Evicted.begin(), Evicted.end()) || std::adjacent_find(Evicted.begin(), Evicted.end()) != Evicted.end())
+            {
+                Fail("DropOldest: evicted frames out of order or twice");
+            }
+            std::vector<int64> All(Consumed);
+            All.insert(All.end(), Evicted.begin(), Evicted.end());
+            std::sort(All.begin(), All.end());
+            bool bEachOnce = (int64)All.size() == Count;
+            for (int64 Index = 0; bEachOnce && Index < Count; ++Index)
+            {
+                bEachOnce = All[Index] == Index;
+            }
+            if (!bEachOnce)
+            {
+                Fail("DropOldest: " + std::to_string(All.size()) + " frames came out of " + std::to_string(Count) + ", not each exactly once");
+            }
+            if (MaxDepth > 5)
+            {
+                Fail("DropOldest: the ring held " + std::to_string(MaxDepth) + " frames");
+            }
+            std::printf("ring: DropOldest %lld frames, %zu consumed, %zu evicted, depth max %d\n", (long long)Count, Consumed.size(),
+                Evicted.size(), MaxDepth);
+        }
+
+        std::printf("ring: %s\n", bOk ? "ok" : "FAILED");
+        return bOk ? 0 : 1;
+    }
+
+    /**
+     * Adaptive bitrate ladder on a scripted link: each congestion signal (loss, too-late drops, send buffer span
+     * towards the latency window, send buffer fill) steps one rung down, drops at once and the others after two
+     * samples; nothing moves while settling or below the last rung; a clean link steps up after the hold time when
+     * the bandwidth estimate has room; a step up that congests again doubles the hold.
+     */
+    int RunAbrCheck()
+    {
+        FBitrateRung Top;
+        Top.Bitrate = 8000;
+        Top.JpegQuality = 85;
+        FBitrateController::FSettings Settings;
+        Settings.Ladder = FBitrateController::MakeDefaultLadder(Top);
+        FBitrateController Controller(Settings);
+
+        bool bOk = true;
+        auto Fail = [&bOk](const std::string& Message)
+        {
+            std::fprintf(stderr, "abr: FAILED - %s\n", Message.c_str());
+            bOk = false;
+        };
+        for (int32 Index = 1; Index < (int32)Settings.Ladder.size(); ++Index)
+        {
+            if (Settings.Ladder[Index].Bitrate >= Settings.Ladder[Index - 1].Bitrate || Settings.Ladder[Index].JpegQuality >= Settings.Ladder[Index - 1].JpegQuality)
+            {
+                Fail("default ladder does not step down");
+            }
+        }
+
+        enum class ELink { Clean, Loss, Drops, Backlog, BufferFull, Tight, NoClients };
+        struct FStep
+        {
+            double Time;
+            ELink Link;
+            int32 ExpectedRung;
+            const char* What;
+        };
+        const FStep Script[] =
+        {
+            {  0.0, ELink::Clean,      0, "clean link stays on the top rung" },
+            {  0.5, ELink::Loss,       0, "one lossy sample is not enough" },
+            {  1.0, ELink::Loss,       1, "second lossy sample steps down" },
+            {  1.5, ELink::Drops,      1, "settling after a change" },
+            {  3.5, ELink::Drops,      2, "too-late drops step down at once" },
+            {  6.0, ELink::Backlog,    2, "one backed-up sample is not enough" },
+            {  6.5, ELink::Backlog,    3, "send buffer past half the latency steps down" },
+            {  9.0, ELink::BufferFull, 3, "one full-buffer sample is not enough" },
+            {  9.5, ELink::BufferFull, 4, "full send buffer steps down" },
+            { 12.0, ELink::Loss,       4, "no rung below the last" },
+            { 12.5, ELink::Drops,      4, "no rung below the last" },
+            { 13.0, ELink::NoClients,  4, "no receivers: nothing to judge" },
+            { 13.5, ELink::Clean,      4, "clean, hold starts" },
+            { 23.0, ELink::Clean,      4, "hold not over yet" },
+            { 23.5, ELink::Clean,      3, "clean for the hold time steps up" },
+            { 24.0, ELink::Clean,      3, "settling, hold starts again" },
+            { 33.5, ELink::Clean,      3, "hold not over yet" },
+            { 34.0, ELink::Tight,      3, "next rung does not fit the bandwidth estimate" },
+            { 34.5, ELink::Clean,      2, "next rung fits: steps up" },
+            { 37.0, ELink::Loss,       2, "congested right after stepping up" },
+            { 37.5, ELink::Loss,       3, "steps back down, hold doubles" },
+            { 40.0, ELink::Clean,      3, "clean, doubled hold starts" },
+            { 59.5, ELink::Clean,      3, "doubled hold not over yet" },
+            { 60.0, ELink::Clean,      2, "steps up after the doubled hold" },
+        };
+        for (const FStep& Step : Script)
+        {
+            FTransmitter::FLinkStats Sample;
+            Sample.NumClients = Step.Link == ELink::NoClients ? 0 : 1;
+            Sample.IntervalSeconds = 0.5;
+            Sample.RttMs = 20.0;
+            Sample.BandwidthMbps = Step.Link == ELink::Tight ? 4.5 : 100.0;
+            Sample.SendRateMbps = 4.0;
+            Sample.PacketsSent = 1000;
+            Sample.PacketsLost = Step.Link == ELink::Loss || Step.Link == ELink::NoClients ? 100 : 0;
+            Sample.PacketsDropped = Step.Link == ELink::Drops ? 10 : 0;
+            Sample.SendBufferMs = Step.Link == ELink::Backlog ? 100 : 10;
+            Sample.SendBufferFill = Step.Link == ELink::BufferFull ? 0.9f : 0.1f;
+
+            Controller.Update(Sample, Step.Time);
+            if (Controller.GetCurrentRungIndex() != Step.ExpectedRung)
+            {
+                char Message[256];
+                std::snprintf(Message, sizeof(Message), "t=%.1f s: %s - rung %d, expected %d", Step.Time, Step.What,
+                    Controller.GetCurrentRungIndex(), Step.ExpectedRung);
+                Fail(Message);
+            }
+            if (Step.Time == 37.5 && Controller.GetUpgradeHoldSeconds() != Settings.UpgradeHoldSeconds * 2.0)
+            {
+                Fail("the hold did not double after a step up congested the link");
+            }
+        }
+
+        std::printf("abr: %d scripted samples over %d rungs, %s\n", (int32)(sizeof(Script) / sizeof(Script[0])), Controller.GetNumRungs(),
+            bOk ? "ok" : "FAILED");
+        return bOk ? 0 : 1;
+    }
+
+    /**
+     * SMPTE 302M packing against the byte layout written out per subframe pair (as other s302m muxers and demuxers
+     * read it): 4-byte AES3 header, then each channel pair as bit-reversed sample bytes with V U C F after each
+     * subframe, F on the first frame of every 192-frame block, carried across buffers and packets. Two hand-packed
+     * frames pin the layout itself; longer 16- and 24-bit runs at 2 and 8 channels are compared byte for byte.
+     */
+    int RunAudioCheck()
+    {
+        bool bOk = true;
+        auto Fail = [&bOk](const std::string& Message)
+        {
+            std::fprintf(stderr, "audio: FAILED - %s\n", Message.c_str());
+            bOk = false;
+        };
+
+        uint8 Reverse[256];
+        for (int32 Value = 0; Value < 256; ++Value)
+        {
+            uint8 Bits = 0;
+            for (int32 Bit = 0; Bit < 8; ++Bit)
+            {
+                Bits |= (uint8)(((Value >> Bit) & 1) << (7 - Bit));
+            }
+            Reverse[Value] = Bits;
+        }
+
+        // 정수 샘플 -> s302m 바이트 (서브프레임 쌍 단위로 바이트마다 적은 배치)
+        auto PackReference = [&Reverse](const std::vector<int32>& Values, int32 NumChannels, int32 Bits, int32 FirstFramingIndex)
+        {
+            std::vector<uint8> Out;
+            const int32 NumFrames = (int32)Values.size() / NumChannels;
+            for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+            {
+                const uint8 Vucf = (FirstFramingIndex + Frame) % 192 == 0 ? 0x10 : 0x00;
+                for (int32 Pair = 0; Pair < NumChannels; Pair += 2)
+                {
+                    const uint32 Left = (uint32)Values[(size_t)Frame * NumChannels + Pair];
+                    const uint32 Right = (uint32)Values[(size_t)Frame * NumChannels + Pair + 1];
+                    if (Bits == 16)
+                    {
+                        Out.push_back(Reverse[Left & 0xFF]);
+                        Out.push_back(Reverse[(Left >> 8) & 0xFF]);
+                        Out.push_back((uint8)(Reverse[(Right & 0x0F) << 4] | Vucf));
+                        Out.push_back(Reverse[(Right >> 4) & 0xFF]);
+                        Out.push_back(Reverse[(Right >> 12) & 0x0F]);
+                    }
+                    else
+                    {
+                        Out.push_back(Reverse[Left & 0xFF]);
+                        Out.push_back(Reverse[(Left >> 8) & 0xFF]);
+                        Out.push_back(Reverse[(Left >> 16) & 0xFF]);
+                        Out.push_back((uint8)(Reverse[(Right & 0x0F) << 4] | Vucf));
+                        Out.push_back(Reverse[(Right >> 4) & 0xFF]);
+                        Out.push_back(Reverse[(Right >> 12) & 0xFF]);
+                        Out.push_back(Reverse[(Right >> 20) & 0x0F]);
+                    }
+                }
+            }
+            return Out;
+        };
+
+        auto Dump = [](const std::vector<uint8>& Bytes, size_t At)
+        {
+            std::string Text;
+            for (size_t Index = At; Index < std::min(Bytes.size(), At + 8); ++Index)
+            {
+                char Hex[4];
+                std::snprintf(Hex, sizeof(Hex), "%02x ", Bytes[Index]);
+                Text += Hex;
+            }
+            return Text;
+        };
+
+        // Runs the encoder over BufferFrames-sized buffers and compares every packet with the reference
+        int32 NumPackets = 0;
+        auto RunCase = [&](int32 NumChannels, int32 Bits, const std::vector<int32>& Values, int32 BufferFrames, int32 MinPacketFrames,
+            const std::vector<uint8>* Literal)
+        {
+            FAudioEncoder::FConfig Config;
+            Config.NumChannels = NumChannels;
+            Config.BitsPerSample = Bits;
+            Config.MinPacketFrames = MinPacketFrames;
+            FAudioEncoder Encoder(Config);
+
+            const double Scale = (double)((1 << (Bits - 1)) - 1);
+            std::vector<float> Samples(Values.size());
+            for (size_t Index = 0; Index < Values.size(); ++Index)
+            {
+                Samples[Index] = (float)(Values[Index] / Scale);
+            }
+
+            std::vector<FEncodedAudioRef> Packets;
+            auto Sink = [&Packets](FEncodedAudioRef Packet) { Packets.push_back(std::move(Packet)); };
+            const int32 NumFrames = (int32)Values.size() / NumChannels;
+            for (int32 Frame = 0; Frame < NumFrames; Frame += BufferFrames)
+            {
+                const int32 Take = std::min(BufferFrames, NumFrames - Frame);
+                Encoder.Encode(Samples.data() + (size_t)Frame * NumChannels, Take, NumChannels, FAudioEncoder::SampleRate,
+                    (double)(Frame + Take) / FAudioEncoder::SampleRate, Sink);
+            }
+
+            char Name[64];
+            std::snprintf(Name, sizeof(Name), "%d-bit %d ch", Bits, NumChannels);
+            if (Literal && (Packets.size() != 1 || Packets[0]->Data != *Literal))
+            {
+                Fail(std::string(Name) + ": hand-packed frame differs, got " + (Packets.empty() ? std::string("nothing") : Dump(Packets[0]->Data, 0)));
+                return;
+            }
+
+            const int32 BytesPerPair = Bits == 16 ? 5 : 7;
+            int32 Frame = 0;
+            for (const FEncodedAudioRef& Packet : Packets)
+            {
+                const int32 PayloadSize = Packet->NumFrames * NumChannels / 2 * BytesPerPair;
+                const std::vector<int32> PacketValues(Values.begin() + (size_t)Frame * NumChannels,
+                    Values.begin() + (size_t)(Frame + Packet->NumFrames) * NumChannels);
+                std::vector<uint8> Expected = { (uint8)(PayloadSize >> 8), (uint8)PayloadSize,
+                    (uint8)((NumChannels - 2) / 2 << 6), (uint8)((Bits - 16) / 4 << 4) };
+                const std::vector<uint8> Body = PackReference(PacketValues, NumChannels, Bits, Frame);
+                Expected.insert(Expected.end(), Body.begin(), Body.end());
+
+                if (Packet->Data.size() != Expected.size())
+                {
+                    Fail(std::string(Name) + ": packet of " + std::to_string(Packet->Data.size()) + " bytes, expected " + std::to_string(Expected.size()));
+                    return;
+                }
+                const auto Mismatch = std::mismatch(Packet->Data.begin(), Packet->Data.end(), Expected.begin());
+                if (Mismatch.first != Packet->Data.end())
+                {
+                    const size_t At = (size_t)(Mismatch.first - Packet->Data.begin());
+                    Fail(std::string(Name) + ": packet " + std::to_string(NumPackets) + " byte " + std::to_string(At) + ": " + Dump(Packet->Data, At)
+                        + "expected " + Dump(Expected, At));
+                    return;
+                }
+                Frame += Packet->NumFrames;
+                NumPackets++;
+            }
+            if (Frame != NumFrames)
+            {
+                Fail(std::string(Name) + ": " + std::to_string(Frame) + " of " + std::to_string(NumFrames) + " frames came out");
+            }
+        };
+
+        // 손으로 짠 한 프레임: L = 최대, R = 최소(16비트) / 0(24비트), 블록 첫 프레임이라 F = 1
+        const std::vector<uint8> Literal16 = { 0x00, 0x05, 0x00, 0x00, 0xFF, 0xFE, 0x18, 0x00, 0x10 };
+        RunCase(2, 16, { 0x7FFF, -0x7FFF }, 1, 1, &Literal16);
+        const std::vector<uint8> Literal24 = { 0x00, 0x07, 0x00, 0x20, 0xFF, 0xFF, 0xFE, 0x10, 0x00, 0x00, 0x00 };
+        RunCase(2, 24, { 0x7FFFFF, 0 }, 1, 1, &Literal24);
+
+        // 긴 구간: 양 끝값과 난수, 버퍼 300 프레임 / 패킷 최소 480 프레임이라 F 비트가 버퍼와 패킷 경계를 넘어감
+        std::mt19937 Random(302);
+        for (int32 Bits : { 16, 24 })
+        {
+            const int32 Max = (1 << (Bits - 1)) - 1;
+            std::uniform_int_distribution<int32> Distribution(-Max, Max);
+            for (int32 NumChannels : { 2, 8 })
+            {
+                std::vector<int32> Values((size_t)1200 * NumChannels);
+                for (size_t Index = 0; Index < Values.size(); ++Index)
+                {
+                    const int32 Pick = (int32)(Index % 16);
+                    Values[Index] = Pick == 0 ? Max : Pick == 1 ? -Max : Pick == 2 ? 0 : Pick == 3 ? -1 : Distribution(Random);
+                }
+                RunCase(NumChannels, Bits, Values, 300, 480, nullptr);
+            }
+        }
+
+        std::printf("audio: %d SMPTE 302M packets compared byte for byte, %s\n", NumPackets, bOk ? "ok" : "FAILED");
+        return bOk ? 0 : 1;
+    }
+
+    /**
+     * Frame cadence slot clock on scripted poll times at 30 fps: polls on time capture every slot; a late poll takes
+     * the latest slot that passed and reports the ones it missed (also across a stall the poll period ignores); a host
+     * at twice the rate captures just ahead of each slot and skips the poll in between, so no slot is stamped twice.
+     * Across the whole run every slot is either captured or reported missed exactly once, on the exact grid.
+     */
+    int RunCadenceCheck()
+    {
+        bool bOk = true;
+        auto Fail = [&bOk](const std::string& Message)
+        {
+            std::fprintf(stderr, "cadence: FAILED - %s\n", Message.c_str());
+            bOk = false;
+        };
+
+        const double FrameRate = 30.0;
+        const double Origin = 100.0;
+        struct FPoll
+        {
+            double Slots;       // poll time in slots from Origin
+            double OffsetMs;    // plus a fixed offset, so polls never sit on a rounding edge
+            int64 ExpectedSlot; // -1: no capture
+            int32 ExpectedMissed;
+            const char* Phase;
+        };
+        std::vector<FPoll> Polls;
+        for (int64 Slot = 0; Slot < 30; ++Slot)
+        {
+            Polls.push_back({ (double)Slot, 1.0, Slot, 0, "on time" });
+        }
+        Polls.push_back({ 33.2, 0.0, 33, 3, "late poll" });
+        for (int64 Slot = 34; Slot < 50; ++Slot)
+        {
+            Polls.push_back({ (double)Slot, 1.0, Slot, 0, "on time after a late poll" });
+        }
+        Polls.push_back({ 80.4, 0.0, 80, 30, "poll after a stall" });
+        for (int64 Half = 0; Half < 40; ++Half)
+        {
+            const bool bNearSlot = (Half & 1) == 0;
+            Polls.push_back({ 81.0 + Half * 0.5, -2.0, bNearSlot ? 81 + Half / 2 : -1, 0, bNearSlot ? "early poll" : "poll between slots" });
+        }
+
+        FFrameCadence Cadence;
+        Cadence.Start(FrameRate, Origin);
+        int32 Captures = 0;
+        int64 Missed = 0;
+        int64 LastSlot = -1;
+        for (const FPoll& Poll : Polls)
+        {
+            const double Now = Origin + Poll.Slots / FrameRate + Poll.OffsetMs / 1000.0;
+            const FFrameCadence::FTick Tick = Cadence.Poll(Now);
+
+            char Where[96];
+            std::snprintf(Where, sizeof(Where), "%s at slot %.2f", Poll.Phase, Poll.Slots);
+            if (Tick.bCapture != (Poll.ExpectedSlot >= 0))
+            {
+                Fail(std::string(Where) + (Tick.bCapture ? ": captured" : ": did not capture"));
+                continue;
+            }
+            if (!Tick.bCapture)
+            {
+                continue;
+            }
+
+            const double SlotIndex = (Tick.SlotTime - Origin) * FrameRate;
+            const int64 Slot = std::llround(SlotIndex);
+            const double ExpectedError = Now - (Origin + Poll.ExpectedSlot / FrameRate);
+            if (std::abs(SlotIndex - (double)Slot) > 1e-6 || Slot != Poll.ExpectedSlot)
+            {
+                Fail(std::string(Where) + ": stamped slot " + std::to_string(SlotIndex) + ", expected " + std::to_string(Poll.ExpectedSlot));
+            }
+            if (std::abs(Tick.Error - ExpectedError) > 1e-9 || (Poll.OffsetMs < 0.0) != (Tick.Error < 0.0))
+            {
+                Fail(std::string(Where) + ": error " + std::to_string(Tick.Error * 1000.0) + " ms, expected " + std::to_string(ExpectedError * 1000.0));
+            }
+            if (Tick.MissedSlots != Poll.ExpectedMissed)
+            {
+                Fail(std::string(Where) + ": " + std::to_string(Tick.MissedSlots) + " missed slots, expected " + std::to_string(Poll.ExpectedMissed));
+            }
+            if (Slot <= LastSlot)
+            {
+                Fail(std::string(Where) + ": slot " + std::to_string(Slot) + " stamped again");
+            }
+            LastSlot = Slot;
+            Captures++;
+            Missed += Tick.MissedSlots;
+        }
+
+        if (Captures + Missed != LastSlot + 1)
+        {
+            Fail(std::to_string(Captures) + " captures + " + std::to_string(Missed) + " missed do not cover " + std::to_string(LastSlot + 1) + " slots");
+        }
+
+        Cadence.Stop();
+        if (Cadence.Poll(Origin + 200.0).bCapture)
+        {
+            Fail("captured after Stop");
+        }
+
+        std::printf("cadence: %d polls, %d captures, %lld missed slots, %s\n", (int32)Polls.size(), Captures, (long long)Missed,
+            bOk ? "ok" : "FAILED");
+        return bOk ? 0 : 1;
+    }
+
+    /**
+     * Local recording: frames handed over from another thread than the one that called Start are dropped until the
+     * first keyframe, then written in order, each file read back from disk holding exactly those frames. A second
+     * Start on the same recorder begins at a keyframe again.
+     */
+    int RunRecorderCheck()
+    {
+        bool bOk = true;
+        auto Fail = [&bOk](const std::string& Message)
+        {
+            std::fprintf(stderr, "recorder: FAILED - %s\n", Message.c_str());
+            bOk = false;
+        };
+
+        // 파일 -> PID 0x100의 PES를 프레임 단위로 (PTS가 같거나 없는 PES는 앞 프레임에 이어 붙임)
+        auto ReadRecording = [&Fail](const std::string& Path)
+        {
+            std::vector<std::pair<int64, std::vector<uint8>>> Frames;
+            std::FILE* File = std::fopen(Path.c_str(), "rb");
+            if (!File)
+            {
+                Fail("cannot open " + Path);
+                return Frames;
+            }
+            uint8 Packet[FTSMuxer::PacketSize];
+            bool bInPes = false;
+            while (std::fread(Packet, 1, sizeof(Packet), File) == sizeof(Packet))
+            {
+                const uint16 Pid = (uint16)(((Packet[1] & 0x1F) << 8) | Packet[2]);
+                const int32 AdaptationControl = (Packet[3] >> 4) & 0x03;
+                if (Packet[0] != 0x47 || Pid != 0x0100 || (AdaptationControl & 0x01) == 0)
+                {
+                    continue;
+                }
+                int32 Offset = AdaptationControl & 0x02 ? 5 + Packet[4] : 4;
+                if (Packet[1] & 0x40)
+                {
+                    const uint8* Pes = Packet + Offset;
+                    int64 Pts = -1;
+                    if (Pes[7] & 0x80)
+                    {
+                        Pts = ((int64)(Pes[9] & 0x0E) << 29) | ((int64)Pes[10] << 22) | ((int64)(Pes[11] & 0xFE) << 14)
+                            | ((int64)Pes[12] << 7) | ((int64)Pes[13] >> 1);
+                    }
+                    if (Frames.empty() || (Pts >= 0 && Pts != Frames.back().first))
+                    {
+                        Frames.emplace_back(Pts, std::vector<uint8>());
+                    }
+                    Offset += 9 + Pes[8];
+                    bInPes = true;
+                }
+                if (bInPes)
+                {
+                    Frames.back().second.insert(Frames.back().second.end(), Packet + Offset, Packet + FTSMuxer::PacketSize);
+                }
+            }
+            std::fclose(File);
+            return Frames;
+        };
+
+        std::mt19937 Random(2302);
+        FRecorder Recorder(FRecorder::FSettings{});
+        int32 TotalRecorded = 0;
+        for (int32 Run = 0; Run < 2; ++Run)
+        {
+            const int32 FirstKeyframe = Run == 0 ? 3 : 7;
+            std::vector<FEncodedFrameRef> Frames;
+            for (int32 Index = 0; Index < 40; ++Index)
+            {
+                FEncodedFrameRef Frame = std::make_shared<FEncodedFrame>();
+                Frame->Format = EEncodingFormat::MJPEG;
+                Frame->Pts = 90000 + Index * 3000;
+                Frame->bKeyframe = Index % 10 == FirstKeyframe;
+                Frame->Data.resize(1000 + Random() % 30000);
+                for (uint8& Byte : Frame->Data)
+                {
+                    Byte = (uint8)Random();
+                }
+                Frame->Data[0] = 0xFF;
+                Frame->Data[1] = 0xD8;
+                Frames.push_back(std::move(Frame));
+            }
+
+            const std::string Path = "CineSRTRecorderCheck" + std::to_string(Run) + ".ts";
+            if (!Recorder.Start(Path))
+            {
+                Fail("Start failed for " + Path);
+                break;
+            }
+
+            // 인코더 풀의 싱크처럼 Start와 다른 스레드에서 넘김
+            std::vector<bool> Accepted(Frames.size());
+            std::thread Producer([&]
+            {
+                for (std::size_t Index = 0; Index < Frames.size(); ++Index)
+                {
+                    Accepted[Index] = Recorder.RecordFrame(Frames[Index]);
+                }
+            });
+            Producer.join();
+            Recorder.Stop();
+
+            const std::string Name = "file " + std::to_string(Run);
+            for (int32 Index = 0; Index < (int32)Frames.size(); ++Index)
+            {
+                if (Accepted[Index] != (Index >= FirstKeyframe))
+                {
+                    Fail(Name + ": frame " + std::to_string(Index) + (Accepted[Index] ? " accepted before the first keyframe" : " dropped after it"));
+                }
+            }
+            const FRecorder::FStats Stats = Recorder.GetStats();
+            if (Stats.FramesDropped != FirstKeyframe || Stats.FramesRecorded != (int64)Frames.size() - FirstKeyframe || Stats.bWriteFailed)
+            {
+                Fail(Name + ": " + std::to_string(Stats.FramesRecorded) + " recorded, " + std::to_string(Stats.FramesDropped) + " dropped");
+            }
+
+            const auto Written = ReadRecording(Path);
+            std::remove(Path.c_str());
+            if (Written.size() != Frames.size() - FirstKeyframe)
+            {
+                Fail(Name + ": " + std::to_string(Written.size()) + " frames on disk, expected " + std::to_string(Frames.size() - FirstKeyframe));
+                continue;
+            }
+            for (std::size_t Index = 0; Index < Written.size(); ++Index)
+            {
+                const FEncodedFrame& Expected = *Frames[FirstKeyframe + Index];
+                if (Written[Index].first - Written[0].first != Expected.Pts - Frames[FirstKeyframe]->Pts || Written[Index].second != Expected.Data)
+                {
+                    Fail(Name + ": frame " + std::to_string(Index) + " on disk is not frame " + std::to_string(FirstKeyframe + Index));
+                    break;
+                }
+            }
+            TotalRecorded += (int32)Written.size();
+        }
+
+        std::printf("recorder: %d frames read back from 2 files, %s\n", TotalRecorded, bOk ? "ok" : "FAILED");
+        return bOk ? 0 : 1;
+    }
+
+#if WITH_SRT
+    /**
+     * Loopback SRT caller. Reassembles nothing: it only looks for the PES header at the start of
+     * each video frame and records when the frame's first packet arrived, and for MJPEG when its
+     * last one (the EOI marker) did.
+     */
+    class FLoopbackReceiver
+    {
+    public:
+        /** Histograms may be null for receivers of cameras whose hand-offs are not recorded. */
+        FLoopbackReceiver(const FBenchOptions& InOptions, const std::string& InStreamId, FLatencyHistogram* InWireLatency, FLatencyHistogram* InEndToEnd,
+            FLatencyHistogram* InFrameLatency = nullptr)
+            : Options(InOptions)
+            , StreamId(InStreamId)
+            , WireLatency(InWireLatency)
+            , EndToEndLatency(InEndToEnd)
+            , FrameLatency(InFrameLatency)
+        {
+        }
+
+        ~FLoopbackReceiver()
+        {
+            Stop();
+        }
+
+        bool Connect()
+        {
+            ConnectTime = GetTimeSeconds();
+            Socket = srt_create_socket();
+            if (Socket == SRT_INVALID_SOCK)
+            {
+                return false;
+            }
+            srt_setsockopt(Socket, 0, SRTO_LATENCY, &Options.LatencyMs, sizeof(Options.LatencyMs));
+            int RecvTimeoutMs = 200;
+            srt_setsockopt(Socket, 0, SRTO_RCVTIMEO, &RecvTimeoutMs, sizeof(RecvTimeoutMs));
+            if (!StreamId.empty())
+            {
+                srt_setsockopt(Socket, 0, SRTO_STREAMID, StreamId.c_str(), (int)StreamId.size());
+            }
+
+            sockaddr_in sa;
+            std::memset(&sa, 0, sizeof sa);
+            sa.sin_family = AF_INET;
+            sa.sin_port = htons((uint16)Options.Port);
+            inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr);
+            if (srt_connect(Socket, (sockaddr*)&sa, sizeof sa) == SRT_ERROR)
+            {
+                std::fprintf(stderr, "Receiver failed to connect: %s\n", srt_getlasterror_str());
+                srt_close(Socket);
+                Socket = SRT_INVALID_SOCK;
+                return false;
+            }
+
+            Thread = std::thread([this] { Run(); });
+            return true;
+        }
+
+        void Stop()
+        {
+            bShouldStop = true;
+            if (Thread.joinable())
+            {
+                Thread.join();
+            }
+            if (Socket != SRT_INVALID_SOCK)
+            {
+                srt_close(Socket);
+                Socket = SRT_INVALID_SOCK;
+            }
+        }
+
+        int64 GetFramesReceived() const { return FramesReceived.load(); }
+
+        /** Connect to the first packet of the first keyframe (random_access_indicator), -1 before one arrived. */
+        double GetTimeToFirstPicture() const { return TimeToFirstPicture.load(); }
+        int64 GetBytesReceived() const { return BytesReceived.load(); }
+
+        /** Audio PES (PID 0x0101): packets, malformed AES3 headers and PTS discontinuities seen by this receiver. */
+        int64 GetAudioPacketsReceived() const { return AudioPacketsReceived.load(); }
+        int64 GetAudioSamplesReceived() const { return AudioSamplesReceived.load(); }
+        int64 GetAudioErrors() const { return AudioErrors.load(); }
+        int64 GetAudioGaps() const { return AudioGaps.load(); }
+
+        /** Null packets (PID 0x1FFF) the muxer padded SRT payloads with. */
+        int64 GetNullPackets() const { return NullPackets.load(); }
+        int64 GetPacketsReceived() const { return PacketsReceived.load(); }
+
+        /** Longest stretch without a PCR on the video PID: in PCR time and in arrival time at this receiver. */
+        double GetMaxPcrGapMs() const { return MaxPcrGapMs.load(); }
+        double GetMaxPcrArrivalGapMs() const { return MaxPcrArrivalGapMs.load(); }
+
+        /**
+         * Audio timing, recorded by this receiver from the first hand-off it matches on:
+         * capture -> first audio packet (through the video PTS origin), and how far each audio PTS is from the last video PTS on arrival.
+         */
+        void SetAudioHistograms(FLatencyHistogram* InLatency, FLatencyHistogram* InSpread)
+        {
+            AudioLatency = InLatency;
+            AudioSpread = InSpread;
+        }
+
+        /** Called from the transmit pump: when each PTS was captured and handed to the transmitter. */
+        static void RecordHandoff(int64 Pts, double CaptureTime, double Time)
+        {
+            std::lock_guard<std::mutex> Lock(HandoffMutex);
+            Handoffs[GetHandoffIndex(Pts)] = FHandoff{Pts, CaptureTime, Time};
+        }
+
+        static void SetPtsStride(int64 Stride) { PtsStride = std::max<int64>(Stride, 1); }
+
+    private:
+        struct FHandoff
+        {
+            int64 Pts = -1;
+            double CaptureTime = 0.0;
+            double Time = 0.0;
+        };
+
+        static constexpr int32 MaxHandoffs = 1024;
+        static std::mutex HandoffMutex;
+        static FHandoff Handoffs[MaxHandoffs];
+        static int64 PtsStride;
+
+        // PTS follows the capture clock, so round to the nearest nominal frame slot
+        static size_t GetHandoffIndex(int64 Pts)
+        {
+            return (size_t)((Pts + PtsStride / 2) / PtsStride) % MaxHandoffs;
+        }
+
+        void Run()
+        {
+            SetCurrentThreadName("BenchReceiver");
+            char Buffer[1500];
+            while (!bShouldStop)
+            {
+                const int Received = srt_recvmsg(Socket, Buffer, sizeof(Buffer));
+                if (Received == SRT_ERROR)
+                {
+                    // Nothing within the receive timeout (an idle link, e.g. static frames being skipped)
+                    const int Error = srt_getlasterror(nullptr);
+                    if (Error == SRT_EASYNCRCV || Error == SRT_ETIMEOUT)
+                    {
+                        continue;
+                    }
+                    break;
+                }
+                const double Now = GetTimeSeconds();
+                BytesReceived += Received;
+                for (int Offset = 0; Offset + 188 <= Received; Offset += 188)
+                {
+                    ParsePacket(reinterpret_cast<const uint8*>(Buffer + Offset), Now);
+                }
+            }
+        }
+
+        void ParsePacket(const uint8* Packet, double Now)
+        {
+            const bool bPayloadStart = (Packet[1] & 0x40) != 0;
+            const uint16 Pid = (uint16)(((Packet[1] & 0x1F) << 8) | Packet[2]);
+            PacketsReceived++;
+            if (Pid == 0x1FFF)
+            {
+                NullPackets++;
+                return;
+            }
+            if (Packet[0] == 0x47 && Pid == 0x0101)
+            {
+                ParseAudioPacket(Packet, Now);
+                return;
+            }
+            if (Packet[0] != 0x47 || Pid != 0x0100)
+            {
+                return;
+            }
+
+            int32 Offset = 4;
+            if (Packet[3] & 0x20)
+            {
+                if (bPayloadStart && Packet[4] > 0 && (Packet[5] & 0x40) && TimeToFirstPicture.load() < 0.0)
+                {
+                    TimeToFirstPicture = Now - ConnectTime;
+                }
+                if (Packet[4] >= 7 && (Packet[5] & 0x10))
+                {
+                    RecordPcr(((int64)Packet[6] << 25) | ((int64)Packet[7] << 17) | ((int64)Packet[8] << 9) | ((int64)Packet[9] << 1) | (Packet[10] >> 7), Now);
+                }
+                Offset += 1 + Packet[4];
+            }
+            if (!bPayloadStart)
+            {
+                CheckFrameEnd(Packet, Offset, Now);
+                return;
+            }
+            if (Offset + 9 > 188)
+            {
+                return;
+            }
+            const uint8* Pes = Packet + Offset;
+            if (Pes[0] != 0 || Pes[1] != 0 || Pes[2] != 1)
+            {
+                return;
+            }
+            if ((Pes[7] & 0x80) == 0)
+            {
+                // MJPEG frames over one bounded PES go on in PES packets without a PTS
+                CheckFrameEnd(Packet, Offset, Now);
+                return;
+            }
+            if (Offset + 14 > 188)
+            {
+                return;
+            }
+
+            // PES PTS leads the frame PTS by the muxer's fixed offset (100 ms)
+            const int64 PesPts = ((int64)(Pes[9] & 0x0E) << 29) | ((int64)Pes[10] << 22) | ((int64)(Pes[11] & 0xFE) << 14)
+                | ((int64)Pes[12] << 7) | ((int64)Pes[13] >> 1);
+            const int64 Pts = PesPts - 9000;
+            FramesReceived++;
+            CurrentPts = Pts;
+            LastVideoPts = Pts;
+            if (!WireLatency)
+            {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> Lock(HandoffMutex);
+                const FHandoff& Handoff = Handoffs[GetHandoffIndex(Pts)];
+                if (Handoff.Pts == Pts)
+                {
+                    WireLatency->Record(Now - Handoff.Time);
+                    EndToEndLatency->Record(Now - Handoff.CaptureTime);
+                    PtsOriginTime = Handoff.CaptureTime - Pts / 90000.0;
+                }
+            }
+            CheckFrameEnd(Packet, Offset, Now);
+        }
+
+        // Gaps between PCRs on the stream clock and on arrival; a jump of more than a second is a new timeline (encoder restart)
+        void RecordPcr(int64 Pcr, double Now)
+        {
+            if (LastPcr >= 0 && std::abs(Pcr - LastPcr) < 90000)
+            {
+                MaxPcrGapMs = std::max(MaxPcrGapMs.load(), (Pcr - LastPcr) / 90.0);
+                MaxPcrArrivalGapMs = std::max(MaxPcrArrivalGapMs.load(), (Now - LastPcrArrival) * 1000.0);
+            }
+            LastPcr = Pcr;
+            LastPcrArrival = Now;
+        }
+
+        // SMPTE 302M: one AES3 packet per PES, its size in the header must match the PES length
+        void ParseAudioPacket(const uint8* Packet, double Now)
+        {
+            if ((Packet[1] & 0x40) == 0)
+            {
+                return;
+            }
+            const int32 Offset = 4 + ((Packet[3] & 0x20) ? 1 + Packet[4] : 0);
+            if (Offset + 18 > 188)
+            {
+                AudioErrors++;
+                return;
+            }
+            const uint8* Pes = Packet + Offset;
+            if (Pes[0] != 0 || Pes[1] != 0 || Pes[2] != 1 || Pes[3] != 0xBD || (Pes[7] & 0x80) == 0)
+            {
+                AudioErrors++;
+                return;
+            }
+            const int32 PesLength = (Pes[4] << 8) | Pes[5];
+            const uint8* Aes3 = Pes + 9 + Pes[8];
+            const int32 PacketSize = (Aes3[0] << 8) | Aes3[1];
+            const int32 Channels = ((Aes3[2] >> 6) + 1) * 2;
+            const int32 Bits = 16 + ((Aes3[3] >> 4) & 0x03) * 4;
+            if (PacketSize != PesLength - 3 - Pes[8] - 4 || PacketSize % (Channels * (Bits + 4) / 8) != 0)
+            {
+                AudioErrors++;
+                return;
+            }
+            const int32 Frames = PacketSize / (Channels * (Bits + 4) / 8);
+            const int64 Pts = (((int64)(Pes[9] & 0x0E) << 29) | ((int64)Pes[10] << 22) | ((int64)(Pes[11] & 0xFE) << 14)
+                | ((int64)Pes[12] << 7) | ((int64)Pes[13] >> 1)) - 9000;
+
+            // Packets continue each other's sample count; the encoder's drift correction moves the PTS by well under a tick
+            if (LastAudioPts >= 0 && std::abs(Pts - (LastAudioPts + LastAudioFrames * 90000 / 48000)) > 2)
+            {
+                AudioGaps++;
+            }
+            LastAudioPts = Pts;
+            LastAudioFrames = Frames;
+            AudioPacketsReceived++;
+            AudioSamplesReceived += Frames;
+
+            if (AudioLatency && PtsOriginTime > 0.0)
+            {
+                AudioLatency->Record(Now - (PtsOriginTime + Pts / 90000.0));
+            }
+            if (AudioSpread && LastVideoPts >= 0)
+            {
+                AudioSpread->Record(std::abs(Pts - LastVideoPts) / 90000.0);
+            }
+        }
+
+        // MJPEG only: every frame ends on a packet boundary with its EOI marker, so that packet completes the frame
+        void CheckFrameEnd(const uint8* Packet, int32 Offset, double Now)
+        {
+            if (!FrameLatency || CurrentPts < 0 || Offset > 186 || Packet[186] != 0xFF || Packet[187] != 0xD9)
+            {
+                return;
+            }
+            std::lock_guard<std::mutex> Lock(HandoffMutex);
+            const FHandoff& Handoff = Handoffs[GetHandoffIndex(CurrentPts)];
+            if (Handoff.Pts == CurrentPts)
+            {
+                FrameLatency->Record(Now - Handoff.CaptureTime);
+            }
+            CurrentPts = -1;
+        }
+
+        const FBenchOptions& Options;
+        const std::string StreamId;
+        FLatencyHistogram* WireLatency;
+        FLatencyHistogram* EndToEndLatency;
+        FLatencyHistogram* FrameLatency;
+        int64 CurrentPts = -1; // frame whose EOI has not arrived yet (receiver thread)
+        FLatencyHistogram* AudioLatency = nullptr;
+        FLatencyHistogram* AudioSpread = nullptr;
+        int64 LastVideoPts = -1;
+        double PtsOriginTime = 0.0; // capture time of PTS 0, from the hand-offs
+        int64 LastAudioPts = -1;
+        int64 LastAudioFrames = 0;
+        std::atomic<int64> AudioPacketsReceived{0};
+        std::atomic<int64> AudioSamplesReceived{0};
+        std::atomic<int64> AudioErrors{0};
+        std::atomic<int64> AudioGaps{0};
+        std::atomic<int64> NullPackets{0};
+        std::atomic<int64> PacketsReceived{0};
+        int64 LastPcr = -1;
+        double LastPcrArrival = 0.0;
+        std::atomic<double> MaxPcrGapMs{0.0};
+        std::atomic<double> MaxPcrArrivalGapMs{0.0};
+        SRTSOCKET Socket = SRT_INVALID_SOCK;
+        std::thread Thread;
+        std::atomic<bool> bShouldStop{false};
+        std::atomic<int64> FramesReceived{0};
+        std::atomic<int64> BytesReceived{0};
+        double ConnectTime = 0.0;
+        std::atomic<double> TimeToFirstPicture{-1.0};
+    };
+
+    std::mutex FLoopbackReceiver::HandoffMutex;
+    FLoopbackReceiver::FHandoff FLoopbackReceiver::Handoffs[FLoopbackReceiver::MaxHandoffs];
+    int64 FLoopbackReceiver::PtsStride = 1;
+#endif
+}
+
+int main(int Argc, char** Argv)
+{
+    FBenchOptions Options;
+    if (!ParseOptions(Argc, Argv, Options))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    if (!Options.bVerbose)
+    {
+        SetLogHandler([](ELogLevel Level, const char* Message)
+        {
+            if (Level >= ELogLevel::Warning)
+            {
+                std::fprintf(stderr, "%s\n", Message);
+            }
+        });
+    }
+
+    if (Options.Check == "reorder")
+    {
+        return RunReorderCheck(Options);
+    }
+    if (Options.Check == "convert")
+    {
+        return RunConvertCheck();
+    }
+    if (Options.Check == "mux")
+    {
+        return RunMuxCheck();
+    }
+    if (Options.Check == "ring")
+    {
+        return RunRingCheck();
+    }
+    if (Options.Check == "abr")
+    {
+        return RunAbrCheck();
+    }
+    if (Options.Check == "audio")
+    {
+        return RunAudioCheck();
+    }
+    if (Options.Check == "cadence")
+    {
+        return RunCadenceCheck();
+    }
+    if (Options.Check == "recorder")
+    {
+        return RunRecorderCheck();
+    }
+
+#if !WITH_SRT
+    if (Options.Clients > 0)
+    {
+        std::fprintf(stderr, "Built without SRT; running encode + mux only\n");
+        Options.Clients = 0;
+    }
+#else
+    // Once per process, like the module's StartupModule - transmitters only take a reference
+    const double SRTStartupBegin = GetTimeSeconds();
+    if (!FTransmitter::StartupSRT())
+    {
+        std::fprintf(stderr, "SRT failed to initialize\n");
+        return 1;
+    }
+    const double SRTStartupMs = (GetTimeSeconds() - SRTStartupBegin) * 1000.0;
+#endif
+
+    // --- Encoder ---
+    FVideoEncoderConfig Config;
+    Config.Width = Options.Width;
+    Config.Height = Options.Height;
+    Config.FPS = Options.FPS;
+    Config.Bitrate = Options.Bitrate;
+    Config.JpegQuality = Options.JpegQuality;
+    Config.ThreadCount = Options.Threads;
+    Config.KeyframeInterval = Options.Gop;
+    Config.SliceRows = Options.SliceRows;
+
+    // Shared by the encoder workers and the transmitter thread, like the component does
+    std::shared_ptr<FPipelineStats> PipelineStats = std::make_shared<FPipelineStats>();
+
+    // Several cameras (or renditions) share one scheduler's threads instead of starting workers each, like the engine subsystem does
+    std::shared_ptr<FEncodeScheduler> Scheduler;
+    if (Options.Cameras > 1 || !Options.Renditions.empty())
+    {
+        Scheduler = std::make_shared<FEncodeScheduler>(Options.SharedThreads);
+    }
+
+    FEncoderPool Encoder;
+    Encoder.SetPipelineStats(PipelineStats);
+    Encoder.SetScheduler(Scheduler);
+    FStaticFrameSettings StaticSettings;
+    StaticSettings.Policy = Options.StaticPolicy;
+    StaticSettings.Tolerance = Options.StaticTolerance;
+    StaticSettings.KeepAliveSeconds = Options.KeepAlive;
+    Encoder.SetStaticFrameSettings(StaticSettings);
+    Encoder.SetWarmUp(Options.bPrewarm);
+    if (!Encoder.Start(Options.Format, Config))
+    {
+        std::fprintf(stderr, "Encoder failed to start (codec not compiled in?)\n");
+        return 1;
+    }
+
+    // Adaptive bitrate: the transmitter thread samples the links and the controller retargets the encoder
+    // (declared before the transmitter so it outlives the thread that calls into it)
+    FBitrateRung TopRung;
+    TopRung.Bitrate = Options.Bitrate;
+    TopRung.JpegQuality = Options.JpegQuality;
+    FBitrateController::FSettings ControllerSettings;
+    ControllerSettings.Ladder = FBitrateController::MakeDefaultLadder(TopRung);
+    ControllerSettings.LatencyMs = Options.LatencyMs;
+    FBitrateController Controller(ControllerSettings);
+    struct FRungChange
+    {
+        double Time;
+        int32 Rung;
+        FTransmitter::FLinkStats Link;
+    };
+    std::vector<FRungChange> RungChanges;
+    std::vector<double> RungSeconds(Controller.GetNumRungs(), 0.0);
+    double LastRungTime = 0.0;
+
+    // --- Transmitter + loopback receivers ---
+    FTransmitter::FSettings TransmitterSettings;
+    TransmitterSettings.Port = Options.Port;
+    TransmitterSettings.LatencyTolerance = Options.LatencyMs;
+    const int32 NumJoins = Options.JoinEvery > 0.0 ? std::max((int32)std::ceil(Options.Seconds / Options.JoinEvery) - 1, 0) : 0;
+    TransmitterSettings.MaxClients = std::max(Options.Clients + NumJoins, 1);
+    TransmitterSettings.JoinCacheMaxBytes = Options.JoinCacheMB * 1024 * 1024;
+    TransmitterSettings.bKeyframeOnJoin = Options.bKeyframeOnJoin;
+    TransmitterSettings.MaxBW = (int32)std::min<int64>((int64)Options.LinkMbps * 1000000 / 8, 0x7FFFFFFF); // bytes/s
+    FTransmitter Transmitter(TransmitterSettings);
+
+    // Camera 0 is the measured stream; a single camera takes every caller like a standalone component
+    std::shared_ptr<FTransmitter::FStream> Stream = Transmitter.CreateStream(Options.Cameras > 1 ? "cam0" : "");
+    Stream->SetPipelineStats(PipelineStats);
+    Stream->OnKeyframeRequest = [&Encoder]
+    {
+        Encoder.RequestKeyframe();
+    };
+    Transmitter.AddStream(Stream);
+    if (Options.bAdaptiveBitrate)
+    {
+        Stream->OnLinkStats = [&](const FTransmitter::FLinkStats& Link)
+        {
+            const double Now = GetTimeSeconds();
+            const int32 PreviousRung = Controller.GetCurrentRungIndex();
+            if (LastRungTime > 0.0)
+            {
+                RungSeconds[PreviousRung] += Now - LastRungTime;
+            }
+            LastRungTime = Now;
+            if (Controller.Update(Link, Now))
+            {
+                const FBitrateRung& Rung = Controller.GetCurrentRung();
+                Encoder.SetRate(Rung.Bitrate, Rung.JpegQuality);
+                RungChanges.push_back(FRungChange{Now, Controller.GetCurrentRungIndex(), Link});
+            }
+        };
+    }
+
+    FLatencyHistogram HandoffLatency; // released by the encoder -> TransmitFrame
+    FLatencyHistogram WireLatency;    // TransmitFrame -> first packet at the receiver
+    FLatencyHistogram EndToEndLatency; // capture -> first packet at the receiver
+    FLatencyHistogram FrameLatency;    // capture -> last packet at the receiver (MJPEG)
+    FLatencyHistogram AudioLatency;    // audio capture -> its PES at the receiver (--audio)
+    FLatencyHistogram AudioSpread;     // |audio PTS - last video PTS| when the audio arrives (--audio)
+
+    // Other cameras: same frames and settings, own encoder pool and stream, one receiver each when clients are on
+    // ISO recordings, one per camera (index 0 = the main camera), fed from the same frame sinks as the transmitter
+    std::vector<std::unique_ptr<FRecorder>> Recorders;
+    if (!Options.RecordDir.empty())
+    {
+        FRecorder::FSettings RecorderSettings;
+        RecorderSettings.WriteBlockBytes = Options.RecordBlockMB * 1024 * 1024;
+        for (int32 Index = 0; Index < Options.Cameras; ++Index)
+        {
+            Recorders.push_back(std::make_unique<FRecorder>(RecorderSettings));
+            const std::string Path = Options.RecordDir + "/" + (Options.Cameras > 1 ? "cam" + std::to_string(Index) : "bench") + ".ts";
+            if (!Recorders.back()->Start(Path))
+            {
+                std::fprintf(stderr, "Cannot record to %s\n", Path.c_str());
+                return 1;
+            }
+        }
+    }
+
+    struct FExtraCamera
+    {
+        std::unique_ptr<FEncoderPool> Encoder;
+        std::shared_ptr<FTransmitter::FStream> Stream;
+        std::shared_ptr<FPipelineStats> Stats; // renditions only
+#if WITH_SRT
+        std::unique_ptr<FLoopbackReceiver> Receiver;
+#endif
+    };
+    std::vector<FExtraCamera> ExtraCameras(Options.Cameras - 1);
+    for (int32 Index = 0; Index < (int32)ExtraCameras.size(); ++Index)
+    {
+        FExtraCamera& Camera = ExtraCameras[Index];
+        Camera.Stream = Transmitter.CreateStream("cam" + std::to_string(Index + 1));
+        Transmitter.AddStream(Camera.Stream);
+        Camera.Encoder = std::make_unique<FEncoderPool>();
+        Camera.Encoder->SetScheduler(Scheduler);
+        Camera.Encoder->SetStaticFrameSettings(StaticSettings);
+        Camera.Encoder->SetWarmUp(Options.bPrewarm);
+        std::shared_ptr<FTransmitter::FStream> CameraStream = Camera.Stream;
+        FRecorder* CameraRecorder = Recorders.empty() ? nullptr : Recorders[Index + 1].get();
+        Camera.Encoder->SetFrameSink([CameraStream, CameraRecorder, &Options](FEncodedFrameRef Encoded)
+        {
+            if (CameraRecorder)
+            {
+                CameraRecorder->RecordFrame(Encoded);
+            }
+            if (Options.Clients > 0)
+            {
+                CameraStream->TransmitFrame(std::move(Encoded));
+            }
+        });
+        if (!Camera.Encoder->Start(Options.Format, Config))
+        {
+            std::fprintf(stderr, "Encoder for camera %d failed to start\n", Index + 1);
+            return 1;
+        }
+    }
+
+    // Simulcast renditions: the main camera's frame references, scaled to each size on the rendition's encode threads
+    std::vector<FExtraCamera> Renditions(Options.Renditions.size());
+    for (int32 Index = 0; Index < (int32)Renditions.size(); ++Index)
+    {
+        FExtraCamera& Rendition = Renditions[Index];
+        FVideoEncoderConfig RenditionConfig = Config;
+        RenditionConfig.Width = Options.Renditions[Index].first;
+        RenditionConfig.Height = Options.Renditions[Index].second;
+        Rendition.Stream = Transmitter.CreateStream(std::to_string(RenditionConfig.Width) + "x" + std::to_string(RenditionConfig.Height));
+        Transmitter.AddStream(Rendition.Stream);
+        Rendition.Stats = std::make_shared<FPipelineStats>();
+        Rendition.Encoder = std::make_unique<FEncoderPool>();
+        Rendition.Encoder->SetScheduler(Scheduler);
+        Rendition.Encoder->SetPipelineStats(Rendition.Stats);
+        Rendition.Encoder->SetScaleInput(true);
+        Rendition.Encoder->SetStaticFrameSettings(StaticSettings);
+        Rendition.Encoder->SetWarmUp(Options.bPrewarm);
+        std::shared_ptr<FTransmitter::FStream> RenditionStream = Rendition.Stream;
+        Rendition.Encoder->SetFrameSink([RenditionStream, &Options](FEncodedFrameRef Encoded)
+        {
+            if (Options.Clients > 0)
+            {
+                RenditionStream->TransmitFrame(std::move(Encoded));
+            }
+        });
+        if (!Rendition.Encoder->Start(Options.Format, RenditionConfig))
+        {
+            std::fprintf(stderr, "Encoder for rendition %s failed to start\n", Rendition.Stream->GetStreamId().c_str());
+            return 1;
+        }
+    }
+
+#if WITH_SRT
+    std::vector<std::unique_ptr<FLoopbackReceiver>> Receivers;
+    FLoopbackReceiver::SetPtsStride(90000 / Options.FPS);
+    double PrepareMs = 0.0;
+    double StartTransmissionMs = 0.0;
+    auto StartTransmitter = [&]
+    {
+        const double Begin = GetTimeSeconds();
+        const bool bStarted = Transmitter.StartTransmission();
+        StartTransmissionMs = (GetTimeSeconds() - Begin) * 1000.0;
+        if (!bStarted)
+        {
+            std::fprintf(stderr, "Transmitter failed to start on port %d\n", Options.Port);
+        }
+        return bStarted;
+    };
+    if (Options.Clients > 0)
+    {
+        // Warm: the listener is bound ahead and receivers queue on it, so starting only launches the thread
+        if (Options.bPrewarm)
+        {
+            const double Begin = GetTimeSeconds();
+            if (!Transmitter.Prepare())
+            {
+                std::fprintf(stderr, "Transmitter failed to bind port %d\n", Options.Port);
+                return 1;
+            }
+            PrepareMs = (GetTimeSeconds() - Begin) * 1000.0;
+        }
+        else if (!StartTransmitter())
+        {
+            return 1;
+        }
+        for (int32 Index = 0; Index < Options.Clients; ++Index)
+        {
+            std::unique_ptr<FLoopbackReceiver> Receiver = std::make_unique<FLoopbackReceiver>(Options, Stream->GetStreamId(), &WireLatency, &EndToEndLatency,
+                Options.Format == EEncodingFormat::MJPEG ? &FrameLatency : nullptr);
+            Receiver->SetAudioHistograms(&AudioLatency, &AudioSpread);
+            if (!Receiver->Connect())
+            {
+                return 1;
+            }
+            Receivers.push_back(std::move(Receiver));
+        }
+        for (FExtraCamera& Camera : ExtraCameras)
+        {
+            Camera.Receiver = std::make_unique<FLoopbackReceiver>(Options, Camera.Stream->GetStreamId(), nullptr, nullptr);
+            if (!Camera.Receiver->Connect())
+            {
+                return 1;
+            }
+        }
+        for (FExtraCamera& Rendition : Renditions)
+        {
+            Rendition.Receiver = std::make_unique<FLoopbackReceiver>(Options, Rendition.Stream->GetStreamId(), nullptr, nullptr);
+            if (!Rendition.Receiver->Connect())
+            {
+                return 1;
+            }
+        }
+        if (Options.bPrewarm && !StartTransmitter())
+        {
+            return 1;
+        }
+        const int32 ExpectedClients = Options.Clients + (int32)ExtraCameras.size() + (int32)Renditions.size();
+        const double ConnectDeadline = GetTimeSeconds() + 5.0;
+        while (Transmitter.GetNumClients() < ExpectedClients && GetTimeSeconds() < ConnectDeadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        if (Transmitter.GetNumClients() < ExpectedClients)
+        {
+            std::fprintf(stderr, "Only %d of %d receivers connected\n", Transmitter.GetNumClients(), ExpectedClients);
+            return 1;
+        }
+    }
+#endif
+
+    // Pre-generate a short loop so frame synthesis is not part of the measurement
+    const int32 NumSourceFrames = 8;
+    const size_t FrameBytes = (size_t)Options.Width * Options.Height * 4;
+    std::vector<std::vector<uint8>> SourceFrames(NumSourceFrames, std::vector<uint8>(FrameBytes));
+    for (int32 Index = 0; Index < NumSourceFrames; ++Index)
+    {
+        FSyntheticFrame::Fill(SourceFrames[Index].data(), Options.Width, Options.Height, Index);
+    }
+
+    // Frames at the switch size, for the on-air reconfiguration test
+    const size_t SwitchFrameBytes = (size_t)Options.SwitchWidth * Options.SwitchHeight * 4;
+    std::vector<std::vector<uint8>> SwitchFrames;
+    if (Options.SwitchAt > 0.0)
+    {
+        SwitchFrames.assign(NumSourceFrames, std::vector<uint8>(SwitchFrameBytes));
+        for (int32 Index = 0; Index < NumSourceFrames; ++Index)
+        {
+            FSyntheticFrame::Fill(SwitchFrames[Index].data(), Options.SwitchWidth, Options.SwitchHeight, Index);
+        }
+    }
+
+    std::shared_ptr<FRawFramePool> FramePool = std::make_shared<FRawFramePool>();
+    FramePool->Preallocate((Options.Threads * 2 + 8) * Options.Cameras, Options.Width, Options.Height, Options.bPrewarm);
+
+    // Hand-off to the transmitter: on the encoder threads through the frame sink, or from the
+    // capture loop in --poll mode (one GetEncodedFrame per captured frame, like the old capture tick)
+    std::atomic<int64> FramesDelivered{0};
+    std::atomic<int64> BytesEncoded{0};
+    std::atomic<int64> FramesStreamed{0};
+    double LastDeliveryTime = 0.0; // sink calls never overlap
+    double MaxDeliveryGap = 0.0;
+    int64 LastDeliveredPts = -1;
+    int64 PtsStepsOffGrid = 0; // PTS steps more than 1 ms away from a whole number of frame intervals (judder)
+    double MaxPtsStepErrorMs = 0.0;
+    double FirstHandoffMs = -1.0;
+    auto DeliverFrame = [&](FEncodedFrameRef Encoded)
+    {
+        const double Now = GetTimeSeconds();
+        if (LastDeliveryTime > 0.0)
+        {
+            MaxDeliveryGap = std::max(MaxDeliveryGap, Now - LastDeliveryTime);
+        }
+        LastDeliveryTime = Now;
+        if (LastDeliveredPts >= 0)
+        {
+            const double Stride = 90000.0 / Options.FPS;
+            const double Step = (double)(Encoded->Pts - LastDeliveredPts);
+            const double StepErrorMs = std::abs(Step - std::max(1.0, std::round(Step / Stride)) * Stride) / 90.0;
+            MaxPtsStepErrorMs = std::max(MaxPtsStepErrorMs, StepErrorMs);
+            PtsStepsOffGrid += StepErrorMs > 1.0 ? 1 : 0;
+        }
+        LastDeliveredPts = Encoded->Pts;
+        HandoffLatency.Record(Now - Encoded->CaptureTime);
+        if (FirstHandoffMs < 0.0)
+        {
+            FirstHandoffMs = (Now - Encoded->CaptureTime) * 1000.0;
+        }
+        if (Encoded->Partial)
+        {
+            // Still being encoded: its Data belongs to the encoder until the frame finishes (bytes come from the pool stats)
+            FramesStreamed++;
+        }
+        else
+        {
+            BytesEncoded += (int64)Encoded->Data.size();
+        }
+        FramesDelivered++;
+        if (!Recorders.empty())
+        {
+            Recorders[0]->RecordFrame(Encoded);
+        }
+#if WITH_SRT
+        if (Options.Clients > 0)
+        {
+            FLoopbackReceiver::RecordHandoff(Encoded->Pts, Encoded->CaptureTime, Now);
+            Stream->TransmitFrame(std::move(Encoded));
+        }
+#endif
+    };
+    if (!Options.bPoll)
+    {
+        Encoder.SetFrameSink(DeliverFrame);
+    }
+    if (Options.GameFPS > 0 && !Options.bNoFill)
+    {
+        Encoder.SetFillMissedSlots(1.0 / Options.FPS);
+    }
+
+    const FResourceUsage UsageBefore = GetResourceUsage();
+    const double StartTime = GetTimeSeconds();
+    Stream->MarkStart(StartTime); // the first capture, not StartTransmission, is what a viewer waits on
+    std::atomic<bool> bGeneratorDone{false};
+    std::atomic<int64> FramesGenerated{0};
+    std::atomic<int64> FramesLate{0};
+    double SwitchRequestTime = -1.0;
+    double SwitchReadyTime = -1.0;
+    int64 SwitchFrame = -1;
+
+    // Capture stand-in: copies a source frame into a pooled buffer at the target cadence
+    std::thread Generator([&]
+    {
+        SetCurrentThreadName("BenchCapture");
+        const double Interval = 1.0 / Options.FPS;
+        const int64 NumFrames = (int64)(Options.Seconds * Options.FPS);
+
+        // Game loop stand-in: frames at the game rate with jitter; the cadence picks the frames that capture
+        FFrameCadence Cadence;
+        Cadence.Start(Options.FPS, StartTime);
+        std::mt19937 Random(1234);
+        std::uniform_real_distribution<double> Jitter(-Options.GameJitterMs / 1000.0, Options.GameJitterMs / 1000.0);
+        int64 GameFrame = 0;
+        int32 Width = Options.Width;
+        int32 Height = Options.Height;
+        const std::vector<std::vector<uint8>>* Source = &SourceFrames;
+        for (int64 Index = 0; Index < NumFrames; ++Index)
+        {
+            // Like SetStreamQuality on air: build the new encoders, keep capturing at the old size until
+            // they are ready, then switch the capture size between two frames
+            if (Options.SwitchAt > 0.0 && SwitchRequestTime < 0.0 && Index * Interval >= Options.SwitchAt)
+            {
+                FVideoEncoderConfig SwitchConfig = Config;
+                SwitchConfig.Width = Options.SwitchWidth;
+                SwitchConfig.Height = Options.SwitchHeight;
+                SwitchRequestTime = GetTimeSeconds();
+                Encoder.Reconfigure(Options.Format, SwitchConfig);
+            }
+            if (SwitchRequestTime >= 0.0 && SwitchFrame < 0 && !Encoder.IsReconfiguring())
+            {
+                SwitchReadyTime = GetTimeSeconds();
+                SwitchFrame = Index;
+                Width = Options.SwitchWidth;
+                Height = Options.SwitchHeight;
+                Source = &SwitchFrames;
+            }
+
+            double CaptureTime = 0.0;
+            if (Options.GameFPS > 0)
+            {
+                FFrameCadence::FTick Tick;
+                while (!Tick.bCapture)
+                {
+                    const double GameFrameDue = StartTime + ++GameFrame / (double)Options.GameFPS + Jitter(Random);
+                    const double Now = GetTimeSeconds();
+                    if (GameFrameDue > Now)
+                    {
+                        std::this_thread::sleep_for(std::chrono::duration<double>(GameFrameDue - Now));
+                    }
+                    Tick = Cadence.Poll(GetTimeSeconds());
+                }
+                if (Tick.SlotTime - StartTime >= Options.Seconds)
+                {
+                    break;
+                }
+                PipelineStats->Record(EPipelineStage::Cadence, std::abs(Tick.Error));
+                PipelineStats->Add(EPipelineCounter::SlotsMissed, Tick.MissedSlots);
+                CaptureTime = Tick.SlotTime;
+            }
+            else
+            {
+                const double Due = StartTime + Index * Interval;
+                const double Now = GetTimeSeconds();
+                if (Due > Now)
+                {
+                    std::this_thread::sleep_for(std::chrono::duration<double>(Due - Now));
+                }
+                else if (Now - Due > Interval)
+                {
+                    FramesLate++;
+                }
+                CaptureTime = GetTimeSeconds();
+            }
+
+            FRawFrameRef Frame = FramePool->Acquire(Width, Height);
+            std::memcpy(Frame->Data.data(), (*Source)[(Index / Options.Still) % NumSourceFrames].data(), Frame->Data.size());
+            Frame->CaptureTime = CaptureTime;
+            PipelineStats->Add(EPipelineCounter::FramesCaptured);
+            for (FExtraCamera& Rendition : Renditions)
+            {
+                Rendition.Stats->Add(EPipelineCounter::FramesCaptured);
+                Rendition.Encoder->SubmitFrame(Frame);
+            }
+            Encoder.SubmitFrame(std::move(Frame));
+            FramesGenerated++;
+
+            if (Width == Options.Width && Height == Options.Height)
+            {
+                for (FExtraCamera& Camera : ExtraCameras)
+                {
+                    FRawFrameRef CameraFrame = FramePool->Acquire(Width, Height);
+                    std::memcpy(CameraFrame->Data.data(), SourceFrames[(Index / Options.Still) % NumSourceFrames].data(), CameraFrame->Data.size());
+                    CameraFrame->CaptureTime = CaptureTime;
+                    Camera.Encoder->SubmitFrame(std::move(CameraFrame));
+                }
+            }
+
+            FEncodedFrameRef Encoded;
+            if (Options.bPoll && Encoder.GetEncodedFrame(Encoded))
+            {
+                DeliverFrame(std::move(Encoded));
+            }
+        }
+        bGeneratorDone = true;
+    });
+
+    // Audio: a render thread handing the encoder a buffer every AudioBufferFrames samples, like a submix listener
+    std::unique_ptr<FAudioEncoder> AudioEncoder;
+    std::atomic<int64> AudioPacketsEncoded{0};
+    std::thread AudioRenderer;
+    if (Options.bAudio)
+    {
+        FAudioEncoder::FConfig AudioConfig;
+        AudioConfig.NumChannels = Options.AudioChannels;
+        AudioConfig.BitsPerSample = Options.AudioBits;
+        AudioEncoder = std::make_unique<FAudioEncoder>(AudioConfig);
+        AudioRenderer = std::thread([&]
+        {
+            SetCurrentThreadName("BenchAudio");
+            const int32 BufferFrames = std::max(Options.AudioBufferFrames, 16);
+            const int32 Channels = AudioEncoder->GetConfig().NumChannels;
+            std::vector<float> Samples((size_t)BufferFrames * Channels);
+            int64 Rendered = 0;
+            while (!bGeneratorDone)
+            {
+                // 1 kHz tone, a quarter of full scale
+                for (int32 Frame = 0; Frame < BufferFrames; ++Frame)
+                {
+                    const float Sample = 0.25f * (float)std::sin(2.0 * 3.14159265358979 * 1000.0 * (Rendered + Frame) / FAudioEncoder::SampleRate);
+                    std::fill_n(Samples.data() + (size_t)Frame * Channels, Channels, Sample);
+                }
+                Rendered += BufferFrames;
+                const double Due = StartTime + (double)Rendered / FAudioEncoder::SampleRate;
+                const double Now = GetTimeSeconds();
+                if (Due > Now)
+                {
+                    std::this_thread::sleep_for(std::chrono::duration<double>(Due - Now));
+                }
+                AudioEncoder->Encode(Samples.data(), BufferFrames, Channels, FAudioEncoder::SampleRate, GetTimeSeconds(), [&](FEncodedAudioRef Packet)
+                {
+                    AudioPacketsEncoded++;
+                    Stream->TransmitAudio(std::move(Packet));
+                });
+            }
+        });
+    }
+
+#if WITH_SRT
+    // Late receivers: another caller every --join-every seconds while the stream runs, timed from connect to its first keyframe
+    std::vector<std::unique_ptr<FLoopbackReceiver>> LateReceivers;
+    std::thread Joiner;
+    if (Options.Clients > 0 && NumJoins > 0)
+    {
+        Joiner = std::thread([&]
+        {
+            SetCurrentThreadName("BenchJoiner");
+            for (int32 Join = 1; Join <= NumJoins; ++Join)
+            {
+                const double Due = StartTime + Join * Options.JoinEvery;
+                while (!bGeneratorDone && GetTimeSeconds() < Due)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                }
+                if (bGeneratorDone)
+                {
+                    break;
+                }
+                std::unique_ptr<FLoopbackReceiver> Receiver = std::make_unique<FLoopbackReceiver>(Options, Stream->GetStreamId(), nullptr, nullptr);
+                if (Receiver->Connect())
+                {
+                    LateReceivers.push_back(std::move(Receiver));
+                }
+            }
+        });
+    }
+#endif
+    Generator.join();
+    if (AudioRenderer.joinable())
+    {
+        AudioRenderer.join();
+    }
+#if WITH_SRT
+    if (Joiner.joinable())
+    {
+        Joiner.join();
+    }
+#endif
+
+    // Wait for the encoder to finish the tail (in --poll mode nothing drains it any more)
+    int64 LastDelivered = -1;
+    double LastProgressTime = GetTimeSeconds();
+    while (true)
+    {
+        const FEncoderPool::FStats Stats = Encoder.GetStats();
+        const int64 Finished = Stats.FramesEncoded + Stats.FramesDropped + Stats.StaticFrames;
+        if (Finished >= FramesGenerated.load() && (Options.bPoll || FramesDelivered.load() >= Stats.FramesEncoded))
+        {
+            break;
+        }
+        if (Finished != LastDelivered)
+        {
+            LastDelivered = Finished;
+            LastProgressTime = GetTimeSeconds();
+        }
+        else if (GetTimeSeconds() - LastProgressTime > 2.0)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const double EncodeElapsed = GetTimeSeconds() - StartTime;
+    const int64 FramesMuxed = FramesDelivered.load();
+
+    // Every frame is queued for the recorders by now; Stop writes out their backlog, so the rate includes the drain
+    const double RecordStopStart = GetTimeSeconds();
+    for (std::unique_ptr<FRecorder>& Recorder : Recorders)
+    {
+        Recorder->Stop();
+    }
+    const double RecordDrainSeconds = GetTimeSeconds() - RecordStopStart;
+
+    // Let the last frames reach the receivers (SRT delivers them after SRTO_LATENCY)
+#if WITH_SRT
+    if (Options.Clients > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(Options.LatencyMs + 300));
+    }
+#endif
+
+    const FResourceUsage UsageAfter = GetResourceUsage();
+    const int64 CurrentRssKB = GetCurrentRssKB();
+    const int32 NumThreads = GetThreadCount();
+    const FEncoderPool::FStats EncoderStats = Encoder.GetStats();
+    const FTransmitter::FStats TransmitterStats = Stream->GetStats();
+
+    // --- Report ---
+    std::printf("CineSRTBench %s %dx%d @ %d fps, %.1f s, %d encoder workers, %d clients\n",
+        Options.Format == EEncodingFormat::H264 ? "H264" : "MJPEG", Options.Width, Options.Height, Options.FPS,
+        Options.Seconds, EncoderStats.WorkerCount, Options.Clients);
+    std::printf("  generated %lld frames (%lld behind schedule), encoded %d, dropped %d -> %.1f fps achieved\n",
+        (long long)FramesGenerated.load(), (long long)FramesLate.load(), EncoderStats.FramesEncoded, EncoderStats.FramesDropped,
+        FramesMuxed / std::max(EncodeElapsed, 1e-6));
+    if (Options.GameFPS > 0)
+    {
+        const FPipelineStats::FStageSummary Cadence = PipelineStats->GetStage(EPipelineStage::Cadence);
+        std::printf("  cadence: game loop %d fps (+/- %.1f ms), capture error p50 %.2f / p99 %.2f ms, %lld slots missed, %d filled\n",
+            Options.GameFPS, Options.GameJitterMs, Cadence.P50Ms, Cadence.P99Ms,
+            (long long)PipelineStats->GetCounter(EPipelineCounter::SlotsMissed), EncoderStats.FilledSlots);
+    }
+    std::printf("  pts: %lld steps off the %.2f ms grid (worst %.2f ms)\n", (long long)PtsStepsOffGrid, 1000.0 / Options.FPS, MaxPtsStepErrorMs);
+    if (Options.StaticPolicy != EStaticFramePolicy::Encode)
+    {
+        std::printf("  static frames: %d %s (picture changes every %d frames, keep-alive %.1f s, tolerance %d)\n", EncoderStats.StaticFrames,
+            Options.StaticPolicy == EStaticFramePolicy::Repeat ? "repeated" : "skipped", Options.Still, Options.KeepAlive, Options.StaticTolerance);
+    }
+    // Frames streamed while encoding never expose their size to the sink; count the encoder's output instead
+    const int64 TotalBytes = FramesStreamed.load() > 0 ? EncoderStats.TotalBytesEncoded : BytesEncoded.load();
+    std::printf("  encode %.2f ms/frame per worker, %.1f KB/frame, %.2f Mbps\n",
+        EncoderStats.AverageEncodeTime * 1000.0, TotalBytes / 1024.0 / std::max<int64>(FramesMuxed, 1),
+        TotalBytes * 8.0 / std::max(EncodeElapsed, 1e-6) / 1e6);
+    if (Options.SliceRows > 0)
+    {
+        std::printf("  slices: every %d rows, %lld of %lld frames handed to the transmitter while still encoding\n",
+            Options.SliceRows, (long long)FramesStreamed.load(), (long long)FramesMuxed);
+    }
+    std::printf("  delivery %s: %lld frames to the transmitter, output queue depth %d (high water %d, %d evicted)\n",
+        Options.bPoll ? "polled per capture" : "encoder sink", (long long)FramesMuxed,
+        EncoderStats.OutputQueueDepth, EncoderStats.OutputQueueHighWater, EncoderStats.OutputFramesDropped);
+
+    if (SwitchFrame >= 0)
+    {
+        std::printf("  reconfigured to %dx%d at %.2f s: encoders ready after %.1f ms, capture switched at frame %lld (%d swaps);"
+            " largest delivery gap %.1f ms (frame interval %.1f ms)\n",
+            Options.SwitchWidth, Options.SwitchHeight, SwitchRequestTime - StartTime, (SwitchReadyTime - SwitchRequestTime) * 1000.0,
+            (long long)SwitchFrame, EncoderStats.Reconfigurations, MaxDeliveryGap * 1000.0, 1000.0 / Options.FPS);
+    }
+
+    std::printf("Latency (ms):\n");
+    PrintLatency("encode (submit->release)", Encoder.GetEncodeLatency());
+    PrintLatency("capture->transmit", HandoffLatency);
+    if (Options.Clients > 0)
+    {
+        std::printf("  %-26s p50 %7.2f  p95 %7.2f  p99 %7.2f  max %7.2f ms\n", "send (queue->srt buffer)",
+            TransmitterStats.SendLatencyP50, TransmitterStats.SendLatencyP95, TransmitterStats.SendLatencyP99, TransmitterStats.SendLatencyMax);
+        PrintLatency("transmit->receive", WireLatency);
+        PrintLatency("capture->receive", EndToEndLatency);
+        if (FrameLatency.GetCount() > 0)
+        {
+            PrintLatency("capture->whole frame recv", FrameLatency);
+        }
+        if (AudioLatency.GetCount() > 0)
+        {
+            PrintLatency("audio capture->receive", AudioLatency);
+            PrintLatency("audio/video PTS spread", AudioSpread);
+        }
+    }
+    std::printf("Pipeline stages (ms):\n%s\n", PipelineStats->FormatSummary().c_str());
+
+    if (!Recorders.empty())
+    {
+        std::printf("Recording: %d files in %s, %d MB writes, backlog drained in %.1f ms at stop\n", (int32)Recorders.size(),
+            Options.RecordDir.c_str(), Options.RecordBlockMB, RecordDrainSeconds * 1000.0);
+        int64 TotalFrames = 0;
+        int64 TotalWritten = 0;
+        double TotalMBps = 0.0;
+        for (const std::unique_ptr<FRecorder>& Recorder : Recorders)
+        {
+            const FRecorder::FStats RecorderStats = Recorder->GetStats();
+            const FLatencyHistogram& WriteLatency = Recorder->GetWriteLatency();
+            std::printf("  %-10s %lld frames, %.1f MB, %.1f MB/s, %lld dropped, %lld failed, backlog high water %d, %lld writes p50 %.2f / p99 %.2f / max %.2f ms%s\n",
+                Recorder->GetPath().substr(Recorder->GetPath().rfind('/') + 1).c_str(), (long long)RecorderStats.FramesRecorded,
+                RecorderStats.BytesWritten / 1048576.0, RecorderStats.WriteMBps, (long long)RecorderStats.FramesDropped,
+                (long long)RecorderStats.FramesFailed, RecorderStats.BacklogHighWater, (long long)RecorderStats.Writes,
+                WriteLatency.GetPercentileMs(50.0), WriteLatency.GetPercentileMs(99.0), WriteLatency.GetMaxMs(),
+                RecorderStats.bWriteFailed ? " (WRITE FAILED)" : "");
+            TotalFrames += RecorderStats.FramesRecorded;
+            TotalWritten += RecorderStats.BytesWritten;
+            TotalMBps += RecorderStats.WriteMBps;
+        }
+        std::printf("  total      %lld frames, %.1f MB, %.1f MB/s\n", (long long)TotalFrames, TotalWritten / 1048576.0, TotalMBps);
+    }
+
+    if (!ExtraCameras.empty())
+    {
+        std::printf("Cameras: %d on port %d, %d shared encode threads\n", Options.Cameras, Options.Port, Scheduler->GetNumThreads());
+        for (FExtraCamera& Camera : ExtraCameras)
+        {
+            const FEncoderPool::FStats CameraStats = Camera.Encoder->GetStats();
+            std::printf("  %-6s encoded %d, dropped %d", Camera.Stream->GetStreamId().c_str(), CameraStats.FramesEncoded, CameraStats.FramesDropped);
+#if WITH_SRT
+            if (Camera.Receiver)
+            {
+                std::printf(", received %lld", (long long)Camera.Receiver->GetFramesReceived());
+            }
+#endif
+            std::printf("\n");
+        }
+    }
+    if (!Renditions.empty())
+    {
+        std::printf("Renditions: %d scaled from %dx%d\n", (int32)Renditions.size(), Options.Width, Options.Height);
+        for (FExtraCamera& Rendition : Renditions)
+        {
+            const FEncoderPool::FStats RenditionStats = Rendition.Encoder->GetStats();
+            const FPipelineStats::FStageSummary Scale = Rendition.Stats->GetStage(EPipelineStage::Scale);
+            std::printf("  %-9s encoded %d, dropped %d, scale p50 %.2f / p99 %.2f ms", Rendition.Stream->GetStreamId().c_str(),
+                RenditionStats.FramesEncoded, RenditionStats.FramesDropped, Scale.P50Ms, Scale.P99Ms);
+#if WITH_SRT
+            if (Rendition.Receiver)
+            {
+                std::printf(", received %lld", (long long)Rendition.Receiver->GetFramesReceived());
+            }
+#endif
+            std::printf("\n");
+        }
+    }
+
+#if WITH_SRT
+    for (int32 Index = 0; Index < (int32)Receivers.size(); ++Index)
+    {
+        std::printf("Client %d: %lld frames, %.2f Mbps, PCR gap max %.1f ms (%.1f ms on arrival)\n", Index, (long long)Receivers[Index]->GetFramesReceived(),
+            Receivers[Index]->GetBytesReceived() * 8.0 / std::max(EncodeElapsed, 1e-6) / 1e6, Receivers[Index]->GetMaxPcrGapMs(),
+            Receivers[Index]->GetMaxPcrArrivalGapMs());
+        if (Options.bAudio)
+        {
+            const FLoopbackReceiver& Receiver = *Receivers[Index];
+            std::printf("  audio: %lld packets, %.2f s of samples, %lld malformed, %lld PTS gaps; null padding %.2f%% of TS packets\n",
+                (long long)Receiver.GetAudioPacketsReceived(), Receiver.GetAudioSamplesReceived() / (double)FAudioEncoder::SampleRate,
+                (long long)Receiver.GetAudioErrors(), (long long)Receiver.GetAudioGaps(),
+                100.0 * Receiver.GetNullPackets() / std::max<int64>(Receiver.GetPacketsReceived(), 1));
+        }
+    }
+    if (!LateReceivers.empty())
+    {
+        FLatencyHistogram JoinLatency;
+        for (const std::unique_ptr<FLoopbackReceiver>& Receiver : LateReceivers)
+        {
+            if (Receiver->GetTimeToFirstPicture() >= 0.0)
+            {
+                JoinLatency.Record(Receiver->GetTimeToFirstPicture());
+            }
+        }
+        std::printf("Joins: %d receivers every %.1f s, join cache %d MB, keyframe on join %s\n", (int32)LateReceivers.size(), Options.JoinEvery,
+            Options.JoinCacheMB, Options.bKeyframeOnJoin ? "on" : "off");
+        PrintLatency("connect->first keyframe", JoinLatency);
+        std::printf("  %-26s p50 %7.2f  max %7.2f ms  (%lld from cache, %lld keyframes requested)\n", "connect->keyframe sent",
+            TransmitterStats.TimeToFirstPictureP50, TransmitterStats.TimeToFirstPictureMax,
+            (long long)TransmitterStats.ClientsJoinedFromCache, (long long)TransmitterStats.KeyframesRequested);
+    }
+    if (Options.Clients > 0)
+    {
+        std::printf("Transmitter: queued %lld, sent %lld, dropped %lld oldest / %lld non-key / %lld timeout, %lld client drops\n",
+            (long long)TransmitterStats.FramesQueued, (long long)TransmitterStats.FramesSent, (long long)TransmitterStats.DroppedOldest,
+            (long long)TransmitterStats.DroppedNonKeyframes, (long long)TransmitterStats.DroppedBlockTimeout,
+            (long long)TransmitterStats.ClientFramesDropped);
+        std::printf("Start-up (%s): SRT startup %.2f ms, listener prepare %.2f ms, StartTransmission %.2f ms, encoder warm-up %.1f ms\n",
+            Options.bPrewarm ? "prewarmed" : "cold", SRTStartupMs, PrepareMs, StartTransmissionMs, EncoderStats.WarmUpTime * 1000.0f);
+        std::printf("  first frame capture->transmit %.2f ms, first capture->first packet sent %.2f ms (frame interval %.2f ms)\n",
+            FirstHandoffMs, TransmitterStats.TimeToFirstPacket, 1000.0 / Options.FPS);
+        if (Options.bAudio)
+        {
+            std::printf("Audio: %d ch %d-bit SMPTE 302M, %lld packets encoded, %lld sent, %lld dropped, %d clock resyncs\n",
+                AudioEncoder->GetConfig().NumChannels, AudioEncoder->GetConfig().BitsPerSample, (long long)AudioPacketsEncoded.load(),
+                (long long)TransmitterStats.AudioPacketsSent, (long long)TransmitterStats.AudioPacketsDropped, AudioEncoder->GetClockResyncs());
+        }
+    }
+#endif
+
+    const double CpuSeconds = UsageAfter.CpuSeconds - UsageBefore.CpuSeconds;
+    std::printf("CPU: %.1f%% of one core (%.2f s over %.2f s, %d cores available)\n",
+        CpuSeconds / std::max(EncodeElapsed, 1e-6) * 100.0, CpuSeconds, EncodeElapsed, GetNumberOfCores());
+    std::printf("Memory: RSS %.1f MB, peak %.1f MB, frame pool %d buffers (%d allocations)\n",
+        CurrentRssKB / 1024.0, std::max(UsageAfter.PeakRssKB, CurrentRssKB) / 1024.0, FramePool->GetStats().TotalFrames, FramePool->GetStats().Allocations);
+    if (NumThreads > 0)
+    {
+        std::printf("Threads: %d in the process\n", NumThreads);
+    }
+
+#if WITH_SRT
+    for (std::unique_ptr<FLoopbackReceiver>& Receiver : Receivers)
+    {
+        Receiver->Stop();
+    }
+    for (std::unique_ptr<FLoopbackReceiver>& Receiver : LateReceivers)
+    {
+        Receiver->Stop();
+    }
+    for (FExtraCamera& Camera : ExtraCameras)
+    {
+        if (Camera.Receiver)
+        {
+            Camera.Receiver->Stop();
+        }
+    }
+    for (FExtraCamera& Rendition : Renditions)
+    {
+        if (Rendition.Receiver)
+        {
+            Rendition.Receiver->Stop();
+        }
+    }
+#endif
+    const std::vector<FTransmitter::FClientStats> ClientStats = Stream->GetClientStats();
+    Transmitter.StopTransmission();
+    Encoder.Stop();
+    for (FExtraCamera& Camera : ExtraCameras)
+    {
+        Camera.Encoder->Stop();
+    }
+    for (FExtraCamera& Rendition : Renditions)
+    {
+        Rendition.Encoder->Stop();
+    }
+
+    // Link samples stop with the transmitter thread, so the controller history is stable from here
+    if (Options.bAdaptiveBitrate)
+    {
+        std::printf("Adaptive bitrate (%s, %d rungs, link cap %s):\n", Options.Format == EEncodingFormat::H264 ? "bitrate" : "JPEG quality",
+            Controller.GetNumRungs(), Options.LinkMbps > 0 ? (std::to_string(Options.LinkMbps) + " Mbps").c_str() : "none");
+        for (const FRungChange& Change : RungChanges)
+        {
+            const FBitrateRung& Rung = ControllerSettings.Ladder[Change.Rung];
+            std::printf("  %6.1f s  -> rung %d (%d Kbps, quality %d)  rtt %.1f ms, send buffer %d ms, %.2f Mbps sent, %lld lost, %lld dropped\n",
+                Change.Time - StartTime, Change.Rung, Rung.Bitrate, Rung.JpegQuality, Change.Link.RttMs, Change.Link.SendBufferMs,
+                Change.Link.SendRateMbps, (long long)Change.Link.PacketsLost, (long long)Change.Link.PacketsDropped);
+        }
+        for (int32 Index = 0; Index < Controller.GetNumRungs(); ++Index)
+        {
+            if (RungSeconds[Index] > 0.0)
+            {
+                std::printf("  rung %d: %.1f s\n", Index, RungSeconds[Index]);
+            }
+        }
+        std::printf("  final rung %d, upgrade hold %.0f s\n", Controller.GetCurrentRungIndex(), Controller.GetUpgradeHoldSeconds());
+    }
+    for (int32 Index = 0; Index < (int32)ClientStats.size(); ++Index)
+    {
+        std::printf("Link %d: rtt %.1f ms, %lld packets lost, %lld dropped too late\n", Index, ClientStats[Index].RttMs,
+            (long long)ClientStats[Index].PacketsLost, (long long)ClientStats[Index].PacketsDropped);
+    }
+#if WITH_SRT
+    FTransmitter::ShutdownSRT();
+#endif
+    return 0;
+}